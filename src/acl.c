@@ -0,0 +1,199 @@
+/*
+  SPDX-License-Identifier: MIT
+  Copyright(c) 2023 Sriram Yagnaraman.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/queue.h>
+
+#include <rte_acl.h>
+#include <rte_malloc.h>
+
+#include "acl.h"
+#include "policer.h"
+#include "node/policer.h"
+
+static struct acl_rule_head acl_rule_node = TAILQ_HEAD_INITIALIZER(acl_rule_node);
+
+/* Indexed by rule id, tens of thousands of rules make a list walk per
+ * add too slow.
+ */
+static struct acl_rule *acl_rule_array[ACL_RULE_ID_MAX];
+
+static uint32_t acl_nb_rules;
+static uint8_t acl_default_action = IP4_ACL_PERMIT;
+static uint8_t acl_started;
+
+struct acl_rule*
+acl_rule_config_get(uint32_t rule_id)
+{
+	if (rule_id >= ACL_RULE_ID_MAX)
+		return NULL;
+
+	return acl_rule_array[rule_id];
+}
+
+int
+acl_rule_config_add(struct acl_rule_config *config)
+{
+	struct ip4_acl_rule *rule = &config->rule;
+	struct acl_rule *r;
+
+	if (config->rule_id >= ACL_RULE_ID_MAX)
+		return -EINVAL;
+
+	if (rule->action >= IP4_ACL_ACTION_MAX || rule->policer >= POLICER_MAX ||
+	    rule->priority < RTE_ACL_MIN_PRIORITY ||
+	    rule->priority > RTE_ACL_MAX_PRIORITY ||
+	    rule->src_depth > 32 || rule->dst_depth > 32 ||
+	    rule->sport_lo > rule->sport_hi ||
+	    rule->dport_lo > rule->dport_hi)
+		return -EINVAL;
+
+	if (acl_rule_array[config->rule_id])
+		return -EEXIST;
+
+	r = rte_malloc(NULL, sizeof(struct acl_rule), 0);
+	if (!r)
+		return -ENOMEM;
+
+	memcpy(&r->config, config, sizeof(*config));
+	TAILQ_INSERT_TAIL(&acl_rule_node, r, next);
+	acl_rule_array[config->rule_id] = r;
+	acl_nb_rules++;
+	return 0;
+}
+
+int
+acl_rule_config_rem(uint32_t rule_id)
+{
+	struct acl_rule *r = acl_rule_config_get(rule_id);
+
+	if (!r)
+		return -ENOENT;
+
+	TAILQ_REMOVE(&acl_rule_node, r, next);
+	acl_rule_array[rule_id] = NULL;
+	acl_nb_rules--;
+	rte_free(r);
+	return 0;
+}
+
+int
+acl_rule_config_set_policer(uint32_t rule_id, uint8_t policer)
+{
+	struct acl_rule *r = acl_rule_config_get(rule_id);
+
+	if (!r)
+		return -ENOENT;
+
+	if (policer >= POLICER_MAX)
+		return -EINVAL;
+
+	r->config.rule.policer = policer;
+	return 0;
+}
+
+int
+acl_rule_config_walk(acl_rule_walk_cb cb, void *data)
+{
+	struct acl_rule *r;
+	int rc = 0;
+
+	TAILQ_FOREACH(r, &acl_rule_node, next) {
+		rc = cb(&r->config, data);
+		if (rc < 0)
+			break;
+	}
+
+	return rc;
+}
+
+int
+acl_config_set_default(uint8_t action)
+{
+	if (action >= IP4_ACL_ACTION_MAX)
+		return -EINVAL;
+
+	acl_default_action = action;
+	return 0;
+}
+
+uint8_t
+acl_config_get_default(void)
+{
+	return acl_default_action;
+}
+
+int
+acl_commit(void)
+{
+	struct ip4_acl_rule *rules = NULL;
+	struct acl_rule *r;
+	uint32_t i = 0;
+	int rc;
+
+	/* Picked up by acl_start() */
+	if (!acl_started)
+		return 0;
+
+	if (acl_nb_rules) {
+		rules = rte_malloc(NULL, acl_nb_rules * sizeof(*rules), 0);
+		if (!rules)
+			return -ENOMEM;
+
+		/* An unconfigured policer has no rates to meter with */
+		TAILQ_FOREACH(r, &acl_rule_node, next) {
+			if (r->config.rule.policer != POLICER_ID_NONE &&
+			    !policer_config_get(r->config.rule.policer)) {
+				RTE_LOG(INFO, USER1, "ACL rule %u: policer %u not configured\n",
+					r->config.rule_id, r->config.rule.policer);
+				rte_free(rules);
+				return -ENOENT;
+			}
+			rules[i++] = r->config.rule;
+		}
+	}
+
+	rc = ip4_acl_rules_set(rules, acl_nb_rules, acl_default_action);
+	rte_free(rules);
+	return rc;
+}
+
+int
+acl_start(struct rte_rcu_qsbr *qsv)
+{
+	int rc;
+
+	/* The node is only in the graph if something was configured */
+	if (acl_started ||
+	    (TAILQ_EMPTY(&acl_rule_node) && acl_default_action == IP4_ACL_PERMIT))
+		return 0;
+
+	rc = ip4_acl_init(qsv, SOCKET_ID_ANY);
+	if (rc < 0)
+		return rc;
+
+	acl_started = 1;
+	rc = acl_commit();
+	if (rc < 0)
+		goto err;
+
+	return 0;
+
+err:
+	acl_started = 0;
+	ip4_acl_fini();
+	return rc;
+}
+
+void
+acl_stop(void)
+{
+	if (!acl_started)
+		return;
+
+	ip4_acl_fini();
+	acl_started = 0;
+}
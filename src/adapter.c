@@ -0,0 +1,397 @@
+/*
+  SPDX-License-Identifier: MIT
+  Copyright(c) 2023 Sriram Yagnaraman.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <rte_ethdev.h>
+#include <rte_eventdev.h>
+#include <rte_event_eth_rx_adapter.h>
+#include <rte_event_eth_tx_adapter.h>
+#include <rte_lcore.h>
+#include <rte_service.h>
+
+#include "adapter.h"
+#include "mempool.h"
+#include "stage.h"
+#include "node/eventdev_rx.h"
+
+#define ADAPTER_MAX_NB_RX	(128)
+#define ADAPTER_MAX_NB_TX	(128)
+
+static struct adapter_params adapters[RTE_EVENT_MAX_DEVS];
+
+void
+adapter_init(uint8_t ev_id)
+{
+	struct adapter_params *adapter = &adapters[ev_id];
+	int i;
+
+	memset(adapter, 0, sizeof(*adapter));
+	adapter->ev_id = ev_id;
+	adapter->id = ev_id;
+	adapter->rx.ev_port_id = ADAPTER_EV_PORT_INVALID;
+	adapter->tx.ev_port_id = ADAPTER_EV_PORT_INVALID;
+	for (i = 0; i < RTE_MAX_ETHPORTS; i++)
+		adapter->tx.txq[i] = ADAPTER_TXQ_INVALID;
+}
+
+struct adapter_params *
+adapter_params_get(uint8_t ev_id)
+{
+	return &adapters[ev_id];
+}
+
+/* Called while counting event ports, an adapter only needs a port of its
+ * own when the PMD cannot deliver to or from the event device itself.
+ */
+int
+adapter_stage_reserve(struct stage_config *stage_config, int *nb_ports)
+{
+	struct adapter_params *adapter = &adapters[stage_config->ev_id];
+	struct stage_link_queue_config *qconf;
+	int nb_links = 0, nb_internal = 0;
+	uint32_t caps;
+	int rc, i;
+
+	switch (stage_config->type) {
+	case STAGE_TYPE_RX:
+		adapter->rx.enabled = 1;
+		adapter->rx.coremask |= stage_config->coremask;
+		for (i = 0; i < STAGE_MAX_LINK_QUEUES; i++) {
+			qconf = &stage_config->link_in_queue[i];
+			if (!qconf->enabled)
+				continue;
+
+			rc = rte_event_eth_rx_adapter_caps_get(adapter->ev_id, qconf->link_id, &caps);
+			if (rc < 0)
+				return rc;
+
+			if (!(caps & RTE_EVENT_ETH_RX_ADAPTER_CAP_INTERNAL_PORT) &&
+			    adapter->rx.ev_port_id == ADAPTER_EV_PORT_INVALID)
+				adapter->rx.ev_port_id = (*nb_ports)++;
+		}
+		break;
+	case STAGE_TYPE_TX:
+		// Workers pick the Tx path per event device, not per link
+		if (adapter->tx.enabled)
+			return -EEXIST;
+
+		adapter->tx.enabled = 1;
+		adapter->tx.coremask = stage_config->coremask;
+		adapter->tx.ev_queue = stage_config->ev_queue.in;
+		for (i = 0; i < STAGE_MAX_LINK_QUEUES; i++) {
+			qconf = &stage_config->link_out_queue[i];
+			if (!qconf->enabled)
+				continue;
+
+			rc = rte_event_eth_tx_adapter_caps_get(adapter->ev_id, qconf->link_id, &caps);
+			if (rc < 0)
+				return rc;
+
+			if (caps & RTE_EVENT_ETH_TX_ADAPTER_CAP_INTERNAL_PORT)
+				nb_internal++;
+			nb_links++;
+			adapter->tx.txq[qconf->link_id] = qconf->queue_id;
+		}
+
+		if (nb_internal && nb_internal != nb_links)
+			return -ENOTSUP;
+
+		adapter->tx.internal_port = (nb_links && nb_internal == nb_links);
+		if (!adapter->tx.internal_port)
+			adapter->tx.ev_port_id = (*nb_ports)++;
+		break;
+	default:
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
+static int
+adapter_port_setup(uint8_t ev_id, uint8_t ev_port_id)
+{
+	struct rte_event_port_conf port_conf;
+	int rc;
+
+	if (ev_port_id == ADAPTER_EV_PORT_INVALID)
+		return -ENOSPC;
+
+	rc = rte_event_port_default_conf_get(ev_id, ev_port_id, &port_conf);
+	if (rc < 0)
+		return rc;
+
+	return rte_event_port_setup(ev_id, ev_port_id, &port_conf);
+}
+
+static int
+adapter_rx_conf_cb(__rte_unused uint8_t id, uint8_t ev_id,
+		   struct rte_event_eth_rx_adapter_conf *conf, void *arg)
+{
+	struct adapter_params *params = arg;
+	int rc;
+
+	rc = adapter_port_setup(ev_id, params->rx.ev_port_id);
+	if (rc < 0)
+		return rc;
+
+	conf->event_port_id = params->rx.ev_port_id;
+	conf->max_nb_rx = ADAPTER_MAX_NB_RX;
+	return 0;
+}
+
+static int
+adapter_tx_conf_cb(__rte_unused uint8_t id, uint8_t ev_id,
+		   struct rte_event_eth_tx_adapter_conf *conf, void *arg)
+{
+	struct adapter_params *params = arg;
+	int rc;
+
+	rc = adapter_port_setup(ev_id, params->tx.ev_port_id);
+	if (rc < 0)
+		return rc;
+
+	conf->event_port_id = params->tx.ev_port_id;
+	conf->max_nb_tx = ADAPTER_MAX_NB_TX;
+	return 0;
+}
+
+static int
+adapter_rx_vector_setup(struct stage_config *stage_config, uint16_t link_id,
+			struct rte_event_eth_rx_adapter_queue_conf *queue_conf)
+{
+	struct rte_event_eth_rx_adapter_vector_limits limits;
+	struct stage_vector_config *vector = &stage_config->vector;
+	struct adapter_params *adapter = &adapters[stage_config->ev_id];
+	struct mempool *m;
+	uint32_t caps;
+	int rc;
+
+	rc = rte_event_eth_rx_adapter_caps_get(adapter->ev_id, link_id, &caps);
+	if (rc < 0)
+		return rc;
+
+	if (!(caps & RTE_EVENT_ETH_RX_ADAPTER_CAP_EVENT_VECTOR))
+		return -ENOTSUP;
+
+	rc = rte_event_eth_rx_adapter_vector_limits_get(adapter->ev_id, link_id, &limits);
+	if (rc < 0)
+		return rc;
+
+	if (vector->size < limits.min_sz || vector->size > limits.max_sz ||
+	    vector->size > EVENTDEV_VECTOR_SIZE_MAX ||
+	    (limits.log2_sz && !rte_is_power_of_2(vector->size)) ||
+	    vector->timeout_ns < limits.min_timeout_ns ||
+	    vector->timeout_ns > limits.max_timeout_ns)
+		return -EINVAL;
+
+	m = mempool_config_get(vector->mp_name);
+	if (!m)
+		return -ENOENT;
+
+	queue_conf->rx_queue_flags |= RTE_EVENT_ETH_RX_ADAPTER_QUEUE_EVENT_VECTOR;
+	queue_conf->vector_sz = vector->size;
+	queue_conf->vector_timeout_ns = vector->timeout_ns;
+	queue_conf->vector_mp = m->mp;
+	return 0;
+}
+
+static int
+adapter_rx_setup(struct stage_config *stage_config)
+{
+	struct adapter_params *adapter = &adapters[stage_config->ev_id];
+	struct rte_event_eth_rx_adapter_queue_conf queue_conf;
+	struct stage_link_queue_config *qconf;
+	int rc, i;
+
+	if (!adapter->rx.created) {
+		rc = rte_event_eth_rx_adapter_create_ext(adapter->id, adapter->ev_id,
+							 adapter_rx_conf_cb, adapter);
+		if (rc < 0)
+			return rc;
+		adapter->rx.created = 1;
+	}
+
+	memset(&queue_conf, 0, sizeof(queue_conf));
+	queue_conf.servicing_weight = 1;
+	queue_conf.ev.queue_id = stage_config->ev_queue.out;
+	queue_conf.ev.sched_type = stage_config->ev_queue.sched_type_out;
+	queue_conf.ev.priority = RTE_EVENT_DEV_PRIORITY_NORMAL;
+
+	for (i = 0; i < STAGE_MAX_LINK_QUEUES; i++) {
+		qconf = &stage_config->link_in_queue[i];
+		if (!qconf->enabled)
+			continue;
+
+		if (stage_config->vector.size) {
+			rc = adapter_rx_vector_setup(stage_config, qconf->link_id, &queue_conf);
+			if (rc < 0) {
+				RTE_LOG(INFO, USER1, "Rx adapter vector (%u) setup failed\n",
+					qconf->link_id);
+				return rc;
+			}
+		}
+
+		rc = rte_event_eth_rx_adapter_queue_add(adapter->id, qconf->link_id,
+							qconf->queue_id, &queue_conf);
+		if (rc < 0) {
+			RTE_LOG(INFO, USER1, "Rx adapter queue add (%u:%u) failed\n",
+				qconf->link_id, qconf->queue_id);
+			return rc;
+		}
+	}
+
+	return 0;
+}
+
+static int
+adapter_tx_setup(struct stage_config *stage_config)
+{
+	struct adapter_params *adapter = &adapters[stage_config->ev_id];
+	struct stage_link_queue_config *qconf;
+	uint8_t ev_port_id;
+	int rc, i;
+
+	if (!adapter->tx.created) {
+		rc = rte_event_eth_tx_adapter_create_ext(adapter->id, adapter->ev_id,
+							 adapter_tx_conf_cb, adapter);
+		if (rc < 0)
+			return rc;
+		adapter->tx.created = 1;
+	}
+
+	for (i = 0; i < STAGE_MAX_LINK_QUEUES; i++) {
+		qconf = &stage_config->link_out_queue[i];
+		if (!qconf->enabled)
+			continue;
+
+		rc = rte_event_eth_tx_adapter_queue_add(adapter->id, qconf->link_id,
+							qconf->queue_id);
+		if (rc < 0) {
+			RTE_LOG(INFO, USER1, "Tx adapter queue add (%u:%u) failed\n",
+				qconf->link_id, qconf->queue_id);
+			return rc;
+		}
+	}
+
+	if (adapter->tx.internal_port)
+		return 0;
+
+	// The adapter service dequeues what the workers send to the Tx queue
+	rc = rte_event_eth_tx_adapter_event_port_get(adapter->id, &ev_port_id);
+	if (rc < 0)
+		return rc;
+
+	rc = rte_event_port_link(adapter->ev_id, ev_port_id, &adapter->tx.ev_queue, NULL, 1);
+	if (rc != 1)
+		return -rte_errno;
+
+	return 0;
+}
+
+int
+adapter_stage_setup(struct stage_config *stage_config, __rte_unused void *data)
+{
+	if (!stage_config->adapter)
+		return 0;
+
+	switch (stage_config->type) {
+	case STAGE_TYPE_RX:
+		return adapter_rx_setup(stage_config);
+	case STAGE_TYPE_TX:
+		return adapter_tx_setup(stage_config);
+	default:
+		return -EINVAL;
+	}
+}
+
+/* Run the adapter service on the stage cores, or on the EAL service
+ * cores when the stage has none.
+ */
+static int
+adapter_service_start(uint32_t service_id, uint32_t coremask)
+{
+	uint16_t core_id;
+	int rc;
+
+	if (!coremask) {
+		rte_service_runstate_set(service_id, 1);
+		rte_service_set_runstate_mapped_check(service_id, 0);
+		return 0;
+	}
+
+	RTE_LCORE_FOREACH_WORKER(core_id) {
+		if (!(coremask & (1UL << core_id)))
+			continue;
+
+		rc = rte_service_lcore_add(core_id);
+		if (rc < 0 && rc != -EALREADY)
+			return rc;
+
+		rc = rte_service_map_lcore_set(service_id, core_id, 1);
+		if (rc < 0)
+			return rc;
+
+		rc = rte_service_lcore_start(core_id);
+		if (rc < 0 && rc != -EALREADY)
+			return rc;
+	}
+
+	return rte_service_runstate_set(service_id, 1);
+}
+
+int
+adapter_start(uint8_t ev_id)
+{
+	struct adapter_params *adapter = &adapters[ev_id];
+	uint32_t service_id;
+	int rc;
+
+	if (adapter->rx.created) {
+		rc = rte_event_eth_rx_adapter_start(adapter->id);
+		if (rc < 0)
+			return rc;
+
+		// No service when every link has an internal port
+		rc = rte_event_eth_rx_adapter_service_id_get(adapter->id, &service_id);
+		if (rc == 0)
+			rc = adapter_service_start(service_id, adapter->rx.coremask);
+		if (rc < 0 && rc != -ESRCH)
+			return rc;
+	}
+
+	if (adapter->tx.created) {
+		rc = rte_event_eth_tx_adapter_start(adapter->id);
+		if (rc < 0)
+			return rc;
+
+		rc = rte_event_eth_tx_adapter_service_id_get(adapter->id, &service_id);
+		if (rc == 0)
+			rc = adapter_service_start(service_id, adapter->tx.coremask);
+		if (rc < 0 && rc != -ESRCH)
+			return rc;
+	}
+
+	return 0;
+}
+
+void
+adapter_stop(uint8_t ev_id)
+{
+	struct adapter_params *adapter = &adapters[ev_id];
+
+	if (adapter->rx.created) {
+		rte_event_eth_rx_adapter_stop(adapter->id);
+		rte_event_eth_rx_adapter_free(adapter->id);
+		adapter->rx.created = 0;
+	}
+
+	if (adapter->tx.created) {
+		rte_event_eth_tx_adapter_stop(adapter->id);
+		rte_event_eth_tx_adapter_free(adapter->id);
+		adapter->tx.created = 0;
+	}
+}
@@ -0,0 +1,255 @@
+/*
+  SPDX-License-Identifier: MIT
+  Copyright(c) 2023 Sriram Yagnaraman.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/queue.h>
+
+#include <rte_alarm.h>
+#include <rte_cycles.h>
+#include <rte_malloc.h>
+
+#include "bridge.h"
+#include "link.h"
+
+#define BRIDGE_AGE_TICKS	(US_PER_S / BRIDGE_LEARN_INTERVAL_US)
+
+static struct bridge_head bridge_node = TAILQ_HEAD_INITIALIZER(bridge_node);
+
+static uint8_t bridge_started;
+static uint32_t bridge_ticks;
+
+struct bridge*
+bridge_config_get(char const *name)
+{
+	struct bridge *b;
+
+	TAILQ_FOREACH(b, &bridge_node, next) {
+		if (strcmp(b->config.name, name) == 0)
+			return b;
+	}
+	return NULL;
+}
+
+static struct bridge*
+bridge_config_get_by_link(uint16_t link_id)
+{
+	struct bridge *b;
+	uint16_t i;
+
+	TAILQ_FOREACH(b, &bridge_node, next) {
+		for (i = 0; i < b->config.nb_links; i++) {
+			if (b->config.link_id[i] == link_id)
+				return b;
+		}
+	}
+	return NULL;
+}
+
+static int
+bridge_alloc_id()
+{
+	uint64_t used = 0;
+	struct bridge *b;
+	uint16_t bd_id;
+
+	TAILQ_FOREACH(b, &bridge_node, next) {
+		used |= 1ULL << b->config.bd_id;
+	}
+
+	for (bd_id = 0; bd_id < L2_BRIDGE_MAX_DOMAINS; bd_id++) {
+		if (!(used & (1ULL << bd_id)))
+			return bd_id;
+	}
+
+	return -ENOSPC;
+}
+
+int
+bridge_config_add(struct bridge_config *config)
+{
+	int rc = -EINVAL;
+	struct bridge *b;
+
+	if (bridge_started)
+		return -EBUSY;
+
+	b = bridge_config_get(config->name);
+	if (b)
+		return -EEXIST;
+
+	rc = bridge_alloc_id();
+	if (rc < 0)
+		return rc;
+
+	b = rte_malloc(NULL, sizeof(struct bridge), 0);
+	if (!b)
+		return -ENOMEM;
+
+	config->bd_id = rc;
+	config->nb_links = 0;
+	if (!config->fdb_size)
+		config->fdb_size = BRIDGE_FDB_SIZE_DEFAULT;
+
+	memcpy(&b->config, config, sizeof(*config));
+	TAILQ_INSERT_TAIL(&bridge_node, b, next);
+	return 0;
+}
+
+int
+bridge_config_rem(char const *name)
+{
+	struct bridge *b = bridge_config_get(name);
+
+	if (!b)
+		return -ENOENT;
+
+	if (bridge_started)
+		return -EBUSY;
+
+	TAILQ_REMOVE(&bridge_node, b, next);
+	rte_free(b);
+	return 0;
+}
+
+int
+bridge_config_add_link(char const *name, char const *link_name)
+{
+	struct bridge *b = bridge_config_get(name);
+	struct link *l = link_config_get(link_name);
+
+	if (!b || !l)
+		return -ENOENT;
+
+	if (bridge_started)
+		return -EBUSY;
+
+	if (bridge_config_get_by_link(l->config.link_id))
+		return -EEXIST;
+
+	if (b->config.nb_links == L2_BRIDGE_MAX_MEMBERS)
+		return -ENOSPC;
+
+	b->config.link_id[b->config.nb_links++] = l->config.link_id;
+	return 0;
+}
+
+int
+bridge_config_set_fdb_size(char const *name, uint32_t fdb_size)
+{
+	struct bridge *b = bridge_config_get(name);
+
+	if (!b)
+		return -ENOENT;
+
+	if (bridge_started)
+		return -EBUSY;
+
+	if (fdb_size == 0)
+		return -EINVAL;
+
+	b->config.fdb_size = fdb_size;
+	return 0;
+}
+
+int
+bridge_config_set_ageing(char const *name, uint16_t ageing_s)
+{
+	struct bridge *b = bridge_config_get(name);
+
+	if (!b)
+		return -ENOENT;
+
+	b->config.ageing_s = ageing_s;
+	if (bridge_started)
+		return l2_bridge_domain_set(b->config.bd_id, ageing_s);
+
+	return 0;
+}
+
+int
+bridge_fdb_flush(char const *name)
+{
+	struct bridge *b = bridge_config_get(name);
+
+	if (!b)
+		return -ENOENT;
+
+	if (!bridge_started)
+		return 0;
+
+	return l2_bridge_fdb_flush(b->config.bd_id);
+}
+
+/* Learning is drained often to keep the ring short, ageing runs once a
+ * second. Both stay off the workers.
+ */
+static void
+bridge_alarm_cb(__rte_unused void *arg)
+{
+	l2_bridge_fdb_learn();
+
+	if (++bridge_ticks == BRIDGE_AGE_TICKS) {
+		bridge_ticks = 0;
+		l2_bridge_fdb_age();
+	}
+
+	rte_eal_alarm_set(BRIDGE_LEARN_INTERVAL_US, bridge_alarm_cb, NULL);
+}
+
+int
+bridge_start(struct rte_rcu_qsbr *qsv)
+{
+	uint32_t fdb_size = 0;
+	struct bridge *b;
+	int rc = 0;
+	uint16_t i;
+
+	if (bridge_started || TAILQ_EMPTY(&bridge_node))
+		return 0;
+
+	/* One FDB for all domains, the domain id is part of the key */
+	TAILQ_FOREACH(b, &bridge_node, next) {
+		fdb_size += b->config.fdb_size;
+	}
+
+	rc = l2_bridge_init(fdb_size, qsv, SOCKET_ID_ANY);
+	if (rc < 0)
+		return rc;
+
+	TAILQ_FOREACH(b, &bridge_node, next) {
+		rc = l2_bridge_domain_set(b->config.bd_id, b->config.ageing_s);
+		if (rc < 0)
+			goto err;
+
+		for (i = 0; i < b->config.nb_links; i++) {
+			rc = l2_bridge_domain_add_link(b->config.bd_id, b->config.link_id[i]);
+			if (rc < 0)
+				goto err;
+		}
+	}
+
+	rc = rte_eal_alarm_set(BRIDGE_LEARN_INTERVAL_US, bridge_alarm_cb, NULL);
+	if (rc < 0)
+		goto err;
+
+	bridge_started = 1;
+	return 0;
+
+err:
+	l2_bridge_fini();
+	return rc;
+}
+
+void
+bridge_stop(void)
+{
+	if (!bridge_started)
+		return;
+
+	rte_eal_alarm_cancel(bridge_alarm_cb, NULL);
+	l2_bridge_fini();
+	bridge_started = 0;
+}
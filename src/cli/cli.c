@@ -17,9 +17,16 @@
 #include <cmdline_socket.h>
 
 #include "cli.h"
+#include "cli_acl.h"
+#include "cli_bridge.h"
+#include "cli_exception.h"
 #include "cli_link.h"
 #include "cli_mempool.h"
+#include "cli_nat.h"
+#include "cli_policer.h"
 #include "cli_stage.h"
+#include "cli_tunnel.h"
+#include "cli_tx_sched.h"
 #include "cli_vswitch.h"
 
 static struct cmdline *cl;
@@ -28,11 +35,22 @@ cmdline_parse_ctx_t commands_ctx[] = {
 	(cmdline_parse_inst_t *)&link_show_cmd_ctx,
 	(cmdline_parse_inst_t *)&link_dev_show_cmd_ctx,
 	(cmdline_parse_inst_t *)&link_dev_config_add_cmd_ctx,
+	(cmdline_parse_inst_t *)&link_dev_config_add_vhost_cmd_ctx,
+	(cmdline_parse_inst_t *)&link_dev_config_add_vhost_mbufs_cmd_ctx,
+	(cmdline_parse_inst_t *)&link_dev_config_add_memif_cmd_ctx,
+	(cmdline_parse_inst_t *)&link_dev_config_add_memif_ring_cmd_ctx,
+	(cmdline_parse_inst_t *)&link_dev_config_add_afxdp_cmd_ctx,
 	(cmdline_parse_inst_t *)&link_dev_config_rem_cmd_ctx,
 	(cmdline_parse_inst_t *)&link_dev_config_show_cmd_ctx,
 	(cmdline_parse_inst_t *)&link_dev_config_set_promiscuous_cmd_ctx,
 	(cmdline_parse_inst_t *)&link_dev_config_set_mtu_cmd_ctx,
 	(cmdline_parse_inst_t *)&link_dev_config_set_peer_cmd_ctx,
+	(cmdline_parse_inst_t *)&link_dev_config_set_rss_cmd_ctx,
+	(cmdline_parse_inst_t *)&link_dev_config_set_vlan_cmd_ctx,
+	(cmdline_parse_inst_t *)&link_dev_config_set_vlan_native_cmd_ctx,
+	(cmdline_parse_inst_t *)&link_dev_config_set_vlan_off_cmd_ctx,
+	(cmdline_parse_inst_t *)&link_dev_config_set_tx_csum_cmd_ctx,
+	(cmdline_parse_inst_t *)&link_dev_config_set_reassembly_cmd_ctx,
 
 	(cmdline_parse_inst_t *)&mempool_add_cmd_ctx,
 	(cmdline_parse_inst_t *)&mempool_rem_show_cmd_ctx,
@@ -41,14 +59,58 @@ cmdline_parse_ctx_t commands_ctx[] = {
 	(cmdline_parse_inst_t *)&stage_rem_cmd_ctx,
 	(cmdline_parse_inst_t *)&stage_show_cmd_ctx,
 	(cmdline_parse_inst_t *)&stage_set_type_cmd_ctx,
+	(cmdline_parse_inst_t *)&stage_set_eventdev_cmd_ctx,
 	(cmdline_parse_inst_t *)&stage_set_queue_in_cmd_ctx,
 	(cmdline_parse_inst_t *)&stage_set_queue_out_cmd_ctx,
 	(cmdline_parse_inst_t *)&stage_set_link_queue_in_cmd_ctx,
 	(cmdline_parse_inst_t *)&stage_set_link_queue_out_cmd_ctx,
 	(cmdline_parse_inst_t *)&stage_set_graph_nodes_cmd_ctx,
+	(cmdline_parse_inst_t *)&stage_set_flow_hash_cmd_ctx,
+	(cmdline_parse_inst_t *)&stage_set_adapter_cmd_ctx,
+	(cmdline_parse_inst_t *)&stage_set_vector_cmd_ctx,
+	(cmdline_parse_inst_t *)&stage_set_flow_cache_cmd_ctx,
+	(cmdline_parse_inst_t *)&stage_set_conntrack_cmd_ctx,
+
+	(cmdline_parse_inst_t *)&bridge_add_cmd_ctx,
+	(cmdline_parse_inst_t *)&bridge_rem_show_cmd_ctx,
+	(cmdline_parse_inst_t *)&bridge_set_link_cmd_ctx,
+	(cmdline_parse_inst_t *)&bridge_set_fdb_cmd_ctx,
+	(cmdline_parse_inst_t *)&bridge_set_ageing_cmd_ctx,
+
+	(cmdline_parse_inst_t *)&tunnel_add_cmd_ctx,
+	(cmdline_parse_inst_t *)&tunnel_rem_show_cmd_ctx,
+	(cmdline_parse_inst_t *)&tunnel_set_link_cmd_ctx,
+	(cmdline_parse_inst_t *)&tunnel_set_overlay_cmd_ctx,
+	(cmdline_parse_inst_t *)&acl_rule_add_cmd_ctx,
+	(cmdline_parse_inst_t *)&acl_rule_rem_cmd_ctx,
+	(cmdline_parse_inst_t *)&acl_show_commit_cmd_ctx,
+	(cmdline_parse_inst_t *)&acl_default_cmd_ctx,
+	(cmdline_parse_inst_t *)&nat_snat_add_cmd_ctx,
+	(cmdline_parse_inst_t *)&nat_dnat_add_cmd_ctx,
+	(cmdline_parse_inst_t *)&nat_rule_rem_cmd_ctx,
+	(cmdline_parse_inst_t *)&nat_show_cmd_ctx,
+	(cmdline_parse_inst_t *)&acl_rule_police_cmd_ctx,
+	(cmdline_parse_inst_t *)&policer_srtcm_add_cmd_ctx,
+	(cmdline_parse_inst_t *)&policer_trtcm_add_cmd_ctx,
+	(cmdline_parse_inst_t *)&policer_rem_cmd_ctx,
+	(cmdline_parse_inst_t *)&policer_color_cmd_ctx,
+	(cmdline_parse_inst_t *)&policer_remark_cmd_ctx,
+	(cmdline_parse_inst_t *)&policer_link_cmd_ctx,
+	(cmdline_parse_inst_t *)&policer_show_cmd_ctx,
+	(cmdline_parse_inst_t *)&tx_sched_link_cmd_ctx,
+	(cmdline_parse_inst_t *)&tx_sched_rem_cmd_ctx,
+	(cmdline_parse_inst_t *)&tx_sched_profile_cmd_ctx,
+	(cmdline_parse_inst_t *)&tx_sched_pipe_cmd_ctx,
+	(cmdline_parse_inst_t *)&tx_sched_vlan_cmd_ctx,
+	(cmdline_parse_inst_t *)&tx_sched_show_cmd_ctx,
+	(cmdline_parse_inst_t *)&exception_enable_cmd_ctx,
+	(cmdline_parse_inst_t *)&exception_enable_size_cmd_ctx,
+	(cmdline_parse_inst_t *)&exception_disable_cmd_ctx,
+	(cmdline_parse_inst_t *)&exception_show_cmd_ctx,
 
 	(cmdline_parse_inst_t *)&vswitch_show_cmd_ctx,
 	(cmdline_parse_inst_t *)&vswitch_start_cmd_ctx,
+	(cmdline_parse_inst_t *)&vswitch_reconfigure_cmd_ctx,
 	(cmdline_parse_inst_t *)&vswitch_stats_cmd_ctx,
 
 	NULL,
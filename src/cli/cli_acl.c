@@ -0,0 +1,312 @@
+/*
+  SPDX-License-Identifier: MIT
+  Copyright(c) 2023 Sriram Yagnaraman.
+*/
+
+#include <arpa/inet.h>
+#include <stdlib.h>
+
+#include <rte_byteorder.h>
+#include <rte_eal.h>
+#include <rte_malloc.h>
+
+#include <cmdline.h>
+#include <cmdline_parse.h>
+#include <cmdline_parse_string.h>
+#include <cmdline_parse_num.h>
+
+#include "cli.h"
+#include "cli_acl.h"
+#include "acl.h"
+
+static char const * const acl_action_names[] = {
+	[IP4_ACL_PERMIT] = "permit",
+	[IP4_ACL_DENY] = "deny",
+};
+
+/* "any", "a.b.c.d" or "a.b.c.d/len", returned in host byte order */
+static int
+cli_acl_parse_prefix(char const *str, uint32_t *ip, uint8_t *depth)
+{
+	char buf[INET_ADDRSTRLEN];
+	struct in_addr addr;
+	char *slash, *end;
+	unsigned long len = 32;
+
+	if (strcmp(str, "any") == 0) {
+		*ip = 0;
+		*depth = 0;
+		return 0;
+	}
+
+	if (rte_strscpy(buf, str, sizeof(buf)) < 0)
+		return -EINVAL;
+
+	slash = strchr(buf, '/');
+	if (slash) {
+		*slash++ = '\0';
+		len = strtoul(slash, &end, 10);
+		if (*slash == '\0' || *end != '\0' || len > 32)
+			return -EINVAL;
+	}
+
+	if (inet_pton(AF_INET, buf, &addr) != 1)
+		return -EINVAL;
+
+	*ip = rte_be_to_cpu_32(addr.s_addr);
+	*depth = len;
+	return 0;
+}
+
+static void
+cli_acl_rule_add(void *parsed_result, struct cmdline *cl, __rte_unused void *data)
+{
+	struct acl_cmd_tokens *res = parsed_result;
+	struct acl_rule_config config;
+	struct ip4_acl_rule *rule = &config.rule;
+	int rc;
+
+	memset(&config, 0, sizeof(config));
+
+	config.rule_id = res->rule_id;
+	rule->priority = res->priority;
+	rule->action = strcmp(res->verdict, "permit") == 0 ? IP4_ACL_PERMIT : IP4_ACL_DENY;
+	rule->proto = res->proto_id;
+	rule->sport_lo = res->sport_lo;
+	rule->sport_hi = res->sport_hi;
+	rule->dport_lo = res->dport_lo;
+	rule->dport_hi = res->dport_hi;
+
+	rc = cli_acl_parse_prefix(res->src_prefix, &rule->src_ip, &rule->src_depth);
+	if (rc < 0)
+		goto err;
+
+	rc = cli_acl_parse_prefix(res->dst_prefix, &rule->dst_ip, &rule->dst_depth);
+	if (rc < 0)
+		goto err;
+
+	rc = acl_rule_config_add(&config);
+	if (rc < 0)
+		goto err;
+
+	return;
+
+err:
+	cmdline_printf(cl, "acl rule add %u failed: %s\n", res->rule_id, rte_strerror(-rc));
+}
+
+static void
+cli_acl_rule_rem(void *parsed_result, struct cmdline *cl, __rte_unused void *data)
+{
+	struct acl_cmd_tokens *res = parsed_result;
+	int rc;
+
+	rc = acl_rule_config_rem(res->rule_id);
+	if (rc < 0)
+		cmdline_printf(cl, "acl rule rem %u failed: %s\n", res->rule_id, rte_strerror(-rc));
+}
+
+static void
+cli_acl_rule_police(void *parsed_result, struct cmdline *cl, __rte_unused void *data)
+{
+	struct acl_cmd_tokens *res = parsed_result;
+	int rc;
+
+	rc = acl_rule_config_set_policer(res->rule_id, res->policer_id);
+	if (rc < 0)
+		cmdline_printf(cl, "acl rule police %u failed: %s\n", res->rule_id, rte_strerror(-rc));
+}
+
+static int
+cli_acl_show_rule(struct acl_rule_config *config, void *data)
+{
+	struct ip4_acl_rule *rule = &config->rule;
+	struct cmdline *cl = data;
+	char src[INET_ADDRSTRLEN], dst[INET_ADDRSTRLEN];
+	struct in_addr addr;
+
+	addr.s_addr = rte_cpu_to_be_32(rule->src_ip);
+	inet_ntop(AF_INET, &addr, src, sizeof(src));
+	addr.s_addr = rte_cpu_to_be_32(rule->dst_ip);
+	inet_ntop(AF_INET, &addr, dst, sizeof(dst));
+
+	cmdline_printf(cl, "\t%u: prio %u src %s/%u dst %s/%u proto %u"
+		       " sport %u-%u dport %u-%u %s police %u\n",
+		       config->rule_id, rule->priority,
+		       src, rule->src_depth, dst, rule->dst_depth, rule->proto,
+		       rule->sport_lo, rule->sport_hi, rule->dport_lo, rule->dport_hi,
+		       acl_action_names[rule->action], rule->policer);
+	return 0;
+}
+
+static void
+cli_acl_show_commit(void *parsed_result, struct cmdline *cl, __rte_unused void *data)
+{
+	struct acl_cmd_tokens *res = parsed_result;
+	int rc;
+
+	if (strcmp(res->action, "commit") == 0) {
+		rc = acl_commit();
+		if (rc < 0)
+			cmdline_printf(cl, "acl commit failed: %s\n", rte_strerror(-rc));
+		return;
+	}
+
+	cmdline_printf(cl, "acl: default %s\n", acl_action_names[acl_config_get_default()]);
+	acl_rule_config_walk(cli_acl_show_rule, cl);
+}
+
+static void
+cli_acl_default(void *parsed_result, struct cmdline *cl, __rte_unused void *data)
+{
+	struct acl_cmd_tokens *res = parsed_result;
+	int rc;
+
+	rc = acl_config_set_default(strcmp(res->verdict, "permit") == 0 ?
+				    IP4_ACL_PERMIT : IP4_ACL_DENY);
+	if (rc < 0)
+		cmdline_printf(cl, "acl default %s failed: %s\n", res->verdict, rte_strerror(-rc));
+}
+
+cmdline_parse_token_string_t acl_cmd =
+	TOKEN_STRING_INITIALIZER(struct acl_cmd_tokens, acl, "acl");
+cmdline_parse_token_string_t acl_rule =
+	TOKEN_STRING_INITIALIZER(struct acl_cmd_tokens, rule, "rule");
+cmdline_parse_token_string_t acl_action_add =
+	TOKEN_STRING_INITIALIZER(struct acl_cmd_tokens, action, "add");
+cmdline_parse_token_string_t acl_action_rem =
+	TOKEN_STRING_INITIALIZER(struct acl_cmd_tokens, action, "rem");
+cmdline_parse_token_string_t acl_action_show_commit =
+	TOKEN_STRING_INITIALIZER(struct acl_cmd_tokens, action, "show#commit");
+cmdline_parse_token_string_t acl_action_police =
+	TOKEN_STRING_INITIALIZER(struct acl_cmd_tokens, action, "police");
+cmdline_parse_token_num_t acl_policer_id =
+	TOKEN_NUM_INITIALIZER(struct acl_cmd_tokens, policer_id, RTE_UINT8);
+cmdline_parse_token_string_t acl_action_default =
+	TOKEN_STRING_INITIALIZER(struct acl_cmd_tokens, action, "default");
+cmdline_parse_token_num_t acl_rule_id =
+	TOKEN_NUM_INITIALIZER(struct acl_cmd_tokens, rule_id, RTE_UINT32);
+cmdline_parse_token_string_t acl_prio =
+	TOKEN_STRING_INITIALIZER(struct acl_cmd_tokens, prio, "prio");
+cmdline_parse_token_num_t acl_priority =
+	TOKEN_NUM_INITIALIZER(struct acl_cmd_tokens, priority, RTE_UINT32);
+cmdline_parse_token_string_t acl_src =
+	TOKEN_STRING_INITIALIZER(struct acl_cmd_tokens, src, "src");
+cmdline_parse_token_string_t acl_src_prefix =
+	TOKEN_STRING_INITIALIZER(struct acl_cmd_tokens, src_prefix, NULL);
+cmdline_parse_token_string_t acl_dst =
+	TOKEN_STRING_INITIALIZER(struct acl_cmd_tokens, dst, "dst");
+cmdline_parse_token_string_t acl_dst_prefix =
+	TOKEN_STRING_INITIALIZER(struct acl_cmd_tokens, dst_prefix, NULL);
+cmdline_parse_token_string_t acl_proto =
+	TOKEN_STRING_INITIALIZER(struct acl_cmd_tokens, proto, "proto");
+cmdline_parse_token_num_t acl_proto_id =
+	TOKEN_NUM_INITIALIZER(struct acl_cmd_tokens, proto_id, RTE_UINT8);
+cmdline_parse_token_string_t acl_sport =
+	TOKEN_STRING_INITIALIZER(struct acl_cmd_tokens, sport, "sport");
+cmdline_parse_token_num_t acl_sport_lo =
+	TOKEN_NUM_INITIALIZER(struct acl_cmd_tokens, sport_lo, RTE_UINT16);
+cmdline_parse_token_num_t acl_sport_hi =
+	TOKEN_NUM_INITIALIZER(struct acl_cmd_tokens, sport_hi, RTE_UINT16);
+cmdline_parse_token_string_t acl_dport =
+	TOKEN_STRING_INITIALIZER(struct acl_cmd_tokens, dport, "dport");
+cmdline_parse_token_num_t acl_dport_lo =
+	TOKEN_NUM_INITIALIZER(struct acl_cmd_tokens, dport_lo, RTE_UINT16);
+cmdline_parse_token_num_t acl_dport_hi =
+	TOKEN_NUM_INITIALIZER(struct acl_cmd_tokens, dport_hi, RTE_UINT16);
+cmdline_parse_token_string_t acl_verdict =
+	TOKEN_STRING_INITIALIZER(struct acl_cmd_tokens, verdict, "permit#deny");
+
+static char const
+cmd_acl_rule_add_help[] = "acl rule add <rule_id> prio <prio> src <prefix#any> dst <prefix#any>"
+			  " proto <proto, 0 any> sport <lo> <hi> dport <lo> <hi> permit#deny";
+
+cmdline_parse_inst_t acl_rule_add_cmd_ctx = {
+	.f = cli_acl_rule_add,
+	.data = NULL,
+	.help_str = cmd_acl_rule_add_help,
+	.tokens = {
+		(void *)&acl_cmd,
+		(void *)&acl_rule,
+		(void *)&acl_action_add,
+		(void *)&acl_rule_id,
+		(void *)&acl_prio,
+		(void *)&acl_priority,
+		(void *)&acl_src,
+		(void *)&acl_src_prefix,
+		(void *)&acl_dst,
+		(void *)&acl_dst_prefix,
+		(void *)&acl_proto,
+		(void *)&acl_proto_id,
+		(void *)&acl_sport,
+		(void *)&acl_sport_lo,
+		(void *)&acl_sport_hi,
+		(void *)&acl_dport,
+		(void *)&acl_dport_lo,
+		(void *)&acl_dport_hi,
+		(void *)&acl_verdict,
+		NULL,
+	},
+};
+
+static char const
+cmd_acl_rule_rem_help[] = "acl rule rem <rule_id>";
+
+cmdline_parse_inst_t acl_rule_rem_cmd_ctx = {
+	.f = cli_acl_rule_rem,
+	.data = NULL,
+	.help_str = cmd_acl_rule_rem_help,
+	.tokens = {
+		(void *)&acl_cmd,
+		(void *)&acl_rule,
+		(void *)&acl_action_rem,
+		(void *)&acl_rule_id,
+		NULL,
+	},
+};
+
+static char const
+cmd_acl_show_commit_help[] = "acl show#commit, commit applies rule changes to a running switch";
+
+cmdline_parse_inst_t acl_show_commit_cmd_ctx = {
+	.f = cli_acl_show_commit,
+	.data = NULL,
+	.help_str = cmd_acl_show_commit_help,
+	.tokens = {
+		(void *)&acl_cmd,
+		(void *)&acl_action_show_commit,
+		NULL,
+	},
+};
+
+static char const
+cmd_acl_default_help[] = "acl default permit#deny";
+
+cmdline_parse_inst_t acl_default_cmd_ctx = {
+	.f = cli_acl_default,
+	.data = NULL,
+	.help_str = cmd_acl_default_help,
+	.tokens = {
+		(void *)&acl_cmd,
+		(void *)&acl_action_default,
+		(void *)&acl_verdict,
+		NULL,
+	},
+};
+
+static char const
+cmd_acl_rule_police_help[] = "acl rule police <rule_id> <policer_id, 0 none>";
+
+cmdline_parse_inst_t acl_rule_police_cmd_ctx = {
+	.f = cli_acl_rule_police,
+	.data = NULL,
+	.help_str = cmd_acl_rule_police_help,
+	.tokens = {
+		(void *)&acl_cmd,
+		(void *)&acl_rule,
+		(void *)&acl_action_police,
+		(void *)&acl_rule_id,
+		(void *)&acl_policer_id,
+		NULL,
+	},
+};
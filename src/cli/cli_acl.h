@@ -0,0 +1,42 @@
+/*
+  SPDX-License-Identifier: MIT
+  Copyright(c) 2023 Sriram Yagnaraman.
+*/
+
+#ifndef __VSWITCH_SRC_CLI_ACL_H_
+#define __VSWITCH_SRC_CLI_ACL_H_
+
+#include <cmdline.h>
+#include <cmdline_parse.h>
+#include <cmdline_parse_string.h>
+
+struct acl_cmd_tokens {
+	cmdline_fixed_string_t acl;
+	cmdline_fixed_string_t rule;
+	cmdline_fixed_string_t action;
+	cmdline_fixed_string_t prio;
+	cmdline_fixed_string_t src;
+	cmdline_fixed_string_t src_prefix;
+	cmdline_fixed_string_t dst;
+	cmdline_fixed_string_t dst_prefix;
+	cmdline_fixed_string_t proto;
+	cmdline_fixed_string_t sport;
+	cmdline_fixed_string_t dport;
+	cmdline_fixed_string_t verdict;
+	uint32_t rule_id;
+	uint32_t priority;
+	uint8_t proto_id;
+	uint16_t sport_lo;
+	uint16_t sport_hi;
+	uint16_t dport_lo;
+	uint16_t dport_hi;
+	uint8_t policer_id;
+};
+
+extern cmdline_parse_inst_t acl_rule_add_cmd_ctx;
+extern cmdline_parse_inst_t acl_rule_rem_cmd_ctx;
+extern cmdline_parse_inst_t acl_show_commit_cmd_ctx;
+extern cmdline_parse_inst_t acl_default_cmd_ctx;
+extern cmdline_parse_inst_t acl_rule_police_cmd_ctx;
+
+#endif /* __VSWITCH_SRC_CLI_ACL_H_*/
@@ -0,0 +1,259 @@
+/*
+  SPDX-License-Identifier: MIT
+  Copyright(c) 2023 Sriram Yagnaraman.
+*/
+
+#include <rte_eal.h>
+#include <rte_ethdev.h>
+#include <rte_malloc.h>
+
+#include <cmdline.h>
+#include <cmdline_parse.h>
+#include <cmdline_parse_string.h>
+#include <cmdline_parse_num.h>
+
+#include "cli.h"
+#include "cli_bridge.h"
+#include "bridge.h"
+
+struct cli_bridge_fdb_show {
+	struct cmdline *cl;
+	uint16_t bd_id;
+};
+
+static void
+cli_bridge_add(void *parsed_result, struct cmdline *cl, __rte_unused void *data)
+{
+	struct bridge_cmd_tokens *res = parsed_result;
+	struct bridge_config config;
+	int rc;
+
+	memset(&config, 0, sizeof(config));
+
+	rte_strscpy(config.name, res->name, BRIDGE_NAME_MAX_LEN);
+	config.name[strlen(res->name)] = '\0';
+	config.fdb_size = BRIDGE_FDB_SIZE_DEFAULT;
+	config.ageing_s = BRIDGE_AGEING_DEFAULT;
+
+	rc = bridge_config_add(&config);
+	if (rc < 0) {
+		cmdline_printf(cl, "bridge add %s failed: %s\n", config.name, rte_strerror(-rc));
+	}
+}
+
+static int
+cli_bridge_fdb_show_entry(struct l2_bridge_fdb_info *info, void *data)
+{
+	struct cli_bridge_fdb_show *show = data;
+	char link_name[RTE_ETH_NAME_MAX_LEN];
+
+	if (info->bd_id != show->bd_id)
+		return 0;
+
+	if (rte_eth_dev_get_name_by_port(info->link_id, link_name) < 0)
+		snprintf(link_name, sizeof(link_name), "%u", info->link_id);
+
+	cmdline_printf(show->cl, "\t" RTE_ETHER_ADDR_PRT_FMT " vlan %u link %s age %u\n",
+		       RTE_ETHER_ADDR_BYTES(&info->mac), info->vlan_id, link_name, info->age);
+	return 0;
+}
+
+static void
+cli_bridge_rem_show(void *parsed_result, struct cmdline *cl, __rte_unused void *data)
+{
+	struct bridge_cmd_tokens *res = parsed_result;
+	char bridge_name[BRIDGE_NAME_MAX_LEN];
+	char link_name[RTE_ETH_NAME_MAX_LEN];
+	struct cli_bridge_fdb_show show;
+	struct bridge *b;
+	int rc = -ENOENT;
+	uint16_t i;
+
+	rte_strscpy(bridge_name, res->name, BRIDGE_NAME_MAX_LEN);
+	bridge_name[strlen(res->name)] = '\0';
+
+	b = bridge_config_get(bridge_name);
+	if (!b)
+		goto err;
+
+	if (strcmp(res->action, "rem") == 0) {
+		rc = bridge_config_rem(bridge_name);
+		if (rc < 0)
+			goto err;
+	} else if (strcmp(res->action, "flush") == 0) {
+		rc = bridge_fdb_flush(bridge_name);
+		if (rc < 0)
+			goto err;
+	} else {
+		cmdline_printf(cl, "%s: bd_id=%u fdb %u ageing %u\n\t links",
+			       b->config.name, b->config.bd_id,
+			       b->config.fdb_size, b->config.ageing_s);
+		for (i = 0; i < b->config.nb_links; i++) {
+			if (rte_eth_dev_get_name_by_port(b->config.link_id[i], link_name) < 0)
+				continue;
+			cmdline_printf(cl, " %s", link_name);
+		}
+		cmdline_printf(cl, "\n");
+
+		show.cl = cl;
+		show.bd_id = b->config.bd_id;
+		l2_bridge_fdb_walk(cli_bridge_fdb_show_entry, &show);
+	}
+
+	return;
+
+err:
+	cmdline_printf(cl, "bridge %s %s failed: %s\n", res->action, bridge_name, rte_strerror(-rc));
+}
+
+static void
+cli_bridge_set_link(void *parsed_result, struct cmdline *cl, __rte_unused void *data)
+{
+	struct bridge_cmd_tokens *res = parsed_result;
+	char bridge_name[BRIDGE_NAME_MAX_LEN];
+	int rc;
+
+	rte_strscpy(bridge_name, res->name, BRIDGE_NAME_MAX_LEN);
+	bridge_name[strlen(res->name)] = '\0';
+
+	rc = bridge_config_add_link(bridge_name, res->dev);
+	if (rc < 0)
+		cmdline_printf(cl, "bridge set %s link %s failed: %s\n",
+			       bridge_name, res->dev, rte_strerror(-rc));
+}
+
+static void
+cli_bridge_set_fdb(void *parsed_result, struct cmdline *cl, __rte_unused void *data)
+{
+	struct bridge_cmd_tokens *res = parsed_result;
+	char bridge_name[BRIDGE_NAME_MAX_LEN];
+	int rc;
+
+	rte_strscpy(bridge_name, res->name, BRIDGE_NAME_MAX_LEN);
+	bridge_name[strlen(res->name)] = '\0';
+
+	rc = bridge_config_set_fdb_size(bridge_name, res->fdb_size);
+	if (rc < 0)
+		cmdline_printf(cl, "bridge set %s fdb failed: %s\n",
+			       bridge_name, rte_strerror(-rc));
+}
+
+static void
+cli_bridge_set_ageing(void *parsed_result, struct cmdline *cl, __rte_unused void *data)
+{
+	struct bridge_cmd_tokens *res = parsed_result;
+	char bridge_name[BRIDGE_NAME_MAX_LEN];
+	int rc;
+
+	rte_strscpy(bridge_name, res->name, BRIDGE_NAME_MAX_LEN);
+	bridge_name[strlen(res->name)] = '\0';
+
+	rc = bridge_config_set_ageing(bridge_name, res->ageing_s);
+	if (rc < 0)
+		cmdline_printf(cl, "bridge set %s ageing failed: %s\n",
+			       bridge_name, rte_strerror(-rc));
+}
+
+cmdline_parse_token_string_t bridge_cmd =
+	TOKEN_STRING_INITIALIZER(struct bridge_cmd_tokens, bridge, "bridge");
+cmdline_parse_token_string_t bridge_action_add =
+	TOKEN_STRING_INITIALIZER(struct bridge_cmd_tokens, action, "add");
+cmdline_parse_token_string_t bridge_action_rem_show =
+	TOKEN_STRING_INITIALIZER(struct bridge_cmd_tokens, action, "rem#show#flush");
+cmdline_parse_token_string_t bridge_action_set =
+	TOKEN_STRING_INITIALIZER(struct bridge_cmd_tokens, action, "set");
+cmdline_parse_token_string_t bridge_name =
+	TOKEN_STRING_INITIALIZER(struct bridge_cmd_tokens, name, NULL);
+cmdline_parse_token_string_t bridge_link =
+	TOKEN_STRING_INITIALIZER(struct bridge_cmd_tokens, link, "link");
+cmdline_parse_token_string_t bridge_dev =
+	TOKEN_STRING_INITIALIZER(struct bridge_cmd_tokens, dev, NULL);
+cmdline_parse_token_string_t bridge_fdb =
+	TOKEN_STRING_INITIALIZER(struct bridge_cmd_tokens, fdb, "fdb");
+cmdline_parse_token_num_t bridge_fdb_size =
+	TOKEN_NUM_INITIALIZER(struct bridge_cmd_tokens, fdb_size, RTE_UINT32);
+cmdline_parse_token_string_t bridge_ageing =
+	TOKEN_STRING_INITIALIZER(struct bridge_cmd_tokens, ageing, "ageing");
+cmdline_parse_token_num_t bridge_ageing_s =
+	TOKEN_NUM_INITIALIZER(struct bridge_cmd_tokens, ageing_s, RTE_UINT16);
+
+static char const
+cmd_bridge_add_help[] = "bridge add <bridge_name>";
+
+cmdline_parse_inst_t bridge_add_cmd_ctx = {
+	.f = cli_bridge_add,
+	.data = NULL,
+	.help_str = cmd_bridge_add_help,
+	.tokens = {
+		(void *)&bridge_cmd,
+		(void *)&bridge_action_add,
+		(void *)&bridge_name,
+		NULL,
+	},
+};
+
+static char const
+cmd_bridge_rem_show_help[] = "bridge rem#show#flush <bridge_name>";
+
+cmdline_parse_inst_t bridge_rem_show_cmd_ctx = {
+	.f = cli_bridge_rem_show,
+	.data = NULL,
+	.help_str = cmd_bridge_rem_show_help,
+	.tokens = {
+		(void *)&bridge_cmd,
+		(void *)&bridge_action_rem_show,
+		(void *)&bridge_name,
+		NULL,
+	},
+};
+
+static char const
+cmd_bridge_set_link_help[] = "bridge set <bridge_name> link <dev>";
+
+cmdline_parse_inst_t bridge_set_link_cmd_ctx = {
+	.f = cli_bridge_set_link,
+	.data = NULL,
+	.help_str = cmd_bridge_set_link_help,
+	.tokens = {
+		(void *)&bridge_cmd,
+		(void *)&bridge_action_set,
+		(void *)&bridge_name,
+		(void *)&bridge_link,
+		(void *)&bridge_dev,
+		NULL,
+	},
+};
+
+static char const
+cmd_bridge_set_fdb_help[] = "bridge set <bridge_name> fdb <size>";
+
+cmdline_parse_inst_t bridge_set_fdb_cmd_ctx = {
+	.f = cli_bridge_set_fdb,
+	.data = NULL,
+	.help_str = cmd_bridge_set_fdb_help,
+	.tokens = {
+		(void *)&bridge_cmd,
+		(void *)&bridge_action_set,
+		(void *)&bridge_name,
+		(void *)&bridge_fdb,
+		(void *)&bridge_fdb_size,
+		NULL,
+	},
+};
+
+static char const
+cmd_bridge_set_ageing_help[] = "bridge set <bridge_name> ageing <seconds, 0 disables>";
+
+cmdline_parse_inst_t bridge_set_ageing_cmd_ctx = {
+	.f = cli_bridge_set_ageing,
+	.data = NULL,
+	.help_str = cmd_bridge_set_ageing_help,
+	.tokens = {
+		(void *)&bridge_cmd,
+		(void *)&bridge_action_set,
+		(void *)&bridge_name,
+		(void *)&bridge_ageing,
+		(void *)&bridge_ageing_s,
+		NULL,
+	},
+};
@@ -0,0 +1,31 @@
+/*
+  SPDX-License-Identifier: MIT
+  Copyright(c) 2023 Sriram Yagnaraman.
+*/
+
+#ifndef __VSWITCH_SRC_CLI_BRIDGE_H_
+#define __VSWITCH_SRC_CLI_BRIDGE_H_
+
+#include <cmdline.h>
+#include <cmdline_parse.h>
+#include <cmdline_parse_string.h>
+
+struct bridge_cmd_tokens {
+	cmdline_fixed_string_t bridge;
+	cmdline_fixed_string_t action;
+	cmdline_fixed_string_t name;
+	cmdline_fixed_string_t link;
+	cmdline_fixed_string_t dev;
+	cmdline_fixed_string_t fdb;
+	cmdline_fixed_string_t ageing;
+	uint32_t fdb_size;
+	uint16_t ageing_s;
+};
+
+extern cmdline_parse_inst_t bridge_add_cmd_ctx;
+extern cmdline_parse_inst_t bridge_rem_show_cmd_ctx;
+extern cmdline_parse_inst_t bridge_set_link_cmd_ctx;
+extern cmdline_parse_inst_t bridge_set_fdb_cmd_ctx;
+extern cmdline_parse_inst_t bridge_set_ageing_cmd_ctx;
+
+#endif /* __VSWITCH_SRC_CLI_BRIDGE_H_*/
@@ -0,0 +1,150 @@
+/*
+  SPDX-License-Identifier: MIT
+  Copyright(c) 2023 Sriram Yagnaraman.
+*/
+
+#include <stdlib.h>
+
+#include <rte_eal.h>
+#include <rte_ethdev.h>
+
+#include <cmdline.h>
+#include <cmdline_parse.h>
+#include <cmdline_parse_string.h>
+#include <cmdline_parse_num.h>
+
+#include "cli.h"
+#include "cli_exception.h"
+#include "exception.h"
+
+static void
+cli_exception_enable(void *parsed_result, struct cmdline *cl, void *data)
+{
+	struct exception_cmd_tokens *res = parsed_result;
+	int rc;
+
+	/* data is set on the variant that gives the queue size */
+	rc = exception_config_set(res->mp_name,
+				  data ? res->queue_size : EXCEPTION_QUEUE_SIZE_DEFAULT);
+	if (rc < 0)
+		cmdline_printf(cl, "exception enable failed: %s\n", rte_strerror(-rc));
+}
+
+static void
+cli_exception_disable(__rte_unused void *parsed_result, struct cmdline *cl,
+		      __rte_unused void *data)
+{
+	int rc;
+
+	rc = exception_config_rem();
+	if (rc < 0)
+		cmdline_printf(cl, "exception disable failed: %s\n", rte_strerror(-rc));
+}
+
+static int
+cli_exception_show_one(uint16_t link_id, uint16_t port_id, void *data)
+{
+	char name[RTE_ETH_NAME_MAX_LEN];
+	struct cmdline *cl = data;
+
+	if (rte_eth_dev_get_name_by_port(link_id, name) < 0)
+		return 0;
+
+	cmdline_printf(cl, "\tlink %s: " EXCEPTION_IFNAME_FMT " port %u\n",
+		       name, link_id, port_id);
+	return 0;
+}
+
+static void
+cli_exception_show(__rte_unused void *parsed_result, struct cmdline *cl,
+		   __rte_unused void *data)
+{
+	struct exception_config *config = exception_config_get();
+
+	cmdline_printf(cl, "exception:\n");
+	if (!config->enabled)
+		return;
+
+	cmdline_printf(cl, "\tmempool %s queue-size %u queues %u\n",
+		       config->mp_name, config->queue_size, exception_config_get_nb_queues());
+	exception_config_walk(cli_exception_show_one, cl);
+}
+
+cmdline_parse_token_string_t exception_cmd =
+	TOKEN_STRING_INITIALIZER(struct exception_cmd_tokens, exception, "exception");
+cmdline_parse_token_string_t exception_action_enable =
+	TOKEN_STRING_INITIALIZER(struct exception_cmd_tokens, action, "enable");
+cmdline_parse_token_string_t exception_action_disable =
+	TOKEN_STRING_INITIALIZER(struct exception_cmd_tokens, action, "disable");
+cmdline_parse_token_string_t exception_action_show =
+	TOKEN_STRING_INITIALIZER(struct exception_cmd_tokens, action, "show");
+cmdline_parse_token_string_t exception_mempool =
+	TOKEN_STRING_INITIALIZER(struct exception_cmd_tokens, mempool, "mempool");
+cmdline_parse_token_string_t exception_mp_name =
+	TOKEN_STRING_INITIALIZER(struct exception_cmd_tokens, mp_name, NULL);
+cmdline_parse_token_string_t exception_size =
+	TOKEN_STRING_INITIALIZER(struct exception_cmd_tokens, size, "queue-size");
+cmdline_parse_token_num_t exception_queue_size =
+	TOKEN_NUM_INITIALIZER(struct exception_cmd_tokens, queue_size, RTE_UINT16);
+
+static char const
+cmd_exception_enable_help[] = "exception enable mempool <mp_name>";
+
+cmdline_parse_inst_t exception_enable_cmd_ctx = {
+	.f = cli_exception_enable,
+	.data = NULL,
+	.help_str = cmd_exception_enable_help,
+	.tokens = {
+		(void *)&exception_cmd,
+		(void *)&exception_action_enable,
+		(void *)&exception_mempool,
+		(void *)&exception_mp_name,
+		NULL,
+	},
+};
+
+static char const
+cmd_exception_enable_size_help[] = "exception enable mempool <mp_name> queue-size <n>";
+
+cmdline_parse_inst_t exception_enable_size_cmd_ctx = {
+	.f = cli_exception_enable,
+	.data = (void *)1,
+	.help_str = cmd_exception_enable_size_help,
+	.tokens = {
+		(void *)&exception_cmd,
+		(void *)&exception_action_enable,
+		(void *)&exception_mempool,
+		(void *)&exception_mp_name,
+		(void *)&exception_size,
+		(void *)&exception_queue_size,
+		NULL,
+	},
+};
+
+static char const
+cmd_exception_disable_help[] = "exception disable";
+
+cmdline_parse_inst_t exception_disable_cmd_ctx = {
+	.f = cli_exception_disable,
+	.data = NULL,
+	.help_str = cmd_exception_disable_help,
+	.tokens = {
+		(void *)&exception_cmd,
+		(void *)&exception_action_disable,
+		NULL,
+	},
+};
+
+static char const
+cmd_exception_show_help[] = "exception show";
+
+cmdline_parse_inst_t exception_show_cmd_ctx = {
+	.f = cli_exception_show,
+	.data = NULL,
+	.help_str = cmd_exception_show_help,
+	.tokens = {
+		(void *)&exception_cmd,
+		(void *)&exception_action_show,
+		NULL,
+	},
+};
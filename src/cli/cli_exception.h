@@ -0,0 +1,27 @@
+/*
+  SPDX-License-Identifier: MIT
+  Copyright(c) 2023 Sriram Yagnaraman.
+*/
+
+#ifndef __VSWITCH_SRC_CLI_EXCEPTION_H_
+#define __VSWITCH_SRC_CLI_EXCEPTION_H_
+
+#include <cmdline.h>
+#include <cmdline_parse.h>
+#include <cmdline_parse_string.h>
+
+struct exception_cmd_tokens {
+	cmdline_fixed_string_t exception;
+	cmdline_fixed_string_t action;
+	cmdline_fixed_string_t mempool;
+	cmdline_fixed_string_t mp_name;
+	cmdline_fixed_string_t size;
+	uint16_t queue_size;
+};
+
+extern cmdline_parse_inst_t exception_enable_cmd_ctx;
+extern cmdline_parse_inst_t exception_enable_size_cmd_ctx;
+extern cmdline_parse_inst_t exception_disable_cmd_ctx;
+extern cmdline_parse_inst_t exception_show_cmd_ctx;
+
+#endif /* __VSWITCH_SRC_CLI_EXCEPTION_H_*/
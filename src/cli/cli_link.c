@@ -18,6 +18,7 @@
 #include "cli.h"
 #include "cli_link.h"
 #include "link.h"
+#include "stage.h"
 
 static char const
 cmd_link_show_help[] = "link show";
@@ -28,6 +29,26 @@ cmd_link_dev_show_help[] = "link <dev> show";
 static char const
 cmd_link_dev_config_add_help[] = "link <dev> config add rxq <nb_rxq> txq <nb_txq> mempool <mp_name>";
 
+static char const
+cmd_link_dev_config_add_vhost_help[] = "link <net_vhostN> config add vhost <server#client> <path> queues <n>";
+
+static char const
+cmd_link_dev_config_add_vhost_mbufs_help[] =
+	"link <net_vhostN> config add vhost <server#client> <path> queues <n> mbufs <n>";
+
+static char const
+cmd_link_dev_config_add_memif_help[] =
+	"link <net_memifN> config add memif <server#client#client-zc> <path> id <id> queues <n>";
+
+static char const
+cmd_link_dev_config_add_memif_ring_help[] =
+	"link <net_memifN> config add memif <server#client#client-zc> <path> id <id> queues <n> "
+	"ring <log2> buffer <size> numa <node>";
+
+static char const
+cmd_link_dev_config_add_afxdp_help[] =
+	"link <net_af_xdpN> config add afxdp <ifname> mempool <mp_name> stages <stage[,stage...]>";
+
 static char const
 cmd_link_dev_config_rem_help[] = "link <dev> config rem";
 
@@ -43,6 +64,31 @@ cmd_link_dev_config_set_mtu_help[] = "link <dev> config mtu <mtu>";
 static char const
 cmd_link_dev_config_set_peer_help[] = "link <dev> config peer <ifname>";
 
+static char const
+cmd_link_dev_config_set_rss_help[] = "link <dev> config rss <qid[,qid...]>";
+
+static char const
+cmd_link_dev_config_set_vlan_help[] = "link <dev> config vlan <access#trunk#qinq> <vid[,vid...]>";
+
+static char const
+cmd_link_dev_config_set_vlan_native_help[] = "link <dev> config vlan native <vid>";
+
+static char const
+cmd_link_dev_config_set_vlan_off_help[] = "link <dev> config vlan off";
+
+static char const
+cmd_link_dev_config_set_tx_csum_help[] = "link <dev> config tx-csum";
+
+static char const
+cmd_link_dev_config_set_reassembly_help[] = "link <dev> config reassembly <on#off>";
+
+static char const * const vlan_mode_names[] = {
+	[VLAN_MODE_NONE] = "off",
+	[VLAN_MODE_ACCESS] = "access",
+	[VLAN_MODE_TRUNK] = "trunk",
+	[VLAN_MODE_QINQ] = "qinq",
+};
+
 static void
 cli_link_dev_config_add(void *parsed_result, struct cmdline *cl, __rte_unused void *data)
 {
@@ -67,6 +113,167 @@ cli_link_dev_config_add(void *parsed_result, struct cmdline *cl, __rte_unused vo
 	}
 }
 
+static void
+cli_link_dev_config_add_vhost(void *parsed_result, struct cmdline *cl, void *data)
+{
+	struct link_config_cmd_tokens *res = parsed_result;
+	struct link_vhost_config vhost;
+	struct link_config config;
+	int rc;
+
+	memset(&config, 0, sizeof(config));
+	memset(&vhost, 0, sizeof(vhost));
+
+	rte_strscpy(config.link_name, res->dev, RTE_ETH_NAME_MAX_LEN);
+	rc = rte_strscpy(vhost.path, res->path, LINK_SOCKET_PATH_LEN);
+	if (rc < 0) {
+		cmdline_printf(cl, "link %s config add failed: %s\n", config.link_name, rte_strerror(-rc));
+		return;
+	}
+	vhost.nb_queues = res->nb_queues;
+	vhost.client = !strcmp(res->role, "client");
+	/* Only the mbufs variant parsed the count */
+	vhost.nb_mbufs = data ? res->nb_mbufs : 0;
+
+	rc = link_config_add_vhost(&config, &vhost);
+	if (rc < 0) {
+                cmdline_printf(cl, "link %s config add failed: %s\n", config.link_name, rte_strerror(-rc));
+	}
+}
+
+static void
+cli_link_dev_config_add_memif(void *parsed_result, struct cmdline *cl, void *data)
+{
+	struct link_config_cmd_tokens *res = parsed_result;
+	struct link_memif_config memif;
+	struct link_config config;
+	int rc;
+
+	memset(&config, 0, sizeof(config));
+	memset(&memif, 0, sizeof(memif));
+
+	rte_strscpy(config.link_name, res->dev, RTE_ETH_NAME_MAX_LEN);
+	rc = rte_strscpy(memif.path, res->path, LINK_SOCKET_PATH_LEN);
+	if (rc < 0) {
+		cmdline_printf(cl, "link %s config add failed: %s\n", config.link_name, rte_strerror(-rc));
+		return;
+	}
+	memif.id = res->memif_id;
+	memif.nb_queues = res->nb_queues;
+	memif.client = strcmp(res->role, "server") != 0;
+	memif.zero_copy = !strcmp(res->role, "client-zc");
+	memif.ring_sz = LINK_MEMIF_RING_SZ_DEFAULT;
+	memif.buf_sz = LINK_MEMIF_BUF_SZ_DEFAULT;
+	memif.numa_node = SOCKET_ID_ANY;
+	/* Only the ring variant parsed the sizes */
+	if (data) {
+		memif.ring_sz = res->ring_sz;
+		memif.buf_sz = res->buf_sz;
+		memif.numa_node = res->numa_node;
+	}
+
+	rc = link_config_add_memif(&config, &memif);
+	if (rc < 0) {
+                cmdline_printf(cl, "link %s config add failed: %s\n", config.link_name, rte_strerror(-rc));
+	}
+}
+
+/* Queue i goes to the i-th stage, in and/or out as the stage type allows */
+static int
+cli_link_stage_queues_set(char const *link_name, char stages[][STAGE_NAME_MAX_LEN],
+			  uint16_t nb_stages)
+{
+	struct stage *s;
+	uint16_t i;
+	int rc;
+
+	for (i = 0; i < nb_stages; i++) {
+		s = stage_config_get(stages[i]);
+		if (!s)
+			return -ENOENT;
+
+		switch (s->config.type) {
+		case STAGE_TYPE_RX:
+			rc = stage_config_set_link_queue_in(stages[i], link_name, i);
+			break;
+		case STAGE_TYPE_TX:
+			rc = stage_config_set_link_queue_out(stages[i], link_name, i);
+			break;
+		case STAGE_TYPE_RTC:
+			rc = stage_config_set_link_queue_in(stages[i], link_name, i);
+			if (rc == 0)
+				rc = stage_config_set_link_queue_out(stages[i], link_name, i);
+			break;
+		default:
+			rc = -EINVAL;
+			break;
+		}
+		if (rc < 0)
+			return rc;
+	}
+
+	return 0;
+}
+
+static void
+cli_link_dev_config_add_afxdp(void *parsed_result, struct cmdline *cl, __rte_unused void *data)
+{
+	struct link_config_cmd_tokens *res = parsed_result;
+	char stages[STAGE_MAX][STAGE_NAME_MAX_LEN];
+	struct link_afxdp_config afxdp;
+	struct link_config config;
+	int rc = -EINVAL;
+	struct stage *s;
+	char *token;
+	uint16_t i;
+
+	memset(&config, 0, sizeof(config));
+	memset(&afxdp, 0, sizeof(afxdp));
+
+	rte_strscpy(config.link_name, res->dev, RTE_ETH_NAME_MAX_LEN);
+	rte_strscpy(config.rx.mp_name, res->mp_name, RTE_MEMPOOL_NAMESIZE);
+	if (rte_strscpy(afxdp.ifname, res->ifname, LINK_IFNAME_LEN) < 0)
+		goto err;
+
+	/* One queue per stage */
+	token = strtok(res->stage_name, ",");
+	while (token != NULL) {
+		if (afxdp.nb_queues == STAGE_MAX)
+			goto err;
+
+		if (rte_strscpy(stages[afxdp.nb_queues++], token, STAGE_NAME_MAX_LEN) < 0)
+			goto err;
+
+		token = strtok(NULL, ",");
+	}
+
+	/* Check the stages first, there is no undo for their queues */
+	for (i = 0; i < afxdp.nb_queues; i++) {
+		s = stage_config_get(stages[i]);
+		if (!s) {
+			rc = -ENOENT;
+			goto err;
+		}
+		if (s->config.type == STAGE_TYPE_WORKER)
+			goto err;
+	}
+
+	rc = link_config_add_afxdp(&config, &afxdp);
+	if (rc < 0)
+		goto err;
+
+	rc = cli_link_stage_queues_set(config.link_name, stages, afxdp.nb_queues);
+	if (rc < 0) {
+		link_config_rem(config.link_name);
+		goto err;
+	}
+
+	return;
+
+err:
+	cmdline_printf(cl, "link %s config add failed: %s\n", config.link_name, rte_strerror(-rc));
+}
+
 static void
 cli_link_dev_config_rem(void *parsed_result, struct cmdline *cl, __rte_unused void *data)
 {
@@ -90,6 +297,7 @@ cli_link_dev_config_show(void *parsed_result, struct cmdline *cl, __rte_unused v
 	char link_name[RTE_ETH_NAME_MAX_LEN];
 	int rc = -ENOENT;
 	struct link* l;
+	uint32_t i;
 
 	rte_strscpy(link_name, res->dev, RTE_ETH_NAME_MAX_LEN);
 	link_name[strlen(res->dev)] = '\0';
@@ -102,8 +310,9 @@ cli_link_dev_config_show(void *parsed_result, struct cmdline *cl, __rte_unused v
 			"%s: link_id=<%u> numa %d\n"
 			"\t rxq %u size %d mempool %s\n"
 			"\t txq %u size %d\n"
-			"\t promiscuous %d mtu %u\n"
-			"\t peer %s link_id=<%u>\n",
+			"\t type %s promiscuous %d mtu %u reassembly %u\n"
+			"\t peer %s link_id=<%u>\n"
+			"\t rss %s",
 			l->config.link_name,
 			l->config.link_id,
 			l->config.numa_node,
@@ -112,10 +321,23 @@ cli_link_dev_config_show(void *parsed_result, struct cmdline *cl, __rte_unused v
 			l->config.rx.mp_name,
 			l->config.tx.nb_queues,
 			l->config.tx.queue_sz,
+			link_type_name(l->config.type),
 			l->config.promiscuous,
 			l->config.mtu,
+			l->config.reassembly,
 			l->config.peer.link_name,
-			l->config.peer.link_id);
+			l->config.peer.link_id,
+			l->config.rx.rss.n_queues ? "queues" : "off\n");
+		for (i = 0; i < l->config.rx.rss.n_queues; i++)
+			cmdline_printf(cl, " %u", l->config.rx.rss.queue_id[i]);
+		if (l->config.rx.rss.n_queues)
+			cmdline_printf(cl, " hf 0x%" PRIx64 "\n", l->config.rx.rss.rss_hf);
+		cmdline_printf(cl, "\t vlan %s", vlan_mode_names[l->config.vlan.mode]);
+		if (l->config.vlan.mode != VLAN_MODE_NONE)
+			cmdline_printf(cl, " pvid %u hw_strip %u hw_insert %u",
+				       l->config.vlan.pvid, l->config.vlan.hw_strip,
+				       l->config.vlan.hw_insert);
+		cmdline_printf(cl, "\n");
 	}
 }
 
@@ -171,6 +393,158 @@ cli_link_dev_config_set_peer(void *parsed_result, struct cmdline *cl, __rte_unus
 	}
 }
 
+static void
+cli_link_dev_config_set_rss(void *parsed_result, struct cmdline *cl, __rte_unused void *data)
+{
+	struct link_config_cmd_tokens *res = parsed_result;
+	char link_name[RTE_ETH_NAME_MAX_LEN];
+	struct link_rss_config rss;
+	char *token, *end;
+	int rc = -EINVAL;
+
+	rte_strscpy(link_name, res->dev, RTE_ETH_NAME_MAX_LEN);
+	link_name[strlen(res->dev)] = '\0';
+
+	memset(&rss, 0, sizeof(rss));
+	token = strtok(res->rss_queues, ",");
+	while (token != NULL) {
+		if (rss.n_queues == ETHDEV_RXQ_RSS_MAX)
+			goto err;
+
+		rss.queue_id[rss.n_queues++] = strtoul(token, &end, 10);
+		if (*end != '\0')
+			goto err;
+
+		token = strtok(NULL, ",");
+	}
+
+	rc = link_config_set_rss(link_name, &rss);
+	if (rc < 0)
+		goto err;
+
+	return;
+
+err:
+	cmdline_printf(cl, "link %s config rss failed: %s\n", link_name, rte_strerror(-rc));
+}
+
+static void
+cli_link_dev_config_set_vlan(void *parsed_result, struct cmdline *cl, __rte_unused void *data)
+{
+	struct link_config_cmd_tokens *res = parsed_result;
+	char link_name[RTE_ETH_NAME_MAX_LEN];
+	struct vlan_link_config vlan;
+	char *token, *end;
+	unsigned long vid;
+	int rc = -EINVAL;
+
+	rte_strscpy(link_name, res->dev, RTE_ETH_NAME_MAX_LEN);
+	link_name[strlen(res->dev)] = '\0';
+
+	memset(&vlan, 0, sizeof(vlan));
+	if (strcmp(res->vlan_mode, "access") == 0)
+		vlan.mode = VLAN_MODE_ACCESS;
+	else if (strcmp(res->vlan_mode, "trunk") == 0)
+		vlan.mode = VLAN_MODE_TRUNK;
+	else
+		vlan.mode = VLAN_MODE_QINQ;
+
+	token = strtok(res->vlan_ids, ",");
+	while (token != NULL) {
+		vid = strtoul(token, &end, 10);
+		if (*end != '\0' || vid == 0 || vid >= VLAN_VID_MAX)
+			goto err;
+
+		if (vlan.mode == VLAN_MODE_ACCESS) {
+			if (vlan.pvid)
+				goto err;
+			vlan.pvid = vid;
+		}
+		vlan.allowed[vid / 64] |= 1ULL << (vid % 64);
+
+		token = strtok(NULL, ",");
+	}
+
+	rc = link_config_set_vlan(link_name, &vlan);
+	if (rc < 0)
+		goto err;
+
+	return;
+
+err:
+	cmdline_printf(cl, "link %s config vlan failed: %s\n", link_name, rte_strerror(-rc));
+}
+
+static void
+cli_link_dev_config_set_vlan_native(void *parsed_result, struct cmdline *cl, __rte_unused void *data)
+{
+	struct link_config_cmd_tokens *res = parsed_result;
+	char link_name[RTE_ETH_NAME_MAX_LEN];
+	int rc;
+
+	rte_strscpy(link_name, res->dev, RTE_ETH_NAME_MAX_LEN);
+	link_name[strlen(res->dev)] = '\0';
+
+	rc = link_config_set_vlan_native(link_name, res->vlan_id);
+	if (rc < 0)
+		cmdline_printf(cl, "link %s config vlan native failed: %s\n",
+			       link_name, rte_strerror(-rc));
+}
+
+static void
+cli_link_dev_config_set_vlan_off(void *parsed_result, struct cmdline *cl, __rte_unused void *data)
+{
+	struct link_config_cmd_tokens *res = parsed_result;
+	char link_name[RTE_ETH_NAME_MAX_LEN];
+	struct vlan_link_config vlan;
+	int rc;
+
+	rte_strscpy(link_name, res->dev, RTE_ETH_NAME_MAX_LEN);
+	link_name[strlen(res->dev)] = '\0';
+
+	memset(&vlan, 0, sizeof(vlan));
+	rc = link_config_set_vlan(link_name, &vlan);
+	if (rc < 0)
+		cmdline_printf(cl, "link %s config vlan off failed: %s\n",
+			       link_name, rte_strerror(-rc));
+}
+
+/* Kept only if the port has all three, NAT checks the links at start */
+static void
+cli_link_dev_config_set_tx_csum(void *parsed_result, struct cmdline *cl, __rte_unused void *data)
+{
+	struct link_config_cmd_tokens *res = parsed_result;
+	char link_name[RTE_ETH_NAME_MAX_LEN];
+	int rc;
+
+	rte_strscpy(link_name, res->dev, RTE_ETH_NAME_MAX_LEN);
+	link_name[strlen(res->dev)] = '\0';
+
+	rc = link_config_add_tx_offloads(link_name, RTE_ETH_TX_OFFLOAD_IPV4_CKSUM |
+					 RTE_ETH_TX_OFFLOAD_TCP_CKSUM |
+					 RTE_ETH_TX_OFFLOAD_UDP_CKSUM);
+	if (rc < 0)
+		cmdline_printf(cl, "link %s config tx-csum failed: %s\n",
+			       link_name, rte_strerror(-rc));
+}
+
+static void
+cli_link_dev_config_set_reassembly(void *parsed_result, struct cmdline *cl,
+				   __rte_unused void *data)
+{
+	struct link_config_cmd_tokens *res = parsed_result;
+	char link_name[RTE_ETH_NAME_MAX_LEN];
+	int rc;
+
+	rte_strscpy(link_name, res->dev, RTE_ETH_NAME_MAX_LEN);
+	link_name[strlen(res->dev)] = '\0';
+
+	rc = link_config_set_reassembly(link_name, strcmp(res->reassembly, "on") == 0);
+	if (rc < 0)
+		cmdline_printf(cl, "link %s config reassembly failed: %s\n",
+			       link_name, rte_strerror(-rc));
+}
+
 cmdline_parse_token_string_t link_dev_config_cmd =
 	TOKEN_STRING_INITIALIZER(struct link_config_cmd_tokens, cmd, "link");
 cmdline_parse_token_string_t link_dev_config_dev =
@@ -195,6 +569,28 @@ cmdline_parse_token_string_t link_dev_config_set_peer =
 	TOKEN_STRING_INITIALIZER(struct link_config_cmd_tokens, action, "peer");
 cmdline_parse_token_string_t link_dev_config_peer =
 	TOKEN_STRING_INITIALIZER(struct link_config_cmd_tokens, peer, NULL);
+cmdline_parse_token_string_t link_dev_config_set_rss =
+	TOKEN_STRING_INITIALIZER(struct link_config_cmd_tokens, action, "rss");
+cmdline_parse_token_string_t link_dev_config_rss_queues =
+	TOKEN_STRING_INITIALIZER(struct link_config_cmd_tokens, rss_queues, NULL);
+cmdline_parse_token_string_t link_dev_config_set_vlan =
+	TOKEN_STRING_INITIALIZER(struct link_config_cmd_tokens, action, "vlan");
+cmdline_parse_token_string_t link_dev_config_vlan_mode =
+	TOKEN_STRING_INITIALIZER(struct link_config_cmd_tokens, vlan_mode, "access#trunk#qinq");
+cmdline_parse_token_string_t link_dev_config_vlan_ids =
+	TOKEN_STRING_INITIALIZER(struct link_config_cmd_tokens, vlan_ids, NULL);
+cmdline_parse_token_string_t link_dev_config_vlan_native =
+	TOKEN_STRING_INITIALIZER(struct link_config_cmd_tokens, vlan_mode, "native");
+cmdline_parse_token_num_t link_dev_config_vlan_id =
+	TOKEN_NUM_INITIALIZER(struct link_config_cmd_tokens, vlan_id, RTE_UINT16);
+cmdline_parse_token_string_t link_dev_config_vlan_off =
+	TOKEN_STRING_INITIALIZER(struct link_config_cmd_tokens, vlan_mode, "off");
+cmdline_parse_token_string_t link_dev_config_set_tx_csum =
+	TOKEN_STRING_INITIALIZER(struct link_config_cmd_tokens, action, "tx-csum");
+cmdline_parse_token_string_t link_dev_config_set_reassembly =
+	TOKEN_STRING_INITIALIZER(struct link_config_cmd_tokens, action, "reassembly");
+cmdline_parse_token_string_t link_dev_config_reassembly =
+	TOKEN_STRING_INITIALIZER(struct link_config_cmd_tokens, reassembly, "on#off");
 cmdline_parse_token_string_t link_dev_config_rxq =
 	TOKEN_STRING_INITIALIZER(struct link_config_cmd_tokens, rxq, "rxq");
 cmdline_parse_token_num_t link_dev_config_nb_rxq =
@@ -207,6 +603,46 @@ cmdline_parse_token_string_t link_dev_config_mempool =
 	TOKEN_STRING_INITIALIZER(struct link_config_cmd_tokens, mempool, "mempool");
 cmdline_parse_token_string_t link_dev_config_mp_name =
 	TOKEN_STRING_INITIALIZER(struct link_config_cmd_tokens, mp_name, NULL);
+cmdline_parse_token_string_t link_dev_config_vhost =
+	TOKEN_STRING_INITIALIZER(struct link_config_cmd_tokens, type, "vhost");
+cmdline_parse_token_string_t link_dev_config_vhost_role =
+	TOKEN_STRING_INITIALIZER(struct link_config_cmd_tokens, role, "server#client");
+cmdline_parse_token_string_t link_dev_config_path =
+	TOKEN_STRING_INITIALIZER(struct link_config_cmd_tokens, path, NULL);
+cmdline_parse_token_string_t link_dev_config_queues =
+	TOKEN_STRING_INITIALIZER(struct link_config_cmd_tokens, queues, "queues");
+cmdline_parse_token_num_t link_dev_config_nb_queues =
+	TOKEN_NUM_INITIALIZER(struct link_config_cmd_tokens, nb_queues, RTE_UINT16);
+cmdline_parse_token_string_t link_dev_config_mbufs =
+	TOKEN_STRING_INITIALIZER(struct link_config_cmd_tokens, mbufs, "mbufs");
+cmdline_parse_token_num_t link_dev_config_nb_mbufs =
+	TOKEN_NUM_INITIALIZER(struct link_config_cmd_tokens, nb_mbufs, RTE_UINT32);
+cmdline_parse_token_string_t link_dev_config_memif =
+	TOKEN_STRING_INITIALIZER(struct link_config_cmd_tokens, type, "memif");
+cmdline_parse_token_string_t link_dev_config_memif_role =
+	TOKEN_STRING_INITIALIZER(struct link_config_cmd_tokens, role, "server#client#client-zc");
+cmdline_parse_token_string_t link_dev_config_id =
+	TOKEN_STRING_INITIALIZER(struct link_config_cmd_tokens, id, "id");
+cmdline_parse_token_num_t link_dev_config_memif_id =
+	TOKEN_NUM_INITIALIZER(struct link_config_cmd_tokens, memif_id, RTE_UINT32);
+cmdline_parse_token_string_t link_dev_config_ring =
+	TOKEN_STRING_INITIALIZER(struct link_config_cmd_tokens, ring, "ring");
+cmdline_parse_token_num_t link_dev_config_ring_sz =
+	TOKEN_NUM_INITIALIZER(struct link_config_cmd_tokens, ring_sz, RTE_UINT8);
+cmdline_parse_token_string_t link_dev_config_buffer =
+	TOKEN_STRING_INITIALIZER(struct link_config_cmd_tokens, buffer, "buffer");
+cmdline_parse_token_num_t link_dev_config_buf_sz =
+	TOKEN_NUM_INITIALIZER(struct link_config_cmd_tokens, buf_sz, RTE_UINT16);
+cmdline_parse_token_string_t link_dev_config_numa =
+	TOKEN_STRING_INITIALIZER(struct link_config_cmd_tokens, numa, "numa");
+cmdline_parse_token_num_t link_dev_config_numa_node =
+	TOKEN_NUM_INITIALIZER(struct link_config_cmd_tokens, numa_node, RTE_UINT8);
+cmdline_parse_token_string_t link_dev_config_afxdp =
+	TOKEN_STRING_INITIALIZER(struct link_config_cmd_tokens, type, "afxdp");
+cmdline_parse_token_string_t link_dev_config_ifname =
+	TOKEN_STRING_INITIALIZER(struct link_config_cmd_tokens, ifname, NULL);
+cmdline_parse_token_string_t link_dev_config_stages =
+	TOKEN_STRING_INITIALIZER(struct link_config_cmd_tokens, stage, "stages");
 cmdline_parse_token_string_t link_dev_config_stage =
 	TOKEN_STRING_INITIALIZER(struct link_config_cmd_tokens, stage, "stage");
 cmdline_parse_token_string_t link_dev_config_stage_name =
@@ -233,6 +669,109 @@ cmdline_parse_inst_t link_dev_config_add_cmd_ctx = {
 	},
 };
 
+cmdline_parse_inst_t link_dev_config_add_vhost_cmd_ctx = {
+	.f = cli_link_dev_config_add_vhost,
+	.data = NULL,
+	.help_str = cmd_link_dev_config_add_vhost_help,
+	.tokens = {
+		(void *)&link_dev_config_cmd,
+		(void *)&link_dev_config_dev,
+		(void *)&link_dev_config_config,
+		(void *)&link_dev_config_add,
+		(void *)&link_dev_config_vhost,
+		(void *)&link_dev_config_vhost_role,
+		(void *)&link_dev_config_path,
+		(void *)&link_dev_config_queues,
+		(void *)&link_dev_config_nb_queues,
+		NULL,
+	},
+};
+
+cmdline_parse_inst_t link_dev_config_add_vhost_mbufs_cmd_ctx = {
+	.f = cli_link_dev_config_add_vhost,
+	.data = (void *)1,
+	.help_str = cmd_link_dev_config_add_vhost_mbufs_help,
+	.tokens = {
+		(void *)&link_dev_config_cmd,
+		(void *)&link_dev_config_dev,
+		(void *)&link_dev_config_config,
+		(void *)&link_dev_config_add,
+		(void *)&link_dev_config_vhost,
+		(void *)&link_dev_config_vhost_role,
+		(void *)&link_dev_config_path,
+		(void *)&link_dev_config_queues,
+		(void *)&link_dev_config_nb_queues,
+		(void *)&link_dev_config_mbufs,
+		(void *)&link_dev_config_nb_mbufs,
+		NULL,
+	},
+};
+
+cmdline_parse_inst_t link_dev_config_add_memif_cmd_ctx = {
+	.f = cli_link_dev_config_add_memif,
+	.data = NULL,
+	.help_str = cmd_link_dev_config_add_memif_help,
+	.tokens = {
+		(void *)&link_dev_config_cmd,
+		(void *)&link_dev_config_dev,
+		(void *)&link_dev_config_config,
+		(void *)&link_dev_config_add,
+		(void *)&link_dev_config_memif,
+		(void *)&link_dev_config_memif_role,
+		(void *)&link_dev_config_path,
+		(void *)&link_dev_config_id,
+		(void *)&link_dev_config_memif_id,
+		(void *)&link_dev_config_queues,
+		(void *)&link_dev_config_nb_queues,
+		NULL,
+	},
+};
+
+cmdline_parse_inst_t link_dev_config_add_memif_ring_cmd_ctx = {
+	.f = cli_link_dev_config_add_memif,
+	.data = (void *)1,
+	.help_str = cmd_link_dev_config_add_memif_ring_help,
+	.tokens = {
+		(void *)&link_dev_config_cmd,
+		(void *)&link_dev_config_dev,
+		(void *)&link_dev_config_config,
+		(void *)&link_dev_config_add,
+		(void *)&link_dev_config_memif,
+		(void *)&link_dev_config_memif_role,
+		(void *)&link_dev_config_path,
+		(void *)&link_dev_config_id,
+		(void *)&link_dev_config_memif_id,
+		(void *)&link_dev_config_queues,
+		(void *)&link_dev_config_nb_queues,
+		(void *)&link_dev_config_ring,
+		(void *)&link_dev_config_ring_sz,
+		(void *)&link_dev_config_buffer,
+		(void *)&link_dev_config_buf_sz,
+		(void *)&link_dev_config_numa,
+		(void *)&link_dev_config_numa_node,
+		NULL,
+	},
+};
+
+cmdline_parse_inst_t link_dev_config_add_afxdp_cmd_ctx = {
+	.f = cli_link_dev_config_add_afxdp,
+	.data = NULL,
+	.help_str = cmd_link_dev_config_add_afxdp_help,
+	.tokens = {
+		(void *)&link_dev_config_cmd,
+		(void *)&link_dev_config_dev,
+		(void *)&link_dev_config_config,
+		(void *)&link_dev_config_add,
+		(void *)&link_dev_config_afxdp,
+		(void *)&link_dev_config_ifname,
+		(void *)&link_dev_config_mempool,
+		(void *)&link_dev_config_mp_name,
+		(void *)&link_dev_config_stages,
+		(void *)&link_dev_config_stage_name,
+		NULL,
+	},
+};
+
 cmdline_parse_inst_t link_dev_config_rem_cmd_ctx = {
 	.f = cli_link_dev_config_rem,
 	.data = NULL,
@@ -301,6 +840,91 @@ cmdline_parse_inst_t link_dev_config_set_peer_cmd_ctx = {
 	},
 };
 
+cmdline_parse_inst_t link_dev_config_set_rss_cmd_ctx = {
+	.f = cli_link_dev_config_set_rss,
+	.data = NULL,
+	.help_str = cmd_link_dev_config_set_rss_help,
+	.tokens = {
+		(void *)&link_dev_config_cmd,
+		(void *)&link_dev_config_dev,
+		(void *)&link_dev_config_config,
+		(void *)&link_dev_config_set_rss,
+		(void *)&link_dev_config_rss_queues,
+		NULL,
+	},
+};
+
+cmdline_parse_inst_t link_dev_config_set_vlan_cmd_ctx = {
+	.f = cli_link_dev_config_set_vlan,
+	.data = NULL,
+	.help_str = cmd_link_dev_config_set_vlan_help,
+	.tokens = {
+		(void *)&link_dev_config_cmd,
+		(void *)&link_dev_config_dev,
+		(void *)&link_dev_config_config,
+		(void *)&link_dev_config_set_vlan,
+		(void *)&link_dev_config_vlan_mode,
+		(void *)&link_dev_config_vlan_ids,
+		NULL,
+	},
+};
+
+cmdline_parse_inst_t link_dev_config_set_vlan_native_cmd_ctx = {
+	.f = cli_link_dev_config_set_vlan_native,
+	.data = NULL,
+	.help_str = cmd_link_dev_config_set_vlan_native_help,
+	.tokens = {
+		(void *)&link_dev_config_cmd,
+		(void *)&link_dev_config_dev,
+		(void *)&link_dev_config_config,
+		(void *)&link_dev_config_set_vlan,
+		(void *)&link_dev_config_vlan_native,
+		(void *)&link_dev_config_vlan_id,
+		NULL,
+	},
+};
+
+cmdline_parse_inst_t link_dev_config_set_vlan_off_cmd_ctx = {
+	.f = cli_link_dev_config_set_vlan_off,
+	.data = NULL,
+	.help_str = cmd_link_dev_config_set_vlan_off_help,
+	.tokens = {
+		(void *)&link_dev_config_cmd,
+		(void *)&link_dev_config_dev,
+		(void *)&link_dev_config_config,
+		(void *)&link_dev_config_set_vlan,
+		(void *)&link_dev_config_vlan_off,
+		NULL,
+	},
+};
+
+cmdline_parse_inst_t link_dev_config_set_tx_csum_cmd_ctx = {
+	.f = cli_link_dev_config_set_tx_csum,
+	.data = NULL,
+	.help_str = cmd_link_dev_config_set_tx_csum_help,
+	.tokens = {
+		(void *)&link_dev_config_cmd,
+		(void *)&link_dev_config_dev,
+		(void *)&link_dev_config_config,
+		(void *)&link_dev_config_set_tx_csum,
+		NULL,
+	},
+};
+
+cmdline_parse_inst_t link_dev_config_set_reassembly_cmd_ctx = {
+	.f = cli_link_dev_config_set_reassembly,
+	.data = NULL,
+	.help_str = cmd_link_dev_config_set_reassembly_help,
+	.tokens = {
+		(void *)&link_dev_config_cmd,
+		(void *)&link_dev_config_dev,
+		(void *)&link_dev_config_config,
+		(void *)&link_dev_config_set_reassembly,
+		(void *)&link_dev_config_reassembly,
+		NULL,
+	},
+};
+
 static int
 link_show_port(struct cmdline *cl, uint16_t port_id)
 {
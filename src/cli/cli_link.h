@@ -28,18 +28,50 @@ struct link_config_cmd_tokens {
 	cmdline_fixed_string_t stage;
 	cmdline_fixed_string_t stage_name;
 	cmdline_fixed_string_t peer;
+	cmdline_fixed_string_t rss_queues;
+	cmdline_fixed_string_t vlan_mode;
+	cmdline_fixed_string_t vlan_ids;
+	cmdline_fixed_string_t reassembly;
+	cmdline_fixed_string_t type;
+	cmdline_fixed_string_t role;
+	cmdline_fixed_string_t path;
+	cmdline_fixed_string_t queues;
+	cmdline_fixed_string_t mbufs;
+	cmdline_fixed_string_t id;
+	cmdline_fixed_string_t ring;
+	cmdline_fixed_string_t buffer;
+	cmdline_fixed_string_t numa;
+	cmdline_fixed_string_t ifname;
 	uint16_t mtu;
+	uint16_t vlan_id;
 	uint16_t nb_rxq;
 	uint16_t nb_txq;
+	uint16_t nb_queues;
+	uint32_t nb_mbufs;
+	uint32_t memif_id;
+	uint16_t buf_sz;
+	uint8_t ring_sz;
+	uint8_t numa_node;
 };
 
 extern cmdline_parse_inst_t link_show_cmd_ctx;
 extern cmdline_parse_inst_t link_dev_show_cmd_ctx;
 extern cmdline_parse_inst_t link_dev_config_add_cmd_ctx;
+extern cmdline_parse_inst_t link_dev_config_add_vhost_cmd_ctx;
+extern cmdline_parse_inst_t link_dev_config_add_vhost_mbufs_cmd_ctx;
+extern cmdline_parse_inst_t link_dev_config_add_memif_cmd_ctx;
+extern cmdline_parse_inst_t link_dev_config_add_memif_ring_cmd_ctx;
+extern cmdline_parse_inst_t link_dev_config_add_afxdp_cmd_ctx;
 extern cmdline_parse_inst_t link_dev_config_rem_cmd_ctx;
 extern cmdline_parse_inst_t link_dev_config_show_cmd_ctx;
 extern cmdline_parse_inst_t link_dev_config_set_promiscuous_cmd_ctx;
 extern cmdline_parse_inst_t link_dev_config_set_mtu_cmd_ctx;
 extern cmdline_parse_inst_t link_dev_config_set_peer_cmd_ctx;
+extern cmdline_parse_inst_t link_dev_config_set_rss_cmd_ctx;
+extern cmdline_parse_inst_t link_dev_config_set_vlan_cmd_ctx;
+extern cmdline_parse_inst_t link_dev_config_set_vlan_native_cmd_ctx;
+extern cmdline_parse_inst_t link_dev_config_set_vlan_off_cmd_ctx;
+extern cmdline_parse_inst_t link_dev_config_set_tx_csum_cmd_ctx;
+extern cmdline_parse_inst_t link_dev_config_set_reassembly_cmd_ctx;
 
 #endif /* __VSWITCH_SRC_CLI_LINK_H_ */
\ No newline at end of file
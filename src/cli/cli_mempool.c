@@ -28,6 +28,8 @@ cli_mempool_add(void *parsed_result, __rte_unused struct cmdline *cl, __rte_unus
 	config.nb_items = res->nb_items;
 	config.cache_sz = res->cache_sz;
 	config.numa_node = res->node;
+	config.type = (strcmp(res->type, "vector") == 0) ?
+			MEMPOOL_TYPE_VECTOR : MEMPOOL_TYPE_PKTMBUF;
 
 	rc = mempool_config_add(&config);
 	if (rc < 0) {
@@ -54,8 +56,10 @@ cli_mempool_rem_show(void *parsed_result, __rte_unused struct cmdline *cl, __rte
                 mempool_config_rem(mp_name);
         } else if (strcmp(res->action, "show") == 0) {
                 cmdline_printf(cl,
-                        "%s: nb_items=%d, item_sz=%d, cache %d numa %d\n",
-                        mp->config.name, mp->config.nb_items, mp->config.item_sz,
+                        "%s: type %s nb_items=%d, item_sz=%d, cache %d numa %d\n",
+                        mp->config.name,
+                        (mp->config.type == MEMPOOL_TYPE_VECTOR) ? "vector" : "pktmbuf",
+                        mp->config.nb_items, mp->config.item_sz,
                         mp->config.cache_sz, mp->config.numa_node);
         } else {
                 cmdline_printf(cl, MSG_ARG_INVALID, res->action);
@@ -74,7 +78,7 @@ cmdline_parse_token_string_t mempool_add =
 cmdline_parse_token_string_t mempool_rem_show =
 	TOKEN_STRING_INITIALIZER(struct mempool_config_cmd_tokens, action, "rem#show");
 cmdline_parse_token_string_t mempool_type =
-	TOKEN_STRING_INITIALIZER(struct mempool_config_cmd_tokens, type, "pktmbuf#event");
+	TOKEN_STRING_INITIALIZER(struct mempool_config_cmd_tokens, type, "pktmbuf#vector");
 cmdline_parse_token_string_t mempool_name =
 	TOKEN_STRING_INITIALIZER(struct mempool_config_cmd_tokens, name, NULL);
 cmdline_parse_token_string_t mempool_add_sz =
@@ -95,7 +99,7 @@ cmdline_parse_token_num_t mempool_add_node =
 	TOKEN_NUM_INITIALIZER(struct mempool_config_cmd_tokens, node, RTE_UINT16);
 
 static char const
-cmd_mempool_add_help[] = "mempool add <mp_name> type pktmbuf#event [size <item_sz>] [items <nb_items>] "
+cmd_mempool_add_help[] = "mempool add <mp_name> type pktmbuf#vector [size <item_sz>] [items <nb_items>] "
 		     "[cache <cache_sz>] [numa <node>]";
 
 cmdline_parse_inst_t mempool_add_cmd_ctx = {
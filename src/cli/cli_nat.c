@@ -0,0 +1,296 @@
+/*
+  SPDX-License-Identifier: MIT
+  Copyright(c) 2023 Sriram Yagnaraman.
+*/
+
+#include <arpa/inet.h>
+#include <stdlib.h>
+
+#include <rte_byteorder.h>
+#include <rte_eal.h>
+#include <rte_malloc.h>
+
+#include <cmdline.h>
+#include <cmdline_parse.h>
+#include <cmdline_parse_string.h>
+#include <cmdline_parse_num.h>
+
+#include "cli.h"
+#include "cli_nat.h"
+#include "nat.h"
+
+static char const * const nat_type_names[] = {
+	[NAT_TYPE_SNAT] = "snat",
+	[NAT_TYPE_DNAT] = "dnat",
+};
+
+/* "a.b.c.d" or "a.b.c.d/len", returned in host byte order */
+static int
+cli_nat_parse_prefix(char const *str, uint32_t *ip, uint8_t *depth)
+{
+	char buf[INET_ADDRSTRLEN];
+	struct in_addr addr;
+	char *slash, *end;
+	unsigned long len = 32;
+
+	if (rte_strscpy(buf, str, sizeof(buf)) < 0)
+		return -EINVAL;
+
+	slash = strchr(buf, '/');
+	if (slash) {
+		if (!depth)
+			return -EINVAL;
+		*slash++ = '\0';
+		len = strtoul(slash, &end, 10);
+		if (*slash == '\0' || *end != '\0' || len > 32)
+			return -EINVAL;
+	}
+
+	if (inet_pton(AF_INET, buf, &addr) != 1)
+		return -EINVAL;
+
+	*ip = rte_be_to_cpu_32(addr.s_addr);
+	if (depth)
+		*depth = len;
+	return 0;
+}
+
+static void
+cli_nat_snat_add(void *parsed_result, struct cmdline *cl, __rte_unused void *data)
+{
+	struct nat_cmd_tokens *res = parsed_result;
+	struct nat_rule_config config;
+	struct nat_rule *rule = &config.rule;
+	int rc;
+
+	memset(&config, 0, sizeof(config));
+
+	config.rule_id = res->rule_id;
+	rule->type = NAT_TYPE_SNAT;
+	rule->proto = res->proto_id;
+	rule->to_port_lo = res->to_port_lo;
+	rule->to_port_hi = res->to_port_hi;
+
+	rc = cli_nat_parse_prefix(res->match, &rule->match_ip, &rule->depth);
+	if (rc < 0)
+		goto err;
+
+	rc = cli_nat_parse_prefix(res->to_ip, &rule->to_ip, NULL);
+	if (rc < 0)
+		goto err;
+
+	rc = nat_rule_config_add(&config);
+	if (rc < 0)
+		goto err;
+
+	return;
+
+err:
+	cmdline_printf(cl, "nat snat add %u failed: %s\n", res->rule_id, rte_strerror(-rc));
+}
+
+static void
+cli_nat_dnat_add(void *parsed_result, struct cmdline *cl, __rte_unused void *data)
+{
+	struct nat_cmd_tokens *res = parsed_result;
+	struct nat_rule_config config;
+	struct nat_rule *rule = &config.rule;
+	int rc;
+
+	memset(&config, 0, sizeof(config));
+
+	config.rule_id = res->rule_id;
+	rule->type = NAT_TYPE_DNAT;
+	rule->proto = res->proto_id;
+	rule->depth = 32;
+	rule->match_port = res->match_port;
+	rule->to_port_lo = res->to_port_lo;
+	rule->to_port_hi = res->to_port_lo;
+
+	rc = cli_nat_parse_prefix(res->match, &rule->match_ip, NULL);
+	if (rc < 0)
+		goto err;
+
+	rc = cli_nat_parse_prefix(res->to_ip, &rule->to_ip, NULL);
+	if (rc < 0)
+		goto err;
+
+	rc = nat_rule_config_add(&config);
+	if (rc < 0)
+		goto err;
+
+	return;
+
+err:
+	cmdline_printf(cl, "nat dnat add %u failed: %s\n", res->rule_id, rte_strerror(-rc));
+}
+
+static void
+cli_nat_rule_rem(void *parsed_result, struct cmdline *cl, __rte_unused void *data)
+{
+	struct nat_cmd_tokens *res = parsed_result;
+	int rc;
+
+	rc = nat_rule_config_rem(res->rule_id);
+	if (rc < 0)
+		cmdline_printf(cl, "nat rule rem %u failed: %s\n", res->rule_id, rte_strerror(-rc));
+}
+
+static int
+cli_nat_show_rule(struct nat_rule_config *config, void *data)
+{
+	struct nat_rule *rule = &config->rule;
+	struct cmdline *cl = data;
+	char match[INET_ADDRSTRLEN], to[INET_ADDRSTRLEN];
+	struct in_addr addr;
+
+	addr.s_addr = rte_cpu_to_be_32(rule->match_ip);
+	inet_ntop(AF_INET, &addr, match, sizeof(match));
+	addr.s_addr = rte_cpu_to_be_32(rule->to_ip);
+	inet_ntop(AF_INET, &addr, to, sizeof(to));
+
+	if (rule->type == NAT_TYPE_SNAT)
+		cmdline_printf(cl, "\t%u: %s src %s/%u proto %u to %s ports %u-%u\n",
+			       config->rule_id, nat_type_names[rule->type],
+			       match, rule->depth, rule->proto,
+			       to, rule->to_port_lo, rule->to_port_hi);
+	else
+		cmdline_printf(cl, "\t%u: %s vip %s port %u proto %u to %s port %u\n",
+			       config->rule_id, nat_type_names[rule->type],
+			       match, rule->match_port, rule->proto,
+			       to, rule->to_port_lo);
+	return 0;
+}
+
+static void
+cli_nat_show(__rte_unused void *parsed_result, struct cmdline *cl, __rte_unused void *data)
+{
+	cmdline_printf(cl, "nat:\n");
+	nat_rule_config_walk(cli_nat_show_rule, cl);
+}
+
+cmdline_parse_token_string_t nat_cmd =
+	TOKEN_STRING_INITIALIZER(struct nat_cmd_tokens, nat, "nat");
+cmdline_parse_token_string_t nat_type_snat =
+	TOKEN_STRING_INITIALIZER(struct nat_cmd_tokens, type, "snat");
+cmdline_parse_token_string_t nat_type_dnat =
+	TOKEN_STRING_INITIALIZER(struct nat_cmd_tokens, type, "dnat");
+cmdline_parse_token_string_t nat_type_rule =
+	TOKEN_STRING_INITIALIZER(struct nat_cmd_tokens, type, "rule");
+cmdline_parse_token_string_t nat_action_add =
+	TOKEN_STRING_INITIALIZER(struct nat_cmd_tokens, action, "add");
+cmdline_parse_token_string_t nat_action_rem =
+	TOKEN_STRING_INITIALIZER(struct nat_cmd_tokens, action, "rem");
+cmdline_parse_token_string_t nat_action_show =
+	TOKEN_STRING_INITIALIZER(struct nat_cmd_tokens, action, "show");
+cmdline_parse_token_num_t nat_rule_id =
+	TOKEN_NUM_INITIALIZER(struct nat_cmd_tokens, rule_id, RTE_UINT32);
+cmdline_parse_token_string_t nat_src =
+	TOKEN_STRING_INITIALIZER(struct nat_cmd_tokens, src, "src");
+cmdline_parse_token_string_t nat_vip =
+	TOKEN_STRING_INITIALIZER(struct nat_cmd_tokens, src, "vip");
+cmdline_parse_token_string_t nat_match =
+	TOKEN_STRING_INITIALIZER(struct nat_cmd_tokens, match, NULL);
+cmdline_parse_token_string_t nat_port =
+	TOKEN_STRING_INITIALIZER(struct nat_cmd_tokens, port, "port");
+cmdline_parse_token_num_t nat_match_port =
+	TOKEN_NUM_INITIALIZER(struct nat_cmd_tokens, match_port, RTE_UINT16);
+cmdline_parse_token_string_t nat_proto =
+	TOKEN_STRING_INITIALIZER(struct nat_cmd_tokens, proto, "proto");
+cmdline_parse_token_num_t nat_proto_id =
+	TOKEN_NUM_INITIALIZER(struct nat_cmd_tokens, proto_id, RTE_UINT8);
+cmdline_parse_token_string_t nat_to =
+	TOKEN_STRING_INITIALIZER(struct nat_cmd_tokens, to, "to");
+cmdline_parse_token_string_t nat_to_ip =
+	TOKEN_STRING_INITIALIZER(struct nat_cmd_tokens, to_ip, NULL);
+cmdline_parse_token_string_t nat_ports =
+	TOKEN_STRING_INITIALIZER(struct nat_cmd_tokens, ports, "ports");
+cmdline_parse_token_string_t nat_to_port =
+	TOKEN_STRING_INITIALIZER(struct nat_cmd_tokens, ports, "port");
+cmdline_parse_token_num_t nat_to_port_lo =
+	TOKEN_NUM_INITIALIZER(struct nat_cmd_tokens, to_port_lo, RTE_UINT16);
+cmdline_parse_token_num_t nat_to_port_hi =
+	TOKEN_NUM_INITIALIZER(struct nat_cmd_tokens, to_port_hi, RTE_UINT16);
+
+static char const
+cmd_nat_snat_add_help[] = "nat snat add <rule_id> src <prefix> proto <proto, 0 any>"
+			  " to <ip> ports <lo> <hi>";
+
+cmdline_parse_inst_t nat_snat_add_cmd_ctx = {
+	.f = cli_nat_snat_add,
+	.data = NULL,
+	.help_str = cmd_nat_snat_add_help,
+	.tokens = {
+		(void *)&nat_cmd,
+		(void *)&nat_type_snat,
+		(void *)&nat_action_add,
+		(void *)&nat_rule_id,
+		(void *)&nat_src,
+		(void *)&nat_match,
+		(void *)&nat_proto,
+		(void *)&nat_proto_id,
+		(void *)&nat_to,
+		(void *)&nat_to_ip,
+		(void *)&nat_ports,
+		(void *)&nat_to_port_lo,
+		(void *)&nat_to_port_hi,
+		NULL,
+	},
+};
+
+static char const
+cmd_nat_dnat_add_help[] = "nat dnat add <rule_id> vip <ip> port <port, 0 any> proto <proto, 0 any>"
+			  " to <ip> port <port, 0 keep>";
+
+cmdline_parse_inst_t nat_dnat_add_cmd_ctx = {
+	.f = cli_nat_dnat_add,
+	.data = NULL,
+	.help_str = cmd_nat_dnat_add_help,
+	.tokens = {
+		(void *)&nat_cmd,
+		(void *)&nat_type_dnat,
+		(void *)&nat_action_add,
+		(void *)&nat_rule_id,
+		(void *)&nat_vip,
+		(void *)&nat_match,
+		(void *)&nat_port,
+		(void *)&nat_match_port,
+		(void *)&nat_proto,
+		(void *)&nat_proto_id,
+		(void *)&nat_to,
+		(void *)&nat_to_ip,
+		(void *)&nat_to_port,
+		(void *)&nat_to_port_lo,
+		NULL,
+	},
+};
+
+static char const
+cmd_nat_rule_rem_help[] = "nat rule rem <rule_id>";
+
+cmdline_parse_inst_t nat_rule_rem_cmd_ctx = {
+	.f = cli_nat_rule_rem,
+	.data = NULL,
+	.help_str = cmd_nat_rule_rem_help,
+	.tokens = {
+		(void *)&nat_cmd,
+		(void *)&nat_type_rule,
+		(void *)&nat_action_rem,
+		(void *)&nat_rule_id,
+		NULL,
+	},
+};
+
+static char const
+cmd_nat_show_help[] = "nat show";
+
+cmdline_parse_inst_t nat_show_cmd_ctx = {
+	.f = cli_nat_show,
+	.data = NULL,
+	.help_str = cmd_nat_show_help,
+	.tokens = {
+		(void *)&nat_cmd,
+		(void *)&nat_action_show,
+		NULL,
+	},
+};
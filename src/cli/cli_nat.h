@@ -0,0 +1,36 @@
+/*
+  SPDX-License-Identifier: MIT
+  Copyright(c) 2023 Sriram Yagnaraman.
+*/
+
+#ifndef __VSWITCH_SRC_CLI_NAT_H_
+#define __VSWITCH_SRC_CLI_NAT_H_
+
+#include <cmdline.h>
+#include <cmdline_parse.h>
+#include <cmdline_parse_string.h>
+
+struct nat_cmd_tokens {
+	cmdline_fixed_string_t nat;
+	cmdline_fixed_string_t type;
+	cmdline_fixed_string_t action;
+	cmdline_fixed_string_t src;
+	cmdline_fixed_string_t match;
+	cmdline_fixed_string_t port;
+	cmdline_fixed_string_t proto;
+	cmdline_fixed_string_t to;
+	cmdline_fixed_string_t to_ip;
+	cmdline_fixed_string_t ports;
+	uint32_t rule_id;
+	uint16_t match_port;
+	uint8_t proto_id;
+	uint16_t to_port_lo;
+	uint16_t to_port_hi;
+};
+
+extern cmdline_parse_inst_t nat_snat_add_cmd_ctx;
+extern cmdline_parse_inst_t nat_dnat_add_cmd_ctx;
+extern cmdline_parse_inst_t nat_rule_rem_cmd_ctx;
+extern cmdline_parse_inst_t nat_show_cmd_ctx;
+
+#endif /* __VSWITCH_SRC_CLI_NAT_H_*/
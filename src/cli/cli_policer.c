@@ -0,0 +1,343 @@
+/*
+  SPDX-License-Identifier: MIT
+  Copyright(c) 2023 Sriram Yagnaraman.
+*/
+
+#include <inttypes.h>
+#include <stdlib.h>
+
+#include <rte_eal.h>
+#include <rte_ethdev.h>
+#include <rte_malloc.h>
+
+#include <cmdline.h>
+#include <cmdline_parse.h>
+#include <cmdline_parse_string.h>
+#include <cmdline_parse_num.h>
+
+#include "cli.h"
+#include "cli_policer.h"
+#include "policer.h"
+
+static char const * const policer_type_names[] = {
+	[POLICER_TYPE_NONE] = "none",
+	[POLICER_TYPE_SRTCM] = "srtcm",
+	[POLICER_TYPE_TRTCM] = "trtcm",
+};
+
+static char const * const policer_action_names[] = {
+	[POLICER_ACTION_PASS] = "pass",
+	[POLICER_ACTION_DROP] = "drop",
+	[POLICER_ACTION_REMARK] = "remark",
+	[POLICER_ACTION_DEMOTE] = "demote",
+};
+
+static char const * const policer_color_names[] = {
+	[RTE_COLOR_GREEN] = "green",
+	[RTE_COLOR_YELLOW] = "yellow",
+	[RTE_COLOR_RED] = "red",
+};
+
+static int
+cli_policer_lookup(char const * const *names, uint32_t nb_names, char const *name)
+{
+	uint32_t i;
+
+	for (i = 0; i < nb_names; i++) {
+		if (names[i] && strcmp(names[i], name) == 0)
+			return i;
+	}
+
+	return -EINVAL;
+}
+
+static void
+cli_policer_add(void *parsed_result, struct cmdline *cl, __rte_unused void *data)
+{
+	struct policer_cmd_tokens *res = parsed_result;
+	struct policer_config config;
+	struct policer_params *params = &config.params;
+	int rc;
+
+	memset(&config, 0, sizeof(config));
+
+	config.policer_id = res->policer_id;
+	params->cir = res->cir_val;
+	params->cbs = res->cbs_val;
+	params->pbs = res->pbs_val;
+	if (strcmp(res->type, "trtcm") == 0) {
+		params->type = POLICER_TYPE_TRTCM;
+		params->pir = res->pir_val;
+	} else {
+		params->type = POLICER_TYPE_SRTCM;
+	}
+	/* Out of profile is dropped unless told otherwise */
+	params->action[RTE_COLOR_RED] = POLICER_ACTION_DROP;
+
+	rc = policer_config_add(&config);
+	if (rc < 0)
+		cmdline_printf(cl, "policer add %u failed: %s\n", res->policer_id, rte_strerror(-rc));
+}
+
+static void
+cli_policer_rem(void *parsed_result, struct cmdline *cl, __rte_unused void *data)
+{
+	struct policer_cmd_tokens *res = parsed_result;
+	int rc;
+
+	rc = policer_config_rem(res->policer_id);
+	if (rc < 0)
+		cmdline_printf(cl, "policer rem %u failed: %s\n", res->policer_id, rte_strerror(-rc));
+}
+
+static void
+cli_policer_color(void *parsed_result, struct cmdline *cl, __rte_unused void *data)
+{
+	struct policer_cmd_tokens *res = parsed_result;
+	int color, action;
+	int rc;
+
+	color = cli_policer_lookup(policer_color_names, RTE_DIM(policer_color_names),
+				   res->color_name);
+	action = cli_policer_lookup(policer_action_names, RTE_DIM(policer_action_names),
+				    res->verdict);
+	if (color < 0 || action < 0) {
+		rc = -EINVAL;
+		goto err;
+	}
+
+	rc = policer_config_set_action(res->policer_id, color, action, res->dscp);
+	if (rc < 0)
+		goto err;
+
+	return;
+
+err:
+	cmdline_printf(cl, "policer %u color %s failed: %s\n",
+		       res->policer_id, res->color_name, rte_strerror(-rc));
+}
+
+static void
+cli_policer_link(void *parsed_result, struct cmdline *cl, __rte_unused void *data)
+{
+	struct policer_cmd_tokens *res = parsed_result;
+	int rc;
+
+	rc = policer_config_set_link(res->dev, res->policer_id);
+	if (rc < 0)
+		cmdline_printf(cl, "policer link %s failed: %s\n", res->dev, rte_strerror(-rc));
+}
+
+static int
+cli_policer_show_one(struct policer_config *config, void *data)
+{
+	struct policer_params *params = &config->params;
+	struct cmdline *cl = data;
+	uint32_t i;
+
+	cmdline_printf(cl, "\t%u: %s cir %"PRIu64" cbs %"PRIu64" pir %"PRIu64" pbs %"PRIu64"\n",
+		       config->policer_id, policer_type_names[params->type],
+		       params->cir, params->cbs, params->pir, params->pbs);
+	for (i = 0; i < RTE_COLORS; i++) {
+		if (params->action[i] == POLICER_ACTION_REMARK)
+			cmdline_printf(cl, "\t\t%s remark %u\n", policer_color_names[i],
+				       params->dscp[i]);
+		else
+			cmdline_printf(cl, "\t\t%s %s\n", policer_color_names[i],
+				       policer_action_names[params->action[i]]);
+	}
+
+	return 0;
+}
+
+static void
+cli_policer_show(__rte_unused void *parsed_result, struct cmdline *cl, __rte_unused void *data)
+{
+	char name[RTE_ETH_NAME_MAX_LEN];
+	uint16_t port_id;
+	uint8_t id;
+
+	cmdline_printf(cl, "policer:\n");
+	policer_config_walk(cli_policer_show_one, cl);
+
+	RTE_ETH_FOREACH_DEV(port_id) {
+		id = policer_config_get_link(port_id);
+		if (id == POLICER_ID_NONE || rte_eth_dev_get_name_by_port(port_id, name) < 0)
+			continue;
+		cmdline_printf(cl, "\tlink %s: %u\n", name, id);
+	}
+}
+
+cmdline_parse_token_string_t policer_cmd =
+	TOKEN_STRING_INITIALIZER(struct policer_cmd_tokens, policer, "policer");
+cmdline_parse_token_string_t policer_action_add =
+	TOKEN_STRING_INITIALIZER(struct policer_cmd_tokens, action, "add");
+cmdline_parse_token_string_t policer_action_rem =
+	TOKEN_STRING_INITIALIZER(struct policer_cmd_tokens, action, "rem");
+cmdline_parse_token_string_t policer_action_link =
+	TOKEN_STRING_INITIALIZER(struct policer_cmd_tokens, action, "link");
+cmdline_parse_token_string_t policer_action_show =
+	TOKEN_STRING_INITIALIZER(struct policer_cmd_tokens, action, "show");
+cmdline_parse_token_num_t policer_id =
+	TOKEN_NUM_INITIALIZER(struct policer_cmd_tokens, policer_id, RTE_UINT32);
+cmdline_parse_token_string_t policer_type_srtcm =
+	TOKEN_STRING_INITIALIZER(struct policer_cmd_tokens, type, "srtcm");
+cmdline_parse_token_string_t policer_type_trtcm =
+	TOKEN_STRING_INITIALIZER(struct policer_cmd_tokens, type, "trtcm");
+cmdline_parse_token_string_t policer_cir =
+	TOKEN_STRING_INITIALIZER(struct policer_cmd_tokens, cir, "cir");
+cmdline_parse_token_num_t policer_cir_val =
+	TOKEN_NUM_INITIALIZER(struct policer_cmd_tokens, cir_val, RTE_UINT64);
+cmdline_parse_token_string_t policer_cbs =
+	TOKEN_STRING_INITIALIZER(struct policer_cmd_tokens, cbs, "cbs");
+cmdline_parse_token_num_t policer_cbs_val =
+	TOKEN_NUM_INITIALIZER(struct policer_cmd_tokens, cbs_val, RTE_UINT64);
+cmdline_parse_token_string_t policer_pir =
+	TOKEN_STRING_INITIALIZER(struct policer_cmd_tokens, pir, "pir");
+cmdline_parse_token_num_t policer_pir_val =
+	TOKEN_NUM_INITIALIZER(struct policer_cmd_tokens, pir_val, RTE_UINT64);
+cmdline_parse_token_string_t policer_ebs =
+	TOKEN_STRING_INITIALIZER(struct policer_cmd_tokens, pbs, "ebs");
+cmdline_parse_token_string_t policer_pbs =
+	TOKEN_STRING_INITIALIZER(struct policer_cmd_tokens, pbs, "pbs");
+cmdline_parse_token_num_t policer_pbs_val =
+	TOKEN_NUM_INITIALIZER(struct policer_cmd_tokens, pbs_val, RTE_UINT64);
+cmdline_parse_token_string_t policer_color =
+	TOKEN_STRING_INITIALIZER(struct policer_cmd_tokens, color, "color");
+cmdline_parse_token_string_t policer_color_name =
+	TOKEN_STRING_INITIALIZER(struct policer_cmd_tokens, color_name, "green#yellow#red");
+cmdline_parse_token_string_t policer_verdict =
+	TOKEN_STRING_INITIALIZER(struct policer_cmd_tokens, verdict, "pass#drop#demote");
+cmdline_parse_token_string_t policer_remark =
+	TOKEN_STRING_INITIALIZER(struct policer_cmd_tokens, verdict, "remark");
+cmdline_parse_token_num_t policer_dscp =
+	TOKEN_NUM_INITIALIZER(struct policer_cmd_tokens, dscp, RTE_UINT8);
+cmdline_parse_token_string_t policer_dev =
+	TOKEN_STRING_INITIALIZER(struct policer_cmd_tokens, dev, NULL);
+
+static char const
+cmd_policer_srtcm_add_help[] = "policer add <id> srtcm cir <bytes/s> cbs <bytes> ebs <bytes>";
+
+cmdline_parse_inst_t policer_srtcm_add_cmd_ctx = {
+	.f = cli_policer_add,
+	.data = NULL,
+	.help_str = cmd_policer_srtcm_add_help,
+	.tokens = {
+		(void *)&policer_cmd,
+		(void *)&policer_action_add,
+		(void *)&policer_id,
+		(void *)&policer_type_srtcm,
+		(void *)&policer_cir,
+		(void *)&policer_cir_val,
+		(void *)&policer_cbs,
+		(void *)&policer_cbs_val,
+		(void *)&policer_ebs,
+		(void *)&policer_pbs_val,
+		NULL,
+	},
+};
+
+static char const
+cmd_policer_trtcm_add_help[] = "policer add <id> trtcm cir <bytes/s> cbs <bytes>"
+			       " pir <bytes/s> pbs <bytes>";
+
+cmdline_parse_inst_t policer_trtcm_add_cmd_ctx = {
+	.f = cli_policer_add,
+	.data = NULL,
+	.help_str = cmd_policer_trtcm_add_help,
+	.tokens = {
+		(void *)&policer_cmd,
+		(void *)&policer_action_add,
+		(void *)&policer_id,
+		(void *)&policer_type_trtcm,
+		(void *)&policer_cir,
+		(void *)&policer_cir_val,
+		(void *)&policer_cbs,
+		(void *)&policer_cbs_val,
+		(void *)&policer_pir,
+		(void *)&policer_pir_val,
+		(void *)&policer_pbs,
+		(void *)&policer_pbs_val,
+		NULL,
+	},
+};
+
+static char const
+cmd_policer_rem_help[] = "policer rem <id>";
+
+cmdline_parse_inst_t policer_rem_cmd_ctx = {
+	.f = cli_policer_rem,
+	.data = NULL,
+	.help_str = cmd_policer_rem_help,
+	.tokens = {
+		(void *)&policer_cmd,
+		(void *)&policer_action_rem,
+		(void *)&policer_id,
+		NULL,
+	},
+};
+
+static char const
+cmd_policer_color_help[] = "policer <id> color <green#yellow#red> <pass#drop#demote>";
+
+cmdline_parse_inst_t policer_color_cmd_ctx = {
+	.f = cli_policer_color,
+	.data = NULL,
+	.help_str = cmd_policer_color_help,
+	.tokens = {
+		(void *)&policer_cmd,
+		(void *)&policer_id,
+		(void *)&policer_color,
+		(void *)&policer_color_name,
+		(void *)&policer_verdict,
+		NULL,
+	},
+};
+
+static char const
+cmd_policer_remark_help[] = "policer <id> color <green#yellow#red> remark <dscp>";
+
+cmdline_parse_inst_t policer_remark_cmd_ctx = {
+	.f = cli_policer_color,
+	.data = NULL,
+	.help_str = cmd_policer_remark_help,
+	.tokens = {
+		(void *)&policer_cmd,
+		(void *)&policer_id,
+		(void *)&policer_color,
+		(void *)&policer_color_name,
+		(void *)&policer_remark,
+		(void *)&policer_dscp,
+		NULL,
+	},
+};
+
+static char const
+cmd_policer_link_help[] = "policer link <dev> <id, 0 none>";
+
+cmdline_parse_inst_t policer_link_cmd_ctx = {
+	.f = cli_policer_link,
+	.data = NULL,
+	.help_str = cmd_policer_link_help,
+	.tokens = {
+		(void *)&policer_cmd,
+		(void *)&policer_action_link,
+		(void *)&policer_dev,
+		(void *)&policer_id,
+		NULL,
+	},
+};
+
+static char const
+cmd_policer_show_help[] = "policer show";
+
+cmdline_parse_inst_t policer_show_cmd_ctx = {
+	.f = cli_policer_show,
+	.data = NULL,
+	.help_str = cmd_policer_show_help,
+	.tokens = {
+		(void *)&policer_cmd,
+		(void *)&policer_action_show,
+		NULL,
+	},
+};
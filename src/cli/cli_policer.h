@@ -0,0 +1,41 @@
+/*
+  SPDX-License-Identifier: MIT
+  Copyright(c) 2023 Sriram Yagnaraman.
+*/
+
+#ifndef __VSWITCH_SRC_CLI_POLICER_H_
+#define __VSWITCH_SRC_CLI_POLICER_H_
+
+#include <cmdline.h>
+#include <cmdline_parse.h>
+#include <cmdline_parse_string.h>
+
+struct policer_cmd_tokens {
+	cmdline_fixed_string_t policer;
+	cmdline_fixed_string_t action;
+	cmdline_fixed_string_t type;
+	cmdline_fixed_string_t cir;
+	cmdline_fixed_string_t cbs;
+	cmdline_fixed_string_t pir;
+	cmdline_fixed_string_t pbs;
+	cmdline_fixed_string_t color;
+	cmdline_fixed_string_t color_name;
+	cmdline_fixed_string_t verdict;
+	cmdline_fixed_string_t dev;
+	uint32_t policer_id;
+	uint64_t cir_val;
+	uint64_t cbs_val;
+	uint64_t pir_val;
+	uint64_t pbs_val;
+	uint8_t dscp;
+};
+
+extern cmdline_parse_inst_t policer_srtcm_add_cmd_ctx;
+extern cmdline_parse_inst_t policer_trtcm_add_cmd_ctx;
+extern cmdline_parse_inst_t policer_rem_cmd_ctx;
+extern cmdline_parse_inst_t policer_color_cmd_ctx;
+extern cmdline_parse_inst_t policer_remark_cmd_ctx;
+extern cmdline_parse_inst_t policer_link_cmd_ctx;
+extern cmdline_parse_inst_t policer_show_cmd_ctx;
+
+#endif /* __VSWITCH_SRC_CLI_POLICER_H_*/
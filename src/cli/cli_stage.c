@@ -16,6 +16,7 @@
 #include "cli.h"
 #include "cli_stage.h"
 #include "stage.h"
+#include "node/flow_hash.h"
 
 static void
 cli_stage_add(void *parsed_result, struct cmdline *cl, __rte_unused void *data)
@@ -30,6 +31,7 @@ cli_stage_add(void *parsed_result, struct cmdline *cl, __rte_unused void *data)
 	config.name[strlen(res->name)] = '\0';
 	config.coremask = res->mask;
 	config.type = STAGE_TYPE_MAX;
+	config.ev_id = STAGE_EV_ID_ANY;
 
 	rc = stage_config_add(&config);
 	if (rc < 0) {
@@ -68,9 +70,9 @@ cli_stage_show(void *parsed_result, struct cmdline *cl, __rte_unused void *data)
                 cmdline_printf(cl, "stage show %s failed: %s\n", stage_name, rte_strerror(-rc));
         } else {
                 cmdline_printf(cl,
-                        "%s: stage_id=%d coremask:0x%04x\n",
+                        "%s: stage_id=%d coremask:0x%04x eventdev %d\n",
                         stage->config.name, stage->config.stage_id,
-			stage->config.coremask);
+			stage->config.coremask, stage->config.ev_id);
         }
 }
 
@@ -91,6 +93,8 @@ cli_stage_set_type(void *parsed_result, struct cmdline *cl, __rte_unused void *d
 		stage_type = STAGE_TYPE_WORKER;
 	else if (strcmp(res->stage_type, "tx") == 0)
 		stage_type = STAGE_TYPE_TX;
+	else if (strcmp(res->stage_type, "rtc") == 0)
+		stage_type = STAGE_TYPE_RTC;
 
 	rc = stage_config_set_type(stage_name, stage_type);
 	if (rc < 0) {
@@ -99,6 +103,22 @@ cli_stage_set_type(void *parsed_result, struct cmdline *cl, __rte_unused void *d
 	}
 }
 
+static void
+cli_stage_set_eventdev(void *parsed_result, struct cmdline *cl, __rte_unused void *data)
+{
+	struct stage_cmd_tokens *res = parsed_result;
+        char stage_name[STAGE_NAME_MAX_LEN];
+	int rc = -ENOENT;
+
+	rte_strscpy(stage_name, res->name, STAGE_NAME_MAX_LEN);
+	stage_name[strlen(res->name)] = '\0';
+
+        rc = stage_config_set_eventdev(stage_name, res->ev_id);
+        if (rc < 0)
+                cmdline_printf(cl, "stage set %s eventdev failed: %s\n",
+			       stage_name, rte_strerror(-rc));
+}
+
 static void
 cli_stage_set_queue_in(void *parsed_result, struct cmdline *cl, __rte_unused void *data)
 {
@@ -113,8 +133,7 @@ cli_stage_set_queue_in(void *parsed_result, struct cmdline *cl, __rte_unused voi
 					  res->in_qid,
 					  (strcmp(res->schedule_type, "atomic") == 0) ?
 						RTE_SCHED_TYPE_ATOMIC :
-					  	RTE_SCHED_TYPE_ORDERED,
-					  res->mp_name);
+					  	RTE_SCHED_TYPE_ORDERED);
         if (rc < 0)
                 cmdline_printf(cl, "stage set %s input event queue failed: %s\n",
 			       stage_name, rte_strerror(-rc));
@@ -194,6 +213,98 @@ cli_stage_set_graph_nodes(void *parsed_result, struct cmdline *cl, __rte_unused
 			       stage_name, rte_strerror(-rc));
 }
 
+static void
+cli_stage_set_flow_hash(void *parsed_result, struct cmdline *cl, __rte_unused void *data)
+{
+	struct stage_cmd_tokens *res = parsed_result;
+        char stage_name[STAGE_NAME_MAX_LEN];
+	uint8_t flow_hash = FLOW_HASH_MAX;
+	int rc = -ENOENT;
+
+	rte_strscpy(stage_name, res->name, STAGE_NAME_MAX_LEN);
+	stage_name[strlen(res->name)] = '\0';
+
+	if (strcmp(res->hash_type, "l3l4") == 0)
+		flow_hash = FLOW_HASH_L3L4;
+	else if (strcmp(res->hash_type, "l3") == 0)
+		flow_hash = FLOW_HASH_L3;
+	else if (strcmp(res->hash_type, "l2") == 0)
+		flow_hash = FLOW_HASH_L2;
+	else if (strcmp(res->hash_type, "none") == 0)
+		flow_hash = FLOW_HASH_NONE;
+
+        rc = stage_config_set_flow_hash(stage_name, flow_hash);
+        if (rc < 0)
+                cmdline_printf(cl, "stage set %s hash %s failed: %s\n",
+			       stage_name, res->hash_type, rte_strerror(-rc));
+}
+
+static void
+cli_stage_set_adapter(void *parsed_result, struct cmdline *cl, __rte_unused void *data)
+{
+	struct stage_cmd_tokens *res = parsed_result;
+        char stage_name[STAGE_NAME_MAX_LEN];
+	int rc = -ENOENT;
+
+	rte_strscpy(stage_name, res->name, STAGE_NAME_MAX_LEN);
+	stage_name[strlen(res->name)] = '\0';
+
+        rc = stage_config_set_adapter(stage_name, strcmp(res->enable, "on") == 0);
+        if (rc < 0)
+                cmdline_printf(cl, "stage set %s adapter %s failed: %s\n",
+			       stage_name, res->enable, rte_strerror(-rc));
+}
+
+static void
+cli_stage_set_vector(void *parsed_result, struct cmdline *cl, __rte_unused void *data)
+{
+	struct stage_cmd_tokens *res = parsed_result;
+        char stage_name[STAGE_NAME_MAX_LEN];
+	int rc = -ENOENT;
+
+	rte_strscpy(stage_name, res->name, STAGE_NAME_MAX_LEN);
+	stage_name[strlen(res->name)] = '\0';
+
+        rc = stage_config_set_vector(stage_name, res->vector_size,
+				     res->vector_timeout, res->mp_name);
+        if (rc < 0)
+                cmdline_printf(cl, "stage set %s vector failed: %s\n",
+			       stage_name, rte_strerror(-rc));
+}
+
+static void
+cli_stage_set_flow_cache(void *parsed_result, struct cmdline *cl, __rte_unused void *data)
+{
+	struct stage_cmd_tokens *res = parsed_result;
+        char stage_name[STAGE_NAME_MAX_LEN];
+	int rc = -ENOENT;
+
+	rte_strscpy(stage_name, res->name, STAGE_NAME_MAX_LEN);
+	stage_name[strlen(res->name)] = '\0';
+
+        rc = stage_config_set_flow_cache(stage_name, res->cache_entries);
+        if (rc < 0)
+                cmdline_printf(cl, "stage set %s cache failed: %s\n",
+			       stage_name, rte_strerror(-rc));
+}
+
+static void
+cli_stage_set_conntrack(void *parsed_result, struct cmdline *cl, __rte_unused void *data)
+{
+	struct stage_cmd_tokens *res = parsed_result;
+        char stage_name[STAGE_NAME_MAX_LEN];
+	int rc = -ENOENT;
+
+	rte_strscpy(stage_name, res->name, STAGE_NAME_MAX_LEN);
+	stage_name[strlen(res->name)] = '\0';
+
+        rc = stage_config_set_conntrack(stage_name, res->conntrack_entries,
+					strcmp(res->strict, "strict") == 0);
+        if (rc < 0)
+                cmdline_printf(cl, "stage set %s conntrack failed: %s\n",
+			       stage_name, rte_strerror(-rc));
+}
+
 cmdline_parse_token_string_t stage_cmd =
 	TOKEN_STRING_INITIALIZER(struct stage_cmd_tokens, stage, "stage");
 cmdline_parse_token_string_t stage_add =
@@ -213,7 +324,11 @@ cmdline_parse_token_num_t stage_mask =
 cmdline_parse_token_string_t stage_type =
 	TOKEN_STRING_INITIALIZER(struct stage_cmd_tokens, type, "type");
 cmdline_parse_token_string_t stage_stage_type =
-	TOKEN_STRING_INITIALIZER(struct stage_cmd_tokens, stage_type, "rx#worker#tx");
+	TOKEN_STRING_INITIALIZER(struct stage_cmd_tokens, stage_type, "rx#worker#tx#rtc");
+cmdline_parse_token_string_t stage_eventdev =
+	TOKEN_STRING_INITIALIZER(struct stage_cmd_tokens, eventdev, "eventdev");
+cmdline_parse_token_num_t stage_ev_id =
+	TOKEN_NUM_INITIALIZER(struct stage_cmd_tokens, ev_id, RTE_INT16);
 cmdline_parse_token_string_t stage_queue =
 	TOKEN_STRING_INITIALIZER(struct stage_cmd_tokens, stage_queue, "queue");
 cmdline_parse_token_string_t stage_in_queue =
@@ -228,10 +343,6 @@ cmdline_parse_token_string_t stage_schedule =
 	TOKEN_STRING_INITIALIZER(struct stage_cmd_tokens, schedule, "schedule");
 cmdline_parse_token_string_t stage_schedule_type =
 	TOKEN_STRING_INITIALIZER(struct stage_cmd_tokens, schedule_type, "atomic#ordered");
-cmdline_parse_token_string_t stage_mempool =
-	TOKEN_STRING_INITIALIZER(struct stage_cmd_tokens, mempool, "mempool");
-cmdline_parse_token_string_t stage_mp_name =
-	TOKEN_STRING_INITIALIZER(struct stage_cmd_tokens, mp_name, NULL);
 cmdline_parse_token_string_t stage_link =
 	TOKEN_STRING_INITIALIZER(struct stage_cmd_tokens, link, "link");
 cmdline_parse_token_string_t stage_dev =
@@ -240,6 +351,38 @@ cmdline_parse_token_string_t stage_graph =
 	TOKEN_STRING_INITIALIZER(struct stage_cmd_tokens, graph, "graph");
 cmdline_parse_token_string_t stage_nodes =
 	TOKEN_STRING_INITIALIZER(struct stage_cmd_tokens, nodes, NULL);
+cmdline_parse_token_string_t stage_hash =
+	TOKEN_STRING_INITIALIZER(struct stage_cmd_tokens, hash, "hash");
+cmdline_parse_token_string_t stage_hash_type =
+	TOKEN_STRING_INITIALIZER(struct stage_cmd_tokens, hash_type, "l3l4#l3#l2#none");
+cmdline_parse_token_string_t stage_adapter =
+	TOKEN_STRING_INITIALIZER(struct stage_cmd_tokens, adapter, "adapter");
+cmdline_parse_token_string_t stage_enable =
+	TOKEN_STRING_INITIALIZER(struct stage_cmd_tokens, enable, "on#off");
+cmdline_parse_token_string_t stage_vector =
+	TOKEN_STRING_INITIALIZER(struct stage_cmd_tokens, vector, "vector");
+cmdline_parse_token_string_t stage_vector_size =
+	TOKEN_STRING_INITIALIZER(struct stage_cmd_tokens, size, "size");
+cmdline_parse_token_num_t stage_vector_nb_elem =
+	TOKEN_NUM_INITIALIZER(struct stage_cmd_tokens, vector_size, RTE_UINT16);
+cmdline_parse_token_string_t stage_vector_timeout =
+	TOKEN_STRING_INITIALIZER(struct stage_cmd_tokens, timeout, "timeout");
+cmdline_parse_token_num_t stage_vector_timeout_ns =
+	TOKEN_NUM_INITIALIZER(struct stage_cmd_tokens, vector_timeout, RTE_UINT64);
+cmdline_parse_token_string_t stage_vector_mempool =
+	TOKEN_STRING_INITIALIZER(struct stage_cmd_tokens, mempool, "mempool");
+cmdline_parse_token_string_t stage_vector_mp_name =
+	TOKEN_STRING_INITIALIZER(struct stage_cmd_tokens, mp_name, NULL);
+cmdline_parse_token_string_t stage_cache =
+	TOKEN_STRING_INITIALIZER(struct stage_cmd_tokens, cache, "cache");
+cmdline_parse_token_num_t stage_cache_entries =
+	TOKEN_NUM_INITIALIZER(struct stage_cmd_tokens, cache_entries, RTE_UINT32);
+cmdline_parse_token_string_t stage_conntrack =
+	TOKEN_STRING_INITIALIZER(struct stage_cmd_tokens, conntrack, "conntrack");
+cmdline_parse_token_num_t stage_conntrack_entries =
+	TOKEN_NUM_INITIALIZER(struct stage_cmd_tokens, conntrack_entries, RTE_UINT32);
+cmdline_parse_token_string_t stage_conntrack_strict =
+	TOKEN_STRING_INITIALIZER(struct stage_cmd_tokens, strict, "strict#loose");
 
 static char const
 cmd_stage_add_help[] = "stage add <stage_name> [coremask <mask>]";
@@ -289,7 +432,7 @@ cmdline_parse_inst_t stage_show_cmd_ctx = {
 };
 
 static char const
-cmd_stage_set_type_help[] = "stage set <stage_name> type rx#worker#tx";
+cmd_stage_set_type_help[] = "stage set <stage_name> type rx#worker#tx#rtc";
 
 cmdline_parse_inst_t stage_set_type_cmd_ctx = {
 	.f = cli_stage_set_type,
@@ -306,7 +449,24 @@ cmdline_parse_inst_t stage_set_type_cmd_ctx = {
 };
 
 static char const
-cmd_stage_set_queue_in_help[] = "stage set <stage_name> queue in <qid> schedule <atomic#ordered> mempool <mp_name>";
+cmd_stage_set_eventdev_help[] = "stage set <stage_name> eventdev <ev_id|-1>";
+
+cmdline_parse_inst_t stage_set_eventdev_cmd_ctx = {
+	.f = cli_stage_set_eventdev,
+	.data = NULL,
+	.help_str = cmd_stage_set_eventdev_help,
+	.tokens = {
+		(void *)&stage_cmd,
+                (void *)&stage_set,
+		(void *)&stage_name,
+		(void *)&stage_eventdev,
+		(void *)&stage_ev_id,
+		NULL,
+	},
+};
+
+static char const
+cmd_stage_set_queue_in_help[] = "stage set <stage_name> queue in <qid> schedule <atomic#ordered>";
 
 cmdline_parse_inst_t stage_set_queue_in_cmd_ctx = {
 	.f = cli_stage_set_queue_in,
@@ -321,8 +481,6 @@ cmdline_parse_inst_t stage_set_queue_in_cmd_ctx = {
 		(void *)&stage_in_qid,
 		(void *)&stage_schedule,
 		(void *)&stage_schedule_type,
-		(void *)&stage_mempool,
-		(void *)&stage_mp_name,
 		NULL,
 	},
 };
@@ -403,3 +561,94 @@ cmdline_parse_inst_t stage_set_graph_nodes_cmd_ctx = {
 		NULL,
 	},
 };
+
+static char const
+cmd_stage_set_flow_hash_help[] = "stage set <stage_name> hash l3l4#l3#l2#none";
+
+cmdline_parse_inst_t stage_set_flow_hash_cmd_ctx = {
+	.f = cli_stage_set_flow_hash,
+	.data = NULL,
+	.help_str = cmd_stage_set_flow_hash_help,
+	.tokens = {
+		(void *)&stage_cmd,
+                (void *)&stage_set,
+		(void *)&stage_name,
+		(void *)&stage_hash,
+		(void *)&stage_hash_type,
+		NULL,
+	},
+};
+
+static char const
+cmd_stage_set_adapter_help[] = "stage set <stage_name> adapter on#off";
+
+cmdline_parse_inst_t stage_set_adapter_cmd_ctx = {
+	.f = cli_stage_set_adapter,
+	.data = NULL,
+	.help_str = cmd_stage_set_adapter_help,
+	.tokens = {
+		(void *)&stage_cmd,
+                (void *)&stage_set,
+		(void *)&stage_name,
+		(void *)&stage_adapter,
+		(void *)&stage_enable,
+		NULL,
+	},
+};
+
+static char const
+cmd_stage_set_vector_help[] = "stage set <stage_name> vector size <nb_elem> timeout <ns> mempool <mp_name>";
+
+cmdline_parse_inst_t stage_set_vector_cmd_ctx = {
+	.f = cli_stage_set_vector,
+	.data = NULL,
+	.help_str = cmd_stage_set_vector_help,
+	.tokens = {
+		(void *)&stage_cmd,
+                (void *)&stage_set,
+		(void *)&stage_name,
+		(void *)&stage_vector,
+		(void *)&stage_vector_size,
+		(void *)&stage_vector_nb_elem,
+		(void *)&stage_vector_timeout,
+		(void *)&stage_vector_timeout_ns,
+		(void *)&stage_vector_mempool,
+		(void *)&stage_vector_mp_name,
+		NULL,
+	},
+};
+
+static char const
+cmd_stage_set_flow_cache_help[] = "stage set <stage_name> cache <entries, 0 disables>";
+
+cmdline_parse_inst_t stage_set_flow_cache_cmd_ctx = {
+	.f = cli_stage_set_flow_cache,
+	.data = NULL,
+	.help_str = cmd_stage_set_flow_cache_help,
+	.tokens = {
+		(void *)&stage_cmd,
+                (void *)&stage_set,
+		(void *)&stage_name,
+		(void *)&stage_cache,
+		(void *)&stage_cache_entries,
+		NULL,
+	},
+};
+
+static char const
+cmd_stage_set_conntrack_help[] = "stage set <stage_name> conntrack <entries, 0 disables> strict#loose";
+
+cmdline_parse_inst_t stage_set_conntrack_cmd_ctx = {
+	.f = cli_stage_set_conntrack,
+	.data = NULL,
+	.help_str = cmd_stage_set_conntrack_help,
+	.tokens = {
+		(void *)&stage_cmd,
+                (void *)&stage_set,
+		(void *)&stage_name,
+		(void *)&stage_conntrack,
+		(void *)&stage_conntrack_entries,
+		(void *)&stage_conntrack_strict,
+		NULL,
+	},
+};
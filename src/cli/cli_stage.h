@@ -17,20 +17,36 @@ struct stage_cmd_tokens {
 	cmdline_fixed_string_t coremask;
 	cmdline_fixed_string_t type;
 	cmdline_fixed_string_t stage_type;
+	cmdline_fixed_string_t eventdev;
 	cmdline_fixed_string_t stage_queue;
 	cmdline_fixed_string_t in_queue;
 	cmdline_fixed_string_t out_queue;
 	cmdline_fixed_string_t schedule;
 	cmdline_fixed_string_t schedule_type;
-	cmdline_fixed_string_t mempool;
-	cmdline_fixed_string_t mp_name;
 	cmdline_fixed_string_t link;
 	cmdline_fixed_string_t dev;
 	cmdline_fixed_string_t graph;
 	cmdline_fixed_string_t nodes;
+	cmdline_fixed_string_t hash;
+	cmdline_fixed_string_t hash_type;
+	cmdline_fixed_string_t adapter;
+	cmdline_fixed_string_t enable;
+	cmdline_fixed_string_t vector;
+	cmdline_fixed_string_t size;
+	cmdline_fixed_string_t timeout;
+	cmdline_fixed_string_t mempool;
+	cmdline_fixed_string_t mp_name;
+	cmdline_fixed_string_t cache;
+	cmdline_fixed_string_t conntrack;
+	cmdline_fixed_string_t strict;
 	uint32_t mask;
+	int16_t ev_id;
 	uint8_t in_qid;
 	uint8_t out_qid;
+	uint16_t vector_size;
+	uint64_t vector_timeout;
+	uint32_t cache_entries;
+	uint32_t conntrack_entries;
 };
 
 extern cmdline_parse_inst_t stage_add_cmd_ctx;
@@ -38,10 +54,16 @@ extern cmdline_parse_inst_t stage_rem_cmd_ctx;
 extern cmdline_parse_inst_t stage_show_cmd_ctx;
 
 extern cmdline_parse_inst_t stage_set_type_cmd_ctx;
+extern cmdline_parse_inst_t stage_set_eventdev_cmd_ctx;
 extern cmdline_parse_inst_t stage_set_queue_in_cmd_ctx;
 extern cmdline_parse_inst_t stage_set_queue_out_cmd_ctx;
 extern cmdline_parse_inst_t stage_set_link_queue_in_cmd_ctx;
 extern cmdline_parse_inst_t stage_set_link_queue_out_cmd_ctx;
 extern cmdline_parse_inst_t stage_set_graph_nodes_cmd_ctx;
+extern cmdline_parse_inst_t stage_set_flow_hash_cmd_ctx;
+extern cmdline_parse_inst_t stage_set_adapter_cmd_ctx;
+extern cmdline_parse_inst_t stage_set_vector_cmd_ctx;
+extern cmdline_parse_inst_t stage_set_flow_cache_cmd_ctx;
+extern cmdline_parse_inst_t stage_set_conntrack_cmd_ctx;
 
 #endif /* __VSWITCH_SRC_CLI_STAGE_H_*/
\ No newline at end of file
@@ -0,0 +1,270 @@
+/*
+  SPDX-License-Identifier: MIT
+  Copyright(c) 2023 Sriram Yagnaraman.
+*/
+
+#include <arpa/inet.h>
+
+#include <rte_eal.h>
+#include <rte_ethdev.h>
+#include <rte_malloc.h>
+
+#include <cmdline.h>
+#include <cmdline_parse.h>
+#include <cmdline_parse_string.h>
+#include <cmdline_parse_num.h>
+
+#include "cli.h"
+#include "cli_tunnel.h"
+#include "tunnel.h"
+
+static char const * const tunnel_type_names[] = {
+	[VTEP_TYPE_VXLAN] = "vxlan",
+	[VTEP_TYPE_GENEVE] = "geneve",
+};
+
+/* Both ends must be of the same address family */
+static int
+cli_tunnel_parse_addr(char const *local, char const *remote, struct vtep_config *vtep)
+{
+	if (inet_pton(AF_INET, local, &vtep->local.ip4) == 1 &&
+	    inet_pton(AF_INET, remote, &vtep->remote.ip4) == 1) {
+		vtep->ipv6 = 0;
+		return 0;
+	}
+
+	if (inet_pton(AF_INET6, local, vtep->local.ip6) == 1 &&
+	    inet_pton(AF_INET6, remote, vtep->remote.ip6) == 1) {
+		vtep->ipv6 = 1;
+		return 0;
+	}
+
+	return -EINVAL;
+}
+
+static void
+cli_tunnel_add(void *parsed_result, struct cmdline *cl, __rte_unused void *data)
+{
+	struct tunnel_cmd_tokens *res = parsed_result;
+	struct tunnel_config config;
+	int rc;
+
+	memset(&config, 0, sizeof(config));
+
+	rte_strscpy(config.name, res->name, TUNNEL_NAME_MAX_LEN);
+	config.name[strlen(res->name)] = '\0';
+	config.vtep.type = strcmp(res->type, "vxlan") == 0 ?
+		VTEP_TYPE_VXLAN : VTEP_TYPE_GENEVE;
+	config.vtep.vni = res->vni_id;
+
+	rc = cli_tunnel_parse_addr(res->local_ip, res->remote_ip, &config.vtep);
+	if (rc < 0)
+		goto err;
+
+	rc = tunnel_config_add(&config);
+	if (rc < 0)
+		goto err;
+
+	return;
+
+err:
+	cmdline_printf(cl, "tunnel add %s failed: %s\n", config.name, rte_strerror(-rc));
+}
+
+static void
+cli_tunnel_show(struct cmdline *cl, struct tunnel *t)
+{
+	struct tunnel_config *config = &t->config;
+	char local[INET6_ADDRSTRLEN], remote[INET6_ADDRSTRLEN];
+	int af = config->vtep.ipv6 ? AF_INET6 : AF_INET;
+
+	inet_ntop(af, &config->vtep.local, local, sizeof(local));
+	inet_ntop(af, &config->vtep.remote, remote, sizeof(remote));
+
+	cmdline_printf(cl, "%s: tunnel_id=%u %s vni %u local %s remote %s\n"
+		       "\t link %s nexthop " RTE_ETHER_ADDR_PRT_FMT "\n"
+		       "\t overlay %s\n",
+		       config->name, config->tunnel_id,
+		       tunnel_type_names[config->vtep.type], config->vtep.vni,
+		       local, remote,
+		       config->link_name, RTE_ETHER_ADDR_BYTES(&config->vtep.dst_mac),
+		       config->overlay_link_name);
+}
+
+static void
+cli_tunnel_rem_show(void *parsed_result, struct cmdline *cl, __rte_unused void *data)
+{
+	struct tunnel_cmd_tokens *res = parsed_result;
+	char tunnel_name[TUNNEL_NAME_MAX_LEN];
+	struct tunnel *t;
+	int rc = -ENOENT;
+
+	rte_strscpy(tunnel_name, res->name, TUNNEL_NAME_MAX_LEN);
+	tunnel_name[strlen(res->name)] = '\0';
+
+	t = tunnel_config_get(tunnel_name);
+	if (!t)
+		goto err;
+
+	if (strcmp(res->action, "rem") == 0) {
+		rc = tunnel_config_rem(tunnel_name);
+		if (rc < 0)
+			goto err;
+	} else {
+		cli_tunnel_show(cl, t);
+	}
+
+	return;
+
+err:
+	cmdline_printf(cl, "tunnel %s %s failed: %s\n", res->action, tunnel_name, rte_strerror(-rc));
+}
+
+static void
+cli_tunnel_set_link(void *parsed_result, struct cmdline *cl, __rte_unused void *data)
+{
+	struct tunnel_cmd_tokens *res = parsed_result;
+	char tunnel_name[TUNNEL_NAME_MAX_LEN];
+	struct rte_ether_addr nexthop;
+	int rc = -EINVAL;
+
+	rte_strscpy(tunnel_name, res->name, TUNNEL_NAME_MAX_LEN);
+	tunnel_name[strlen(res->name)] = '\0';
+
+	if (rte_ether_unformat_addr(res->mac, &nexthop) < 0)
+		goto err;
+
+	rc = tunnel_config_set_link(tunnel_name, res->dev, &nexthop);
+	if (rc < 0)
+		goto err;
+
+	return;
+
+err:
+	cmdline_printf(cl, "tunnel set %s link %s failed: %s\n",
+		       tunnel_name, res->dev, rte_strerror(-rc));
+}
+
+static void
+cli_tunnel_set_overlay(void *parsed_result, struct cmdline *cl, __rte_unused void *data)
+{
+	struct tunnel_cmd_tokens *res = parsed_result;
+	char tunnel_name[TUNNEL_NAME_MAX_LEN];
+	int rc;
+
+	rte_strscpy(tunnel_name, res->name, TUNNEL_NAME_MAX_LEN);
+	tunnel_name[strlen(res->name)] = '\0';
+
+	rc = tunnel_config_set_overlay(tunnel_name, res->dev);
+	if (rc < 0)
+		cmdline_printf(cl, "tunnel set %s overlay %s failed: %s\n",
+			       tunnel_name, res->dev, rte_strerror(-rc));
+}
+
+cmdline_parse_token_string_t tunnel_cmd =
+	TOKEN_STRING_INITIALIZER(struct tunnel_cmd_tokens, tunnel, "tunnel");
+cmdline_parse_token_string_t tunnel_action_add =
+	TOKEN_STRING_INITIALIZER(struct tunnel_cmd_tokens, action, "add");
+cmdline_parse_token_string_t tunnel_action_rem_show =
+	TOKEN_STRING_INITIALIZER(struct tunnel_cmd_tokens, action, "rem#show");
+cmdline_parse_token_string_t tunnel_action_set =
+	TOKEN_STRING_INITIALIZER(struct tunnel_cmd_tokens, action, "set");
+cmdline_parse_token_string_t tunnel_name =
+	TOKEN_STRING_INITIALIZER(struct tunnel_cmd_tokens, name, NULL);
+cmdline_parse_token_string_t tunnel_type =
+	TOKEN_STRING_INITIALIZER(struct tunnel_cmd_tokens, type, "vxlan#geneve");
+cmdline_parse_token_string_t tunnel_vni =
+	TOKEN_STRING_INITIALIZER(struct tunnel_cmd_tokens, vni, "vni");
+cmdline_parse_token_num_t tunnel_vni_id =
+	TOKEN_NUM_INITIALIZER(struct tunnel_cmd_tokens, vni_id, RTE_UINT32);
+cmdline_parse_token_string_t tunnel_local =
+	TOKEN_STRING_INITIALIZER(struct tunnel_cmd_tokens, local, "local");
+cmdline_parse_token_string_t tunnel_local_ip =
+	TOKEN_STRING_INITIALIZER(struct tunnel_cmd_tokens, local_ip, NULL);
+cmdline_parse_token_string_t tunnel_remote =
+	TOKEN_STRING_INITIALIZER(struct tunnel_cmd_tokens, remote, "remote");
+cmdline_parse_token_string_t tunnel_remote_ip =
+	TOKEN_STRING_INITIALIZER(struct tunnel_cmd_tokens, remote_ip, NULL);
+cmdline_parse_token_string_t tunnel_link =
+	TOKEN_STRING_INITIALIZER(struct tunnel_cmd_tokens, link, "link");
+cmdline_parse_token_string_t tunnel_dev =
+	TOKEN_STRING_INITIALIZER(struct tunnel_cmd_tokens, dev, NULL);
+cmdline_parse_token_string_t tunnel_nexthop =
+	TOKEN_STRING_INITIALIZER(struct tunnel_cmd_tokens, nexthop, "nexthop");
+cmdline_parse_token_string_t tunnel_mac =
+	TOKEN_STRING_INITIALIZER(struct tunnel_cmd_tokens, mac, NULL);
+cmdline_parse_token_string_t tunnel_overlay =
+	TOKEN_STRING_INITIALIZER(struct tunnel_cmd_tokens, overlay, "overlay");
+
+static char const
+cmd_tunnel_add_help[] = "tunnel add <tunnel_name> vxlan#geneve vni <vni> local <ip> remote <ip>";
+
+cmdline_parse_inst_t tunnel_add_cmd_ctx = {
+	.f = cli_tunnel_add,
+	.data = NULL,
+	.help_str = cmd_tunnel_add_help,
+	.tokens = {
+		(void *)&tunnel_cmd,
+		(void *)&tunnel_action_add,
+		(void *)&tunnel_name,
+		(void *)&tunnel_type,
+		(void *)&tunnel_vni,
+		(void *)&tunnel_vni_id,
+		(void *)&tunnel_local,
+		(void *)&tunnel_local_ip,
+		(void *)&tunnel_remote,
+		(void *)&tunnel_remote_ip,
+		NULL,
+	},
+};
+
+static char const
+cmd_tunnel_rem_show_help[] = "tunnel rem#show <tunnel_name>";
+
+cmdline_parse_inst_t tunnel_rem_show_cmd_ctx = {
+	.f = cli_tunnel_rem_show,
+	.data = NULL,
+	.help_str = cmd_tunnel_rem_show_help,
+	.tokens = {
+		(void *)&tunnel_cmd,
+		(void *)&tunnel_action_rem_show,
+		(void *)&tunnel_name,
+		NULL,
+	},
+};
+
+static char const
+cmd_tunnel_set_link_help[] = "tunnel set <tunnel_name> link <dev> nexthop <mac>";
+
+cmdline_parse_inst_t tunnel_set_link_cmd_ctx = {
+	.f = cli_tunnel_set_link,
+	.data = NULL,
+	.help_str = cmd_tunnel_set_link_help,
+	.tokens = {
+		(void *)&tunnel_cmd,
+		(void *)&tunnel_action_set,
+		(void *)&tunnel_name,
+		(void *)&tunnel_link,
+		(void *)&tunnel_dev,
+		(void *)&tunnel_nexthop,
+		(void *)&tunnel_mac,
+		NULL,
+	},
+};
+
+static char const
+cmd_tunnel_set_overlay_help[] = "tunnel set <tunnel_name> overlay <dev>";
+
+cmdline_parse_inst_t tunnel_set_overlay_cmd_ctx = {
+	.f = cli_tunnel_set_overlay,
+	.data = NULL,
+	.help_str = cmd_tunnel_set_overlay_help,
+	.tokens = {
+		(void *)&tunnel_cmd,
+		(void *)&tunnel_action_set,
+		(void *)&tunnel_name,
+		(void *)&tunnel_overlay,
+		(void *)&tunnel_dev,
+		NULL,
+	},
+};
@@ -0,0 +1,36 @@
+/*
+  SPDX-License-Identifier: MIT
+  Copyright(c) 2023 Sriram Yagnaraman.
+*/
+
+#ifndef __VSWITCH_SRC_CLI_TUNNEL_H_
+#define __VSWITCH_SRC_CLI_TUNNEL_H_
+
+#include <cmdline.h>
+#include <cmdline_parse.h>
+#include <cmdline_parse_string.h>
+
+struct tunnel_cmd_tokens {
+	cmdline_fixed_string_t tunnel;
+	cmdline_fixed_string_t action;
+	cmdline_fixed_string_t name;
+	cmdline_fixed_string_t type;
+	cmdline_fixed_string_t vni;
+	cmdline_fixed_string_t local;
+	cmdline_fixed_string_t local_ip;
+	cmdline_fixed_string_t remote;
+	cmdline_fixed_string_t remote_ip;
+	cmdline_fixed_string_t link;
+	cmdline_fixed_string_t dev;
+	cmdline_fixed_string_t nexthop;
+	cmdline_fixed_string_t mac;
+	cmdline_fixed_string_t overlay;
+	uint32_t vni_id;
+};
+
+extern cmdline_parse_inst_t tunnel_add_cmd_ctx;
+extern cmdline_parse_inst_t tunnel_rem_show_cmd_ctx;
+extern cmdline_parse_inst_t tunnel_set_link_cmd_ctx;
+extern cmdline_parse_inst_t tunnel_set_overlay_cmd_ctx;
+
+#endif /* __VSWITCH_SRC_CLI_TUNNEL_H_*/
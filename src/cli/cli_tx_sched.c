@@ -0,0 +1,256 @@
+/*
+  SPDX-License-Identifier: MIT
+  Copyright(c) 2023 Sriram Yagnaraman.
+*/
+
+#include <inttypes.h>
+#include <stdlib.h>
+
+#include <rte_eal.h>
+#include <rte_ethdev.h>
+#include <rte_malloc.h>
+
+#include <cmdline.h>
+#include <cmdline_parse.h>
+#include <cmdline_parse_string.h>
+#include <cmdline_parse_num.h>
+
+#include "cli.h"
+#include "cli_tx_sched.h"
+#include "tx_sched.h"
+
+static void
+cli_tx_sched_link(void *parsed_result, struct cmdline *cl, __rte_unused void *data)
+{
+	struct tx_sched_cmd_tokens *res = parsed_result;
+	int rc;
+
+	rc = tx_sched_config_set_link(res->dev, res->rate_val, res->nb_pipes);
+	if (rc < 0)
+		cmdline_printf(cl, "sched link %s failed: %s\n", res->dev, rte_strerror(-rc));
+}
+
+static void
+cli_tx_sched_rem(void *parsed_result, struct cmdline *cl, __rte_unused void *data)
+{
+	struct tx_sched_cmd_tokens *res = parsed_result;
+	int rc;
+
+	rc = tx_sched_config_rem_link(res->dev);
+	if (rc < 0)
+		cmdline_printf(cl, "sched link %s rem failed: %s\n", res->dev, rte_strerror(-rc));
+}
+
+static void
+cli_tx_sched_profile(void *parsed_result, struct cmdline *cl, __rte_unused void *data)
+{
+	struct tx_sched_cmd_tokens *res = parsed_result;
+	int rc;
+
+	rc = tx_sched_config_set_profile(res->dev, res->profile_id, res->rate_val,
+					 res->size_val);
+	if (rc < 0)
+		cmdline_printf(cl, "sched link %s profile %u failed: %s\n",
+			       res->dev, res->profile_id, rte_strerror(-rc));
+}
+
+static void
+cli_tx_sched_pipe(void *parsed_result, struct cmdline *cl, __rte_unused void *data)
+{
+	struct tx_sched_cmd_tokens *res = parsed_result;
+	int rc;
+
+	rc = tx_sched_config_set_pipe(res->dev, res->pipe_id, res->profile_id);
+	if (rc < 0)
+		cmdline_printf(cl, "sched link %s pipe %u failed: %s\n",
+			       res->dev, res->pipe_id, rte_strerror(-rc));
+}
+
+static void
+cli_tx_sched_vlan(void *parsed_result, struct cmdline *cl, __rte_unused void *data)
+{
+	struct tx_sched_cmd_tokens *res = parsed_result;
+	int rc;
+
+	rc = tx_sched_config_set_vlan(res->dev, res->vid, res->pipe_id);
+	if (rc < 0)
+		cmdline_printf(cl, "sched link %s vlan %u failed: %s\n",
+			       res->dev, res->vid, rte_strerror(-rc));
+}
+
+static int
+cli_tx_sched_show_one(uint16_t link_id, struct tx_sched_link_config *config, void *data)
+{
+	char name[RTE_ETH_NAME_MAX_LEN];
+	struct cmdline *cl = data;
+	uint32_t i;
+
+	if (rte_eth_dev_get_name_by_port(link_id, name) < 0)
+		return 0;
+
+	cmdline_printf(cl, "\tlink %s: rate %"PRIu64" pipes %u\n",
+		       name, config->rate, config->nb_pipes);
+	for (i = 0; i < config->nb_profiles; i++)
+		cmdline_printf(cl, "\t\tprofile %u: rate %"PRIu64" size %"PRIu64"\n",
+			       i, config->profiles[i].rate, config->profiles[i].size);
+	for (i = 0; i < config->nb_pipes; i++) {
+		if (config->pipe_profile[i])
+			cmdline_printf(cl, "\t\tpipe %u: profile %u\n", i, config->pipe_profile[i]);
+	}
+	for (i = 0; i < VLAN_VID_MAX; i++) {
+		if (config->vlan_pipe[i])
+			cmdline_printf(cl, "\t\tvlan %u: pipe %u\n", i, config->vlan_pipe[i]);
+	}
+
+	return 0;
+}
+
+static void
+cli_tx_sched_show(__rte_unused void *parsed_result, struct cmdline *cl, __rte_unused void *data)
+{
+	cmdline_printf(cl, "sched:\n");
+	tx_sched_config_walk(cli_tx_sched_show_one, cl);
+}
+
+cmdline_parse_token_string_t tx_sched_cmd =
+	TOKEN_STRING_INITIALIZER(struct tx_sched_cmd_tokens, sched, "sched");
+cmdline_parse_token_string_t tx_sched_link =
+	TOKEN_STRING_INITIALIZER(struct tx_sched_cmd_tokens, link, "link");
+cmdline_parse_token_string_t tx_sched_dev =
+	TOKEN_STRING_INITIALIZER(struct tx_sched_cmd_tokens, dev, NULL);
+cmdline_parse_token_string_t tx_sched_action_rem =
+	TOKEN_STRING_INITIALIZER(struct tx_sched_cmd_tokens, action, "rem");
+cmdline_parse_token_string_t tx_sched_action_show =
+	TOKEN_STRING_INITIALIZER(struct tx_sched_cmd_tokens, action, "show");
+cmdline_parse_token_string_t tx_sched_rate =
+	TOKEN_STRING_INITIALIZER(struct tx_sched_cmd_tokens, rate, "rate");
+cmdline_parse_token_num_t tx_sched_rate_val =
+	TOKEN_NUM_INITIALIZER(struct tx_sched_cmd_tokens, rate_val, RTE_UINT64);
+cmdline_parse_token_string_t tx_sched_pipes =
+	TOKEN_STRING_INITIALIZER(struct tx_sched_cmd_tokens, pipes, "pipes");
+cmdline_parse_token_num_t tx_sched_nb_pipes =
+	TOKEN_NUM_INITIALIZER(struct tx_sched_cmd_tokens, nb_pipes, RTE_UINT32);
+cmdline_parse_token_string_t tx_sched_size =
+	TOKEN_STRING_INITIALIZER(struct tx_sched_cmd_tokens, size, "size");
+cmdline_parse_token_num_t tx_sched_size_val =
+	TOKEN_NUM_INITIALIZER(struct tx_sched_cmd_tokens, size_val, RTE_UINT64);
+cmdline_parse_token_string_t tx_sched_profile =
+	TOKEN_STRING_INITIALIZER(struct tx_sched_cmd_tokens, profile, "profile");
+cmdline_parse_token_num_t tx_sched_profile_id =
+	TOKEN_NUM_INITIALIZER(struct tx_sched_cmd_tokens, profile_id, RTE_UINT32);
+cmdline_parse_token_string_t tx_sched_pipe =
+	TOKEN_STRING_INITIALIZER(struct tx_sched_cmd_tokens, pipe, "pipe");
+cmdline_parse_token_num_t tx_sched_pipe_id =
+	TOKEN_NUM_INITIALIZER(struct tx_sched_cmd_tokens, pipe_id, RTE_UINT32);
+cmdline_parse_token_string_t tx_sched_vlan =
+	TOKEN_STRING_INITIALIZER(struct tx_sched_cmd_tokens, action, "vlan");
+cmdline_parse_token_num_t tx_sched_vid =
+	TOKEN_NUM_INITIALIZER(struct tx_sched_cmd_tokens, vid, RTE_UINT16);
+
+static char const
+cmd_tx_sched_link_help[] = "sched link <dev> rate <bytes/s> pipes <n>";
+
+cmdline_parse_inst_t tx_sched_link_cmd_ctx = {
+	.f = cli_tx_sched_link,
+	.data = NULL,
+	.help_str = cmd_tx_sched_link_help,
+	.tokens = {
+		(void *)&tx_sched_cmd,
+		(void *)&tx_sched_link,
+		(void *)&tx_sched_dev,
+		(void *)&tx_sched_rate,
+		(void *)&tx_sched_rate_val,
+		(void *)&tx_sched_pipes,
+		(void *)&tx_sched_nb_pipes,
+		NULL,
+	},
+};
+
+static char const
+cmd_tx_sched_rem_help[] = "sched link <dev> rem";
+
+cmdline_parse_inst_t tx_sched_rem_cmd_ctx = {
+	.f = cli_tx_sched_rem,
+	.data = NULL,
+	.help_str = cmd_tx_sched_rem_help,
+	.tokens = {
+		(void *)&tx_sched_cmd,
+		(void *)&tx_sched_link,
+		(void *)&tx_sched_dev,
+		(void *)&tx_sched_action_rem,
+		NULL,
+	},
+};
+
+static char const
+cmd_tx_sched_profile_help[] = "sched link <dev> profile <id> rate <bytes/s> size <bytes>";
+
+cmdline_parse_inst_t tx_sched_profile_cmd_ctx = {
+	.f = cli_tx_sched_profile,
+	.data = NULL,
+	.help_str = cmd_tx_sched_profile_help,
+	.tokens = {
+		(void *)&tx_sched_cmd,
+		(void *)&tx_sched_link,
+		(void *)&tx_sched_dev,
+		(void *)&tx_sched_profile,
+		(void *)&tx_sched_profile_id,
+		(void *)&tx_sched_rate,
+		(void *)&tx_sched_rate_val,
+		(void *)&tx_sched_size,
+		(void *)&tx_sched_size_val,
+		NULL,
+	},
+};
+
+static char const
+cmd_tx_sched_pipe_help[] = "sched link <dev> pipe <id> profile <id>";
+
+cmdline_parse_inst_t tx_sched_pipe_cmd_ctx = {
+	.f = cli_tx_sched_pipe,
+	.data = NULL,
+	.help_str = cmd_tx_sched_pipe_help,
+	.tokens = {
+		(void *)&tx_sched_cmd,
+		(void *)&tx_sched_link,
+		(void *)&tx_sched_dev,
+		(void *)&tx_sched_pipe,
+		(void *)&tx_sched_pipe_id,
+		(void *)&tx_sched_profile,
+		(void *)&tx_sched_profile_id,
+		NULL,
+	},
+};
+
+static char const
+cmd_tx_sched_vlan_help[] = "sched link <dev> vlan <vid> pipe <id>";
+
+cmdline_parse_inst_t tx_sched_vlan_cmd_ctx = {
+	.f = cli_tx_sched_vlan,
+	.data = NULL,
+	.help_str = cmd_tx_sched_vlan_help,
+	.tokens = {
+		(void *)&tx_sched_cmd,
+		(void *)&tx_sched_link,
+		(void *)&tx_sched_dev,
+		(void *)&tx_sched_vlan,
+		(void *)&tx_sched_vid,
+		(void *)&tx_sched_pipe,
+		(void *)&tx_sched_pipe_id,
+		NULL,
+	},
+};
+
+static char const
+cmd_tx_sched_show_help[] = "sched show";
+
+cmdline_parse_inst_t tx_sched_show_cmd_ctx = {
+	.f = cli_tx_sched_show,
+	.data = NULL,
+	.help_str = cmd_tx_sched_show_help,
+	.tokens = {
+		(void *)&tx_sched_cmd,
+		(void *)&tx_sched_action_show,
+		NULL,
+	},
+};
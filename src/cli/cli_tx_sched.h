@@ -0,0 +1,38 @@
+/*
+  SPDX-License-Identifier: MIT
+  Copyright(c) 2023 Sriram Yagnaraman.
+*/
+
+#ifndef __VSWITCH_SRC_CLI_TX_SCHED_H_
+#define __VSWITCH_SRC_CLI_TX_SCHED_H_
+
+#include <cmdline.h>
+#include <cmdline_parse.h>
+#include <cmdline_parse_string.h>
+
+struct tx_sched_cmd_tokens {
+	cmdline_fixed_string_t sched;
+	cmdline_fixed_string_t link;
+	cmdline_fixed_string_t dev;
+	cmdline_fixed_string_t action;
+	cmdline_fixed_string_t rate;
+	cmdline_fixed_string_t pipes;
+	cmdline_fixed_string_t size;
+	cmdline_fixed_string_t profile;
+	cmdline_fixed_string_t pipe;
+	uint64_t rate_val;
+	uint64_t size_val;
+	uint32_t nb_pipes;
+	uint32_t profile_id;
+	uint32_t pipe_id;
+	uint16_t vid;
+};
+
+extern cmdline_parse_inst_t tx_sched_link_cmd_ctx;
+extern cmdline_parse_inst_t tx_sched_rem_cmd_ctx;
+extern cmdline_parse_inst_t tx_sched_profile_cmd_ctx;
+extern cmdline_parse_inst_t tx_sched_pipe_cmd_ctx;
+extern cmdline_parse_inst_t tx_sched_vlan_cmd_ctx;
+extern cmdline_parse_inst_t tx_sched_show_cmd_ctx;
+
+#endif /* __VSWITCH_SRC_CLI_TX_SCHED_H_*/
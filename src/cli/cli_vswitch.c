@@ -17,13 +17,17 @@
 #include "link.h"
 #include "stage.h"
 #include "vswitch.h"
+#include "node/eventdev_tx.h"
 
 static void
 cli_vswitch_show(__rte_unused void *parsed_result, struct cmdline *cl, __rte_unused void *data)
 {
 	struct vswitch_config *config = vswitch_config_get();
+	struct eventdev_tx_node_stats ev_tx_stats;
+	struct vswitch_eventdev *ev;
 	struct lcore_params *lcore;
 	uint16_t core_id;
+	uint8_t ev_id;
 
 	cmdline_printf(cl, "Vswitch\n");
 	if (!config) {
@@ -35,11 +39,13 @@ cli_vswitch_show(__rte_unused void *parsed_result, struct cmdline *cl, __rte_unu
 		stage_get_enabled_coremask());
 	cmdline_printf(cl, "  Used worker cores:\t0x%04lx\n",
 		stage_get_used_coremask());
-	cmdline_printf(cl, "  Event device,\tid: %d, \tdriver: %s\n",
-			config->ev_id,
-			config->ev_info.driver_name);
-	cmdline_printf(cl, "  Number of event ports:\t%d\n", config->nb_ports);
-	cmdline_printf(cl, "  Number of event queues:\t%d\n", config->nb_queues);
+	for (ev_id = 0; ev_id < config->nb_eventdevs; ev_id++) {
+		ev = &config->eventdevs[ev_id];
+		cmdline_printf(cl, "  Event device,\tid: %u, \tdriver: %s\tnuma: %d\n",
+				ev_id, ev->info.driver_name, ev->socket_id);
+		cmdline_printf(cl, "    Number of event ports:\t%d\n", ev->nb_ports);
+		cmdline_printf(cl, "    Number of event queues:\t%d\n", ev->nb_queues);
+	}
 	for (core_id = 0; core_id < RTE_MAX_LCORE; core_id++) {
 		lcore = &config->lcores[core_id];
 		if (!lcore->enabled) {
@@ -60,6 +66,14 @@ cli_vswitch_show(__rte_unused void *parsed_result, struct cmdline *cl, __rte_unu
 				lcore->ev_in_queue, lcore->ev_out_queue,
 				lcore->nb_link_in_queues, lcore->nb_link_out_queues,
 				lcore->graph_name);
+			if (eventdev_tx_node_stats_get(lcore->ev_tx_node_id, &ev_tx_stats) == 0)
+				cmdline_printf(cl, "\tev_port %u tx: enqueued %" PRIu64 "  retries %" PRIu64
+					"  carried %" PRIu64 "  dropped %" PRIu64
+					"  released %" PRIu64 "\n",
+					lcore->ev_port_id,
+					ev_tx_stats.enqueued, ev_tx_stats.retries,
+					ev_tx_stats.carried, ev_tx_stats.dropped,
+					ev_tx_stats.released);
 			rte_graph_dump(stdout, lcore->graph_id);
 		}
 	}
@@ -78,6 +92,22 @@ cli_vswitch_start(__rte_unused void *parsed_result, struct cmdline *cl, __rte_un
 		cmdline_printf(cl, "Done.\n");
 }
 
+static void
+cli_vswitch_reconfigure(__rte_unused void *parsed_result, struct cmdline *cl,
+			__rte_unused void *data)
+{
+	int rc;
+
+	rc = vswitch_reconfigure();
+	if (rc == -ENOTSUP)
+		cmdline_printf(cl, "Vswitch reconfigure failed: only run-to-completion stages"
+			       " are rebuilt, eventdev stage changes need a restart\n");
+	else if (rc < 0)
+		cmdline_printf(cl, "Vswitch reconfigure failed: %s\n", rte_strerror(-rc));
+	else
+		cmdline_printf(cl, "Done.\n");
+}
+
 static void
 cli_vswitch_stats(__rte_unused void *parsed_result, struct cmdline *cl, __rte_unused void *data)
 {
@@ -112,6 +142,8 @@ cmdline_parse_token_string_t vswitch_action_show =
 	TOKEN_STRING_INITIALIZER(struct vswitch_cmd_tokens, action, "show");
 cmdline_parse_token_string_t vswitch_action_start =
 	TOKEN_STRING_INITIALIZER(struct vswitch_cmd_tokens, action, "start");
+cmdline_parse_token_string_t vswitch_action_reconfigure =
+	TOKEN_STRING_INITIALIZER(struct vswitch_cmd_tokens, action, "reconfigure");
 cmdline_parse_token_string_t vswitch_action_stats =
 	TOKEN_STRING_INITIALIZER(struct vswitch_cmd_tokens, action, "stats");
 
@@ -137,6 +169,17 @@ cmdline_parse_inst_t vswitch_start_cmd_ctx = {
 	},
 };
 
+cmdline_parse_inst_t vswitch_reconfigure_cmd_ctx = {
+	.f = cli_vswitch_reconfigure,
+	.data = NULL,
+	.help_str = "vswitch reconfigure (run-to-completion stages only)",
+	.tokens = {
+		(void *)&vswitch_cmd,
+		(void *)&vswitch_action_reconfigure,
+		NULL,
+	},
+};
+
 cmdline_parse_inst_t vswitch_stats_cmd_ctx = {
 	.f = cli_vswitch_stats,
 	.data = NULL,
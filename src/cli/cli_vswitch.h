@@ -19,6 +19,7 @@ struct vswitch_cmd_tokens {
 
 extern cmdline_parse_inst_t vswitch_show_cmd_ctx;
 extern cmdline_parse_inst_t vswitch_start_cmd_ctx;
+extern cmdline_parse_inst_t vswitch_reconfigure_cmd_ctx;
 extern cmdline_parse_inst_t vswitch_stats_cmd_ctx;
 
 #endif /* __VSWITCH_SRC_CLI_VSWITCH_H_*/
\ No newline at end of file
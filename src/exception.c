@@ -0,0 +1,268 @@
+/*
+  SPDX-License-Identifier: MIT
+  Copyright(c) 2023 Sriram Yagnaraman.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <rte_dev.h>
+#include <rte_ethdev.h>
+#include <rte_malloc.h>
+
+#include "exception.h"
+#include "link.h"
+#include "mempool.h"
+#include "stage.h"
+
+#define EXCEPTION_ARGS_LEN	(256)
+
+static struct exception_config exception_config;
+static struct rte_mempool *exception_mp;
+
+static uint16_t exception_port[RTE_MAX_ETHPORTS];
+static uint16_t exception_lcore_queue[RTE_MAX_LCORE];
+static uint16_t exception_lcore_poller[RTE_MAX_LCORE];
+static uint16_t exception_nb_queues;
+static uint16_t exception_nb_pollers;
+static uint8_t exception_started;
+
+int
+exception_config_set(char const *mp_name, uint16_t queue_size)
+{
+	struct mempool *m = mempool_config_get(mp_name);
+
+	if (exception_started)
+		return -EBUSY;
+
+	if (!m)
+		return -ENOENT;
+
+	if (m->config.type != MEMPOOL_TYPE_PKTMBUF || !rte_is_power_of_2(queue_size))
+		return -EINVAL;
+
+	exception_config.enabled = 1;
+	exception_config.queue_size = queue_size;
+	rte_strscpy(exception_config.mp_name, mp_name, sizeof(exception_config.mp_name));
+	exception_mp = m->mp;
+	return 0;
+}
+
+int
+exception_config_rem(void)
+{
+	if (exception_started)
+		return -EBUSY;
+
+	memset(&exception_config, 0, sizeof(exception_config));
+	exception_mp = NULL;
+	return 0;
+}
+
+struct exception_config *
+exception_config_get(void)
+{
+	return &exception_config;
+}
+
+uint16_t
+exception_config_get_nb_queues(void)
+{
+	return exception_nb_queues;
+}
+
+int
+exception_config_walk(exception_walk_cb cb, void *data)
+{
+	uint16_t i;
+	int rc = 0;
+
+	if (!exception_started)
+		return 0;
+
+	for (i = 0; i < RTE_MAX_ETHPORTS; i++) {
+		if (exception_port[i] == EXCEPTION_PORT_INVALID)
+			continue;
+
+		rc = cb(i, exception_port[i], data);
+		if (rc < 0)
+			break;
+	}
+
+	return rc;
+}
+
+uint16_t
+exception_config_get_rx_queues(unsigned int lcore_id, uint16_t *queues, uint16_t max)
+{
+	uint16_t q, n = 0;
+
+	if (!exception_started || lcore_id >= RTE_MAX_LCORE ||
+	    exception_lcore_poller[lcore_id] == EXCEPTION_QUEUE_INVALID)
+		return 0;
+
+	for (q = 0; q < exception_nb_queues && n < max; q++) {
+		if (q % exception_nb_pollers == exception_lcore_poller[lcore_id])
+			queues[n++] = q;
+	}
+
+	return n;
+}
+
+/* Every lcore may punt so each gets a tx queue, the rx queues are spread
+ * over the lcores that can send on links.
+ */
+static int
+exception_assign_lcores(struct stage_config *config, __rte_unused void *data)
+{
+	bool egress = false;
+	uint32_t core_id;
+	int i;
+
+	for (i = 0; i < STAGE_MAX_LINK_QUEUES; i++) {
+		if (config->link_out_queue[i].enabled) {
+			egress = true;
+			break;
+		}
+	}
+
+	for (core_id = 0; core_id < 32; core_id++) {
+		if (!(config->coremask & (1U << core_id)))
+			continue;
+
+		exception_lcore_queue[core_id] = exception_nb_queues++;
+		if (egress)
+			exception_lcore_poller[core_id] = exception_nb_pollers++;
+	}
+
+	return 0;
+}
+
+static int
+exception_port_create(uint16_t link_id, __rte_unused uint16_t peer_link_id,
+		      __rte_unused void *data)
+{
+	char name[RTE_ETH_NAME_MAX_LEN], args[EXCEPTION_ARGS_LEN];
+	struct rte_ether_addr mac;
+	struct rte_eth_conf conf;
+	uint16_t port_id, q;
+	int socket;
+	int rc;
+
+	rc = rte_eth_macaddr_get(link_id, &mac);
+	if (rc < 0)
+		return rc;
+
+	/* The host side mirrors the link address so ARP and ND just work */
+	snprintf(name, sizeof(name), "virtio_user" EXCEPTION_IFNAME_FMT, link_id);
+	snprintf(args, sizeof(args),
+		 "path=/dev/vhost-net,queues=%u,queue_size=%u,iface=" EXCEPTION_IFNAME_FMT
+		 ",mac=" RTE_ETHER_ADDR_PRT_FMT,
+		 exception_nb_queues, exception_config.queue_size, link_id,
+		 RTE_ETHER_ADDR_BYTES(&mac));
+
+	rc = rte_eal_hotplug_add("vdev", name, args);
+	if (rc < 0)
+		return rc;
+
+	rc = rte_eth_dev_get_port_by_name(name, &port_id);
+	if (rc < 0)
+		goto err;
+
+	socket = rte_eth_dev_socket_id(port_id);
+	if (socket == SOCKET_ID_ANY)
+		socket = 0;
+
+	memset(&conf, 0, sizeof(conf));
+	rc = rte_eth_dev_configure(port_id, exception_nb_queues, exception_nb_queues, &conf);
+	if (rc < 0)
+		goto err;
+
+	for (q = 0; q < exception_nb_queues; q++) {
+		rc = rte_eth_rx_queue_setup(port_id, q, exception_config.queue_size, socket,
+					    NULL, exception_mp);
+		if (rc < 0)
+			goto err;
+
+		rc = rte_eth_tx_queue_setup(port_id, q, exception_config.queue_size, socket,
+					    NULL);
+		if (rc < 0)
+			goto err;
+	}
+
+	rc = rte_eth_dev_start(port_id);
+	if (rc < 0)
+		goto err;
+
+	exception_port[link_id] = port_id;
+	RTE_LOG(INFO, USER1, "Exception port %u (" EXCEPTION_IFNAME_FMT ") for link %u\n",
+		port_id, link_id, link_id);
+	return 0;
+
+err:
+	rte_eal_hotplug_remove("vdev", name);
+	return rc;
+}
+
+static void
+exception_ports_destroy(void)
+{
+	char name[RTE_ETH_NAME_MAX_LEN];
+	uint16_t i;
+
+	for (i = 0; i < RTE_MAX_ETHPORTS; i++) {
+		if (exception_port[i] == EXCEPTION_PORT_INVALID)
+			continue;
+
+		rte_eth_dev_stop(exception_port[i]);
+		rte_eth_dev_close(exception_port[i]);
+		snprintf(name, sizeof(name), "virtio_user" EXCEPTION_IFNAME_FMT, i);
+		rte_eal_hotplug_remove("vdev", name);
+		exception_port[i] = EXCEPTION_PORT_INVALID;
+	}
+}
+
+int
+exception_start(void)
+{
+	int rc;
+
+	if (exception_started || !exception_config.enabled)
+		return 0;
+
+	memset(exception_port, 0xff, sizeof(exception_port));
+	memset(exception_lcore_queue, 0xff, sizeof(exception_lcore_queue));
+	memset(exception_lcore_poller, 0xff, sizeof(exception_lcore_poller));
+	exception_nb_queues = 0;
+	exception_nb_pollers = 0;
+
+	stage_config_walk(exception_assign_lcores, NULL);
+	if (exception_nb_queues == 0)
+		return 0;
+
+	rc = link_map_walk(exception_port_create, NULL);
+	if (rc < 0)
+		goto err;
+
+	rc = exception_init(exception_port, exception_lcore_queue);
+	if (rc < 0)
+		goto err;
+
+	exception_started = 1;
+	return 0;
+
+err:
+	exception_ports_destroy();
+	return rc;
+}
+
+void
+exception_stop(void)
+{
+	if (!exception_started)
+		return;
+
+	exception_fini();
+	exception_ports_destroy();
+	exception_started = 0;
+}
@@ -0,0 +1,44 @@
+/*
+  SPDX-License-Identifier: MIT
+  Copyright(c) 2023 Sriram Yagnaraman.
+*/
+
+#ifndef __VSWITCH_SRC_API_ACL_H_
+#define __VSWITCH_SRC_API_ACL_H_
+
+#include <sys/queue.h>
+
+#include <rte_rcu_qsbr.h>
+
+#include "node/ip4_acl.h"
+
+#define ACL_RULE_ID_MAX		(IP4_ACL_RULES_MAX)
+
+/* Rule changes after start take effect on acl_commit() */
+struct acl_rule_config {
+	uint32_t rule_id;
+	struct ip4_acl_rule rule;
+};
+
+struct acl_rule {
+	TAILQ_ENTRY(acl_rule) next;
+	struct acl_rule_config config;
+};
+TAILQ_HEAD(acl_rule_head, acl_rule);
+
+typedef int (*acl_rule_walk_cb) (struct acl_rule_config *config, void *data);
+
+struct acl_rule *acl_rule_config_get(uint32_t rule_id);
+int acl_rule_config_add(struct acl_rule_config *config);
+int acl_rule_config_rem(uint32_t rule_id);
+int acl_rule_config_set_policer(uint32_t rule_id, uint8_t policer);
+int acl_rule_config_walk(acl_rule_walk_cb cb, void *data);
+
+int acl_config_set_default(uint8_t action);
+uint8_t acl_config_get_default(void);
+
+int acl_commit(void);
+int acl_start(struct rte_rcu_qsbr *qsv);
+void acl_stop(void);
+
+#endif /* __VSWITCH_SRC_API_ACL_H_ */
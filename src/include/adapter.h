@@ -0,0 +1,50 @@
+/*
+  SPDX-License-Identifier: MIT
+  Copyright(c) 2023 Sriram Yagnaraman.
+*/
+
+#ifndef __VSWITCH_SRC_API_ADAPTER_H_
+#define __VSWITCH_SRC_API_ADAPTER_H_
+
+#include <rte_ethdev.h>
+#include <rte_eventdev.h>
+
+#include "stage.h"
+
+#define ADAPTER_EV_PORT_INVALID		(0xFF)
+#define ADAPTER_TXQ_INVALID		(0xFFFF)
+
+/* One Rx and one Tx adapter per event device, shared by all links.
+ * Adapter ids are global, each device uses its own id.
+ */
+struct adapter_params {
+	uint8_t ev_id;
+	uint8_t id;
+
+	struct {
+		uint8_t enabled;
+		uint8_t created;
+		uint8_t ev_port_id;
+		uint32_t coremask;
+	} rx;
+
+	struct {
+		uint8_t enabled;
+		uint8_t created;
+		uint8_t internal_port;
+		uint8_t ev_port_id;
+		uint8_t ev_queue;
+		uint32_t coremask;
+		uint16_t txq[RTE_MAX_ETHPORTS];
+	} tx;
+};
+
+void adapter_init(uint8_t ev_id);
+struct adapter_params *adapter_params_get(uint8_t ev_id);
+
+int adapter_stage_reserve(struct stage_config *stage_config, int *nb_ports);
+int adapter_stage_setup(struct stage_config *stage_config, void *data);
+int adapter_start(uint8_t ev_id);
+void adapter_stop(uint8_t ev_id);
+
+#endif /* __VSWITCH_SRC_API_ADAPTER_H_ */
@@ -0,0 +1,47 @@
+/*
+  SPDX-License-Identifier: MIT
+  Copyright(c) 2023 Sriram Yagnaraman.
+*/
+
+#ifndef __VSWITCH_SRC_API_BRIDGE_H_
+#define __VSWITCH_SRC_API_BRIDGE_H_
+
+#include <sys/queue.h>
+
+#include <rte_rcu_qsbr.h>
+
+#include "node/l2_bridge.h"
+
+#define BRIDGE_NAME_MAX_LEN		(32)
+#define BRIDGE_FDB_SIZE_DEFAULT		(4096)
+#define BRIDGE_AGEING_DEFAULT		(300)
+#define BRIDGE_LEARN_INTERVAL_US	(10000)
+
+struct bridge_config {
+	char name[BRIDGE_NAME_MAX_LEN];
+	uint16_t bd_id;
+	uint32_t fdb_size;
+	uint16_t ageing_s;
+	uint16_t nb_links;
+	uint16_t link_id[L2_BRIDGE_MAX_MEMBERS];
+};
+
+struct bridge {
+	TAILQ_ENTRY(bridge) next;
+	struct bridge_config config;
+};
+TAILQ_HEAD(bridge_head, bridge);
+
+struct bridge *bridge_config_get(char const *name);
+int bridge_config_add(struct bridge_config *config);
+int bridge_config_rem(char const *name);
+int bridge_config_add_link(char const *name, char const *link_name);
+int bridge_config_set_fdb_size(char const *name, uint32_t fdb_size);
+int bridge_config_set_ageing(char const *name, uint16_t ageing_s);
+
+int bridge_fdb_flush(char const *name);
+
+int bridge_start(struct rte_rcu_qsbr *qsv);
+void bridge_stop(void);
+
+#endif /* __VSWITCH_SRC_API_BRIDGE_H_ */
@@ -0,0 +1,42 @@
+/*
+  SPDX-License-Identifier: MIT
+  Copyright(c) 2023 Sriram Yagnaraman.
+*/
+
+#ifndef __VSWITCH_SRC_API_EXCEPTION_H_
+#define __VSWITCH_SRC_API_EXCEPTION_H_
+
+#include <rte_mempool.h>
+
+#include "node/exception.h"
+
+#define EXCEPTION_QUEUE_SIZE_DEFAULT	(1024)
+#define EXCEPTION_IFNAME_FMT		"vs%u"
+
+/* Every link gets a virtio-user port backed by a vhost-net TAP named
+ * after its link id. Fixed once the switch is started.
+ */
+struct exception_config {
+	uint8_t enabled;
+	char mp_name[RTE_MEMPOOL_NAMESIZE];
+	uint16_t queue_size;
+};
+
+typedef int (*exception_walk_cb) (uint16_t link_id, uint16_t port_id, void *data);
+
+int exception_config_set(char const *mp_name, uint16_t queue_size);
+int exception_config_rem(void);
+struct exception_config *exception_config_get(void);
+uint16_t exception_config_get_nb_queues(void);
+int exception_config_walk(exception_walk_cb cb, void *data);
+
+/* Queues of the exception ports polled by lcore_id, each one has a
+ * single poller.
+ */
+uint16_t exception_config_get_rx_queues(unsigned int lcore_id, uint16_t *queues,
+					uint16_t max);
+
+int exception_start(void);
+void exception_stop(void);
+
+#endif /* __VSWITCH_SRC_API_EXCEPTION_H_ */
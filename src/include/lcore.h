@@ -8,11 +8,14 @@
 
 #include <rte_eventdev.h>
 #include <rte_graph.h>
+#include <rte_rcu_qsbr.h>
 
 #include "stage.h"
 
 #define EV_QUEUE_ID_INVALID	(0xFF)
-#define GRAPH_MAX_PATTERNS	(16)
+#define GRAPH_MAX_PATTERNS	(64)
+/* One per core of a stage, coremasks are 32 bits */
+#define LCORE_EV_OUT_QUEUES_MAX	(32)
 
 struct lcore_params {
 	uint16_t core_id;
@@ -23,10 +26,21 @@ struct lcore_params {
 	uint8_t ev_in_queue_needed;
 	uint8_t ev_in_queue_sched_type;
 	uint8_t ev_in_queue;
-	char ev_in_queue_mp_name[RTE_MEMPOOL_NAMESIZE];
 	uint8_t ev_out_queue_needed;
 	uint8_t ev_out_queue_sched_type;
 	uint8_t ev_out_queue;
+	/* Per core input queues of the next stage, picked by flow id */
+	uint8_t nb_ev_out_queues;
+	uint8_t ev_out_queues[LCORE_EV_OUT_QUEUES_MAX];
+	uint8_t ev_out_flow_hash;
+	uint16_t ev_out_vector_size;
+	struct rte_mempool *ev_out_vector_mp;
+	uint32_t flow_cache_size;
+	uint32_t conntrack_size;
+	uint8_t conntrack_strict;
+	rte_node_t ev_rx_node_id;
+	rte_node_t ev_tx_node_id;
+	struct eventdev_tx_node_buf *ev_tx_buf;
 	struct rte_event_port_conf ev_port_config;
 	uint8_t nb_link_in_queues;
 	uint8_t nb_link_out_queues;
@@ -42,13 +56,18 @@ struct lcore_params {
 	char nodes[STAGE_GRAPH_NODES_MAX_LEN];
 	struct rte_graph_param graph_config;
 	struct rte_graph *graph;
+	struct rte_rcu_qsbr *qsv;
 	char graph_name[RTE_GRAPH_NAMESIZE];
 	rte_graph_t graph_id;
+	/* Bumped by every reconfigure, part of the clone and graph names */
+	uint16_t generation;
 } __rte_cache_aligned;
 
-void lcore_init(uint16_t core_id, uint8_t ev_id, struct lcore_params *lcore);
+void lcore_init(uint16_t core_id, struct lcore_params *lcore);
+void lcore_params_update(struct lcore_params *lcore, struct lcore_params const *next);
 int lcore_config_populate(struct stage_config *stage_config, uint8_t ev_port_id, struct lcore_params *lcore);
 int lcore_graph_populate(struct lcore_params *lcore, bool enable_graph_pcap);
+int lcore_graph_create(struct lcore_params *lcore);
 int lcore_graph_worker(void *arg);
 
 
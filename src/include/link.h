@@ -9,16 +9,68 @@
 #include <rte_ethdev.h>
 #include <rte_mempool.h>
 
+#include "node/vlan.h"
+
 #define LINK_ID_MAX 		(0xFFFF)
 #define ETHDEV_RXQ_RSS_MAX	(16)
 #define ETHDEV_RX_DESC_DEFAULT	(1024)
 #define ETHDEV_TX_DESC_DEFAULT	(1024)
+#define ETHDEV_RSS_KEY_LEN_MAX	(64)
+#define LINK_VDEV_QUEUES_MAX	(16)
+#define LINK_SOCKET_PATH_LEN	(108)
+#define LINK_IFNAME_LEN		(16)
+#define LINK_VHOST_PREFIX	"net_vhost"
+#define LINK_MEMIF_PREFIX	"net_memif"
+#define LINK_AFXDP_PREFIX	"net_af_xdp"
+#define LINK_AFXDP_QUEUE_SZ_MIN	(64)
+#define LINK_AFXDP_BUSY_BUDGET	(64)
+#define LINK_MEMIF_RING_SZ_DEFAULT	(10)
+#define LINK_MEMIF_RING_SZ_MAX	(14)
+#define LINK_MEMIF_BUF_SZ_DEFAULT	(2048)
+
+enum link_type {
+	LINK_TYPE_ETHDEV = 0,
+	LINK_TYPE_VHOST,
+	LINK_TYPE_MEMIF,
+	LINK_TYPE_AFXDP,
+	LINK_TYPE_MAX
+};
 
 typedef int (*link_map_cb) (uint16_t link_id, uint16_t peer_link_id, void *data);
 
 struct link_rss_config {
 	uint32_t queue_id[ETHDEV_RXQ_RSS_MAX];
 	uint32_t n_queues;
+	uint64_t rss_hf;
+};
+
+struct link_vhost_config {
+	char path[LINK_SOCKET_PATH_LEN];
+	uint16_t nb_queues;
+	/* QEMU owns the socket and the link reconnects to it */
+	uint8_t client;
+	/* 0 sizes the guest pool from the queues */
+	uint32_t nb_mbufs;
+};
+
+struct link_memif_config {
+	char path[LINK_SOCKET_PATH_LEN];
+	uint32_t id;
+	uint16_t nb_queues;
+	uint8_t client;
+	/* Clients only, the peer reads and writes our mbufs */
+	uint8_t zero_copy;
+	/* log2 of the descriptors per ring */
+	uint8_t ring_sz;
+	uint16_t buf_sz;
+	/* SOCKET_ID_ANY follows the port */
+	int numa_node;
+};
+
+struct link_afxdp_config {
+	char ifname[LINK_IFNAME_LEN];
+	uint16_t start_queue;
+	uint16_t nb_queues;
 };
 
 struct link_config {
@@ -31,12 +83,13 @@ struct link_config {
 		uint32_t queue_sz;
 		char mp_name[RTE_MEMPOOL_NAMESIZE];
 		struct rte_mempool *mp;
-		struct link_rss_config *rss;
+		struct link_rss_config rss;
 	} rx;
 
 	struct {
 		uint32_t nb_queues;
 		uint32_t queue_sz;
+		uint64_t offloads;
 	} tx;
 
 	struct {
@@ -46,24 +99,47 @@ struct link_config {
 
 	int promiscuous;
 	uint32_t mtu;
+	/* Fragments received on the link are put back together */
+	uint8_t reassembly;
+	/* Anything but ethdev was created at runtime, vhost and memif along
+	 * with their mempool.
+	 */
+	uint8_t type;
+	struct vlan_link_config vlan;
 };
 
 struct link {
 	TAILQ_ENTRY(link) next;
 	struct link_config config;
+	uint8_t started;
 };
 TAILQ_HEAD(link_head, link);
 
 struct rte_eth_conf *link_config_default_get();
+char const *link_type_name(uint8_t type);
 
 struct link *link_config_get(char const *name);
 int link_config_add(struct link_config *l);
+int link_config_add_vhost(struct link_config *l, struct link_vhost_config const *vhost);
+int link_config_add_memif(struct link_config *l, struct link_memif_config const *memif);
+/* rx.mp_name names the pool that becomes the UMEM */
+int link_config_add_afxdp(struct link_config *l, struct link_afxdp_config const *afxdp);
 int link_config_rem(char const *name);
 int link_get_peer(uint16_t link_id, uint16_t *peer_link_id);
 
 int link_config_set_promiscuous(char const *name, bool enable);
 int link_config_set_mtu(char const *name, uint32_t mtu);
 int link_config_set_peer(char const *name, char const *peer_name);
+int link_config_set_rss(char const *name, struct link_rss_config *rss);
+int link_config_set_vlan(char const *name, struct vlan_link_config *vlan);
+int link_config_set_vlan_native(char const *name, uint16_t vid);
+int link_config_add_tx_offloads(char const *name, uint64_t offloads);
+uint64_t link_tx_offloads_common(void);
+bool link_vlan_sw_insert(void);
+int link_config_set_reassembly(char const *name, bool enable);
+bool link_reassembly_enabled(uint16_t link_id);
+uint32_t link_mtu_get(uint16_t link_id);
+uint32_t link_mtu_max(void);
 
 int link_start();
 int link_map_walk(link_map_cb cb, void *data);
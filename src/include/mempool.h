@@ -13,7 +13,7 @@
 
 enum {
 	MEMPOOL_TYPE_PKTMBUF = 0,
-	MEMPOOL_TYPE_EVENT,
+	MEMPOOL_TYPE_VECTOR,
 	MEMPOOL_TYPE_MAX
 };
 
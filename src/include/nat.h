@@ -0,0 +1,37 @@
+/*
+  SPDX-License-Identifier: MIT
+  Copyright(c) 2023 Sriram Yagnaraman.
+*/
+
+#ifndef __VSWITCH_SRC_API_NAT_H_
+#define __VSWITCH_SRC_API_NAT_H_
+
+#include <sys/queue.h>
+
+#include "node/nat.h"
+
+#define NAT_RULE_ID_MAX		(NAT_RULES_MAX)
+
+/* Rules are fixed once the switch is started */
+struct nat_rule_config {
+	uint32_t rule_id;
+	struct nat_rule rule;
+};
+
+struct nat_rule_entry {
+	TAILQ_ENTRY(nat_rule_entry) next;
+	struct nat_rule_config config;
+};
+TAILQ_HEAD(nat_rule_head, nat_rule_entry);
+
+typedef int (*nat_rule_walk_cb) (struct nat_rule_config *config, void *data);
+
+struct nat_rule_entry *nat_rule_config_get(uint32_t rule_id);
+int nat_rule_config_add(struct nat_rule_config *config);
+int nat_rule_config_rem(uint32_t rule_id);
+int nat_rule_config_walk(nat_rule_walk_cb cb, void *data);
+
+int nat_start(void);
+void nat_stop(void);
+
+#endif /* __VSWITCH_SRC_API_NAT_H_ */
@@ -0,0 +1,43 @@
+/*
+  SPDX-License-Identifier: MIT
+  Copyright(c) 2023 Sriram Yagnaraman.
+*/
+
+#ifndef __VSWITCH_SRC_API_POLICER_H_
+#define __VSWITCH_SRC_API_POLICER_H_
+
+#include <sys/queue.h>
+
+#include "node/policer.h"
+
+#define POLICER_ID_MAX		(POLICER_MAX)
+
+/* Profiles and attachments are fixed once the switch is started */
+struct policer_config {
+	uint32_t policer_id;
+	struct policer_params params;
+};
+
+struct policer {
+	TAILQ_ENTRY(policer) next;
+	struct policer_config config;
+};
+TAILQ_HEAD(policer_head, policer);
+
+typedef int (*policer_walk_cb) (struct policer_config *config, void *data);
+
+struct policer *policer_config_get(uint32_t policer_id);
+int policer_config_add(struct policer_config *config);
+int policer_config_rem(uint32_t policer_id);
+int policer_config_set_action(uint32_t policer_id, uint8_t color, uint8_t action,
+			      uint8_t dscp);
+int policer_config_walk(policer_walk_cb cb, void *data);
+
+/* policer_id 0 detaches the link */
+int policer_config_set_link(char const *link_name, uint32_t policer_id);
+uint8_t policer_config_get_link(uint16_t link_id);
+
+int policer_start(void);
+void policer_stop(void);
+
+#endif /* __VSWITCH_SRC_API_POLICER_H_ */
@@ -7,11 +7,13 @@
 #define __VSWITCH_SRC_API_STAGE_H_
 
 #include <rte_eventdev.h>
+#include <rte_mempool.h>
 
 #define STAGE_NAME_MAX_LEN		(64)
 #define STAGE_MAX			(16)
 #define STAGE_MAX_LINK_QUEUES		(8)
 #define STAGE_GRAPH_NODES_MAX_LEN	(512)
+#define STAGE_EV_ID_ANY			(-1)
 
 extern char const *stage_type_str[];
 
@@ -19,6 +21,7 @@ enum {
 	STAGE_TYPE_RX = 0,
 	STAGE_TYPE_WORKER,
 	STAGE_TYPE_TX,
+	STAGE_TYPE_RTC,
 	STAGE_TYPE_MAX
 };
 
@@ -33,18 +36,33 @@ struct stage_ev_queue_config {
 	uint8_t sched_type_in;
 	uint8_t out;
 	uint8_t sched_type_out;
-	char mp_name[RTE_MEMPOOL_NAMESIZE];
 	struct rte_event_queue_conf config_in;
 };
 
+/* Event vectors on the output queue, size 0 disables */
+struct stage_vector_config {
+	uint16_t size;
+	uint64_t timeout_ns;
+	char mp_name[RTE_MEMPOOL_NAMESIZE];
+};
+
 struct stage_config {
 	char name[STAGE_NAME_MAX_LEN];
 	uint32_t stage_id;
 	uint32_t coremask;
 	uint8_t type;
+	int16_t ev_id;
 	struct stage_link_queue_config link_in_queue[STAGE_MAX_LINK_QUEUES];
 	struct stage_link_queue_config link_out_queue[STAGE_MAX_LINK_QUEUES];
 	struct stage_ev_queue_config ev_queue;
+	uint8_t flow_hash;
+	uint8_t adapter;
+	struct stage_vector_config vector;
+	/* Flow cache entries per worker, 0 disables */
+	uint32_t flow_cache;
+	/* Connection tracking entries per worker, 0 disables */
+	uint32_t conntrack;
+	uint8_t conntrack_strict;
 	char nodes[STAGE_GRAPH_NODES_MAX_LEN];
 };
 
@@ -67,11 +85,18 @@ int stage_config_add(struct stage_config *config);
 int stage_config_rem(char const *name);
 
 int stage_config_set_type(char const *name, uint8_t type);
-int stage_config_set_ev_queue_in(char const *name, uint8_t qid, uint8_t schedule_type, char const *mp_name);
+int stage_config_set_eventdev(char const *name, int16_t ev_id);
+int stage_config_set_ev_queue_in(char const *name, uint8_t qid, uint8_t schedule_type);
 int stage_config_set_ev_queue_out(char const *name, uint8_t qid, uint8_t schedule_type);
 int stage_config_set_link_queue_in(char const *name, char const *link_name, uint8_t qid);
 int stage_config_set_link_queue_out(char const *name, char const *link_name, uint8_t qid);
 int stage_config_set_graph_nodes(char const *name, char const *nodes);
+int stage_config_set_flow_hash(char const *name, uint8_t flow_hash);
+int stage_config_set_adapter(char const *name, bool enable);
+int stage_config_set_vector(char const *name, uint16_t size, uint64_t timeout_ns,
+			    char const *mp_name);
+int stage_config_set_flow_cache(char const *name, uint32_t entries);
+int stage_config_set_conntrack(char const *name, uint32_t entries, bool strict);
 
 int stage_config_walk(stage_config_cb cb, void *data);
 
@@ -0,0 +1,51 @@
+/*
+  SPDX-License-Identifier: MIT
+  Copyright(c) 2023 Sriram Yagnaraman.
+*/
+
+#ifndef __VSWITCH_SRC_API_TUNNEL_H_
+#define __VSWITCH_SRC_API_TUNNEL_H_
+
+#include <sys/queue.h>
+
+#include <rte_ethdev.h>
+
+#include "node/vtep.h"
+
+#define TUNNEL_NAME_MAX_LEN	(32)
+
+/* Frames received on the overlay link are encapsulated towards remote
+ * and sent on the underlay link. Matching frames from remote to local
+ * are decapsulated on the underlay ingress and routed by ip4_lookup or
+ * ip6_lookup.
+ */
+struct tunnel_config {
+	char name[TUNNEL_NAME_MAX_LEN];
+	uint16_t tunnel_id;
+	char link_name[RTE_ETH_NAME_MAX_LEN];
+	uint16_t link_id;
+	char overlay_link_name[RTE_ETH_NAME_MAX_LEN];
+	uint16_t overlay_link_id;
+	struct vtep_config vtep;
+};
+
+struct tunnel {
+	TAILQ_ENTRY(tunnel) next;
+	struct tunnel_config config;
+};
+TAILQ_HEAD(tunnel_head, tunnel);
+
+typedef int (*tunnel_walk_cb) (struct tunnel_config *config, void *data);
+
+struct tunnel *tunnel_config_get(char const *name);
+int tunnel_config_add(struct tunnel_config *config);
+int tunnel_config_rem(char const *name);
+int tunnel_config_set_link(char const *name, char const *link_name,
+			   struct rte_ether_addr *nexthop);
+int tunnel_config_set_overlay(char const *name, char const *link_name);
+int tunnel_config_walk(tunnel_walk_cb cb, void *data);
+
+int tunnel_start(void);
+void tunnel_stop(void);
+
+#endif /* __VSWITCH_SRC_API_TUNNEL_H_ */
@@ -0,0 +1,32 @@
+/*
+  SPDX-License-Identifier: MIT
+  Copyright(c) 2023 Sriram Yagnaraman.
+*/
+
+#ifndef __VSWITCH_SRC_API_TX_SCHED_H_
+#define __VSWITCH_SRC_API_TX_SCHED_H_
+
+#include "node/tx_sched.h"
+
+/* Links without a scheduler keep sending straight to the tx queue.
+ * Fixed once the switch is started.
+ */
+typedef int (*tx_sched_walk_cb) (uint16_t link_id, struct tx_sched_link_config *config,
+				 void *data);
+
+int tx_sched_config_set_link(char const *link_name, uint64_t rate, uint32_t nb_pipes);
+int tx_sched_config_rem_link(char const *link_name);
+int tx_sched_config_set_profile(char const *link_name, uint32_t profile_id, uint64_t rate,
+				uint64_t size);
+int tx_sched_config_set_pipe(char const *link_name, uint32_t pipe_id, uint32_t profile_id);
+int tx_sched_config_set_vlan(char const *link_name, uint16_t vid, uint32_t pipe_id);
+int tx_sched_config_walk(tx_sched_walk_cb cb, void *data);
+
+struct tx_sched_link_config *tx_sched_config_get_link(uint16_t link_id);
+/* Number of lcores sending on the link, each gets its share of the rates */
+uint32_t tx_sched_config_get_share(uint16_t link_id);
+
+int tx_sched_start(void);
+void tx_sched_stop(void);
+
+#endif /* __VSWITCH_SRC_API_TX_SCHED_H_ */
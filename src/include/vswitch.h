@@ -8,18 +8,33 @@
 
 #include <rte_eventdev.h>
 #include <rte_graph.h>
+#include <rte_rcu_qsbr.h>
 
 #include "lcore.h"
 #include "options.h"
+#include "stage.h"
 
-struct vswitch_config {
-	struct params params;
+/* Clone registrations of each rebuild stay behind, bound how many */
+#define VSWITCH_GENERATION_MAX	(64)
+
+struct vswitch_eventdev {
+	int socket_id;
 	int nb_ports;
 	int nb_queues;
-	int ev_id;
-	int ev_service_id;
-	struct rte_event_dev_info ev_info;
+	uint32_t service_id;
+	struct rte_event_dev_info info;
+};
+
+struct vswitch_config {
+	struct params params;
+	struct rte_rcu_qsbr *qsv;
+	uint8_t started;
+	uint16_t generation;
+	uint8_t nb_eventdevs;
+	struct vswitch_eventdev eventdevs[RTE_EVENT_MAX_DEVS];
 	struct lcore_params lcores[RTE_MAX_LCORE];
+	/* Stage config the running graphs were built from, by stage id */
+	struct stage_config stages[STAGE_MAX];
 };
 
 int vswitch_init(struct params *p);
@@ -27,6 +42,10 @@ int vswitch_quit();
 struct vswitch_config* vswitch_config_get();
 
 int vswitch_start();
+/* Rebuilds the run-to-completion graphs while the workers run. Eventdev
+ * stages keep the ports and queues of start, -ENOTSUP if they changed.
+ */
+int vswitch_reconfigure();
 int vswitch_dump_stats(char const *file);
 
 #endif /* __VSWITCH_SRC_API_VSWITCH_H_ */
\ No newline at end of file
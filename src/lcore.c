@@ -5,43 +5,251 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include <rte_ethdev.h>
+#include <rte_errno.h>
 #include <rte_eventdev.h>
 #include <rte_graph.h>
 #include <rte_graph_worker.h>
 #include <rte_malloc.h>
 #include <rte_mbuf.h>
 #include <rte_node_eth_api.h>
+#include <rte_pause.h>
+#include <rte_string_fns.h>
 
+#include "adapter.h"
+#include "exception.h"
 #include "lcore.h"
 #include "link.h"
+#include "mempool.h"
 #include "stage.h"
+#include "tunnel.h"
+#include "tx_sched.h"
+#include "node/conntrack.h"
 #include "node/eventdev_dispatcher.h"
 #include "node/eventdev_rx.h"
 #include "node/eventdev_tx.h"
+#include "node/flow_cache.h"
 #include "node/forward.h"
+#include "node/ip_frag.h"
+#include "node/ip4_acl.h"
+#include "node/l2_bridge.h"
+#include "node/nat.h"
+#include "node/policer.h"
+#include "node/vlan.h"
+#include "node/vtep.h"
 
 void
-lcore_init(uint16_t core_id, uint8_t ev_id, struct lcore_params *lcore)
+lcore_init(uint16_t core_id, struct lcore_params *lcore)
 {
         lcore->core_id = core_id;
         lcore->enabled = 0;
-        lcore->ev_id = ev_id;
+        lcore->ev_id = 0;
         lcore->ev_port_id = 0;
         lcore->ev_in_queue_needed = 0;
         lcore->ev_in_queue = EV_QUEUE_ID_INVALID;
         lcore->ev_out_queue_needed = 0;
         lcore->ev_out_queue = EV_QUEUE_ID_INVALID;
+        lcore->nb_ev_out_queues = 0;
+        lcore->ev_rx_node_id = RTE_NODE_ID_INVALID;
+        lcore->ev_tx_node_id = RTE_NODE_ID_INVALID;
+        lcore->ev_tx_buf = NULL;
         lcore->nb_link_in_queues = 0;
         lcore->nb_link_out_queues = 0;
+        lcore->generation = 0;
+        lcore->graph = NULL;
+        lcore->graph_id = RTE_GRAPH_ID_INVALID;
 
 }
 
+/* Hands a rebuilt config to a parked lcore. The worker keeps reading
+ * core_id, qsv, graph and ev_tx_buf, the first two never change and
+ * the graph is published by the caller once this returns.
+ */
+void
+lcore_params_update(struct lcore_params *lcore, struct lcore_params const *next)
+{
+	lcore->enabled = next->enabled;
+	lcore->type = next->type;
+	lcore->ev_id = next->ev_id;
+	lcore->ev_port_id = next->ev_port_id;
+	lcore->ev_in_queue_needed = next->ev_in_queue_needed;
+	lcore->ev_in_queue_sched_type = next->ev_in_queue_sched_type;
+	lcore->ev_in_queue = next->ev_in_queue;
+	lcore->ev_out_queue_needed = next->ev_out_queue_needed;
+	lcore->ev_out_queue_sched_type = next->ev_out_queue_sched_type;
+	lcore->ev_out_queue = next->ev_out_queue;
+	lcore->nb_ev_out_queues = next->nb_ev_out_queues;
+	memcpy(lcore->ev_out_queues, next->ev_out_queues, sizeof(lcore->ev_out_queues));
+	lcore->ev_out_flow_hash = next->ev_out_flow_hash;
+	lcore->ev_out_vector_size = next->ev_out_vector_size;
+	lcore->ev_out_vector_mp = next->ev_out_vector_mp;
+	lcore->flow_cache_size = next->flow_cache_size;
+	lcore->conntrack_size = next->conntrack_size;
+	lcore->conntrack_strict = next->conntrack_strict;
+	lcore->ev_rx_node_id = next->ev_rx_node_id;
+	lcore->ev_tx_node_id = next->ev_tx_node_id;
+	__atomic_store_n(&lcore->ev_tx_buf, next->ev_tx_buf, __ATOMIC_RELAXED);
+	lcore->ev_port_config = next->ev_port_config;
+	lcore->nb_link_in_queues = next->nb_link_in_queues;
+	lcore->nb_link_out_queues = next->nb_link_out_queues;
+	memcpy(lcore->link_in_queues, next->link_in_queues, sizeof(lcore->link_in_queues));
+	memcpy(lcore->link_out_queues, next->link_out_queues, sizeof(lcore->link_out_queues));
+	memcpy(lcore->nodes, next->nodes, sizeof(lcore->nodes));
+	lcore->graph_config = next->graph_config;
+	memcpy(lcore->graph_name, next->graph_name, sizeof(lcore->graph_name));
+	lcore->graph_id = next->graph_id;
+	lcore->generation = next->generation;
+}
+
+/* Clones cannot be unregistered, a rebuilt graph names its own with
+ * the generation appended.
+ */
+static void
+lcore_node_suffix(struct lcore_params *lcore, char *suffix, int id)
+{
+	int n;
+
+	if (id < 0)
+		n = snprintf(suffix, RTE_NODE_NAMESIZE, "%u", lcore->core_id);
+	else
+		n = snprintf(suffix, RTE_NODE_NAMESIZE, "%u-%d", lcore->core_id, id);
+
+	if (lcore->generation && n > 0 && n < RTE_NODE_NAMESIZE)
+		snprintf(suffix + n, RTE_NODE_NAMESIZE - n, ".%u", lcore->generation);
+}
+
+/* rte_node_ethdev_rx_config() and rte_node_ethdev_tx_config() clone a
+ * node named after the port and queue, a second call for the same pair
+ * fails. Each pair is configured once, later graphs reuse the clone and
+ * an rx clone gets the edge it forwards on pointed at the new chain.
+ */
+struct lcore_ethdev_node {
+	uint16_t link_id;
+	uint16_t queue_id;
+	uint8_t rx;
+	rte_node_t node_id;
+	rte_edge_t next_edge;
+};
+
+static struct lcore_ethdev_node *lcore_ethdev_nodes;
+static uint32_t lcore_nb_ethdev_nodes;
+
+static struct lcore_ethdev_node *
+lcore_ethdev_node_get(uint16_t link_id, uint16_t queue_id, uint8_t rx)
+{
+	struct lcore_ethdev_node *e;
+	uint32_t i;
+
+	for (i = 0; i < lcore_nb_ethdev_nodes; i++) {
+		e = &lcore_ethdev_nodes[i];
+		if (e->link_id == link_id && e->queue_id == queue_id && e->rx == rx)
+			return e;
+	}
+
+	return NULL;
+}
+
+static struct lcore_ethdev_node *
+lcore_ethdev_node_add(uint16_t link_id, uint16_t queue_id, uint8_t rx, rte_node_t node_id)
+{
+	struct lcore_ethdev_node *e;
+
+	e = rte_realloc(lcore_ethdev_nodes, (lcore_nb_ethdev_nodes + 1) * sizeof(*e), 0);
+	if (!e)
+		return NULL;
+
+	lcore_ethdev_nodes = e;
+	e = &lcore_ethdev_nodes[lcore_nb_ethdev_nodes++];
+	e->link_id = link_id;
+	e->queue_id = queue_id;
+	e->rx = rx;
+	e->node_id = node_id;
+	e->next_edge = RTE_EDGE_ID_INVALID;
+	return e;
+}
+
+static rte_edge_t
+lcore_node_edge_find(rte_node_t node_id, char const *name)
+{
+	rte_edge_t i, nb_edges, edge = RTE_EDGE_ID_INVALID;
+	char **names;
+	size_t size;
+
+	size = rte_node_edge_get(node_id, NULL);
+	if (size == 0 || size == RTE_EDGE_ID_INVALID)
+		return RTE_EDGE_ID_INVALID;
+
+	names = malloc(size);
+	if (!names)
+		return RTE_EDGE_ID_INVALID;
+
+	nb_edges = rte_node_edge_get(node_id, names);
+	for (i = 0; i < nb_edges; i++) {
+		if (strcmp(names[i], name) == 0) {
+			edge = i;
+			break;
+		}
+	}
+
+	free(names);
+	return edge;
+}
+
+static rte_node_t
+lcore_ethdev_rx_node(struct rte_node_ethdev_rx_config *rx_config)
+{
+	struct lcore_ethdev_node *e;
+	char const *next_node = rx_config->next_node;
+	rte_node_t node_id;
+
+	e = lcore_ethdev_node_get(rx_config->link_id, rx_config->queue_id, 1);
+	if (e) {
+		if (e->next_edge == RTE_EDGE_ID_INVALID ||
+		    rte_node_edge_update(e->node_id, e->next_edge, &next_node, 1) != 1)
+			return RTE_NODE_ID_INVALID;
+		return e->node_id;
+	}
+
+	node_id = rte_node_ethdev_rx_config(rx_config);
+	if (node_id == RTE_NODE_ID_INVALID)
+		return node_id;
+
+	e = lcore_ethdev_node_add(rx_config->link_id, rx_config->queue_id, 1, node_id);
+	if (!e)
+		return RTE_NODE_ID_INVALID;
+
+	/* Not found leaves the clone usable, only not for a rebuild */
+	e->next_edge = lcore_node_edge_find(node_id, next_node);
+	return node_id;
+}
+
+static rte_node_t
+lcore_ethdev_tx_node(struct rte_node_ethdev_tx_config *tx_config)
+{
+	struct lcore_ethdev_node *e;
+	rte_node_t node_id;
+
+	e = lcore_ethdev_node_get(tx_config->link_id, tx_config->queue_id, 0);
+	if (e)
+		return e->node_id;
+
+	node_id = rte_node_ethdev_tx_config(tx_config);
+	if (node_id == RTE_NODE_ID_INVALID)
+		return node_id;
+
+	if (!lcore_ethdev_node_add(tx_config->link_id, tx_config->queue_id, 0, node_id))
+		return RTE_NODE_ID_INVALID;
+
+	return node_id;
+}
+
 int
 lcore_config_populate(struct stage_config *stage_config, uint8_t ev_port_id, struct lcore_params *lcore)
 {
 	struct stage_link_queue_config *qconf;
+	struct mempool *m;
 	int i;
 
 	/* generic config */
@@ -53,7 +261,22 @@ lcore_config_populate(struct stage_config *stage_config, uint8_t ev_port_id, str
 	lcore->ev_port_config.dequeue_depth = 128;
 	lcore->ev_port_config.enqueue_depth = 128;
 	lcore->ev_port_config.new_event_threshold = 4096;
+	lcore->ev_id = (stage_config->ev_id < 0) ? 0 : stage_config->ev_id;
 	lcore->ev_port_id = ev_port_id;
+	lcore->ev_out_flow_hash = stage_config->flow_hash;
+	lcore->nb_ev_out_queues = 0;
+	lcore->ev_out_vector_size = 0;
+	lcore->ev_out_vector_mp = NULL;
+	lcore->flow_cache_size = stage_config->flow_cache;
+	lcore->conntrack_size = stage_config->conntrack;
+	lcore->conntrack_strict = stage_config->conntrack_strict;
+	if (stage_config->vector.size) {
+		m = mempool_config_get(stage_config->vector.mp_name);
+		if (!m)
+			return -ENOENT;
+		lcore->ev_out_vector_size = stage_config->vector.size;
+		lcore->ev_out_vector_mp = m->mp;
+	}
 
 	/* event queue config */
 	switch (stage_config->type) {
@@ -66,7 +289,6 @@ lcore_config_populate(struct stage_config *stage_config, uint8_t ev_port_id, str
 		lcore->ev_in_queue_needed = 1;
 		lcore->ev_in_queue_sched_type = stage_config->ev_queue.sched_type_in;
 		lcore->ev_in_queue = stage_config->ev_queue.in;
-		strncpy(lcore->ev_in_queue_mp_name, stage_config->ev_queue.mp_name, RTE_MEMPOOL_NAMESIZE);
 		lcore->ev_out_queue_needed = 1;
 		lcore->ev_out_queue_sched_type = stage_config->ev_queue.sched_type_out;
 		lcore->ev_out_queue = stage_config->ev_queue.out;
@@ -75,7 +297,6 @@ lcore_config_populate(struct stage_config *stage_config, uint8_t ev_port_id, str
 		lcore->ev_in_queue_needed = 1;
 		lcore->ev_in_queue_sched_type = stage_config->ev_queue.sched_type_in;
 		lcore->ev_in_queue = stage_config->ev_queue.in;
-		strncpy(lcore->ev_in_queue_mp_name, stage_config->ev_queue.mp_name, RTE_MEMPOOL_NAMESIZE);
 		break;
 	default:
 		break;
@@ -102,18 +323,1012 @@ lcore_config_populate(struct stage_config *stage_config, uint8_t ev_port_id, str
 	return 0;
 }
 
-int
-lcore_graph_populate(struct lcore_params *lcore, bool enable_graph_pcap)
+static int
+lcore_graph_reassembly_add(struct lcore_params *lcore, char const **next_node,
+			   char const **node_patterns, uint16_t *nb_node_patterns)
+{
+	uint8_t links[RTE_MAX_ETHPORTS] = { 0 };
+	char node_suffix[RTE_NODE_NAMESIZE];
+	char const *node_name;
+	bool enabled = false;
+	rte_node_t node_id;
+	uint16_t link_id;
+	int rc, i;
+
+	for (i = 0; i < lcore->nb_link_in_queues; i++) {
+		link_id = lcore->link_in_queues[i].link_id;
+		links[link_id] = link_reassembly_enabled(link_id);
+		enabled |= links[link_id];
+	}
+
+	if (!enabled)
+		return 0;
+
+	lcore_node_suffix(lcore, node_suffix, -1);
+	node_id = ip_reassembly_node_clone(node_suffix);
+	if (node_id == RTE_NODE_ID_INVALID) {
+		RTE_LOG(INFO, USER1, "IP reassembly node (%s) create failed\n", node_suffix);
+		return -ENOMEM;
+	}
+
+	rc = ip_reassembly_node_data_add(node_id, lcore->core_id, links, *next_node);
+	if (rc < 0) {
+		RTE_LOG(INFO, USER1, "IP reassembly node (%s) add (%s) failed\n",
+			node_suffix, *next_node);
+		return rc;
+	}
+
+	node_name = rte_node_id_to_name(node_id);
+	if (node_name == NULL) {
+		RTE_LOG(INFO, USER1, "IP reassembly node (%s) get name failed\n", node_suffix);
+		return -ENOENT;
+	}
+
+	node_patterns[(*nb_node_patterns)++] = strdup(node_name);
+	*next_node = node_name;
+	return 0;
+}
+
+static int
+lcore_tunnel_on_link(struct tunnel_config *config, void *data)
+{
+	uint16_t *link_id = data;
+
+	/* Stops the walk at the first match */
+	return config->link_id == *link_id ? -EEXIST : 0;
+}
+
+/* Terminate tunnels on the lcores polling an underlay link, whatever is
+ * not for a local endpoint goes on to next_node.
+ */
+static int
+lcore_graph_tunnel_decap_add(struct lcore_params *lcore, char const **next_node,
+			     char const **node_patterns, uint16_t *nb_node_patterns)
+{
+	char node_suffix[RTE_NODE_NAMESIZE];
+	char const *node_name;
+	bool enabled = false;
+	rte_node_t node_id;
+	uint16_t link_id;
+	int rc, i;
+
+	if (!vtep_decap_enabled)
+		return 0;
+
+	for (i = 0; i < lcore->nb_link_in_queues && !enabled; i++) {
+		link_id = lcore->link_in_queues[i].link_id;
+		enabled = tunnel_config_walk(lcore_tunnel_on_link, &link_id) < 0;
+	}
+
+	if (!enabled)
+		return 0;
+
+	lcore_node_suffix(lcore, node_suffix, -1);
+	node_id = vtep_decap_node_clone(node_suffix);
+	if (node_id == RTE_NODE_ID_INVALID) {
+		RTE_LOG(INFO, USER1, "Tunnel decap node (%s) create failed\n", node_suffix);
+		return -ENOMEM;
+	}
+
+	rc = vtep_decap_node_data_add(node_id, *next_node);
+	if (rc < 0) {
+		RTE_LOG(INFO, USER1, "Tunnel decap node (%s) add (%s) failed\n",
+			node_suffix, *next_node);
+		return rc;
+	}
+
+	node_name = rte_node_id_to_name(node_id);
+	if (node_name == NULL) {
+		RTE_LOG(INFO, USER1, "Tunnel decap node (%s) get name failed\n", node_suffix);
+		return -ENOENT;
+	}
+
+	node_patterns[(*nb_node_patterns)++] = strdup(node_name);
+	*next_node = node_name;
+	return 0;
+}
+
+static int
+lcore_graph_ethdev_rx_add(struct lcore_params *lcore, char const *next_node,
+			  char const **node_patterns, uint16_t *nb_node_patterns)
 {
-	char const *node_name, *ev_node_name, *link_node_name;
-	rte_node_t node_id, ev_node_id, link_node_id;
 	struct rte_node_ethdev_rx_config rx_config;
+	char node_suffix[RTE_NODE_NAMESIZE];
+	char const *link_node_name;
+	rte_node_t link_node_id;
+	int rc, i;
+
+	/* Built back to front, frames go ethdev_rx -> vlan_rx -> reassembly
+	 * -> tunnel decap -> acl -> policer -> next_node.
+	 */
+
+	/* Police what the ACL let through, it may have picked the policer */
+	if (policer_enabled() && lcore->nb_link_in_queues) {
+		lcore_node_suffix(lcore, node_suffix, -1);
+		link_node_id = policer_node_clone(node_suffix);
+		if (link_node_id == RTE_NODE_ID_INVALID) {
+			RTE_LOG(INFO, USER1, "Policer node (%s) create failed\n", node_suffix);
+			return -ENOMEM;
+		}
+
+		rc = policer_node_data_add(link_node_id, lcore->core_id, ip4_acl_enabled(),
+					   next_node);
+		if (rc < 0) {
+			RTE_LOG(INFO, USER1, "Policer node (%s) add (%s) failed\n",
+				node_suffix, next_node);
+			return rc;
+		}
+
+		next_node = rte_node_id_to_name(link_node_id);
+		if (next_node == NULL) {
+			RTE_LOG(INFO, USER1, "Policer node (%s) get name failed\n", node_suffix);
+			return -ENOENT;
+		}
+
+		node_patterns[(*nb_node_patterns)++] = strdup(next_node);
+	}
+
+	/* Filter after the vlan tag is gone, before any forwarding decision */
+	if (ip4_acl_enabled() && lcore->nb_link_in_queues) {
+		lcore_node_suffix(lcore, node_suffix, -1);
+		link_node_id = ip4_acl_node_clone(node_suffix);
+		if (link_node_id == RTE_NODE_ID_INVALID) {
+			RTE_LOG(INFO, USER1, "ACL node (%s) create failed\n", node_suffix);
+			return -ENOMEM;
+		}
+
+		rc = ip4_acl_node_data_add(link_node_id, next_node);
+		if (rc < 0) {
+			RTE_LOG(INFO, USER1, "ACL node (%s) add (%s) failed\n",
+				node_suffix, next_node);
+			return rc;
+		}
+
+		next_node = rte_node_id_to_name(link_node_id);
+		if (next_node == NULL) {
+			RTE_LOG(INFO, USER1, "ACL node (%s) get name failed\n", node_suffix);
+			return -ENOENT;
+		}
+
+		node_patterns[(*nb_node_patterns)++] = strdup(next_node);
+	}
+
+	/* Inner frames are routed, the rest continues to the filters */
+	if (lcore->nb_link_in_queues) {
+		rc = lcore_graph_tunnel_decap_add(lcore, &next_node, node_patterns,
+						  nb_node_patterns);
+		if (rc < 0)
+			return rc;
+	}
+
+	/* Put fragments back together so the ACL and later nodes see ports */
+	if (lcore->nb_link_in_queues) {
+		rc = lcore_graph_reassembly_add(lcore, &next_node, node_patterns, nb_node_patterns);
+		if (rc < 0)
+			return rc;
+	}
+
+	/* Classify into the internal vlan before anything else sees the frame */
+	if (vlan_enabled() && lcore->nb_link_in_queues) {
+		lcore_node_suffix(lcore, node_suffix, -1);
+		link_node_id = vlan_rx_node_clone(node_suffix);
+		if (link_node_id == RTE_NODE_ID_INVALID) {
+			RTE_LOG(INFO, USER1, "VLAN rx node (%s) create failed\n", node_suffix);
+			return -ENOMEM;
+		}
+
+		rc = vlan_rx_node_data_set_next(link_node_id, next_node);
+		if (rc < 0) {
+			RTE_LOG(INFO, USER1, "VLAN rx node (%s) set next (%s) failed\n",
+				node_suffix, next_node);
+			return rc;
+		}
+
+		next_node = rte_node_id_to_name(link_node_id);
+		if (next_node == NULL) {
+			RTE_LOG(INFO, USER1, "VLAN rx node (%s) get name failed\n", node_suffix);
+			return -ENOENT;
+		}
+
+		node_patterns[(*nb_node_patterns)++] = strdup(next_node);
+	}
+
+	for (i = 0; i < lcore->nb_link_in_queues; i++) {
+		rx_config.link_id = lcore->link_in_queues[i].link_id;
+		rx_config.queue_id = lcore->link_in_queues[i].queue_id;
+		strncpy(rx_config.next_node, next_node, sizeof(rx_config.next_node));
+		link_node_id = lcore_ethdev_rx_node(&rx_config);
+		if (link_node_id == RTE_NODE_ID_INVALID) {
+			RTE_LOG(INFO, USER1, "Ethdev rx node (%u:%u) create failed\n",
+				rx_config.link_id, rx_config.queue_id);
+			return -ENOMEM;
+		}
+
+		link_node_name = rte_node_id_to_name(link_node_id);
+		if (link_node_name == NULL) {
+			RTE_LOG(INFO, USER1, "Ethdev rx node (%u:%u) get name failed\n",
+				rx_config.link_id, rx_config.queue_id);
+			return -ENOENT;
+		}
+
+		node_patterns[(*nb_node_patterns)++] = strdup(link_node_name);
+	}
+
+	return 0;
+}
+
+struct lcore_bridge_ingress {
+	rte_node_t fwd_node_id;
+	char const *bridge_node_name;
+};
+
+static int
+lcore_bridge_ingress_add(uint16_t link_id, __rte_unused uint16_t peer_link_id, void *data)
+{
+	struct lcore_bridge_ingress *ingress = data;
+
+	if (l2_bridge_domain_get(link_id) == L2_BRIDGE_ID_INVALID)
+		return 0;
+
+	return forward_node_data_add(ingress->fwd_node_id, link_id,
+				     ingress->bridge_node_name);
+}
+
+static int
+lcore_graph_bridge_add(struct lcore_params *lcore, rte_node_t *bridge_node_id,
+		       char const **node_patterns, uint16_t *nb_node_patterns)
+{
+	char node_suffix[RTE_NODE_NAMESIZE];
+	char const *node_name;
+	rte_node_t node_id;
+
+	lcore_node_suffix(lcore, node_suffix, -1);
+	node_id = l2_bridge_node_clone(node_suffix);
+	if (node_id == RTE_NODE_ID_INVALID) {
+		RTE_LOG(INFO, USER1, "L2 bridge node (%s) create failed\n", node_suffix);
+		return -ENOMEM;
+	}
+
+	node_name = rte_node_id_to_name(node_id);
+	if (node_name == NULL) {
+		RTE_LOG(INFO, USER1, "L2 bridge node (%s) get name failed\n", node_suffix);
+		return -ENOENT;
+	}
+
+	node_patterns[(*nb_node_patterns)++] = strdup(node_name);
+	*bridge_node_id = node_id;
+	return 0;
+}
+
+/* The flow cache sits between forward and the bridge, misses fall
+ * through to the bridge which learns the decision back into it.
+ */
+static int
+lcore_graph_flow_cache_add(struct lcore_params *lcore, rte_node_t bridge_node_id,
+			   rte_node_t *cache_node_id,
+			   char const **node_patterns, uint16_t *nb_node_patterns)
+{
+	char node_suffix[RTE_NODE_NAMESIZE];
+	char const *node_name;
+	rte_node_t node_id;
+	int rc;
+
+	lcore_node_suffix(lcore, node_suffix, -1);
+	node_id = flow_cache_node_clone(node_suffix);
+	if (node_id == RTE_NODE_ID_INVALID) {
+		RTE_LOG(INFO, USER1, "Flow cache node (%s) create failed\n", node_suffix);
+		return -ENOMEM;
+	}
+
+	node_name = rte_node_id_to_name(node_id);
+	if (node_name == NULL) {
+		RTE_LOG(INFO, USER1, "Flow cache node (%s) get name failed\n", node_suffix);
+		return -ENOENT;
+	}
+
+	rc = flow_cache_node_data_add(node_id, lcore->core_id, lcore->flow_cache_size,
+				      rte_node_id_to_name(bridge_node_id));
+	if (rc < 0) {
+		RTE_LOG(INFO, USER1, "Flow cache node (%s) data add failed\n", node_suffix);
+		return rc;
+	}
+
+	node_patterns[(*nb_node_patterns)++] = strdup(node_name);
+	*cache_node_id = node_id;
+	return 0;
+}
+
+/* Tagged links get a vs_vlan_tx clone in front of their ethdev tx node,
+ * the returned name is what upstream nodes should use as egress.
+ */
+static int
+lcore_graph_vlan_tx_add(struct lcore_params *lcore, uint16_t link_id,
+			char const **link_node_name,
+			char const **node_patterns, uint16_t *nb_node_patterns)
+{
+	char node_suffix[RTE_NODE_NAMESIZE];
+	char const *node_name;
+	rte_node_t node_id;
+	int rc;
+
+	if (vlan_links[link_id].mode == VLAN_MODE_NONE)
+		return 0;
+
+	lcore_node_suffix(lcore, node_suffix, link_id);
+	node_id = vlan_tx_node_clone(node_suffix);
+	if (node_id == RTE_NODE_ID_INVALID) {
+		RTE_LOG(INFO, USER1, "VLAN tx node (%s) create failed\n", node_suffix);
+		return -ENOMEM;
+	}
+
+	rc = vlan_tx_node_data_add(node_id, link_id, *link_node_name);
+	if (rc < 0) {
+		RTE_LOG(INFO, USER1, "VLAN tx node (%s) add (%s) failed\n",
+			node_suffix, *link_node_name);
+		return rc;
+	}
+
+	node_name = rte_node_id_to_name(node_id);
+	if (node_name == NULL) {
+		RTE_LOG(INFO, USER1, "VLAN tx node (%s) get name failed\n", node_suffix);
+		return -ENOENT;
+	}
+
+	node_patterns[(*nb_node_patterns)++] = strdup(node_name);
+	*link_node_name = node_name;
+	return 0;
+}
+
+/* Packets are classified and queued in front of the link, a source
+ * node dequeues at the scheduled rate.
+ */
+static int
+lcore_graph_tx_sched_add(struct lcore_params *lcore, uint16_t link_id,
+			 char const **link_node_name,
+			 char const **node_patterns, uint16_t *nb_node_patterns)
+{
+	struct tx_sched_link_config *config = tx_sched_config_get_link(link_id);
+	rte_node_t classify_id, enq_id, deq_id;
+	char node_suffix[RTE_NODE_NAMESIZE];
+	char const *node_name;
+	int rc;
+
+	if (!config)
+		return 0;
+
+	lcore_node_suffix(lcore, node_suffix, link_id);
+	classify_id = tx_sched_classify_node_clone(node_suffix);
+	enq_id = tx_sched_node_clone(node_suffix);
+	deq_id = tx_sched_deq_node_clone(node_suffix);
+	if (classify_id == RTE_NODE_ID_INVALID || enq_id == RTE_NODE_ID_INVALID ||
+	    deq_id == RTE_NODE_ID_INVALID) {
+		RTE_LOG(INFO, USER1, "Tx sched nodes (%s) create failed\n", node_suffix);
+		return -ENOMEM;
+	}
+
+	rc = tx_sched_node_data_add(classify_id, enq_id, deq_id, lcore->core_id, link_id,
+				    config, tx_sched_config_get_share(link_id),
+				    *link_node_name);
+	if (rc < 0) {
+		RTE_LOG(INFO, USER1, "Tx sched nodes (%s) add (%s) failed\n",
+			node_suffix, *link_node_name);
+		return rc;
+	}
+
+	node_patterns[(*nb_node_patterns)++] = strdup(rte_node_id_to_name(enq_id));
+	node_patterns[(*nb_node_patterns)++] = strdup(rte_node_id_to_name(deq_id));
+
+	node_name = rte_node_id_to_name(classify_id);
+	if (node_name == NULL) {
+		RTE_LOG(INFO, USER1, "Tx sched node (%s) get name failed\n", node_suffix);
+		return -ENOENT;
+	}
+
+	node_patterns[(*nb_node_patterns)++] = strdup(node_name);
+	*link_node_name = node_name;
+	return 0;
+}
+
+/* Only links that can be handed more than they carry need it: a larger
+ * MTU elsewhere, or tunnel headers added on the way out.
+ */
+static int
+lcore_graph_ip_frag_add(struct lcore_params *lcore, uint16_t link_id,
+			char const **link_node_name,
+			char const **node_patterns, uint16_t *nb_node_patterns)
+{
+	char node_suffix[RTE_NODE_NAMESIZE];
+	uint32_t mtu = link_mtu_get(link_id);
+	char const *node_name;
+	rte_node_t node_id;
+	int rc;
+
+	if (mtu >= link_mtu_max() && tunnel_config_walk(lcore_tunnel_on_link, &link_id) == 0)
+		return 0;
+
+	lcore_node_suffix(lcore, node_suffix, link_id);
+	node_id = ip_frag_node_clone(node_suffix);
+	if (node_id == RTE_NODE_ID_INVALID) {
+		RTE_LOG(INFO, USER1, "IP frag node (%s) create failed\n", node_suffix);
+		return -ENOMEM;
+	}
+
+	rc = ip_frag_node_data_add(node_id, lcore->core_id, mtu, *link_node_name);
+	if (rc < 0) {
+		RTE_LOG(INFO, USER1, "IP frag node (%s) add (%s) failed\n",
+			node_suffix, *link_node_name);
+		return rc;
+	}
+
+	node_name = rte_node_id_to_name(node_id);
+	if (node_name == NULL) {
+		RTE_LOG(INFO, USER1, "IP frag node (%s) get name failed\n", node_suffix);
+		return -ENOENT;
+	}
+
+	node_patterns[(*nb_node_patterns)++] = strdup(node_name);
+	*link_node_name = node_name;
+	return 0;
+}
+
+struct lcore_tunnel_egress {
+	struct lcore_params *lcore;
+	rte_node_t fwd_node_id;
+	char const **egress;
+	char const **node_patterns;
+	uint16_t *nb_node_patterns;
+};
+
+/* Overlay ingress goes through an encap clone to this lcore's underlay
+ * egress, taking precedence over the overlay link's peer.
+ */
+static int
+lcore_tunnel_encap_add(struct tunnel_config *config, void *data)
+{
+	struct lcore_tunnel_egress *tunnel = data;
+	char node_suffix[RTE_NODE_NAMESIZE];
+	char const *node_name;
+	rte_node_t node_id;
+	int rc;
+
+	if (config->overlay_link_id == LINK_ID_MAX ||
+	    tunnel->egress[config->link_id] == NULL)
+		return 0;
+
+	lcore_node_suffix(tunnel->lcore, node_suffix, config->tunnel_id);
+	node_id = vtep_encap_node_clone(node_suffix);
+	if (node_id == RTE_NODE_ID_INVALID) {
+		RTE_LOG(INFO, USER1, "Tunnel encap node (%s) create failed\n", node_suffix);
+		return -ENOMEM;
+	}
+
+	rc = vtep_encap_node_data_add(node_id, config->tunnel_id,
+				      tunnel->egress[config->link_id]);
+	if (rc < 0) {
+		RTE_LOG(INFO, USER1, "Tunnel encap node (%s) add (%s) failed\n",
+			node_suffix, tunnel->egress[config->link_id]);
+		return rc;
+	}
+
+	node_name = rte_node_id_to_name(node_id);
+	if (node_name == NULL) {
+		RTE_LOG(INFO, USER1, "Tunnel encap node (%s) get name failed\n", node_suffix);
+		return -ENOENT;
+	}
+
+	tunnel->node_patterns[(*tunnel->nb_node_patterns)++] = strdup(node_name);
+	return forward_node_data_add(tunnel->fwd_node_id, config->overlay_link_id, node_name);
+}
+
+/* What the host sends on a link's exception port leaves through that
+ * link, polled by the lcores that can send on it.
+ */
+static int
+lcore_graph_exception_rx_add(struct lcore_params *lcore, char const **egress,
+			     char const **node_patterns, uint16_t *nb_node_patterns)
+{
+	uint16_t queues[EXCEPTION_POLLS_MAX];
+	char node_suffix[RTE_NODE_NAMESIZE];
+	rte_node_t node_id = RTE_NODE_ID_INVALID;
+	uint16_t link_id, nb_queues, nb_polls = 0, i;
+	char const *node_name;
+	int rc;
+
+	nb_queues = exception_config_get_rx_queues(lcore->core_id, queues, RTE_DIM(queues));
+	if (!exception_enabled() || nb_queues == 0)
+		return 0;
+
+	lcore_node_suffix(lcore, node_suffix, -1);
+	for (link_id = 0; link_id < RTE_MAX_ETHPORTS; link_id++) {
+		if (egress[link_id] == NULL)
+			continue;
+
+		if (node_id == RTE_NODE_ID_INVALID) {
+			node_id = exception_rx_node_clone(node_suffix);
+			if (node_id == RTE_NODE_ID_INVALID) {
+				RTE_LOG(INFO, USER1, "Exception rx node (%s) create failed\n",
+					node_suffix);
+				return -ENOMEM;
+			}
+		}
+
+		for (i = 0; i < nb_queues; i++) {
+			rc = exception_rx_node_data_add(node_id, link_id, queues[i],
+							egress[link_id]);
+			/* Link without an exception port */
+			if (rc == -EINVAL)
+				break;
+			if (rc < 0) {
+				RTE_LOG(INFO, USER1, "Exception rx node (%s) add (%s) failed\n",
+					node_suffix, egress[link_id]);
+				return rc;
+			}
+			nb_polls++;
+		}
+	}
+
+	if (nb_polls == 0)
+		return 0;
+
+	node_name = rte_node_id_to_name(node_id);
+	if (node_name == NULL) {
+		RTE_LOG(INFO, USER1, "Exception rx node (%s) get name failed\n", node_suffix);
+		return -ENOENT;
+	}
+
+	node_patterns[(*nb_node_patterns)++] = strdup(node_name);
+	return 0;
+}
+
+static int
+lcore_graph_forward_add(struct lcore_params *lcore, char const **fwd_node_name,
+			char const **node_patterns, uint16_t *nb_node_patterns)
+{
+	rte_node_t node_id, link_node_id, bridge_node_id = RTE_NODE_ID_INVALID;
+	rte_node_t cache_node_id = RTE_NODE_ID_INVALID;
 	struct rte_node_ethdev_tx_config tx_config;
+	char const *node_name, *link_node_name;
+	char const *egress[RTE_MAX_ETHPORTS] = { NULL };
+	struct lcore_tunnel_egress tunnel;
+	struct lcore_bridge_ingress ingress;
+	char node_suffix[RTE_NODE_NAMESIZE];
+	uint16_t peer_link_id;
+	int rc, i;
+
+	lcore_node_suffix(lcore, node_suffix, -1);
+	node_id = forward_node_clone(node_suffix);
+	if (node_id == RTE_NODE_ID_INVALID) {
+		RTE_LOG(INFO, USER1, "Forward node (%s) create failed\n", node_suffix);
+		return -ENOMEM;
+	}
+
+	node_name = rte_node_id_to_name(node_id);
+	if (node_name == NULL) {
+		RTE_LOG(INFO, USER1, "Forward node (%s) get name failed\n", node_suffix);
+		return -ENOENT;
+	}
+
+	node_patterns[(*nb_node_patterns)++] = strdup(node_name);
+
+	/* Bridged links bypass their peer and go through the FDB */
+	if (l2_bridge_enabled()) {
+		rc = lcore_graph_bridge_add(lcore, &bridge_node_id,
+					    node_patterns, nb_node_patterns);
+		if (rc < 0)
+			return rc;
+
+		if (lcore->flow_cache_size) {
+			rc = lcore_graph_flow_cache_add(lcore, bridge_node_id, &cache_node_id,
+							node_patterns, nb_node_patterns);
+			if (rc < 0)
+				return rc;
+		}
+	}
+	for (i = 0; i < lcore->nb_link_out_queues; i++) {
+		tx_config.link_id = lcore->link_out_queues[i].link_id;
+		tx_config.queue_id = lcore->link_out_queues[i].queue_id;
+		link_node_id = lcore_ethdev_tx_node(&tx_config);
+		if (link_node_id == RTE_NODE_ID_INVALID) {
+			RTE_LOG(INFO, USER1, "Ethdev tx node (%u:%u) create failed\n",
+				tx_config.link_id, tx_config.queue_id);
+			return -ENOMEM;
+		}
+
+		link_node_name = rte_node_id_to_name(link_node_id);
+		if (link_node_name == NULL) {
+			RTE_LOG(INFO, USER1, "Ethdev tx node (%u:%u) get name failed\n",
+				tx_config.link_id, tx_config.queue_id);
+			return -ENOENT;
+		}
+
+		node_patterns[(*nb_node_patterns)++] = strdup(link_node_name);
+
+		/* Built back to front, frames go ip_frag -> tx_sched -> vlan_tx
+		 * -> ethdev_tx so fragments are tagged like any other frame.
+		 */
+		rc = lcore_graph_vlan_tx_add(lcore, tx_config.link_id, &link_node_name,
+					     node_patterns, nb_node_patterns);
+		if (rc < 0)
+			return rc;
+
+		rc = lcore_graph_tx_sched_add(lcore, tx_config.link_id, &link_node_name,
+					      node_patterns, nb_node_patterns);
+		if (rc < 0)
+			return rc;
+
+		rc = lcore_graph_ip_frag_add(lcore, tx_config.link_id, &link_node_name,
+					     node_patterns, nb_node_patterns);
+		if (rc < 0)
+			return rc;
+
+		egress[tx_config.link_id] = link_node_name;
+		if (bridge_node_id != RTE_NODE_ID_INVALID &&
+		    l2_bridge_domain_get(tx_config.link_id) != L2_BRIDGE_ID_INVALID) {
+			rc = l2_bridge_node_data_add(bridge_node_id,
+						     tx_config.link_id,
+						     link_node_name);
+			if (rc < 0) {
+				RTE_LOG(INFO, USER1, "L2 bridge node (%s) add (%s) failed\n",
+					node_suffix, link_node_name);
+				return rc;
+			}
+
+			if (cache_node_id != RTE_NODE_ID_INVALID) {
+				rc = flow_cache_node_data_add_egress(cache_node_id,
+								     tx_config.link_id,
+								     link_node_name);
+				if (rc < 0) {
+					RTE_LOG(INFO, USER1, "Flow cache node (%s) add (%s) failed\n",
+						node_suffix, link_node_name);
+					return rc;
+				}
+			}
+			continue;
+		}
+
+		rc = link_get_peer(tx_config.link_id, &peer_link_id);
+		if (rc < 0) {
+			RTE_LOG(INFO, USER1, "link_get_peer (%u) failed\n", tx_config.link_id);
+			continue;
+		}
+
+		rc = forward_node_data_add(
+			node_id,
+			peer_link_id,
+			link_node_name);
+		if (rc < 0) {
+			RTE_LOG(INFO, USER1, "Forward node (%s) add (%s) failed\n",
+				node_suffix, link_node_name);
+			return rc;
+		}
+	}
+
+	rc = lcore_graph_exception_rx_add(lcore, egress, node_patterns, nb_node_patterns);
+	if (rc < 0)
+		return rc;
+
+	tunnel.lcore = lcore;
+	tunnel.fwd_node_id = node_id;
+	tunnel.egress = egress;
+	tunnel.node_patterns = node_patterns;
+	tunnel.nb_node_patterns = nb_node_patterns;
+	rc = tunnel_config_walk(lcore_tunnel_encap_add, &tunnel);
+	if (rc < 0)
+		return rc;
+
+	if (bridge_node_id != RTE_NODE_ID_INVALID) {
+		ingress.fwd_node_id = node_id;
+		ingress.bridge_node_name = rte_node_id_to_name(
+			(cache_node_id != RTE_NODE_ID_INVALID) ? cache_node_id : bridge_node_id);
+		rc = link_map_walk(lcore_bridge_ingress_add, &ingress);
+		if (rc < 0) {
+			RTE_LOG(INFO, USER1, "Forward node (%s) add (%s) failed\n",
+				node_suffix, ingress.bridge_node_name);
+			return rc;
+		}
+	}
+
+	*fwd_node_name = node_name;
+	return 0;
+}
+
+struct lcore_tx_adapter_egress {
+	struct adapter_params *adapter;
+	rte_node_t node_id;
+};
+
+static int
+lcore_tx_adapter_egress_add(uint16_t link_id, uint16_t peer_link_id, void *data)
+{
+	struct lcore_tx_adapter_egress *egress = data;
+	struct adapter_params *adapter = egress->adapter;
+
+	if (peer_link_id == LINK_ID_MAX ||
+	    adapter->tx.txq[peer_link_id] == ADAPTER_TXQ_INVALID)
+		return 0;
+
+	return eventdev_tx_node_data_add_egress(egress->node_id,
+						link_id,
+						peer_link_id,
+						adapter->tx.txq[peer_link_id]);
+}
+
+struct lcore_tx_adapter_bridge {
+	struct adapter_params *adapter;
+	rte_node_t ev_node_id;
+	rte_node_t fwd_node_id;
+	rte_node_t bridge_node_id;
+	char const *ev_node_name;
+	char const *bridge_node_name;
+	uint16_t nb_egress;
+};
+
+/* Bridged links send through the FDB and leave on the link it picked,
+ * everything else goes straight to the Tx adapter towards the peer.
+ */
+static int
+lcore_tx_adapter_bridge_add(uint16_t link_id, __rte_unused uint16_t peer_link_id, void *data)
+{
+	struct lcore_tx_adapter_bridge *bridge = data;
+	struct adapter_params *adapter = bridge->adapter;
+	int rc;
+
+	if (l2_bridge_domain_get(link_id) == L2_BRIDGE_ID_INVALID)
+		return forward_node_data_add(bridge->fwd_node_id, link_id,
+					     bridge->ev_node_name);
+
+	if (adapter->tx.txq[link_id] != ADAPTER_TXQ_INVALID) {
+		rc = l2_bridge_node_data_add(bridge->bridge_node_id, link_id,
+					     bridge->ev_node_name);
+		if (rc < 0)
+			return rc;
+
+		rc = eventdev_tx_node_data_add_egress(bridge->ev_node_id, link_id, link_id,
+						      adapter->tx.txq[link_id]);
+		if (rc < 0)
+			return rc;
+
+		bridge->nb_egress++;
+	}
+
+	return forward_node_data_add(bridge->fwd_node_id, link_id,
+				     bridge->bridge_node_name);
+}
+
+static int
+lcore_graph_tx_adapter_bridge_add(struct lcore_params *lcore, rte_node_t ev_node_id,
+				  char const **next_node,
+				  char const **node_patterns, uint16_t *nb_node_patterns)
+{
+	struct lcore_tx_adapter_bridge bridge = {
+		.adapter = adapter_params_get(lcore->ev_id),
+		.ev_node_id = ev_node_id,
+		.ev_node_name = *next_node,
+		.nb_egress = 0,
+	};
+	char node_suffix[RTE_NODE_NAMESIZE];
+	char const *fwd_node_name;
+	int rc;
+
+	lcore_node_suffix(lcore, node_suffix, -1);
+	bridge.fwd_node_id = forward_node_clone(node_suffix);
+	if (bridge.fwd_node_id == RTE_NODE_ID_INVALID) {
+		RTE_LOG(INFO, USER1, "Forward node (%s) create failed\n", node_suffix);
+		return -ENOMEM;
+	}
+
+	fwd_node_name = rte_node_id_to_name(bridge.fwd_node_id);
+	if (fwd_node_name == NULL)
+		return -ENOENT;
+
+	rc = lcore_graph_bridge_add(lcore, &bridge.bridge_node_id,
+				    node_patterns, nb_node_patterns);
+	if (rc < 0)
+		return rc;
+
+	bridge.bridge_node_name = rte_node_id_to_name(bridge.bridge_node_id);
+	rc = link_map_walk(lcore_tx_adapter_bridge_add, &bridge);
+	if (rc < 0) {
+		RTE_LOG(INFO, USER1, "L2 bridge node (%s) add tx adapter egress failed\n",
+			node_suffix);
+		return rc;
+	}
+
+	/* Without a bridged egress the node has no data and cannot run */
+	if (bridge.nb_egress == 0) {
+		(*nb_node_patterns)--;
+		free((void *)(uintptr_t)node_patterns[*nb_node_patterns]);
+		forward_node_data_rem(bridge.fwd_node_id);
+		return 0;
+	}
+
+	rc = l2_bridge_node_data_set_port(bridge.bridge_node_id);
+	if (rc < 0)
+		return rc;
+
+	node_patterns[(*nb_node_patterns)++] = strdup(fwd_node_name);
+	*next_node = fwd_node_name;
+	return 0;
+}
+
+static int
+lcore_graph_tx_adapter_set(struct lcore_params *lcore, rte_node_t ev_node_id,
+			   char const **next_node,
+			   char const **node_patterns, uint16_t *nb_node_patterns)
+{
+	struct adapter_params *adapter = adapter_params_get(lcore->ev_id);
+	struct lcore_tx_adapter_egress egress = {
+		.adapter = adapter,
+		.node_id = ev_node_id,
+	};
+	int rc;
+
+	if (!adapter->tx.enabled || adapter->tx.ev_queue != lcore->ev_out_queue)
+		return 0;
+
+	rc = eventdev_tx_node_data_set_tx_adapter(ev_node_id,
+			adapter->tx.internal_port ?
+				EVENTDEV_TX_ADAPTER_INTERNAL :
+				EVENTDEV_TX_ADAPTER_EVENT);
+	if (rc < 0)
+		return rc;
+
+	rc = link_map_walk(lcore_tx_adapter_egress_add, &egress);
+	if (rc < 0)
+		return rc;
+
+	if (!l2_bridge_enabled())
+		return 0;
+
+	return lcore_graph_tx_adapter_bridge_add(lcore, ev_node_id, next_node,
+						 node_patterns, nb_node_patterns);
+}
+
+/* Workers track connections between their event rx and tx nodes, the
+ * dispatcher is bypassed since the events are unpacked into mbufs. NAT,
+ * when configured, follows conntrack.
+ */
+static int
+lcore_graph_conntrack_add(struct lcore_params *lcore, rte_node_t ev_rx_node_id,
+			  char const *next_node,
+			  char const **node_patterns, uint16_t *nb_node_patterns)
+{
+	rte_node_t node_id, nat_node_id = RTE_NODE_ID_INVALID;
+	char const *node_name, *nat_node_name = NULL;
+	char node_suffix[RTE_NODE_NAMESIZE];
+	int rc;
+
+	lcore_node_suffix(lcore, node_suffix, -1);
+	if (nat_enabled()) {
+		nat_node_id = nat_node_clone(node_suffix);
+		if (nat_node_id == RTE_NODE_ID_INVALID) {
+			RTE_LOG(INFO, USER1, "NAT node (%s) create failed\n", node_suffix);
+			return -ENOMEM;
+		}
+
+		nat_node_name = rte_node_id_to_name(nat_node_id);
+		if (nat_node_name == NULL) {
+			RTE_LOG(INFO, USER1, "NAT node (%s) get name failed\n", node_suffix);
+			return -ENOENT;
+		}
+	}
+
+	node_id = conntrack_node_clone(node_suffix);
+	if (node_id == RTE_NODE_ID_INVALID) {
+		RTE_LOG(INFO, USER1, "Conntrack node (%s) create failed\n", node_suffix);
+		return -ENOMEM;
+	}
+
+	node_name = rte_node_id_to_name(node_id);
+	if (node_name == NULL) {
+		RTE_LOG(INFO, USER1, "Conntrack node (%s) get name failed\n", node_suffix);
+		return -ENOENT;
+	}
+
+	rc = conntrack_node_data_add(node_id, lcore->core_id, lcore->conntrack_size,
+				     lcore->conntrack_strict,
+				     nat_node_name ? nat_node_name : next_node);
+	if (rc < 0) {
+		RTE_LOG(INFO, USER1, "Conntrack node (%s) data add failed\n", node_suffix);
+		return rc;
+	}
+
+	/* The bindings are sized after the connection table */
+	if (nat_node_name) {
+		rc = nat_node_data_add(nat_node_id, lcore->core_id, next_node);
+		if (rc < 0) {
+			RTE_LOG(INFO, USER1, "NAT node (%s) data add failed\n", node_suffix);
+			return rc;
+		}
+
+		node_patterns[(*nb_node_patterns)++] = strdup(nat_node_name);
+	}
+
+	rc = eventdev_rx_node_data_set_next(ev_rx_node_id, node_name);
+	if (rc < 0) {
+		RTE_LOG(INFO, USER1, "Eventdev rx node set next (%s) failed\n", node_name);
+		return rc;
+	}
+
+	node_patterns[(*nb_node_patterns)++] = strdup(node_name);
+	return 0;
+}
+
+/* Run-to-completion lcores chain the stage nodes in list order in front
+ * of next_node. Every node is cloned for the lcore and its only edge is
+ * pointed at the next one. A node with more than one edge picks its own
+ * way out and cannot be chained.
+ */
+static int
+lcore_graph_user_add(struct lcore_params *lcore, char const **next_node,
+		     char const **node_patterns, uint16_t *nb_node_patterns)
+{
+	char const *names[GRAPH_MAX_PATTERNS];
 	char node_suffix[RTE_NODE_NAMESIZE];
+	char nodes[STAGE_GRAPH_NODES_MAX_LEN];
+	char const *node_name;
+	rte_node_t node_id;
+	int nb_names = 0;
+	char *saveptr;
+
+	/* The list is parsed again on every rebuild */
+	rte_strscpy(nodes, lcore->nodes, sizeof(nodes));
+	node_name = strtok_r(nodes, ",", &saveptr);
+	while (node_name != NULL && nb_names < GRAPH_MAX_PATTERNS) {
+		names[nb_names++] = node_name;
+		node_name = strtok_r(NULL, ",", &saveptr);
+	}
+
+	if (node_name != NULL)
+		return -ENOSPC;
+
+	lcore_node_suffix(lcore, node_suffix, -1);
+	while (nb_names--) {
+		node_id = rte_node_from_name(names[nb_names]);
+		if (node_id == RTE_NODE_ID_INVALID) {
+			RTE_LOG(INFO, USER1, "Stage node (%s) not found\n", names[nb_names]);
+			return -ENOENT;
+		}
+
+		if (rte_node_edge_count(node_id) > 1) {
+			RTE_LOG(INFO, USER1, "Stage node (%s) has more than one edge\n",
+				names[nb_names]);
+			return -ENOTSUP;
+		}
+
+		node_id = rte_node_clone(node_id, node_suffix);
+		if (node_id == RTE_NODE_ID_INVALID) {
+			RTE_LOG(INFO, USER1, "Stage node (%s) clone failed\n", names[nb_names]);
+			return -ENOMEM;
+		}
+
+		if (rte_node_edge_update(node_id, 0, next_node, 1) != 1) {
+			RTE_LOG(INFO, USER1, "Stage node (%s) add (%s) failed\n",
+				names[nb_names], *next_node);
+			return -EINVAL;
+		}
+
+		*next_node = rte_node_id_to_name(node_id);
+		if (*next_node == NULL)
+			return -ENOENT;
+
+		node_patterns[(*nb_node_patterns)++] = strdup(*next_node);
+	}
+
+	return 0;
+}
+
+int
+lcore_graph_populate(struct lcore_params *lcore, bool enable_graph_pcap)
+{
+	char const *node_name, *ev_node_name;
+	char node_suffix[RTE_NODE_NAMESIZE];
+	char nodes[STAGE_GRAPH_NODES_MAX_LEN];
 	char pcap_filename[NAME_MAX];
 	char const **node_patterns;
 	uint16_t nb_node_patterns;
-	uint16_t peer_link_id;
+	rte_node_t ev_node_id, ev_rx_node_id = RTE_NODE_ID_INVALID;
+	char *saveptr;
 	int rc = -EINVAL;
 	int i;
 
@@ -128,12 +1343,14 @@ lcore_graph_populate(struct lcore_params *lcore, bool enable_graph_pcap)
 		GRAPH_MAX_PATTERNS * sizeof(*node_patterns),
 		0);
 
-	rc = rte_event_port_setup(lcore->ev_id,
-					lcore->ev_port_id,
-					&lcore->ev_port_config);
-	if (rc < 0) {
-		rc = -rte_errno;
-		goto err;
+	if (lcore->ev_in_queue_needed || lcore->ev_out_queue_needed) {
+		rc = rte_event_port_setup(lcore->ev_id,
+					  lcore->ev_port_id,
+					  &lcore->ev_port_config);
+		if (rc < 0) {
+			rc = -rte_errno;
+			goto err;
+		}
 	}
 
 	if (lcore->ev_in_queue_needed) {
@@ -165,38 +1382,22 @@ lcore_graph_populate(struct lcore_params *lcore, bool enable_graph_pcap)
 
 		rc = eventdev_rx_node_data_add(ev_node_id,
 						lcore->ev_id,
-						lcore->ev_port_id,
-						lcore->ev_in_queue_mp_name);
+						lcore->ev_port_id);
 		if (rc < 0) {
 			RTE_LOG(INFO, USER1, "Eventdev rx node (%s) data add failed\n", ev_node_name);
 			goto err;
 		}
 		node_patterns[nb_node_patterns++] = strdup(ev_node_name);
+		ev_rx_node_id = ev_node_id;
+		lcore->ev_rx_node_id = ev_node_id;
 
 		if (lcore->ev_out_queue_needed) {
-			rc = eventdev_dispatcher_set_mempool(lcore->ev_in_queue_mp_name);
-			if (rc < 0) {
-				RTE_LOG(INFO, USER1, "Eventdev dispatcher node set mempool (%s) failed\n", 
-					lcore->ev_in_queue_mp_name);
-				goto err;
-			}
-
 			node_patterns[nb_node_patterns++] = strdup("vs_eventdev_dispatcher");
 		} else {
-			snprintf(node_suffix, sizeof(node_suffix), "%u", lcore->ev_port_id);
-			node_id = forward_node_clone(node_suffix);
-			if (node_id == RTE_NODE_ID_INVALID) {
-				RTE_LOG(INFO, USER1, "Forward node (%s) create failed\n", node_suffix);
-				rc = -ENOMEM;
+			rc = lcore_graph_forward_add(lcore, &node_name,
+						     node_patterns, &nb_node_patterns);
+			if (rc < 0)
 				goto err;
-			}
-
-			node_name = rte_node_id_to_name(node_id);
-			if (node_name == NULL) {
-				RTE_LOG(INFO, USER1, "Forward node (%s) get name failed\n", node_suffix);
-				rc = -ENOENT;
-				goto err;
-			}
 
 			rc = eventdev_rx_node_data_set_next(ev_node_id, node_name);
 			if (rc < 0) {
@@ -204,45 +1405,6 @@ lcore_graph_populate(struct lcore_params *lcore, bool enable_graph_pcap)
 					ev_node_name, node_name);
 				goto err;
 			}
-
-			node_patterns[nb_node_patterns++] = strdup(node_name);
-			for (i = 0; i < lcore->nb_link_out_queues; i++) {
-				tx_config.link_id = lcore->link_out_queues[i].link_id;
-				tx_config.queue_id = lcore->link_out_queues[i].queue_id;
-				link_node_id = rte_node_ethdev_tx_config(&tx_config);
-				if (link_node_id == RTE_NODE_ID_INVALID) {
-					RTE_LOG(INFO, USER1, "Ethdev tx node (%u:%u) create failed\n",
-						tx_config.link_id, tx_config.queue_id);
-					rc = -ENOMEM;
-					goto err;
-				}
-
-				link_node_name = rte_node_id_to_name(link_node_id);
-				if (link_node_name == NULL) {
-					RTE_LOG(INFO, USER1, "Ethdev tx node (%u:%u) get name failed\n",
-						tx_config.link_id, tx_config.queue_id);
-					rc = -ENOENT;
-					goto err;
-				}
-
-				node_patterns[nb_node_patterns++] = strdup(link_node_name);
-				rc = link_get_peer(tx_config.link_id, &peer_link_id);
-				if (rc < 0) {
-					RTE_LOG(INFO, USER1, "link_get_peer (%u) failed\n", tx_config.link_id);
-					continue;
-				}
-
-				rc = forward_node_data_add(
-					node_id,
-					peer_link_id,
-					link_node_name);
-				if (rc < 0) {
-					RTE_LOG(INFO, USER1, "Forward node (%s) add (%s) failed\n",
-						node_suffix, link_node_name);
-					goto err;
-
-				}
-			}
 		}
 	}
 
@@ -279,13 +1441,39 @@ lcore_graph_populate(struct lcore_params *lcore, bool enable_graph_pcap)
 				goto err;
 			}
 
-			rc = eventdev_dispatcher_add_next(ev_node_name, lcore->core_id);
+			rc = eventdev_tx_node_data_set_vector(ev_node_id,
+						lcore->ev_out_vector_size,
+						lcore->ev_out_vector_mp);
 			if (rc < 0) {
-				RTE_LOG(INFO, USER1, "Eventdev dispatcher node add next (%s) failed\n",
+				RTE_LOG(INFO, USER1, "Eventdev tx node (%s) set vector failed\n",
 					ev_node_name);
 				goto err;
 			}
 
+			node_name = ev_node_name;
+			rc = lcore_graph_tx_adapter_set(lcore, ev_node_id, &node_name,
+							node_patterns, &nb_node_patterns);
+			if (rc < 0) {
+				RTE_LOG(INFO, USER1, "Eventdev tx node (%s) set tx adapter failed\n",
+					ev_node_name);
+				goto err;
+			}
+
+			rc = eventdev_dispatcher_add_next(node_name, lcore->core_id);
+			if (rc < 0) {
+				RTE_LOG(INFO, USER1, "Eventdev dispatcher node add next (%s) failed\n",
+					node_name);
+				goto err;
+			}
+
+			if (lcore->conntrack_size) {
+				rc = lcore_graph_conntrack_add(lcore, ev_rx_node_id, node_name,
+							       node_patterns, &nb_node_patterns);
+				if (rc < 0)
+					goto err;
+			}
+
+			lcore->ev_tx_node_id = ev_node_id;
 			node_patterns[nb_node_patterns++] = strdup(ev_node_name);
 		} else {
 			rc = eventdev_tx_node_data_add(ev_node_id,
@@ -303,44 +1491,76 @@ lcore_graph_populate(struct lcore_params *lcore, bool enable_graph_pcap)
 				goto err;
 			}
 
-			node_patterns[nb_node_patterns++] = strdup(ev_node_name);
-			for (i = 0; i < lcore->nb_link_in_queues; i++) {
-				rx_config.link_id = lcore->link_in_queues[i].link_id;
-				rx_config.queue_id = lcore->link_in_queues[i].queue_id;
-				strncpy(rx_config.next_node, ev_node_name, sizeof(rx_config.next_node));
-				link_node_id = rte_node_ethdev_rx_config(&rx_config);
-				if (link_node_id == RTE_NODE_ID_INVALID) {
-					RTE_LOG(INFO, USER1, "Ethdev rx node (%u:%u) create failed\n",
-						rx_config.link_id, rx_config.queue_id);
-					rc = -ENOMEM;
-					goto err;
-				}
-
-				link_node_name = rte_node_id_to_name(link_node_id);
-				if (link_node_name == NULL) {
-					RTE_LOG(INFO, USER1, "Ethdev rx node (%u:%u) get name failed\n",
-						rx_config.link_id, rx_config.queue_id);
-					rc = -ENOENT;
-					goto err;
-				}
+			rc = eventdev_tx_node_data_set_flow_hash(ev_node_id,
+						lcore->ev_out_flow_hash);
+			if (rc < 0) {
+				RTE_LOG(INFO, USER1, "Eventdev tx node (%s) set flow hash failed\n",
+					ev_node_name);
+				goto err;
+			}
 
-				node_patterns[nb_node_patterns++] = strdup(link_node_name);
+			rc = eventdev_tx_node_data_set_vector(ev_node_id,
+						lcore->ev_out_vector_size,
+						lcore->ev_out_vector_mp);
+			if (rc < 0) {
+				RTE_LOG(INFO, USER1, "Eventdev tx node (%s) set vector failed\n",
+					ev_node_name);
+				goto err;
 			}
+
+			lcore->ev_tx_node_id = ev_node_id;
+			node_patterns[nb_node_patterns++] = strdup(ev_node_name);
+			rc = lcore_graph_ethdev_rx_add(lcore, ev_node_name,
+						       node_patterns, &nb_node_patterns);
+			if (rc < 0)
+				goto err;
+		}
+
+		rc = eventdev_tx_node_data_set_queues(ev_node_id,
+					lcore->ev_out_queues,
+					lcore->nb_ev_out_queues);
+		if (rc < 0) {
+			RTE_LOG(INFO, USER1, "Eventdev tx node (%s) set queues failed\n",
+				ev_node_name);
+			goto err;
 		}
 	}
 
-	node_name = strtok(lcore->nodes, ",");
-	while (node_name != NULL) {
-		node_patterns[nb_node_patterns++] = strdup(node_name);
-		node_name = strtok(NULL, ",");
+	/* Run-to-completion: ethdev_rx -> stage nodes -> vs_forward -> ethdev_tx */
+	if (lcore->type == STAGE_TYPE_RTC) {
+		rc = lcore_graph_forward_add(lcore, &node_name,
+					     node_patterns, &nb_node_patterns);
+		if (rc < 0)
+			goto err;
+
+		rc = lcore_graph_user_add(lcore, &node_name,
+					  node_patterns, &nb_node_patterns);
+		if (rc < 0)
+			goto err;
+
+		rc = lcore_graph_ethdev_rx_add(lcore, node_name,
+					       node_patterns, &nb_node_patterns);
+		if (rc < 0)
+			goto err;
+	} else {
+		rte_strscpy(nodes, lcore->nodes, sizeof(nodes));
+		node_name = strtok_r(nodes, ",", &saveptr);
+		while (node_name != NULL && nb_node_patterns < GRAPH_MAX_PATTERNS) {
+			node_patterns[nb_node_patterns++] = strdup(node_name);
+			node_name = strtok_r(NULL, ",", &saveptr);
+		}
 	}
 
 	RTE_LOG(DEBUG, USER1, "Core (%u) create graph with patterns:\n", lcore->core_id);
 	for (i = 0; i < nb_node_patterns; i++) {
 		RTE_LOG(DEBUG, USER1, "\t%s\n", node_patterns[i]);
 	}
-	snprintf(lcore->graph_name, sizeof(lcore->graph_name),
-		"worker_%u", lcore->core_id);
+	if (lcore->generation)
+		snprintf(lcore->graph_name, sizeof(lcore->graph_name),
+			"worker_%u.%u", lcore->core_id, lcore->generation);
+	else
+		snprintf(lcore->graph_name, sizeof(lcore->graph_name),
+			"worker_%u", lcore->core_id);
 	lcore->graph_config.node_patterns = node_patterns;
 	lcore->graph_config.nb_node_patterns = nb_node_patterns;
 	if (enable_graph_pcap) {
@@ -359,29 +1579,80 @@ err:
 	return rc;
 }
 
+/* On the main lcore, the worker only picks the graph up. The patterns
+ * are not needed once the graph exists.
+ */
+int
+lcore_graph_create(struct lcore_params *lcore)
+{
+	struct rte_graph *graph;
+	rte_graph_t graph_id;
+	int rc = 0;
+	int i;
+
+	if (!lcore->enabled)
+		return 0;
+
+	lcore->graph_config.socket_id = rte_lcore_to_socket_id(lcore->core_id);
+	graph_id = rte_graph_create(lcore->graph_name, &lcore->graph_config);
+	if (graph_id == RTE_GRAPH_ID_INVALID) {
+		RTE_LOG(INFO, USER1, "Graph (%s) create failed\n", lcore->graph_name);
+		rc = -rte_errno;
+		goto out;
+	}
+
+	graph = rte_graph_lookup(lcore->graph_name);
+	if (!graph) {
+		RTE_LOG(INFO, USER1, "Graph (%s) not found\n", lcore->graph_name);
+		rte_graph_destroy(graph_id);
+		rc = -ENOENT;
+		goto out;
+	}
+
+	lcore->graph_id = graph_id;
+	lcore->graph = graph;
+	lcore->ev_tx_buf = eventdev_tx_node_buf_get(lcore->ev_tx_node_id);
+	/* A worker forwards no more events than its port dequeued */
+	if (lcore->ev_tx_buf && lcore->ev_in_queue_needed)
+		eventdev_tx_node_buf_set_held(lcore->ev_tx_buf,
+					      eventdev_rx_node_held_get(lcore->ev_rx_node_id));
+
+out:
+	for (i = 0; i < lcore->graph_config.nb_node_patterns; i++)
+		free((void *)(uintptr_t)lcore->graph_config.node_patterns[i]);
+	rte_free(lcore->graph_config.node_patterns);
+	lcore->graph_config.node_patterns = NULL;
+	lcore->graph_config.nb_node_patterns = 0;
+	return rc;
+}
+
 int
 lcore_graph_worker(void *arg)
 {
 	struct lcore_params *lcore = (struct lcore_params*) arg;
+	struct rte_graph *graph;
 
 	RTE_LOG(INFO, USER1, "Lcore %u (%s) started\n", lcore->core_id, stage_type_str[lcore->type]);
 
-	lcore->graph_id = rte_graph_create(lcore->graph_name, &lcore->graph_config);
-	if (lcore->graph_id == RTE_GRAPH_ID_INVALID)
-		rte_exit(EXIT_FAILURE,
-				"rte_graph_create(): graph_id invalid"
-				" for lcore %u\n", lcore->core_id);
-
-	lcore->graph = rte_graph_lookup(lcore->graph_name);
-	if (!lcore->graph)
-		rte_exit(EXIT_FAILURE,
-				"rte_graph_lookup(): graph %s not found\n",
-				lcore->graph_name);
+	rte_rcu_qsbr_thread_register(lcore->qsv, lcore->core_id);
+	rte_rcu_qsbr_thread_online(lcore->qsv, lcore->core_id);
 
+	/* The graph is swapped on reconfigure, no graph parks the lcore */
 	while(1) {
-		rte_graph_walk(lcore->graph);
+		graph = __atomic_load_n(&lcore->graph, __ATOMIC_ACQUIRE);
+		if (likely(graph != NULL)) {
+			rte_graph_walk(graph);
+			if (lcore->ev_tx_buf)
+				eventdev_tx_node_flush(lcore->ev_tx_buf);
+		} else {
+			rte_pause();
+		}
+		rte_rcu_qsbr_quiescent(lcore->qsv, lcore->core_id);
 	}
 
+	rte_rcu_qsbr_thread_offline(lcore->qsv, lcore->core_id);
+	rte_rcu_qsbr_thread_unregister(lcore->qsv, lcore->core_id);
+
 	RTE_LOG(INFO, USER1, "Lcore %u (%s) stopped\n", lcore->core_id, stage_type_str[lcore->type]);
 
 	return 0;
@@ -8,8 +8,9 @@
 #include <rte_mbuf.h>
 
 #include "classifier_priv.h"
+#include "vtep.h"
 
-static const uint8_t classifier_next[256] __rte_cache_aligned = {
+const uint8_t classifier_next[CLASSIFIER_TYPE_MAX] __rte_cache_aligned = {
 	[RTE_PTYPE_L3_IPV4] = CLASSIFIER_NEXT_IP4_LOOKUP,
 
 	[RTE_PTYPE_L3_IPV4_EXT] = CLASSIFIER_NEXT_IP4_LOOKUP,
@@ -37,14 +38,35 @@ static const uint8_t classifier_next[256] __rte_cache_aligned = {
 
 	[RTE_PTYPE_L3_IPV6_EXT_UNKNOWN | RTE_PTYPE_L2_ETHER] =
 		CLASSIFIER_NEXT_IP6_LOOKUP,
+
+	[CLASSIFIER_TYPE_TUNNEL ... CLASSIFIER_TYPE_MAX - 1] =
+		CLASSIFIER_NEXT_TUNNEL_DECAP,
 };
 
+/* Only touches packet data for UDP over untagged IP, and only once
+ * tunnel endpoints are configured.
+ */
+static __rte_always_inline uint16_t
+classifier_type(struct rte_mbuf *mbuf)
+{
+	uint32_t ptype = mbuf->packet_type;
+	uint16_t type = ptype & (RTE_PTYPE_L2_MASK | RTE_PTYPE_L3_MASK);
+
+	if (likely(!vtep_decap_enabled))
+		return type;
+
+	if (vtep_mbuf_is_tunnel(mbuf))
+		type |= CLASSIFIER_TYPE_TUNNEL;
+
+	return type;
+}
+
 static uint16_t
 classifier_node_process(struct rte_graph *graph, struct rte_node *node,
 		     void **objs, uint16_t nb_objs)
 {
 	struct rte_mbuf *mbuf0, *mbuf1, *mbuf2, *mbuf3, **pkts;
-	uint8_t l0, l1, l2, l3, last_type;
+	uint16_t l0, l1, l2, l3, last_type;
 	uint16_t next_index, n_left_from;
 	uint16_t held = 0, last_spec = 0;
 	struct classifier_node_ctx *ctx;
@@ -87,19 +109,15 @@ classifier_node_process(struct rte_graph *graph, struct rte_node *node,
 		pkts += 4;
 		n_left_from -= 4;
 
-		l0 = mbuf0->packet_type &
-			(RTE_PTYPE_L2_MASK | RTE_PTYPE_L3_MASK);
-		l1 = mbuf1->packet_type &
-			(RTE_PTYPE_L2_MASK | RTE_PTYPE_L3_MASK);
-		l2 = mbuf2->packet_type &
-			(RTE_PTYPE_L2_MASK | RTE_PTYPE_L3_MASK);
-		l3 = mbuf3->packet_type &
-			(RTE_PTYPE_L2_MASK | RTE_PTYPE_L3_MASK);
+		l0 = classifier_type(mbuf0);
+		l1 = classifier_type(mbuf1);
+		l2 = classifier_type(mbuf2);
+		l3 = classifier_type(mbuf3);
 
 		/* Check if they are destined to same
 		 * next node based on l2l3 packet type.
 		 */
-		uint8_t fix_spec = (last_type ^ l0) | (last_type ^ l1) |
+		uint16_t fix_spec = (last_type ^ l0) | (last_type ^ l1) |
 			(last_type ^ l2) | (last_type ^ l3);
 
 		if (unlikely(fix_spec)) {
@@ -184,8 +202,7 @@ classifier_node_process(struct rte_graph *graph, struct rte_node *node,
 		pkts += 1;
 		n_left_from -= 1;
 
-		l0 = mbuf0->packet_type &
-			(RTE_PTYPE_L2_MASK | RTE_PTYPE_L3_MASK);
+		l0 = classifier_type(mbuf0);
 		if (unlikely((l0 != last_type) &&
 			     (classifier_next[l0] != next_index))) {
 			/* Copy things successfully speculated till now */
@@ -226,10 +243,11 @@ struct rte_node_register classifier_node = {
 
 	.nb_edges = CLASSIFIER_NEXT_MAX,
 	.next_nodes = {
-		[CLASSIFIER_NEXT_KERNEL_TX] = "kernel_tx",
+		[CLASSIFIER_NEXT_EXCEPTION] = "vs_exception_tx",
 		[CLASSIFIER_NEXT_IP4_LOOKUP] = "ip4_lookup",
 		[CLASSIFIER_NEXT_IP6_LOOKUP] = "ip6_lookup",
 		[CLASSIFIER_NEXT_PKT_DROP] = "pkt_drop",
+		[CLASSIFIER_NEXT_TUNNEL_DECAP] = "vs_tunnel_decap",
 	},
 };
 RTE_NODE_REGISTER(classifier_node);
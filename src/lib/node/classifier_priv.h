@@ -10,14 +10,22 @@
 
 #define OBJS_PER_CLINE (RTE_CACHE_LINE_SIZE / sizeof(void *))
 
+/* L2 | L3 packet type, plus one bit for overlay UDP ports */
+#define CLASSIFIER_TYPE_TUNNEL	(0x100)
+#define CLASSIFIER_TYPE_MAX	(0x200)
+
 enum classifier_next_nodes {
-	CLASSIFIER_NEXT_KERNEL_TX = 0,
+	CLASSIFIER_NEXT_EXCEPTION = 0,
 	CLASSIFIER_NEXT_IP4_LOOKUP,
 	CLASSIFIER_NEXT_IP6_LOOKUP,
 	CLASSIFIER_NEXT_PKT_DROP,
+	/* Must stay last, vs_tunnel_decap shares the edges before it */
+	CLASSIFIER_NEXT_TUNNEL_DECAP,
 	CLASSIFIER_NEXT_MAX,
 };
 
+extern const uint8_t classifier_next[CLASSIFIER_TYPE_MAX];
+
 struct classifier_node_ctx {
 	uint16_t l2l3_type;
 };
@@ -0,0 +1,681 @@
+/*
+  SPDX-License-Identifier: MIT
+  Copyright(c) 2023 Sriram Yagnaraman.
+*/
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <rte_cycles.h>
+#include <rte_errno.h>
+#include <rte_ether.h>
+#include <rte_graph.h>
+#include <rte_graph_worker.h>
+#include <rte_hash.h>
+#include <rte_hash_crc.h>
+#include <rte_icmp.h>
+#include <rte_ip.h>
+#include <rte_lcore.h>
+#include <rte_malloc.h>
+#include <rte_mbuf.h>
+#include <rte_mbuf_dyn.h>
+#include <rte_tcp.h>
+#include <rte_udp.h>
+
+#include "conntrack_priv.h"
+#include "conntrack.h"
+
+#define CONNTRACK_TCP_FLAGS	(RTE_TCP_SYN_FLAG | RTE_TCP_ACK_FLAG | \
+				 RTE_TCP_FIN_FLAG | RTE_TCP_RST_FLAG)
+
+int conntrack_mbuf_offset = -1;
+
+static const struct rte_mbuf_dynfield conntrack_mbuf_desc = {
+	.name = CONNTRACK_MBUF_NAME,
+	.size = sizeof(struct conntrack_mbuf),
+	.align = __alignof__(struct conntrack_mbuf),
+};
+
+/* Seconds, roughly the netfilter defaults with a shorter established */
+static const uint32_t conntrack_timeouts[CONNTRACK_PROTO_STATE_MAX] = {
+	[CONNTRACK_TCP_SYN_SENT] = 120,
+	[CONNTRACK_TCP_SYN_RECV] = 60,
+	[CONNTRACK_TCP_ESTABLISHED] = 7200,
+	[CONNTRACK_TCP_FIN_WAIT] = 120,
+	[CONNTRACK_TCP_TIME_WAIT] = 120,
+	[CONNTRACK_TCP_CLOSE] = 10,
+	[CONNTRACK_UDP_UNREPLIED] = 30,
+	[CONNTRACK_UDP_REPLIED] = 180,
+	[CONNTRACK_ICMP_UNREPLIED] = 30,
+	[CONNTRACK_ICMP_REPLIED] = 30,
+};
+
+static struct conntrack_table *conntrack_lcore[RTE_MAX_LCORE];
+static conntrack_release_cb conntrack_release;
+
+static struct conntrack_node_list node_list = {
+	.head = NULL,
+};
+
+static __rte_always_inline void
+conntrack_wheel_link(struct conntrack_table *t, uint32_t idx)
+{
+	struct conntrack_wheel *w = &t->wheel;
+	struct conntrack_entry *e = &t->entries[idx];
+	uint32_t *head = &w->slots[e->expire & CONNTRACK_WHEEL_MASK];
+
+	e->armed = e->expire;
+	e->prev = CONNTRACK_IDX_INVALID;
+	e->next = *head;
+	if (*head != CONNTRACK_IDX_INVALID)
+		t->entries[*head].prev = idx;
+	*head = idx;
+}
+
+static __rte_always_inline void
+conntrack_wheel_unlink(struct conntrack_table *t, uint32_t idx)
+{
+	struct conntrack_wheel *w = &t->wheel;
+	struct conntrack_entry *e = &t->entries[idx];
+	uint32_t *head = &w->slots[e->armed & CONNTRACK_WHEEL_MASK];
+
+	if (e->prev != CONNTRACK_IDX_INVALID)
+		t->entries[e->prev].next = e->next;
+	else if (*head == idx)
+		*head = e->next;
+	else
+		w->pending = e->next;
+
+	if (e->next != CONNTRACK_IDX_INVALID)
+		t->entries[e->next].prev = e->prev;
+}
+
+/* Later expiries are picked up lazily when the slot comes round, only
+ * a shorter timeout moves the entry.
+ */
+static __rte_always_inline void
+conntrack_timer_set(struct conntrack_table *t, uint32_t idx)
+{
+	struct conntrack_entry *e = &t->entries[idx];
+
+	e->expire = t->wheel.now + conntrack_timeouts[e->state];
+	if ((int32_t)(e->expire - e->armed) >= 0)
+		return;
+
+	conntrack_wheel_unlink(t, idx);
+	conntrack_wheel_link(t, idx);
+}
+
+static void
+conntrack_entry_free(struct conntrack_table *t, uint32_t idx)
+{
+	struct conntrack_entry *e = &t->entries[idx];
+
+	if (conntrack_release)
+		conntrack_release(idx);
+
+	rte_hash_del_key(t->hash, &e->key);
+	if (e->has_alias)
+		rte_hash_del_key(t->hash, &e->alias);
+	t->free[t->nb_free++] = idx;
+}
+
+/* Walks the slots behind the current tick, a bounded number of entries
+ * per call so a burst never waits on a large expiry.
+ */
+static void
+conntrack_expire(struct conntrack_table *t)
+{
+	struct conntrack_wheel *w = &t->wheel;
+	uint32_t budget = CONNTRACK_EXPIRE_BUDGET;
+	struct conntrack_entry *e;
+	uint32_t idx, *slot;
+
+	while (budget) {
+		if (w->pending == CONNTRACK_IDX_INVALID) {
+			if (w->cur == w->now)
+				break;
+
+			slot = &w->slots[w->cur++ & CONNTRACK_WHEEL_MASK];
+			w->pending = *slot;
+			*slot = CONNTRACK_IDX_INVALID;
+			continue;
+		}
+
+		idx = w->pending;
+		e = &t->entries[idx];
+		w->pending = e->next;
+		if (e->next != CONNTRACK_IDX_INVALID)
+			t->entries[e->next].prev = CONNTRACK_IDX_INVALID;
+		budget--;
+
+		if ((int32_t)(e->expire - w->now) > 0)
+			conntrack_wheel_link(t, idx);
+		else
+			conntrack_entry_free(t, idx);
+	}
+}
+
+static __rte_always_inline int
+conntrack_key_get(struct rte_mbuf *mbuf, struct conntrack_key *key,
+		  uint8_t *dir, uint8_t *flags)
+{
+	struct rte_ether_hdr *eth = rte_pktmbuf_mtod(mbuf, struct rte_ether_hdr *);
+	uint16_t len = rte_pktmbuf_data_len(mbuf);
+	uint16_t off = sizeof(*eth), sport, dport;
+	struct rte_icmp_hdr *icmp;
+	struct rte_tcp_hdr *tcp;
+	struct rte_udp_hdr *udp;
+	struct rte_ipv4_hdr *ip;
+	uint32_t src, dst;
+
+	if (eth->ether_type != RTE_BE16(RTE_ETHER_TYPE_IPV4) ||
+	    len < off + sizeof(*ip))
+		return -1;
+
+	/* Later fragments carry no ports and are not tracked */
+	ip = (struct rte_ipv4_hdr *)(eth + 1);
+	if (ip->fragment_offset & RTE_BE16(RTE_IPV4_HDR_OFFSET_MASK))
+		return -1;
+
+	off += rte_ipv4_hdr_len(ip);
+	switch (ip->next_proto_id) {
+	case IPPROTO_TCP:
+		if (len < off + sizeof(*tcp))
+			return -1;
+		tcp = rte_pktmbuf_mtod_offset(mbuf, struct rte_tcp_hdr *, off);
+		sport = tcp->src_port;
+		dport = tcp->dst_port;
+		*flags = tcp->tcp_flags & CONNTRACK_TCP_FLAGS;
+		break;
+	case IPPROTO_UDP:
+		if (len < off + sizeof(*udp))
+			return -1;
+		udp = rte_pktmbuf_mtod_offset(mbuf, struct rte_udp_hdr *, off);
+		sport = udp->src_port;
+		dport = udp->dst_port;
+		*flags = 0;
+		break;
+	case IPPROTO_ICMP:
+		if (len < off + sizeof(*icmp))
+			return -1;
+		icmp = rte_pktmbuf_mtod_offset(mbuf, struct rte_icmp_hdr *, off);
+		if (icmp->icmp_type != RTE_IP_ICMP_ECHO_REQUEST &&
+		    icmp->icmp_type != RTE_IP_ICMP_ECHO_REPLY)
+			return -1;
+		sport = icmp->icmp_ident;
+		dport = icmp->icmp_ident;
+		*flags = icmp->icmp_type;
+		break;
+	default:
+		return -1;
+	}
+
+	src = ip->src_addr;
+	dst = ip->dst_addr;
+	*dir = (src > dst || (src == dst && sport > dport));
+	key->addr[*dir] = src;
+	key->port[*dir] = sport;
+	key->addr[!*dir] = dst;
+	key->port[!*dir] = dport;
+	key->proto = ip->next_proto_id;
+	memset(key->pad, 0, sizeof(key->pad));
+	return 0;
+}
+
+/* Whether a packet without an entry may open a connection */
+static __rte_always_inline int
+conntrack_can_open(uint8_t proto, uint8_t flags)
+{
+	switch (proto) {
+	case IPPROTO_TCP:
+		return (flags & (RTE_TCP_SYN_FLAG | RTE_TCP_ACK_FLAG | RTE_TCP_RST_FLAG)) ==
+			RTE_TCP_SYN_FLAG;
+	case IPPROTO_ICMP:
+		return flags == RTE_IP_ICMP_ECHO_REQUEST;
+	default:
+		return 1;
+	}
+}
+
+static __rte_always_inline uint8_t
+conntrack_tcp_update(struct conntrack_entry *e, uint8_t reply, uint8_t flags)
+{
+	uint8_t syn = flags & RTE_TCP_SYN_FLAG;
+	uint8_t ack = flags & RTE_TCP_ACK_FLAG;
+
+	if (flags & RTE_TCP_RST_FLAG) {
+		e->state = CONNTRACK_TCP_CLOSE;
+		return e->replied ? CONNTRACK_ESTABLISHED : CONNTRACK_NEW;
+	}
+
+	switch (e->state) {
+	case CONNTRACK_TCP_SYN_SENT:
+		if (reply && syn && ack) {
+			e->state = CONNTRACK_TCP_SYN_RECV;
+			e->replied = 1;
+		} else if (reply || !syn || ack) {
+			return CONNTRACK_INVALID;
+		}
+		break;
+	case CONNTRACK_TCP_SYN_RECV:
+		if (!reply && ack && !syn)
+			e->state = CONNTRACK_TCP_ESTABLISHED;
+		else if (syn && !(reply && ack))
+			return CONNTRACK_INVALID;
+		break;
+	case CONNTRACK_TCP_ESTABLISHED:
+	case CONNTRACK_TCP_FIN_WAIT:
+		if (syn)
+			return CONNTRACK_INVALID;
+		if (flags & RTE_TCP_FIN_FLAG) {
+			e->fin |= 1 << reply;
+			e->state = (e->fin == 3) ?
+				CONNTRACK_TCP_TIME_WAIT : CONNTRACK_TCP_FIN_WAIT;
+		}
+		break;
+	default:
+		/* A fresh handshake from the same side reuses the tuple */
+		if (!reply && syn && !ack) {
+			e->state = CONNTRACK_TCP_SYN_SENT;
+			e->replied = 0;
+			e->fin = 0;
+			return CONNTRACK_NEW;
+		}
+		if (syn)
+			return CONNTRACK_INVALID;
+		break;
+	}
+
+	return e->replied ? CONNTRACK_ESTABLISHED : CONNTRACK_NEW;
+}
+
+static __rte_always_inline uint8_t
+conntrack_update(struct conntrack_entry *e, uint8_t reply, uint8_t flags)
+{
+	switch (e->key.proto) {
+	case IPPROTO_TCP:
+		return conntrack_tcp_update(e, reply, flags);
+	case IPPROTO_ICMP:
+		if (flags != (reply ? RTE_IP_ICMP_ECHO_REPLY : RTE_IP_ICMP_ECHO_REQUEST))
+			return CONNTRACK_INVALID;
+		if (reply) {
+			e->state = CONNTRACK_ICMP_REPLIED;
+			e->replied = 1;
+		}
+		break;
+	default:
+		if (reply) {
+			e->state = CONNTRACK_UDP_REPLIED;
+			e->replied = 1;
+		}
+		break;
+	}
+
+	return e->replied ? CONNTRACK_ESTABLISHED : CONNTRACK_NEW;
+}
+
+static __rte_always_inline uint32_t
+conntrack_entry_new(struct conntrack_table *t, struct conntrack_key *key, uint8_t dir)
+{
+	struct conntrack_entry *e;
+	uint32_t idx;
+
+	if (unlikely(t->nb_free == 0))
+		return CONNTRACK_IDX_INVALID;
+
+	idx = t->free[t->nb_free - 1];
+	if (unlikely(rte_hash_add_key_data(t->hash, key, (void *)(uintptr_t)idx) < 0))
+		return CONNTRACK_IDX_INVALID;
+	t->nb_free--;
+
+	e = &t->entries[idx];
+	memset(e, 0, sizeof(*e));
+	e->key = *key;
+	e->orig_dir = dir;
+	switch (key->proto) {
+	case IPPROTO_TCP:
+		e->state = CONNTRACK_TCP_SYN_SENT;
+		break;
+	case IPPROTO_ICMP:
+		e->state = CONNTRACK_ICMP_UNREPLIED;
+		break;
+	default:
+		e->state = CONNTRACK_UDP_UNREPLIED;
+		break;
+	}
+
+	e->expire = t->wheel.now + conntrack_timeouts[e->state];
+	conntrack_wheel_link(t, idx);
+	return idx;
+}
+
+/* A miss may be a flow opened earlier in the same burst */
+static __rte_always_inline uint32_t
+conntrack_miss(struct conntrack_table *t, struct conntrack_key *key, uint8_t dir,
+	       uint8_t flags, uint8_t *state)
+{
+	void *data;
+
+	if (rte_hash_lookup_data(t->hash, key, &data) >= 0)
+		return (uint32_t)(uintptr_t)data;
+
+	if (!conntrack_can_open(key->proto, flags)) {
+		*state = CONNTRACK_INVALID;
+		return CONNTRACK_IDX_INVALID;
+	}
+
+	*state = CONNTRACK_NEW;
+	return conntrack_entry_new(t, key, dir);
+}
+
+static uint16_t
+conntrack_node_process(struct rte_graph *graph,
+		       struct rte_node *node,
+		       void **objs,
+		       uint16_t nb_objs)
+{
+	struct conntrack_node_ctx *ctx = (struct conntrack_node_ctx *)node->ctx;
+	struct rte_mbuf **pkts = (struct rte_mbuf **)objs;
+	struct conntrack_table *t = ctx->table;
+	struct conntrack_key keys[CONNTRACK_BURST];
+	const void *key_ptrs[CONNTRACK_BURST];
+	void *data[CONNTRACK_BURST];
+	uint8_t dirs[CONNTRACK_BURST];
+	uint8_t flags[CONNTRACK_BURST];
+	uint16_t kidx[CONNTRACK_BURST];
+	uint16_t i, j, k, n, nb_keys, held = 0;
+	struct conntrack_entry *e;
+	struct conntrack_mbuf *cm;
+	uint64_t hits = 0;
+	uint32_t idx;
+	void **to_next;
+
+	t->wheel.now = (rte_rdtsc() - t->tsc_base) / t->tsc_per_tick;
+	conntrack_expire(t);
+
+	to_next = rte_node_next_stream_get(graph, node, ctx->next_node, nb_objs);
+
+	for (i = 0; i < nb_objs; i += n) {
+		n = RTE_MIN(nb_objs - i, CONNTRACK_BURST);
+
+		nb_keys = 0;
+		for (j = 0; j < n; j++) {
+			cm = conntrack_mbuf_get(pkts[i + j]);
+			cm->idx = CONNTRACK_IDX_INVALID;
+			cm->state = CONNTRACK_UNTRACKED;
+			cm->reply = 0;
+
+			if (conntrack_key_get(pkts[i + j], &keys[nb_keys],
+					      &dirs[nb_keys], &flags[nb_keys]) < 0)
+				continue;
+
+			key_ptrs[nb_keys] = &keys[nb_keys];
+			kidx[nb_keys++] = j;
+		}
+
+		if (nb_keys)
+			rte_hash_lookup_bulk_data(t->hash, key_ptrs, nb_keys, &hits, data);
+
+		for (k = 0; k < nb_keys; k++) {
+			cm = conntrack_mbuf_get(pkts[i + kidx[k]]);
+			if (likely((hits >> k) & 1)) {
+				idx = (uint32_t)(uintptr_t)data[k];
+			} else {
+				idx = conntrack_miss(t, &keys[k], dirs[k], flags[k], &cm->state);
+				if (idx == CONNTRACK_IDX_INVALID) {
+					/* Table full is not the packet's fault */
+					if (cm->state == CONNTRACK_NEW)
+						cm->state = CONNTRACK_UNTRACKED;
+					continue;
+				}
+				if (cm->state == CONNTRACK_NEW) {
+					cm->idx = idx;
+					continue;
+				}
+			}
+
+			/* Alias keys are ordered by the rewritten tuple */
+			if (idx & CONNTRACK_ALIAS_FLAG) {
+				idx &= ~CONNTRACK_ALIAS_FLAG;
+				e = &t->entries[idx];
+				cm->reply = (dirs[k] != e->alias_orig_dir);
+			} else {
+				e = &t->entries[idx];
+				cm->reply = (dirs[k] != e->orig_dir);
+			}
+
+			cm->idx = idx;
+			cm->state = conntrack_update(e, cm->reply, flags[k]);
+			if (cm->state != CONNTRACK_INVALID)
+				conntrack_timer_set(t, idx);
+		}
+
+		for (j = 0; j < n; j++) {
+			cm = conntrack_mbuf_get(pkts[i + j]);
+			if (unlikely(cm->state == CONNTRACK_INVALID && ctx->strict))
+				rte_node_enqueue_x1(graph, node, CONNTRACK_NEXT_PKT_DROP, pkts[i + j]);
+			else
+				to_next[held++] = pkts[i + j];
+		}
+	}
+
+	rte_node_next_stream_put(graph, node, ctx->next_node, held);
+	return nb_objs;
+}
+
+void
+conntrack_release_register(conntrack_release_cb cb)
+{
+	conntrack_release = cb;
+}
+
+uint32_t
+conntrack_table_size(unsigned int lcore_id)
+{
+	if (lcore_id >= RTE_MAX_LCORE || !conntrack_lcore[lcore_id])
+		return 0;
+
+	return conntrack_lcore[lcore_id]->nb_entries;
+}
+
+int
+conntrack_alias_add(struct rte_mbuf *mbuf)
+{
+	struct conntrack_mbuf *cm = conntrack_mbuf_get(mbuf);
+	unsigned int lcore_id = rte_lcore_id();
+	struct conntrack_entry *e;
+	struct conntrack_table *t;
+	struct conntrack_key key;
+	uint8_t dir, flags;
+	int rc;
+
+	if (lcore_id >= RTE_MAX_LCORE || !conntrack_lcore[lcore_id] ||
+	    cm->idx == CONNTRACK_IDX_INVALID)
+		return -EINVAL;
+
+	t = conntrack_lcore[lcore_id];
+	e = &t->entries[cm->idx];
+	if (e->has_alias)
+		return -EEXIST;
+
+	if (conntrack_key_get(mbuf, &key, &dir, &flags) < 0)
+		return -EINVAL;
+
+	/* Nothing in the tuple changed */
+	if (memcmp(&key, &e->key, sizeof(key)) == 0)
+		return 0;
+
+	/* Adding over another connection's key would steal its entry */
+	if (rte_hash_lookup(t->hash, &key) >= 0)
+		return -EEXIST;
+
+	rc = rte_hash_add_key_data(t->hash, &key,
+				   (void *)(uintptr_t)(cm->idx | CONNTRACK_ALIAS_FLAG));
+	if (rc < 0)
+		return rc;
+
+	e->alias = key;
+	e->alias_orig_dir = dir;
+	e->has_alias = 1;
+	return 0;
+}
+
+static struct conntrack_node_item*
+conntrack_node_data_get(rte_node_t node_id)
+{
+	struct conntrack_node_item *item = node_list.head;
+
+	for (; item; item = item->next) {
+		if (item->node_id == node_id)
+			return item;
+	}
+
+	return NULL;
+}
+
+static void
+conntrack_table_free(struct conntrack_table *t)
+{
+	if (!t)
+		return;
+
+	rte_hash_free(t->hash);
+	rte_free(t->entries);
+	rte_free(t->free);
+	rte_free(t);
+}
+
+static struct conntrack_table *
+conntrack_table_create(unsigned int lcore_id, uint32_t entries)
+{
+	int socket_id = rte_lcore_to_socket_id(lcore_id);
+	struct rte_hash_parameters params;
+	char name[RTE_HASH_NAMESIZE];
+	struct conntrack_table *t;
+	uint32_t i;
+
+	t = rte_zmalloc_socket(NULL, sizeof(*t), RTE_CACHE_LINE_SIZE, socket_id);
+	if (!t)
+		return NULL;
+
+	t->entries = rte_malloc_socket(NULL, entries * sizeof(*t->entries),
+				       RTE_CACHE_LINE_SIZE, socket_id);
+	t->free = rte_malloc_socket(NULL, entries * sizeof(*t->free),
+				    RTE_CACHE_LINE_SIZE, socket_id);
+	if (!t->entries || !t->free)
+		goto err;
+
+	/* Only the owning lcore touches it, no concurrency flags */
+	snprintf(name, sizeof(name), "vs_conntrack_%u", lcore_id);
+	memset(&params, 0, sizeof(params));
+	params.name = name;
+	/* Room for an alias key per entry */
+	params.entries = entries * 2;
+	params.key_len = sizeof(struct conntrack_key);
+	params.hash_func = rte_hash_crc;
+	params.hash_func_init_val = 0;
+	params.socket_id = socket_id;
+	params.extra_flag = RTE_HASH_EXTRA_FLAGS_EXT_TABLE;
+	t->hash = rte_hash_create(&params);
+	if (!t->hash)
+		goto err;
+
+	/* Lowest indexes first so a small load stays in few pages */
+	for (i = 0; i < entries; i++)
+		t->free[i] = entries - 1 - i;
+	t->nb_free = entries;
+	t->nb_entries = entries;
+
+	for (i = 0; i < CONNTRACK_WHEEL_SLOTS; i++)
+		t->wheel.slots[i] = CONNTRACK_IDX_INVALID;
+	t->wheel.pending = CONNTRACK_IDX_INVALID;
+	t->tsc_per_tick = rte_get_tsc_hz();
+	t->tsc_base = rte_rdtsc();
+
+	return t;
+
+err:
+	conntrack_table_free(t);
+	return NULL;
+}
+
+int
+conntrack_node_data_add(rte_node_t node_id, unsigned int lcore_id, uint32_t entries,
+			bool strict, char const *next_node)
+{
+	struct conntrack_node_item *item;
+	struct conntrack_table *t;
+
+	if (next_node == NULL || lcore_id >= RTE_MAX_LCORE ||
+	    entries > CONNTRACK_ENTRIES_MAX)
+		return -EINVAL;
+
+	if (conntrack_lcore[lcore_id] || conntrack_node_data_get(node_id))
+		return -EEXIST;
+
+	if (conntrack_mbuf_offset < 0) {
+		conntrack_mbuf_offset = rte_mbuf_dynfield_register(&conntrack_mbuf_desc);
+		if (conntrack_mbuf_offset < 0)
+			return -rte_errno;
+	}
+
+	item = rte_zmalloc(NULL, sizeof(struct conntrack_node_item), 0);
+	if (!item)
+		return -ENOMEM;
+
+	t = conntrack_table_create(lcore_id, RTE_MAX(entries, (uint32_t)CONNTRACK_ENTRIES_MIN));
+	if (!t) {
+		rte_free(item);
+		return -ENOMEM;
+	}
+
+	rte_node_edge_update(node_id, RTE_EDGE_ID_INVALID, &next_node, 1);
+	item->ctx.table = t;
+	item->ctx.next_node = rte_node_edge_count(node_id) - 1;
+	item->ctx.strict = strict;
+	conntrack_lcore[lcore_id] = t;
+	item->node_id = node_id;
+	item->prev = NULL;
+	item->next = node_list.head;
+	if (node_list.head)
+		node_list.head->prev = item;
+	node_list.head = item;
+
+	return 0;
+}
+
+static int
+conntrack_node_init(__rte_unused const struct rte_graph *graph, struct rte_node *node)
+{
+	struct conntrack_node_ctx *ctx = (struct conntrack_node_ctx *)node->ctx;
+	struct conntrack_node_item *item = conntrack_node_data_get(node->id);
+
+	RTE_VERIFY(sizeof(*ctx) <= sizeof(node->ctx));
+	RTE_VERIFY(item != NULL);
+
+	memcpy(ctx, &item->ctx, sizeof(*ctx));
+
+	return 0;
+}
+
+static struct rte_node_register conntrack_node = {
+	.process = conntrack_node_process,
+	.name = "vs_conntrack",
+
+	.init = conntrack_node_init,
+
+	.nb_edges = CONNTRACK_NEXT_MAX,
+	.next_nodes = {
+		[CONNTRACK_NEXT_PKT_DROP] = "pkt_drop",
+	},
+};
+
+rte_node_t
+conntrack_node_clone(char const *name)
+{
+	return rte_node_clone(conntrack_node.id, name);
+}
+
+RTE_NODE_REGISTER(conntrack_node);
@@ -0,0 +1,65 @@
+/*
+  SPDX-License-Identifier: MIT
+  Copyright(c) 2023 Sriram Yagnaraman.
+*/
+
+#ifndef __SRC_LIB_NODE_CONNTRACK_H__
+#define __SRC_LIB_NODE_CONNTRACK_H__
+
+#include <rte_graph.h>
+#include <rte_mbuf.h>
+#include <rte_mbuf_dyn.h>
+
+#define CONNTRACK_ENTRIES_MIN	(1024)
+#define CONNTRACK_ENTRIES_MAX	(1 << 24)
+#define CONNTRACK_IDX_INVALID	(UINT32_MAX)
+
+/* What later nodes see, in the spirit of the netfilter ctinfo */
+enum conntrack_state {
+	CONNTRACK_UNTRACKED = 0,
+	CONNTRACK_NEW,
+	CONNTRACK_ESTABLISHED,
+	CONNTRACK_INVALID,
+};
+
+/* Set on every packet that goes through vs_conntrack. idx is only
+ * meaningful on the lcore that tracked the packet.
+ */
+struct conntrack_mbuf {
+	uint32_t idx;
+	uint8_t state;
+	uint8_t reply;
+};
+
+extern int conntrack_mbuf_offset;
+
+static __rte_always_inline struct conntrack_mbuf *
+conntrack_mbuf_get(struct rte_mbuf *mbuf)
+{
+	return RTE_MBUF_DYNFIELD(mbuf, conntrack_mbuf_offset, struct conntrack_mbuf *);
+}
+
+/* Called on the owning lcore when an entry expires, before its index
+ * is reused.
+ */
+typedef void (*conntrack_release_cb) (uint32_t idx);
+
+void conntrack_release_register(conntrack_release_cb cb);
+uint32_t conntrack_table_size(unsigned int lcore_id);
+
+/* Adds the tuple of the rewritten packet as a second key of its entry,
+ * so that replies to a translated connection find it. Only on the lcore
+ * that tracked the packet. -EEXIST when the tuple is already tracked.
+ */
+int conntrack_alias_add(struct rte_mbuf *mbuf);
+
+rte_node_t conntrack_node_clone(char const *name);
+
+/* One table per worker, the stages feeding it steer both directions of
+ * a flow to the queue of the same worker. strict drops packets that are
+ * not part of a valid connection.
+ */
+int conntrack_node_data_add(rte_node_t node_id, unsigned int lcore_id, uint32_t entries,
+			    bool strict, char const *next_node);
+
+#endif /* __SRC_LIB_NODE_CONNTRACK_H__ */
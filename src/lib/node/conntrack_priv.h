@@ -0,0 +1,110 @@
+/*
+  SPDX-License-Identifier: MIT
+  Copyright(c) 2023 Sriram Yagnaraman.
+*/
+
+#ifndef __SRC_LIB_NODE_CONNTRACK_PRIV_H__
+#define __SRC_LIB_NODE_CONNTRACK_PRIV_H__
+
+#include <rte_common.h>
+#include <rte_graph.h>
+#include <rte_hash.h>
+
+#include "conntrack.h"
+
+#define CONNTRACK_BURST		(RTE_HASH_LOOKUP_BULK_MAX)
+#define CONNTRACK_MBUF_NAME	"vs_conntrack_mbuf"
+/* Set in the hash data of alias keys */
+#define CONNTRACK_ALIAS_FLAG	(1U << 31)
+
+/* One second ticks, entries past the wheel span go round again */
+#define CONNTRACK_WHEEL_SLOTS	(1024)
+#define CONNTRACK_WHEEL_MASK	(CONNTRACK_WHEEL_SLOTS - 1)
+#define CONNTRACK_EXPIRE_BUDGET	(64)
+
+enum conntrack_proto_state {
+	CONNTRACK_TCP_SYN_SENT = 0,
+	CONNTRACK_TCP_SYN_RECV,
+	CONNTRACK_TCP_ESTABLISHED,
+	CONNTRACK_TCP_FIN_WAIT,
+	CONNTRACK_TCP_TIME_WAIT,
+	CONNTRACK_TCP_CLOSE,
+	CONNTRACK_UDP_UNREPLIED,
+	CONNTRACK_UDP_REPLIED,
+	CONNTRACK_ICMP_UNREPLIED,
+	CONNTRACK_ICMP_REPLIED,
+	CONNTRACK_PROTO_STATE_MAX,
+};
+
+/* Both directions share one key, the lower address/port pair first.
+ * ICMP echo uses the identifier as both ports.
+ */
+struct conntrack_key {
+	uint32_t addr[2];
+	uint16_t port[2];
+	uint8_t proto;
+	uint8_t pad[3];
+};
+
+struct conntrack_entry {
+	struct conntrack_key key;
+	struct conntrack_key alias;
+	uint32_t expire;
+	/* Tick of the wheel slot the entry is linked in */
+	uint32_t armed;
+	uint32_t prev;
+	uint32_t next;
+	uint8_t state;
+	/* Direction of the first packet, 0 is lower to higher */
+	uint8_t orig_dir;
+	uint8_t replied;
+	/* FIN seen, one bit per direction */
+	uint8_t fin;
+	uint8_t has_alias;
+	/* Direction of the first packet in alias key order */
+	uint8_t alias_orig_dir;
+};
+
+struct conntrack_wheel {
+	uint32_t now;
+	uint32_t cur;
+	/* Slot being expired, detached so re-armed entries wait a turn */
+	uint32_t pending;
+	uint32_t slots[CONNTRACK_WHEEL_SLOTS];
+};
+
+struct conntrack_table {
+	struct rte_hash *hash;
+	struct conntrack_entry *entries;
+	uint32_t *free;
+	uint32_t nb_free;
+	uint32_t nb_entries;
+	uint64_t tsc_base;
+	uint64_t tsc_per_tick;
+	struct conntrack_wheel wheel;
+};
+
+struct conntrack_node_ctx {
+	struct conntrack_table *table;
+	rte_edge_t next_node;
+	uint8_t strict;
+};
+
+struct conntrack_node_item {
+	struct conntrack_node_item *next;
+	struct conntrack_node_item *prev;
+	struct conntrack_node_ctx ctx;
+
+	rte_node_t node_id;
+};
+
+struct conntrack_node_list {
+	struct conntrack_node_item *head;
+};
+
+enum conntrack_next_nodes {
+	CONNTRACK_NEXT_PKT_DROP = 0,
+	CONNTRACK_NEXT_MAX,
+};
+
+#endif /* __SRC_LIB_NODE_CONNTRACK_PRIV_H__ */
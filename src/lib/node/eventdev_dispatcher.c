@@ -12,12 +12,84 @@
 #include <rte_graph_worker.h>
 #include <rte_mbuf.h>
 #include <rte_mempool.h>
+#include <rte_vect.h>
 
 #include "eventdev_dispatcher_priv.h"
 #include "eventdev_dispatcher.h"
+#include "eventdev_rx.h"
 
 static struct eventdev_dispatcher_node_data node_main;
 
+static __rte_always_inline void
+eventdev_dispatcher_gather(void **objs, uint16_t count)
+{
+	uint16_t i = 0;
+
+	/* Each event is 16 bytes with the mbuf pointer in the upper
+	 * 64 bits, so two events unpack into two mbuf pointers.
+	 * The mbufs are written over the event pointers in place.
+	 */
+#if defined(RTE_ARCH_X86)
+	__m128i e0, e1, e2, e3;
+
+	for (; i + 4 <= count; i += 4) {
+		e0 = _mm_loadu_si128((__m128i *)objs[i]);
+		e1 = _mm_loadu_si128((__m128i *)objs[i + 1]);
+		e2 = _mm_loadu_si128((__m128i *)objs[i + 2]);
+		e3 = _mm_loadu_si128((__m128i *)objs[i + 3]);
+		_mm_storeu_si128((__m128i *)&objs[i], _mm_unpackhi_epi64(e0, e1));
+		_mm_storeu_si128((__m128i *)&objs[i + 2], _mm_unpackhi_epi64(e2, e3));
+	}
+#elif defined(RTE_ARCH_ARM64)
+	uint64x2_t e0, e1, e2, e3;
+
+	for (; i + 4 <= count; i += 4) {
+		e0 = vld1q_u64((uint64_t *)objs[i]);
+		e1 = vld1q_u64((uint64_t *)objs[i + 1]);
+		e2 = vld1q_u64((uint64_t *)objs[i + 2]);
+		e3 = vld1q_u64((uint64_t *)objs[i + 3]);
+		vst1q_u64((uint64_t *)&objs[i], vzip2q_u64(e0, e1));
+		vst1q_u64((uint64_t *)&objs[i + 2], vzip2q_u64(e2, e3));
+	}
+#endif
+	for (; i < count; i++)
+		objs[i] = ((struct rte_event *)objs[i])->mbuf;
+}
+
+/* Only the first mbuf of a vector forwards the dequeued event */
+static __rte_noinline void
+eventdev_dispatcher_unpack(struct rte_graph *graph,
+			   struct rte_node *node,
+			   rte_edge_t next_index,
+			   void **objs,
+			   uint16_t count,
+			   uint16_t nb_pkts)
+{
+	struct rte_event_vector *vec;
+	struct rte_event *event;
+	void **to_next;
+	uint16_t i, j;
+
+	to_next = rte_node_next_stream_get(graph, node, next_index, nb_pkts);
+	for (i = 0; i < count; i++) {
+		event = (struct rte_event *)objs[i];
+		if (event->event_type & RTE_EVENT_TYPE_VECTOR) {
+			vec = event->vec;
+			rte_memcpy(to_next, &vec->mbufs[vec->elem_offset],
+				   vec->nb_elem * sizeof(void *));
+			((struct rte_mbuf *)to_next[0])->ol_flags &= ~eventdev_new_flag;
+			for (j = 1; j < vec->nb_elem; j++)
+				((struct rte_mbuf *)to_next[j])->ol_flags |= eventdev_new_flag;
+			to_next += vec->nb_elem;
+			rte_mempool_put(rte_mempool_from_obj(vec), vec);
+		} else {
+			*to_next++ = event->mbuf;
+		}
+	}
+
+	rte_node_next_stream_put(graph, node, next_index, nb_pkts);
+}
+
 static __rte_always_inline uint16_t
 eventdev_dispatcher_node_process(struct rte_graph *graph,
 			 struct rte_node *node,
@@ -25,42 +97,36 @@ eventdev_dispatcher_node_process(struct rte_graph *graph,
 			 uint16_t count)
 {
 	struct eventdev_dispatcher_node_ctx *ctx = (struct eventdev_dispatcher_node_ctx *)node->ctx;
-	uint8_t next_index = EVENTDEV_DISPATCHER_NEXT_PKT_DROP;
+	rte_edge_t next_index = EVENTDEV_DISPATCHER_NEXT_PKT_DROP;
 	struct rte_event *event;
+	uint16_t nb_pkts = count;
+	uint8_t vector = 0;
 	int i;
 
 	if (ctx->port_id == RTE_MAX_LCORE)
 		ctx->port_id = rte_lcore_id();
 
+	if (ctx->data->next[ctx->port_id].enabled != 0)
+		next_index = ctx->data->next[ctx->port_id].id;
+
 	for (i = 0; i < count; i++) {
 		event = (struct rte_event *)events[i];
-		if (ctx->data->next[ctx->port_id].enabled != 0)
-			next_index = ctx->data->next[ctx->port_id].id;
-		rte_node_enqueue(graph,
-				 node,
-				 next_index,
-				 (void**) &event->mbuf,
-				 1);
+		if (unlikely(event->event_type & RTE_EVENT_TYPE_VECTOR)) {
+			nb_pkts += event->vec->nb_elem - 1;
+			vector = 1;
+		}
 	}
 
-	rte_mempool_put_bulk(ctx->data->mp, (void**)events, count);
-	return count;
-}
-
-int
-eventdev_dispatcher_set_mempool(char const* mp_name)
-{
-	rte_node_t id;
-
-	id = rte_node_from_name("vs_eventdev_dispatcher");
-	if (id == RTE_NODE_ID_INVALID)
-		return -EIO;
+	if (unlikely(vector)) {
+		eventdev_dispatcher_unpack(graph, node, next_index, events, count, nb_pkts);
+		return count;
+	}
 
-	node_main.mp = rte_mempool_lookup(mp_name);
-	if (!node_main.mp)
-		return -ENOENT;
+	/* All events go to the same edge, hand the whole burst over */
+	eventdev_dispatcher_gather(events, count);
+	rte_node_next_stream_move(graph, node, next_index);
 
-	return 0;
+	return count;
 }
 
 int
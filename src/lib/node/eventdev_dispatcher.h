@@ -8,7 +8,6 @@
 
 #include <rte_graph.h>
 
-int eventdev_dispatcher_set_mempool(char const* mp_name);
 int eventdev_dispatcher_add_next(char const* next_node, uint16_t port_id);
 
 #endif /* __SRC_LIB_NODE_EVENTDEV_DISPATCHER_H__ */
@@ -8,7 +8,6 @@
 
 #include <rte_common.h>
 #include <rte_graph.h>
-#include <rte_mempool.h>
 
 enum eventdev_dispatcher_next_nodes {
 	EVENTDEV_DISPATCHER_NEXT_PKT_DROP = 0,
@@ -20,7 +19,6 @@ struct eventdev_dispatcher_node_data {
 		rte_edge_t id;
 		uint8_t enabled;
 	} next[RTE_MAX_LCORE];
-	struct rte_mempool *mp;
 };
 
 struct eventdev_dispatcher_node_ctx {
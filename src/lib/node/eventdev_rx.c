@@ -10,11 +10,20 @@
 #include <rte_eventdev.h>
 #include <rte_graph.h>
 #include <rte_graph_worker.h>
+#include <rte_errno.h>
 #include <rte_mbuf.h>
+#include <rte_mbuf_dyn.h>
+#include <rte_mempool.h>
 
 #include "eventdev_rx_priv.h"
 #include "eventdev_rx.h"
 
+uint64_t eventdev_new_flag;
+
+static const struct rte_mbuf_dynflag eventdev_new_desc = {
+	.name = EVENTDEV_NEW_NAME,
+};
+
 static struct eventdev_rx_node_list node_list = {
 	.head = NULL,
 };
@@ -40,7 +49,7 @@ eventdev_rx_node_data_set_next(rte_node_t node_id, char const *next_node)
 }
 
 int
-eventdev_rx_node_data_add(rte_node_t node_id, uint8_t ev_id, uint8_t ev_port_id, char const *event_mempool)
+eventdev_rx_node_data_add(rte_node_t node_id, uint8_t ev_id, uint8_t ev_port_id)
 {
 	struct eventdev_rx_node_item* item;
 
@@ -55,7 +64,7 @@ eventdev_rx_node_data_add(rte_node_t node_id, uint8_t ev_id, uint8_t ev_port_id,
 	item->node_id = node_id;
 	item->ctx.ev_id = ev_id;
 	item->ctx.ev_port_id = ev_port_id;
-	item->ctx.mp = rte_mempool_lookup(event_mempool);
+	item->ctx.buf = NULL;
 	item->ctx.next_node = EVENTDEV_RX_NEXT_DISPATCHER;
 	item->prev = NULL;
 	item->next = node_list.head;
@@ -99,6 +108,50 @@ eventdev_rx_node_data_get(rte_node_t node_id)
 	return NULL;
 }
 
+uint16_t *
+eventdev_rx_node_held_get(rte_node_t node_id)
+{
+	struct eventdev_rx_node_item *item;
+
+	item = eventdev_rx_node_data_get(node_id);
+	if (!item || !item->ctx.buf)
+		return NULL;
+
+	return &item->ctx.buf->nb_held;
+}
+
+/* Only the first mbuf of a vector forwards the dequeued event */
+static __rte_noinline void
+eventdev_rx_node_unpack(struct rte_graph *graph,
+			struct rte_node *node,
+			rte_edge_t next_index,
+			struct rte_event *events,
+			uint16_t n_events,
+			uint16_t nb_pkts)
+{
+	struct rte_event_vector *vec;
+	void **to_next;
+	uint16_t i, j;
+
+	to_next = rte_node_next_stream_get(graph, node, next_index, nb_pkts);
+	for (i = 0; i < n_events; i++) {
+		if (events[i].event_type & RTE_EVENT_TYPE_VECTOR) {
+			vec = events[i].vec;
+			rte_memcpy(to_next, &vec->mbufs[vec->elem_offset],
+				   vec->nb_elem * sizeof(void *));
+			((struct rte_mbuf *)to_next[0])->ol_flags &= ~eventdev_new_flag;
+			for (j = 1; j < vec->nb_elem; j++)
+				((struct rte_mbuf *)to_next[j])->ol_flags |= eventdev_new_flag;
+			to_next += vec->nb_elem;
+			rte_mempool_put(rte_mempool_from_obj(vec), vec);
+		} else {
+			*to_next++ = events[i].mbuf;
+		}
+	}
+
+	rte_node_next_stream_put(graph, node, next_index, nb_pkts);
+}
+
 static __rte_always_inline uint16_t
 eventdev_rx_node_process(struct rte_graph *graph,
 			 struct rte_node *node,
@@ -107,29 +160,47 @@ eventdev_rx_node_process(struct rte_graph *graph,
 {
 	struct eventdev_rx_node_ctx *ctx = (struct eventdev_rx_node_ctx *)node->ctx;
 	bool ev_dispatcher = (ctx->next_node == EVENTDEV_RX_NEXT_DISPATCHER);
-	struct rte_event events[RTE_GRAPH_BURST_SIZE];
-	uint16_t n_events = 0;
+	struct rte_event *events = ctx->buf->events;
+	uint16_t n_events = 0, nb_pkts;
+	uint8_t vector = 0;
 	int i, timeout = 0;
 
+	/* The event buffer is owned by the node and is only refilled on the
+	 * next walk, so the dispatcher can read the events in place.
+	 */
 	n_events = rte_event_dequeue_burst(ctx->ev_id,
 						ctx->ev_port_id,
 						events,
 						RTE_GRAPH_BURST_SIZE,
 						timeout);
+	/* The dequeue released whatever the last walk still held */
+	ctx->buf->nb_held = n_events;
 	if (n_events) {
-		if (likely(rte_mempool_get_bulk(ctx->mp, node->objs, n_events)) == 0) {
+		/* Vectors are unpacked here unless the dispatcher does it */
+		if (!ev_dispatcher) {
+			nb_pkts = n_events;
 			for (i = 0; i < n_events; i++) {
-				if (ev_dispatcher)
-					node->objs[i] = &events[i];
-				else
-					node->objs[i] = events[i].mbuf;
+				if (unlikely(events[i].event_type & RTE_EVENT_TYPE_VECTOR)) {
+					nb_pkts += events[i].vec->nb_elem - 1;
+					vector = 1;
+				}
+			}
+
+			if (unlikely(vector)) {
+				eventdev_rx_node_unpack(graph, node, ctx->next_node,
+							events, n_events, nb_pkts);
+				return nb_pkts;
 			}
-			node->idx = n_events;
-			rte_node_next_stream_move(graph, node, ctx->next_node);
+		}
 
-			if (!ev_dispatcher)
-				rte_mempool_put_bulk(ctx->mp, node->objs, n_events);
+		for (i = 0; i < n_events; i++) {
+			if (ev_dispatcher)
+				node->objs[i] = &events[i];
+			else
+				node->objs[i] = events[i].mbuf;
 		}
+		node->idx = n_events;
+		rte_node_next_stream_move(graph, node, ctx->next_node);
 	} else {
 		rte_pause();
 	}
@@ -138,10 +209,11 @@ eventdev_rx_node_process(struct rte_graph *graph,
 }
 
 static int
-eventdev_rx_node_init(__rte_unused const struct rte_graph *graph, struct rte_node *node)
+eventdev_rx_node_init(const struct rte_graph *graph, struct rte_node *node)
 {
 	struct eventdev_rx_node_ctx *ctx = (struct eventdev_rx_node_ctx *)node->ctx;
 	struct eventdev_rx_node_item *item = eventdev_rx_node_data_get(node->id);
+	int rc;
 
 	RTE_VERIFY(sizeof(*ctx) <= sizeof(node->ctx));
 
@@ -150,15 +222,40 @@ eventdev_rx_node_init(__rte_unused const struct rte_graph *graph, struct rte_nod
 
 	RTE_VERIFY(item != NULL);
 
+	rc = rte_mbuf_dynflag_register(&eventdev_new_desc);
+	if (rc < 0)
+		return -rte_errno;
+	eventdev_new_flag = RTE_BIT64(rc);
+
+	ctx->buf = rte_zmalloc_socket(NULL, sizeof(*ctx->buf), RTE_CACHE_LINE_SIZE,
+				      graph->socket);
+	if (!ctx->buf)
+		return -ENOMEM;
+
+	item->ctx.buf = ctx->buf;
 	return 0;
 }
 
+static void
+eventdev_rx_node_fini(__rte_unused const struct rte_graph *graph, struct rte_node *node)
+{
+	struct eventdev_rx_node_ctx *ctx = (struct eventdev_rx_node_ctx *)node->ctx;
+	struct eventdev_rx_node_item *item = eventdev_rx_node_data_get(node->id);
+
+	if (item)
+		item->ctx.buf = NULL;
+
+	rte_free(ctx->buf);
+	ctx->buf = NULL;
+}
+
 static struct rte_node_register eventdev_rx_node = {
 	.process = eventdev_rx_node_process,
 	.flags = RTE_NODE_SOURCE_F,
 	.name = "vs_eventdev_rx",
 
 	.init = eventdev_rx_node_init,
+	.fini = eventdev_rx_node_fini,
 
 	.nb_edges = EVENTDEV_RX_NEXT_MAX,
 	.next_nodes = {
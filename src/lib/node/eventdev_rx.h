@@ -8,11 +8,28 @@
 
 #include <rte_graph.h>
 
+/* Vectors are unpacked into a single stream, a full burst of them must
+ * fit in its 16-bit count.
+ */
+#define EVENTDEV_VECTOR_SIZE_MAX	(UINT16_MAX / RTE_GRAPH_BURST_SIZE)
+
+/* Set on an mbuf that does not own the event it travels with, such as
+ * the tail of an unpacked vector or a flooded copy. vs_eventdev_tx sends
+ * it as a new event rather than forwarding a dequeued one again.
+ */
+#define EVENTDEV_NEW_NAME	"vs_eventdev_new"
+extern uint64_t eventdev_new_flag;
+
 rte_node_t eventdev_rx_node_clone(char const *name);
 
-int eventdev_rx_node_data_add(rte_node_t node_id, uint8_t ev_id, uint8_t ev_port_id, char const *event_mempool);
+int eventdev_rx_node_data_add(rte_node_t node_id, uint8_t ev_id, uint8_t ev_port_id);
 int eventdev_rx_node_data_rem(rte_node_t node_id);
 
 int eventdev_rx_node_data_set_next(rte_node_t node_id, char const *next_node);
 
+/* Events the port dequeued in the last walk and did not forward or
+ * release yet. vs_eventdev_tx takes one for every FORWARD it sends.
+ */
+uint16_t *eventdev_rx_node_held_get(rte_node_t node_id);
+
 #endif /* __SRC_LIB_NODE_EVENTDEV_RX_H__ */
@@ -8,7 +8,7 @@
 
 #include <rte_common.h>
 #include <rte_graph.h>
-#include <rte_mempool.h>
+#include <rte_eventdev.h>
 
 enum eventdev_rx_next_nodes {
         EVENTDEV_RX_NEXT_DISPATCHER = 0,
@@ -16,11 +16,16 @@ enum eventdev_rx_next_nodes {
 	EVENTDEV_RX_NEXT_MAX,
 };
 
+struct eventdev_rx_node_buf {
+	struct rte_event events[RTE_GRAPH_BURST_SIZE];
+	uint16_t nb_held;
+} __rte_cache_aligned;
+
 struct eventdev_rx_node_ctx {
         rte_node_t next_node;
         uint8_t ev_id;
         uint8_t ev_port_id;
-        struct rte_mempool *mp;
+        struct eventdev_rx_node_buf *buf;
 };
 
 struct eventdev_rx_node_item {
@@ -8,15 +8,18 @@
 
 #include <rte_malloc.h>
 #include <rte_eventdev.h>
+#include <rte_event_eth_tx_adapter.h>
 #include <rte_graph.h>
 #include <rte_graph_worker.h>
 #include <rte_mbuf.h>
+#include <rte_pause.h>
 
+#include "eventdev_rx.h"
 #include "eventdev_tx_priv.h"
 #include "eventdev_tx.h"
-
-#define DEFAULT_PKT_BURST (32)
-#define DEFAULT_EVENT_BURST (32)
+#include "flow_hash.h"
+#include "nat.h"
+#include "policer.h"
 
 static struct eventdev_tx_node_list node_list = {
 	.head = NULL,
@@ -26,8 +29,8 @@ static struct eventdev_tx_node_item* eventdev_tx_node_data_get(rte_node_t node_i
 
 int
 eventdev_tx_node_data_add(rte_node_t node_id,
-			  uint16_t ev_id,
-			  uint16_t ev_port_id,
+			  uint8_t ev_id,
+			  uint8_t ev_port_id,
 			  uint8_t op,
 			  uint8_t sched_type,
 			  uint8_t queue_id,
@@ -36,6 +39,7 @@ eventdev_tx_node_data_add(rte_node_t node_id,
 			  uint8_t priority)
 {
 	struct eventdev_tx_node_item* item;
+	int i;
 
 	item = eventdev_tx_node_data_get(node_id);
 	if (item)
@@ -54,6 +58,16 @@ eventdev_tx_node_data_add(rte_node_t node_id,
 	item->ctx.event_type = event_type;
 	item->ctx.sub_event_type = sub_event_type;
 	item->ctx.priority = priority;
+	item->ctx.buf = NULL;
+	item->flow_hash = FLOW_HASH_L3L4;
+	item->tx_adapter = EVENTDEV_TX_ADAPTER_NONE;
+	item->vector_size = 0;
+	item->vector_mp = NULL;
+	item->nb_queues = 0;
+	for (i = 0; i < RTE_MAX_ETHPORTS; i++) {
+		item->egress[i].port = EVENTDEV_TX_EGRESS_INVALID;
+		item->egress[i].queue = 0;
+	}
 	item->prev = NULL;
 	item->next = node_list.head;
 	node_list.head = item;
@@ -96,6 +110,393 @@ eventdev_tx_node_data_get(rte_node_t node_id)
 	return NULL;
 }
 
+int
+eventdev_tx_node_data_set_flow_hash(rte_node_t node_id, uint8_t flow_hash)
+{
+	struct eventdev_tx_node_item *item;
+
+	item = eventdev_tx_node_data_get(node_id);
+	if (!item)
+		return -ENOENT;
+
+	if (flow_hash >= FLOW_HASH_MAX)
+		return -EINVAL;
+
+	item->flow_hash = flow_hash;
+	return 0;
+}
+
+int
+eventdev_tx_node_data_set_tx_adapter(rte_node_t node_id, uint8_t mode)
+{
+	struct eventdev_tx_node_item *item;
+
+	item = eventdev_tx_node_data_get(node_id);
+	if (!item)
+		return -ENOENT;
+
+	switch (mode) {
+	case EVENTDEV_TX_ADAPTER_NONE:
+	case EVENTDEV_TX_ADAPTER_EVENT:
+	case EVENTDEV_TX_ADAPTER_INTERNAL:
+		item->tx_adapter = mode;
+		break;
+	default:
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
+int
+eventdev_tx_node_data_set_vector(rte_node_t node_id,
+				 uint16_t vector_size,
+				 struct rte_mempool *vector_mp)
+{
+	struct eventdev_tx_node_item *item;
+
+	item = eventdev_tx_node_data_get(node_id);
+	if (!item)
+		return -ENOENT;
+
+	if (vector_size && (!vector_mp || vector_size > EVENTDEV_VECTOR_SIZE_MAX))
+		return -EINVAL;
+
+	item->vector_size = vector_size;
+	item->vector_mp = vector_size ? vector_mp : NULL;
+	return 0;
+}
+
+int
+eventdev_tx_node_data_set_queues(rte_node_t node_id,
+				 uint8_t const *queues,
+				 uint16_t nb_queues)
+{
+	struct eventdev_tx_node_item *item;
+
+	item = eventdev_tx_node_data_get(node_id);
+	if (!item)
+		return -ENOENT;
+
+	if (nb_queues > EVENTDEV_TX_QUEUES_MAX)
+		return -EINVAL;
+
+	memcpy(item->queues, queues, nb_queues * sizeof(queues[0]));
+	item->nb_queues = nb_queues;
+	return 0;
+}
+
+int
+eventdev_tx_node_data_add_egress(rte_node_t node_id,
+				 uint16_t in_port,
+				 uint16_t out_port,
+				 uint16_t out_queue)
+{
+	struct eventdev_tx_node_item *item;
+
+	item = eventdev_tx_node_data_get(node_id);
+	if (!item)
+		return -ENOENT;
+
+	if (in_port >= RTE_MAX_ETHPORTS || out_port >= RTE_MAX_ETHPORTS)
+		return -EINVAL;
+
+	item->egress[in_port].port = out_port;
+	item->egress[in_port].queue = out_queue;
+	return 0;
+}
+
+int
+eventdev_tx_node_stats_get(rte_node_t node_id, struct eventdev_tx_node_stats *stats)
+{
+	struct eventdev_tx_node_item *item;
+
+	item = eventdev_tx_node_data_get(node_id);
+	if (!item)
+		return -ENOENT;
+
+	if (!item->ctx.buf)
+		return -EAGAIN;
+
+	memcpy(stats, &item->ctx.buf->stats, sizeof(*stats));
+	return 0;
+}
+
+struct eventdev_tx_node_buf *
+eventdev_tx_node_buf_get(rte_node_t node_id)
+{
+	struct eventdev_tx_node_item *item;
+
+	item = eventdev_tx_node_data_get(node_id);
+	return item ? item->ctx.buf : NULL;
+}
+
+void
+eventdev_tx_node_buf_set_held(struct eventdev_tx_node_buf *buf, uint16_t *held)
+{
+	buf->held = held;
+}
+
+/* Every dequeued event is forwarded at most once. Mbufs that do not own
+ * one, and anything past the events the port holds, go out as new.
+ */
+static __rte_always_inline uint8_t
+eventdev_tx_node_op(struct eventdev_tx_node_buf *buf, struct rte_mbuf *mbuf)
+{
+	uint8_t op = buf->ev.op;
+
+	if (buf->held) {
+		if (likely(!(mbuf->ol_flags & eventdev_new_flag)) && *buf->held) {
+			(*buf->held)--;
+			op = RTE_EVENT_OP_FORWARD;
+		} else {
+			op = RTE_EVENT_OP_NEW;
+		}
+		mbuf->ol_flags &= ~eventdev_new_flag;
+	}
+
+	return op;
+}
+
+/* A vector forwards one dequeued event if any of its mbufs owns one */
+static __rte_always_inline uint8_t
+eventdev_tx_node_vector_op(struct eventdev_tx_node_buf *buf, struct rte_event_vector *vec)
+{
+	uint8_t owned = 0;
+	uint16_t i;
+
+	if (!buf->held)
+		return buf->ev.op;
+
+	for (i = 0; i < vec->nb_elem; i++) {
+		owned |= !(vec->mbufs[i]->ol_flags & eventdev_new_flag);
+		vec->mbufs[i]->ol_flags &= ~eventdev_new_flag;
+	}
+
+	if (owned && *buf->held) {
+		(*buf->held)--;
+		return RTE_EVENT_OP_FORWARD;
+	}
+
+	return RTE_EVENT_OP_NEW;
+}
+
+static __rte_always_inline uint16_t
+eventdev_tx_node_enqueue(struct eventdev_tx_node_buf *buf, uint16_t nb_events)
+{
+	uint16_t n_enq = 0, retry = 0, i;
+
+	/* Retry partial enqueues with exponential backoff, anything
+	 * left after the last attempt is carried to the next walk.
+	 */
+	while (1) {
+		if (buf->tx_adapter == EVENTDEV_TX_ADAPTER_INTERNAL)
+			n_enq += rte_event_eth_tx_adapter_enqueue(buf->ev_id,
+								  buf->ev_port_id,
+								  &buf->events[n_enq],
+								  nb_events - n_enq,
+								  0);
+		else
+			n_enq += rte_event_enqueue_burst(buf->ev_id,
+							 buf->ev_port_id,
+							 &buf->events[n_enq],
+							 nb_events - n_enq);
+		if (likely(n_enq == nb_events) || retry == EVENTDEV_TX_MAX_RETRIES)
+			break;
+
+		for (i = 0; i < (1 << retry); i++)
+			rte_pause();
+		retry++;
+	}
+
+	buf->stats.enqueued += n_enq;
+	buf->stats.retries += retry;
+
+	return n_enq;
+}
+
+static void
+eventdev_tx_node_events_free(struct eventdev_tx_node_buf *buf, uint16_t start, uint16_t end)
+{
+	uint16_t i;
+
+	for (i = start; i < end; i++) {
+		if (buf->events[i].event_type & RTE_EVENT_TYPE_VECTOR) {
+			rte_pktmbuf_free_bulk(buf->events[i].vec->mbufs,
+					      buf->events[i].vec->nb_elem);
+			rte_mempool_put(buf->vector_mp, buf->events[i].vec);
+		} else {
+			rte_pktmbuf_free(buf->events[i].mbuf);
+		}
+	}
+}
+
+/* Keeps the events after n_enq for the next attempt, the first
+ * nb_carried of them were carried before.
+ */
+static __rte_always_inline void
+eventdev_tx_node_carry(struct eventdev_tx_node_buf *buf, uint16_t nb_carried,
+		       uint16_t nb_events, uint16_t n_enq)
+{
+	uint16_t i;
+
+	buf->nb_events = nb_events - n_enq;
+	if (likely(buf->nb_events == 0))
+		return;
+
+	memmove(&buf->events[0], &buf->events[n_enq],
+		buf->nb_events * sizeof(buf->events[0]));
+
+	/* The next dequeue releases the event a carried FORWARD stands for,
+	 * so it goes out as new and its budget goes back to be released.
+	 */
+	for (i = nb_carried > n_enq ? nb_carried - n_enq : 0; i < buf->nb_events; i++) {
+		if (buf->events[i].op == RTE_EVENT_OP_FORWARD) {
+			buf->events[i].op = RTE_EVENT_OP_NEW;
+			if (buf->held)
+				(*buf->held)++;
+		}
+		buf->stats.carried++;
+	}
+}
+
+/* Releases the dequeued events nothing was forwarded for, a release that
+ * does not fit is left to the next dequeue.
+ */
+static __rte_noinline void
+eventdev_tx_node_release(struct eventdev_tx_node_buf *buf)
+{
+	struct rte_event events[RTE_GRAPH_BURST_SIZE];
+	uint16_t nb_events = RTE_MIN(*buf->held, RTE_GRAPH_BURST_SIZE);
+	uint16_t n_rel, i;
+
+	for (i = 0; i < nb_events; i++) {
+		events[i].event = 0;
+		events[i].op = RTE_EVENT_OP_RELEASE;
+	}
+
+	n_rel = rte_event_enqueue_burst(buf->ev_id, buf->ev_port_id, events, nb_events);
+	*buf->held -= n_rel;
+	buf->stats.released += n_rel;
+}
+
+static void
+eventdev_tx_node_retry(struct eventdev_tx_node_buf *buf)
+{
+	uint16_t nb_events = buf->nb_events;
+	uint16_t n_enq;
+
+	n_enq = eventdev_tx_node_enqueue(buf, nb_events);
+	if (n_enq)
+		buf->nb_flushes = 0;
+	else
+		buf->nb_flushes++;
+
+	if (unlikely(buf->nb_flushes >= EVENTDEV_TX_MAX_FLUSHES)) {
+		eventdev_tx_node_events_free(buf, n_enq, nb_events);
+		buf->stats.dropped += nb_events - n_enq;
+		buf->nb_events = 0;
+		buf->nb_flushes = 0;
+		return;
+	}
+
+	eventdev_tx_node_carry(buf, nb_events, nb_events, n_enq);
+}
+
+void
+eventdev_tx_node_flush(struct eventdev_tx_node_buf *buf)
+{
+	if (unlikely(buf->nb_events))
+		eventdev_tx_node_retry(buf);
+
+	if (buf->held && *buf->held)
+		eventdev_tx_node_release(buf);
+}
+
+/* Pack mbufs of the same flow into event vectors. Flows are tracked in a
+ * few buckets keyed by flow id, a collision just closes the open vector.
+ * Vectors are never held across bursts, so no timeout is needed here.
+ * Demoted mbufs stay out of vectors to keep their lower priority.
+ */
+static __rte_noinline uint16_t
+eventdev_tx_node_vectorize(struct eventdev_tx_node_buf *buf,
+			   void **mbufs,
+			   uint16_t count,
+			   struct rte_event *events)
+{
+	struct rte_event *open[EVENTDEV_TX_VECTOR_BUCKETS] = { NULL };
+	struct rte_event_vector *vec;
+	uint16_t nb_events = 0, i;
+	struct rte_mbuf *mbuf;
+	struct rte_event *ev;
+	uint32_t flow_id;
+
+	for (i = 0; i < count; i++) {
+		mbuf = (struct rte_mbuf *)mbufs[i];
+		flow_id = mbuf->hash.rss & EVENTDEV_TX_FLOW_ID_MASK;
+		if (unlikely(mbuf->ol_flags & policer_demote_flag)) {
+			ev = &events[nb_events++];
+			ev->event = buf->ev.event;
+			ev->flow_id = flow_id;
+			ev->priority = RTE_EVENT_DEV_PRIORITY_LOWEST;
+			ev->mbuf = mbuf;
+			continue;
+		}
+
+		ev = open[flow_id % EVENTDEV_TX_VECTOR_BUCKETS];
+		if (ev && ev->flow_id == flow_id && ev->vec->nb_elem < buf->vector_size) {
+			ev->vec->mbufs[ev->vec->nb_elem++] = mbuf;
+			continue;
+		}
+
+		ev = &events[nb_events++];
+		ev->event = buf->ev.event;
+		ev->flow_id = flow_id;
+		if (unlikely(rte_mempool_get(buf->vector_mp, (void **)&vec) < 0)) {
+			ev->mbuf = mbuf;
+			open[flow_id % EVENTDEV_TX_VECTOR_BUCKETS] = NULL;
+			continue;
+		}
+
+		vec->nb_elem = 1;
+		vec->elem_offset = 0;
+		vec->attr_valid = 0;
+		vec->mbufs[0] = mbuf;
+		ev->event_type |= RTE_EVENT_TYPE_VECTOR;
+		ev->vec = vec;
+		open[flow_id % EVENTDEV_TX_VECTOR_BUCKETS] = ev;
+	}
+
+	/* A vector of one costs more to unpack than a plain event */
+	for (i = 0; i < nb_events; i++) {
+		ev = &events[i];
+		if (ev->event_type & RTE_EVENT_TYPE_VECTOR) {
+			if (ev->vec->nb_elem > 1) {
+				ev->op = eventdev_tx_node_vector_op(buf, ev->vec);
+				continue;
+			}
+
+			vec = ev->vec;
+			ev->event_type = buf->ev.event_type;
+			ev->mbuf = vec->mbufs[0];
+			rte_mempool_put(buf->vector_mp, vec);
+		}
+		ev->op = eventdev_tx_node_op(buf, ev->mbuf);
+	}
+
+	return nb_events;
+}
+
+static __rte_always_inline void
+eventdev_tx_node_steer(struct eventdev_tx_node_buf *buf, struct rte_event *events,
+		       uint16_t nb_events)
+{
+	uint16_t i;
+
+	for (i = 0; i < nb_events; i++)
+		events[i].queue_id = buf->queues[events[i].flow_id % buf->nb_queues];
+}
+
 static __rte_always_inline uint16_t
 eventdev_tx_node_process(struct rte_graph *graph,
 			 struct rte_node *node,
@@ -103,44 +504,90 @@ eventdev_tx_node_process(struct rte_graph *graph,
 			 uint16_t count)
 {
 	struct eventdev_tx_node_ctx *ctx = (struct eventdev_tx_node_ctx *)node->ctx;
-	struct rte_event events[DEFAULT_EVENT_BURST];
-	uint16_t n_pkts = 0;
-	int i;
+	struct eventdev_tx_node_buf *buf = ctx->buf;
+	uint16_t nb_events = buf->nb_events;
+	uint16_t nb_carried = nb_events;
+	struct eventdev_tx_node_egress *egress;
+	struct rte_event *events;
+	struct rte_mbuf *mbuf;
+	uint16_t n_new, n_enq;
+	int i, j;
+
+	n_new = RTE_MIN(count, EVENTDEV_TX_BUF_SIZE - nb_events);
+	events = &buf->events[nb_events];
+	for (i = 0, j = 0; i < n_new; i++) {
+		if (likely(i + 4 < n_new))
+			rte_prefetch0(rte_pktmbuf_mtod((struct rte_mbuf *)mbufs[i + 4], void *));
+
+		mbuf = (struct rte_mbuf *)mbufs[i];
+
+		/* The Tx adapter sends on mbuf->port, pick the peer link here */
+		if (buf->tx_adapter != EVENTDEV_TX_ADAPTER_NONE) {
+			egress = &buf->egress[mbuf->port];
+			if (unlikely(egress->port == EVENTDEV_TX_EGRESS_INVALID)) {
+				buf->stats.dropped++;
+				rte_node_enqueue_x1(graph, node, EVENTDEV_TX_NEXT_PKT_DROP, mbuf);
+				continue;
+			}
+			mbuf->port = egress->port;
+			rte_event_eth_tx_adapter_txq_set(mbuf, egress->queue);
+		}
 
-	for (i = 0; i < count; i++) {
-		events[i].op = ctx->op;
-		events[i].queue_id = ctx->queue_id;
-		events[i].sched_type = ctx->sched_type;
-		events[i].event_type = ctx->event_type;
-		events[i].mbuf = mbufs[i];
-		if (ctx->op == RTE_EVENT_OP_NEW) {
-			events[i].flow_id = ((struct rte_mbuf*)mbufs[i])->hash.rss;
-			events[i].sub_event_type = ctx->sub_event_type;
-			events[i].priority = ctx->priority;
+		/* A NIC hash need not match for both directions, steered
+		 * flows always take ours.
+		 */
+		if (unlikely(buf->nb_queues))
+			mbuf->ol_flags &= ~RTE_MBUF_F_RX_RSS_HASH;
+
+		/* Spread flows over the workers even without NIC RSS */
+		if (unlikely(nat_steering))
+			nat_flow_hash_set(mbuf);
+		flow_hash_set(mbuf, buf->flow_hash);
+
+		if (buf->vector_size) {
+			mbufs[j++] = mbuf;
+			continue;
 		}
+
+		events[j].event = buf->ev.event;
+		events[j].op = eventdev_tx_node_op(buf, mbuf);
+		events[j].flow_id = mbuf->hash.rss;
+		if (unlikely(mbuf->ol_flags & policer_demote_flag))
+			events[j].priority = RTE_EVENT_DEV_PRIORITY_LOWEST;
+		events[j].mbuf = mbuf;
+		j++;
 	}
 
-	n_pkts = rte_event_enqueue_burst(ctx->ev_id,
-					 ctx->ev_port_id,
-					 events,
-					 count);
+	if (buf->vector_size)
+		j = eventdev_tx_node_vectorize(buf, mbufs, j, events);
+	if (buf->nb_queues)
+		eventdev_tx_node_steer(buf, events, j);
+	nb_events += j;
+
+	n_enq = eventdev_tx_node_enqueue(buf, nb_events);
+	if (n_enq)
+		buf->nb_flushes = 0;
+	eventdev_tx_node_carry(buf, nb_carried, nb_events, n_enq);
 
-	if (n_pkts != count) {
+	/* Only drop what does not fit next to the carried events */
+	if (unlikely(n_new != count)) {
+		buf->stats.dropped += count - n_new;
 		rte_node_enqueue(graph,
 				 node,
 				 EVENTDEV_TX_NEXT_PKT_DROP,
-				 &mbufs[count],
-				 count - n_pkts);
+				 &mbufs[n_new],
+				 count - n_new);
 	}
 
 	return count;
 }
 
 static int
-eventdev_tx_node_init(__rte_unused const struct rte_graph *graph, struct rte_node *node)
+eventdev_tx_node_init(const struct rte_graph *graph, struct rte_node *node)
 {
 	struct eventdev_tx_node_ctx *ctx = (struct eventdev_tx_node_ctx *)node->ctx;
 	struct eventdev_tx_node_item *item = eventdev_tx_node_data_get(node->id);
+	struct eventdev_tx_node_buf *buf;
 
 	RTE_VERIFY(sizeof(*ctx) <= sizeof(node->ctx));
 
@@ -149,14 +596,57 @@ eventdev_tx_node_init(__rte_unused const struct rte_graph *graph, struct rte_nod
 
 	RTE_VERIFY(item != NULL);
 
+	buf = rte_zmalloc_socket(NULL, sizeof(*buf), RTE_CACHE_LINE_SIZE, graph->socket);
+	if (!buf)
+		return -ENOMEM;
+
+	buf->ev_id = ctx->ev_id;
+	buf->ev_port_id = ctx->ev_port_id;
+	buf->ev.op = ctx->op;
+	buf->ev.queue_id = ctx->queue_id;
+	buf->ev.sched_type = ctx->sched_type;
+	buf->ev.event_type = ctx->event_type;
+	buf->ev.sub_event_type = ctx->sub_event_type;
+	buf->ev.priority = ctx->priority;
+	buf->flow_hash = item->flow_hash;
+	buf->tx_adapter = item->tx_adapter;
+	buf->vector_size = item->vector_size;
+	buf->vector_mp = item->vector_mp;
+	buf->nb_queues = item->nb_queues;
+	memcpy(buf->queues, item->queues, sizeof(buf->queues));
+	memcpy(buf->egress, item->egress, sizeof(buf->egress));
+
+	ctx->buf = buf;
+	item->ctx.buf = buf;
+
 	return 0;
 }
 
+static void
+eventdev_tx_node_fini(__rte_unused const struct rte_graph *graph, struct rte_node *node)
+{
+	struct eventdev_tx_node_ctx *ctx = (struct eventdev_tx_node_ctx *)node->ctx;
+	struct eventdev_tx_node_item *item = eventdev_tx_node_data_get(node->id);
+	struct eventdev_tx_node_buf *buf = ctx->buf;
+
+	if (!buf)
+		return;
+
+	eventdev_tx_node_events_free(buf, 0, buf->nb_events);
+
+	if (item)
+		item->ctx.buf = NULL;
+
+	rte_free(buf);
+	ctx->buf = NULL;
+}
+
 static struct rte_node_register eventdev_tx_node = {
 	.process = eventdev_tx_node_process,
 	.name = "vs_eventdev_tx",
 
 	.init = eventdev_tx_node_init,
+	.fini = eventdev_tx_node_fini,
 
 	.nb_edges = EVENTDEV_TX_NEXT_MAX,
 	.next_nodes = {
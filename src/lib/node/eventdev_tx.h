@@ -7,12 +7,29 @@
 #define __SRC_LIB_NODE_EVENTDEV_TX_H__
 
 #include <rte_graph.h>
+#include <rte_mempool.h>
+
+struct eventdev_tx_node_stats {
+	uint64_t enqueued;
+	uint64_t retries;
+	uint64_t carried;
+	uint64_t dropped;
+	uint64_t released;
+};
+
+enum eventdev_tx_adapter_mode {
+	EVENTDEV_TX_ADAPTER_NONE = 0,
+	/* Events go to the queue the Tx adapter service is linked to */
+	EVENTDEV_TX_ADAPTER_EVENT,
+	/* Events go straight to the PMD through the adapter's internal port */
+	EVENTDEV_TX_ADAPTER_INTERNAL,
+};
 
 rte_node_t eventdev_tx_node_clone(char const *name);
 
 int eventdev_tx_node_data_add(rte_node_t node_id,
-			      uint16_t ev_id,
-			      uint16_t ev_port_id,
+			      uint8_t ev_id,
+			      uint8_t ev_port_id,
 			      uint8_t op,
 			      uint8_t sched_type,
 			      uint8_t queue_id,
@@ -21,4 +38,32 @@ int eventdev_tx_node_data_add(rte_node_t node_id,
 			      uint8_t priority);
 int eventdev_tx_node_data_rem(rte_node_t node_id);
 
+int eventdev_tx_node_data_set_flow_hash(rte_node_t node_id, uint8_t flow_hash);
+int eventdev_tx_node_data_set_tx_adapter(rte_node_t node_id, uint8_t mode);
+int eventdev_tx_node_data_set_vector(rte_node_t node_id,
+				     uint16_t vector_size,
+				     struct rte_mempool *vector_mp);
+/* Spreads the events over queues by flow id instead of the queue given
+ * at add, a flow always lands on the same one.
+ */
+int eventdev_tx_node_data_set_queues(rte_node_t node_id,
+				     uint8_t const *queues,
+				     uint16_t nb_queues);
+int eventdev_tx_node_data_add_egress(rte_node_t node_id,
+				     uint16_t in_port,
+				     uint16_t out_port,
+				     uint16_t out_queue);
+
+int eventdev_tx_node_stats_get(rte_node_t node_id, struct eventdev_tx_node_stats *stats);
+
+/* Events carried over are otherwise only retried when the node runs
+ * again. The worker flushes them between walks, they are dropped when
+ * the port stays full for EVENTDEV_TX_MAX_FLUSHES calls. The flush also
+ * releases the dequeued events that were not forwarded.
+ */
+struct eventdev_tx_node_buf;
+struct eventdev_tx_node_buf *eventdev_tx_node_buf_get(rte_node_t node_id);
+void eventdev_tx_node_buf_set_held(struct eventdev_tx_node_buf *buf, uint16_t *held);
+void eventdev_tx_node_flush(struct eventdev_tx_node_buf *buf);
+
 #endif /* __SRC_LIB_NODE_EVENTDEV_TX_H__ */
@@ -7,28 +7,76 @@
 #define __SRC_LIB_NODE_EVENTDEV_TX_PRIV_H__
 
 #include <rte_common.h>
+#include <rte_eventdev.h>
 #include <rte_graph.h>
+#include <rte_mempool.h>
+
+#include "eventdev_tx.h"
+
+/* Room for a full graph burst on top of the events carried over */
+#define EVENTDEV_TX_BUF_SIZE		(2 * RTE_GRAPH_BURST_SIZE)
+#define EVENTDEV_TX_MAX_RETRIES		(6)
+/* Idle flushes before carried events are given up */
+#define EVENTDEV_TX_MAX_FLUSHES		(1024)
+#define EVENTDEV_TX_EGRESS_INVALID	(UINT16_MAX)
+#define EVENTDEV_TX_VECTOR_BUCKETS	(16)
+#define EVENTDEV_TX_FLOW_ID_MASK	((1 << 20) - 1)
+/* One per core of the next stage, coremasks are 32 bits */
+#define EVENTDEV_TX_QUEUES_MAX		(32)
 
 enum eventdev_tx_next_nodes {
 	EVENTDEV_TX_NEXT_PKT_DROP = 0,
 	EVENTDEV_TX_NEXT_MAX,
 };
 
+/* Output port and queue for the Tx adapter, indexed by input port */
+struct eventdev_tx_node_egress {
+	uint16_t port;
+	uint16_t queue;
+};
+
+struct eventdev_tx_node_buf {
+	struct rte_event events[EVENTDEV_TX_BUF_SIZE];
+	struct rte_event ev;
+	uint8_t ev_id;
+	uint8_t ev_port_id;
+	uint16_t nb_events;
+	uint16_t nb_flushes;
+	/* Dequeued events left to forward, NULL unless the port dequeues */
+	uint16_t *held;
+	uint8_t flow_hash;
+	uint8_t tx_adapter;
+	uint16_t vector_size;
+	struct rte_mempool *vector_mp;
+	uint16_t nb_queues;
+	uint8_t queues[EVENTDEV_TX_QUEUES_MAX];
+	struct eventdev_tx_node_stats stats;
+	struct eventdev_tx_node_egress egress[RTE_MAX_ETHPORTS];
+} __rte_cache_aligned;
+
 struct eventdev_tx_node_ctx {
-        uint16_t ev_id;
-	uint16_t ev_port_id;
+        uint8_t ev_id;
+	uint8_t ev_port_id;
         uint8_t op;
         uint8_t sched_type;
         uint8_t queue_id;
         uint8_t event_type;
         uint8_t sub_event_type;
         uint8_t priority;
+        struct eventdev_tx_node_buf *buf;
 };
 
 struct eventdev_tx_node_item {
         struct eventdev_tx_node_item *next;
         struct eventdev_tx_node_item *prev;
         struct eventdev_tx_node_ctx ctx;
+        uint8_t flow_hash;
+        uint8_t tx_adapter;
+        uint16_t vector_size;
+        struct rte_mempool *vector_mp;
+        uint16_t nb_queues;
+        uint8_t queues[EVENTDEV_TX_QUEUES_MAX];
+        struct eventdev_tx_node_egress egress[RTE_MAX_ETHPORTS];
         rte_node_t node_id;
 };
 
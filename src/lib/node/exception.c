@@ -0,0 +1,317 @@
+/*
+  SPDX-License-Identifier: MIT
+  Copyright(c) 2023 Sriram Yagnaraman.
+*/
+
+#include <errno.h>
+#include <string.h>
+
+#include <rte_ethdev.h>
+#include <rte_graph.h>
+#include <rte_graph_worker.h>
+#include <rte_lcore.h>
+#include <rte_malloc.h>
+#include <rte_mbuf.h>
+#include <rte_net.h>
+
+#include "exception_priv.h"
+#include "exception.h"
+#include "vlan.h"
+
+static struct exception_main *exception_main;
+
+static struct exception_rx_node_list node_list = {
+	.head = NULL,
+};
+
+int
+exception_init(uint16_t const *ports, uint16_t const *lcore_queue)
+{
+	struct exception_main *em;
+
+	if (exception_main)
+		return -EEXIST;
+
+	if (!ports || !lcore_queue)
+		return -EINVAL;
+
+	em = rte_zmalloc(NULL, sizeof(*em), RTE_CACHE_LINE_SIZE);
+	if (!em)
+		return -ENOMEM;
+
+	memcpy(em->port, ports, sizeof(em->port));
+	memcpy(em->lcore_queue, lcore_queue, sizeof(em->lcore_queue));
+	exception_main = em;
+	return 0;
+}
+
+void
+exception_fini(void)
+{
+	struct exception_main *em = exception_main;
+
+	exception_main = NULL;
+	rte_free(em);
+}
+
+bool
+exception_enabled(void)
+{
+	return exception_main != NULL;
+}
+
+/* Trunk links carry the vlan in the mbuf, the host sees it tagged */
+static __rte_always_inline int
+exception_vlan_insert(struct rte_mbuf **mbuf)
+{
+	struct rte_mbuf *m = *mbuf;
+
+	if (vlan_links[m->port].mode != VLAN_MODE_TRUNK || !vlan_mbuf_get(m))
+		return 0;
+
+	m->ol_flags &= ~(RTE_MBUF_F_RX_VLAN | RTE_MBUF_F_RX_VLAN_STRIPPED);
+	return rte_vlan_insert(mbuf);
+}
+
+static uint16_t
+exception_tx_node_process(struct rte_graph *graph,
+			  struct rte_node *node,
+			  void **objs,
+			  uint16_t nb_objs)
+{
+	struct exception_tx_node_ctx *ctx = (struct exception_tx_node_ctx *)node->ctx;
+	struct rte_mbuf **pkts = (struct rte_mbuf **)objs;
+	struct exception_main *em = exception_main;
+	uint16_t i, j, n, sent, port_id, count = 0;
+
+	/* Graphs can be created off their lcore, look the queue up here */
+	if (unlikely(!ctx->resolved)) {
+		ctx->queue_id = em ? em->lcore_queue[rte_lcore_id()] : EXCEPTION_QUEUE_INVALID;
+		ctx->resolved = 1;
+	}
+
+	if (unlikely(!em || ctx->queue_id == EXCEPTION_QUEUE_INVALID)) {
+		rte_node_enqueue(graph, node, EXCEPTION_NEXT_PKT_DROP, objs, nb_objs);
+		return nb_objs;
+	}
+
+	for (i = 0; i < nb_objs; i++) {
+		if (unlikely(em->port[pkts[i]->port] == EXCEPTION_PORT_INVALID ||
+			     exception_vlan_insert(&pkts[i]) < 0)) {
+			rte_node_enqueue_x1(graph, node, EXCEPTION_NEXT_PKT_DROP, pkts[i]);
+			continue;
+		}
+		pkts[count++] = pkts[i];
+	}
+
+	/* Punted traffic comes in runs from the same link, one burst each */
+	for (i = 0; i < count; i = j) {
+		for (j = i + 1; j < count && pkts[j]->port == pkts[i]->port; j++)
+			;
+
+		n = j - i;
+		port_id = em->port[pkts[i]->port];
+		sent = rte_eth_tx_burst(port_id, ctx->queue_id, &pkts[i], n);
+		if (unlikely(sent < n))
+			rte_node_enqueue(graph, node, EXCEPTION_NEXT_PKT_DROP,
+					 (void **)&pkts[i + sent], n - sent);
+	}
+
+	return nb_objs;
+}
+
+static int
+exception_tx_node_init(__rte_unused const struct rte_graph *graph, struct rte_node *node)
+{
+	struct exception_tx_node_ctx *ctx = (struct exception_tx_node_ctx *)node->ctx;
+
+	RTE_VERIFY(sizeof(*ctx) <= sizeof(node->ctx));
+
+	ctx->queue_id = EXCEPTION_QUEUE_INVALID;
+	ctx->resolved = 0;
+
+	return 0;
+}
+
+/* Host frames are classified as if the link had received them, the tx
+ * side then tags them like forwarded traffic.
+ */
+static __rte_always_inline uint16_t
+exception_vlan_classify(struct rte_graph *graph, struct rte_node *node,
+			struct rte_mbuf **pkts, uint16_t count, uint16_t link_id)
+{
+	uint16_t i, held = 0;
+
+	for (i = 0; i < count; i++) {
+		pkts[i]->port = link_id;
+		if (likely(vlan_classify(pkts[i])))
+			pkts[held++] = pkts[i];
+		else
+			rte_node_enqueue_x1(graph, node, EXCEPTION_NEXT_PKT_DROP, pkts[i]);
+	}
+
+	return held;
+}
+
+static uint16_t
+exception_rx_node_process(struct rte_graph *graph,
+			  struct rte_node *node,
+			  __rte_unused void **objs,
+			  __rte_unused uint16_t nb_objs)
+{
+	struct exception_rx_node_ctx *ctx = (struct exception_rx_node_ctx *)node->ctx;
+	struct exception_rx *rx = ctx->rx;
+	struct exception_poll *poll;
+	uint16_t i, count;
+
+	for (i = 0; i < rx->nb_polls; i++) {
+		poll = &rx->polls[rx->cur];
+		if (++rx->cur == rx->nb_polls)
+			rx->cur = 0;
+
+		count = rte_eth_rx_burst(poll->port_id, poll->queue_id,
+					 (struct rte_mbuf **)node->objs, RTE_GRAPH_BURST_SIZE);
+		if (!count)
+			continue;
+
+		count = exception_vlan_classify(graph, node, (struct rte_mbuf **)node->objs,
+						count, poll->link_id);
+		if (!count)
+			continue;
+
+		node->idx = count;
+		rte_node_next_stream_move(graph, node, poll->next_node);
+		return count;
+	}
+
+	return 0;
+}
+
+static struct exception_rx_node_item*
+exception_rx_node_data_get(rte_node_t node_id)
+{
+	struct exception_rx_node_item *item = node_list.head;
+
+	for (; item; item = item->next) {
+		if (item->node_id == node_id)
+			return item;
+	}
+
+	return NULL;
+}
+
+int
+exception_rx_node_data_add(rte_node_t node_id, uint16_t link_id, uint16_t queue_id,
+			   char const *next_node)
+{
+	struct exception_main *em = exception_main;
+	struct exception_rx_node_item *item;
+	struct exception_poll *poll;
+
+	if (!em)
+		return -ENOENT;
+
+	if (next_node == NULL || link_id >= RTE_MAX_ETHPORTS ||
+	    em->port[link_id] == EXCEPTION_PORT_INVALID)
+		return -EINVAL;
+
+	item = exception_rx_node_data_get(node_id);
+	if (!item) {
+		item = rte_zmalloc(NULL, sizeof(struct exception_rx_node_item), 0);
+		if (!item)
+			return -ENOMEM;
+
+		item->rx = rte_zmalloc(NULL, sizeof(struct exception_rx), RTE_CACHE_LINE_SIZE);
+		if (!item->rx) {
+			rte_free(item);
+			return -ENOMEM;
+		}
+
+		item->node_id = node_id;
+		item->prev = NULL;
+		item->next = node_list.head;
+		if (node_list.head)
+			node_list.head->prev = item;
+		node_list.head = item;
+	}
+
+	if (item->rx->nb_polls == EXCEPTION_POLLS_MAX)
+		return -ENOSPC;
+
+	rte_node_edge_update(node_id, RTE_EDGE_ID_INVALID, &next_node, 1);
+	poll = &item->rx->polls[item->rx->nb_polls++];
+	poll->port_id = em->port[link_id];
+	poll->queue_id = queue_id;
+	poll->link_id = link_id;
+	poll->next_node = rte_node_edge_count(node_id) - 1;
+
+	return 0;
+}
+
+static int
+exception_rx_node_init(__rte_unused const struct rte_graph *graph, struct rte_node *node)
+{
+	struct exception_rx_node_ctx *ctx = (struct exception_rx_node_ctx *)node->ctx;
+	struct exception_rx_node_item *item = exception_rx_node_data_get(node->id);
+
+	RTE_VERIFY(sizeof(*ctx) <= sizeof(node->ctx));
+	RTE_VERIFY(item != NULL);
+
+	ctx->rx = item->rx;
+
+	return 0;
+}
+
+static struct rte_node_register exception_tx_node = {
+	.process = exception_tx_node_process,
+	.name = "vs_exception_tx",
+
+	.init = exception_tx_node_init,
+
+	.nb_edges = EXCEPTION_NEXT_MAX,
+	.next_nodes = {
+		[EXCEPTION_NEXT_PKT_DROP] = "pkt_drop",
+	},
+};
+
+static void
+exception_rx_node_fini(__rte_unused const struct rte_graph *graph, struct rte_node *node)
+{
+	struct exception_rx_node_item *item = exception_rx_node_data_get(node->id);
+
+	if (!item)
+		return;
+
+	if (item->next)
+		item->next->prev = item->prev;
+	if (item->prev)
+		item->prev->next = item->next;
+	if (item == node_list.head)
+		node_list.head = item->next;
+
+	rte_free(item->rx);
+	rte_free(item);
+}
+
+static struct rte_node_register exception_rx_node = {
+	.process = exception_rx_node_process,
+	.flags = RTE_NODE_SOURCE_F,
+	.name = "vs_exception_rx",
+
+	.init = exception_rx_node_init,
+	.fini = exception_rx_node_fini,
+
+	.nb_edges = EXCEPTION_NEXT_MAX,
+	.next_nodes = {
+		[EXCEPTION_NEXT_PKT_DROP] = "pkt_drop",
+	},
+};
+
+rte_node_t
+exception_rx_node_clone(char const *name)
+{
+	return rte_node_clone(exception_rx_node.id, name);
+}
+
+RTE_NODE_REGISTER(exception_tx_node);
+RTE_NODE_REGISTER(exception_rx_node);
@@ -0,0 +1,30 @@
+/*
+  SPDX-License-Identifier: MIT
+  Copyright(c) 2023 Sriram Yagnaraman.
+*/
+
+#ifndef __SRC_LIB_NODE_EXCEPTION_H__
+#define __SRC_LIB_NODE_EXCEPTION_H__
+
+#include <rte_ethdev.h>
+#include <rte_graph.h>
+
+#define EXCEPTION_PORT_INVALID	(UINT16_MAX)
+#define EXCEPTION_QUEUE_INVALID	(UINT16_MAX)
+#define EXCEPTION_POLLS_MAX	(64)
+
+/* ports maps a link to its kernel facing port, lcore_queue gives each
+ * lcore its own queue on all of them.
+ */
+int exception_init(uint16_t const *ports, uint16_t const *lcore_queue);
+void exception_fini(void);
+bool exception_enabled(void);
+
+/* Polls queue_id of the port of link_id, what the host sends there goes
+ * to next_node.
+ */
+rte_node_t exception_rx_node_clone(char const *name);
+int exception_rx_node_data_add(rte_node_t node_id, uint16_t link_id, uint16_t queue_id,
+			       char const *next_node);
+
+#endif /* __SRC_LIB_NODE_EXCEPTION_H__ */
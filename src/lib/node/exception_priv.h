@@ -0,0 +1,59 @@
+/*
+  SPDX-License-Identifier: MIT
+  Copyright(c) 2023 Sriram Yagnaraman.
+*/
+
+#ifndef __SRC_LIB_NODE_EXCEPTION_PRIV_H__
+#define __SRC_LIB_NODE_EXCEPTION_PRIV_H__
+
+#include <rte_common.h>
+#include <rte_graph.h>
+
+#include "exception.h"
+
+struct exception_main {
+	uint16_t port[RTE_MAX_ETHPORTS];
+	uint16_t lcore_queue[RTE_MAX_LCORE];
+};
+
+struct exception_tx_node_ctx {
+	uint16_t queue_id;
+	uint8_t resolved;
+};
+
+struct exception_poll {
+	uint16_t port_id;
+	uint16_t queue_id;
+	uint16_t link_id;
+	rte_edge_t next_node;
+};
+
+/* Polled round robin, one burst per visit */
+struct exception_rx {
+	uint16_t nb_polls;
+	uint16_t cur;
+	struct exception_poll polls[EXCEPTION_POLLS_MAX];
+};
+
+struct exception_rx_node_ctx {
+	struct exception_rx *rx;
+};
+
+struct exception_rx_node_item {
+	struct exception_rx_node_item *next;
+	struct exception_rx_node_item *prev;
+	struct exception_rx *rx;
+
+	rte_node_t node_id;
+};
+
+struct exception_rx_node_list {
+	struct exception_rx_node_item *head;
+};
+
+enum exception_next_nodes {
+	EXCEPTION_NEXT_PKT_DROP = 0,
+	EXCEPTION_NEXT_MAX,
+};
+
+#endif /* __SRC_LIB_NODE_EXCEPTION_PRIV_H__ */
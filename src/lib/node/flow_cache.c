@@ -0,0 +1,410 @@
+/*
+  SPDX-License-Identifier: MIT
+  Copyright(c) 2023 Sriram Yagnaraman.
+*/
+
+#include <errno.h>
+#include <string.h>
+
+#include <rte_byteorder.h>
+#include <rte_ether.h>
+#include <rte_graph.h>
+#include <rte_graph_worker.h>
+#include <rte_hash_crc.h>
+#include <rte_ip.h>
+#include <rte_lcore.h>
+#include <rte_malloc.h>
+#include <rte_mbuf.h>
+#include <rte_vect.h>
+
+#include "flow_cache_priv.h"
+#include "flow_cache.h"
+#include "flow_hash.h"
+#include "vlan.h"
+
+/* Entries start at generation 0 and are never valid */
+uint32_t flow_cache_generation = 1;
+
+static struct flow_cache *flow_cache_lcore[RTE_MAX_LCORE];
+
+static struct flow_cache_node_list node_list = {
+	.head = NULL,
+};
+
+static __rte_always_inline void
+flow_cache_key_get(struct rte_mbuf *mbuf, struct flow_cache_key *key)
+{
+	struct rte_ether_hdr *eth = rte_pktmbuf_mtod(mbuf, struct rte_ether_hdr *);
+	uint16_t len = rte_pktmbuf_data_len(mbuf);
+	uint16_t off = sizeof(*eth);
+	struct rte_ipv4_hdr *ip4;
+	struct rte_ipv6_hdr *ip6;
+	uint16_t *ports;
+
+	memset(key, 0, sizeof(*key));
+	rte_ether_addr_copy(&eth->dst_addr, &key->dst_mac);
+	key->vlan_id = vlan_mbuf_get(mbuf);
+	key->in_port = mbuf->port;
+
+	if (eth->ether_type == RTE_BE16(RTE_ETHER_TYPE_IPV4) &&
+	    len >= off + sizeof(*ip4)) {
+		ip4 = (struct rte_ipv4_hdr *)(eth + 1);
+		key->ip_version = 4;
+		key->proto = ip4->next_proto_id;
+		memcpy(key->src_addr, &ip4->src_addr, sizeof(ip4->src_addr));
+		memcpy(key->dst_addr, &ip4->dst_addr, sizeof(ip4->dst_addr));
+		/* Only the first fragment has ports, leave them all out */
+		if (ip4->fragment_offset &
+		    RTE_BE16(RTE_IPV4_HDR_OFFSET_MASK | RTE_IPV4_HDR_MF_FLAG))
+			return;
+		off += rte_ipv4_hdr_len(ip4);
+	} else if (eth->ether_type == RTE_BE16(RTE_ETHER_TYPE_IPV6) &&
+		   len >= off + sizeof(*ip6)) {
+		ip6 = (struct rte_ipv6_hdr *)(eth + 1);
+		key->ip_version = 6;
+		key->proto = ip6->proto;
+		memcpy(key->src_addr, &ip6->src_addr, sizeof(key->src_addr));
+		memcpy(key->dst_addr, &ip6->dst_addr, sizeof(key->dst_addr));
+		off += sizeof(*ip6);
+	} else {
+		return;
+	}
+
+	if (flow_hash_has_ports(key->proto) && len >= off + 2 * sizeof(uint16_t)) {
+		ports = rte_pktmbuf_mtod_offset(mbuf, uint16_t *, off);
+		key->src_port = ports[0];
+		key->dst_port = ports[1];
+	}
+}
+
+static __rte_always_inline bool
+flow_cache_key_eq(const struct flow_cache_key *a, const struct flow_cache_key *b)
+{
+#if defined(RTE_ARCH_X86)
+	const __m128i *x = (const __m128i *)a;
+	const __m128i *y = (const __m128i *)b;
+	__m128i d;
+
+	d = _mm_or_si128(_mm_xor_si128(_mm_loadu_si128(x), _mm_loadu_si128(y)),
+			 _mm_xor_si128(_mm_loadu_si128(x + 1), _mm_loadu_si128(y + 1)));
+	d = _mm_or_si128(d, _mm_xor_si128(_mm_loadu_si128(x + 2), _mm_loadu_si128(y + 2)));
+	return _mm_testz_si128(d, d);
+#elif defined(RTE_ARCH_ARM64)
+	const uint8_t *x = (const uint8_t *)a;
+	const uint8_t *y = (const uint8_t *)b;
+	uint8x16_t d;
+
+	d = vorrq_u8(veorq_u8(vld1q_u8(x), vld1q_u8(y)),
+		     veorq_u8(vld1q_u8(x + 16), vld1q_u8(y + 16)));
+	d = vorrq_u8(d, veorq_u8(vld1q_u8(x + 32), vld1q_u8(y + 32)));
+	return vmaxvq_u8(d) == 0;
+#else
+	return memcmp(a, b, sizeof(*a)) == 0;
+#endif
+}
+
+static __rte_always_inline uint32_t
+flow_cache_idx0(struct flow_cache *fc, uint32_t sig)
+{
+	return sig & fc->mask;
+}
+
+static __rte_always_inline uint32_t
+flow_cache_idx1(struct flow_cache *fc, uint32_t sig)
+{
+	return ((sig >> 16) | (sig << 16)) & fc->mask;
+}
+
+static __rte_always_inline struct flow_cache_entry *
+flow_cache_lookup(struct flow_cache *fc, struct flow_cache_key *key, uint32_t sig,
+		  uint32_t generation)
+{
+	struct flow_cache_entry *e;
+	uint32_t idx;
+
+	idx = flow_cache_idx0(fc, sig);
+	if (fc->sigs[idx] == sig) {
+		e = &fc->entries[idx];
+		if (likely(e->generation == generation && flow_cache_key_eq(&e->key, key)))
+			return e;
+	}
+
+	idx = flow_cache_idx1(fc, sig);
+	if (fc->sigs[idx] == sig) {
+		e = &fc->entries[idx];
+		if (likely(e->generation == generation && flow_cache_key_eq(&e->key, key)))
+			return e;
+	}
+
+	return NULL;
+}
+
+void
+flow_cache_learn(struct rte_mbuf *mbuf, uint16_t link_id, uint8_t *hit)
+{
+	unsigned int lcore_id = rte_lcore_id();
+	struct flow_cache_entry *e;
+	struct flow_cache_key key;
+	struct flow_cache *fc;
+	uint32_t sig, idx;
+
+	if (unlikely(lcore_id >= RTE_MAX_LCORE))
+		return;
+
+	fc = __atomic_load_n(&flow_cache_lcore[lcore_id], __ATOMIC_ACQUIRE);
+	if (fc == NULL || hit == NULL || !fc->next_nodes[link_id].enabled)
+		return;
+
+	flow_cache_key_get(mbuf, &key);
+	sig = rte_hash_crc(&key, sizeof(key), FLOW_CACHE_SEED);
+
+	/* Reuse a stale slot first, otherwise let the signature pick */
+	idx = flow_cache_idx0(fc, sig);
+	if (fc->entries[idx].generation == fc->generation &&
+	    (fc->entries[flow_cache_idx1(fc, sig)].generation != fc->generation ||
+	     (sig & 0x80000000)))
+		idx = flow_cache_idx1(fc, sig);
+
+	/* The generation of the burst that missed, anything that changed
+	 * since then has already bumped the global one.
+	 */
+	e = &fc->entries[idx];
+	memcpy(&e->key, &key, sizeof(key));
+	e->next = fc->next_nodes[link_id].id;
+	e->link_id = link_id;
+	e->hit = hit;
+	e->generation = fc->generation;
+	fc->sigs[idx] = sig;
+}
+
+static __rte_always_inline void
+flow_cache_node_enqueue(struct rte_graph *graph, struct rte_node *node,
+			rte_edge_t next, rte_edge_t next_index,
+			void **to_next, uint16_t *held, void *obj)
+{
+	if (likely(next == next_index))
+		to_next[(*held)++] = obj;
+	else
+		rte_node_enqueue_x1(graph, node, next, obj);
+}
+
+static uint16_t
+flow_cache_node_process(struct rte_graph *graph,
+			struct rte_node *node,
+			void **objs,
+			uint16_t nb_objs)
+{
+	struct flow_cache_node_ctx *ctx = (struct flow_cache_node_ctx *)node->ctx;
+	struct rte_mbuf **pkts = (struct rte_mbuf **)objs;
+	struct flow_cache_key keys[FLOW_CACHE_BURST];
+	uint32_t sigs[FLOW_CACHE_BURST];
+	struct flow_cache *fc = ctx->fc;
+	struct flow_cache_entry *e;
+	rte_edge_t next, next_index;
+	uint16_t i, j, n, held = 0;
+	void **to_next;
+
+	fc->generation = __atomic_load_n(&flow_cache_generation, __ATOMIC_ACQUIRE);
+
+	/* Learn into the cache of the graph that runs, a rebuilt graph
+	 * brings its own.
+	 */
+	if (unlikely(flow_cache_lcore[rte_lcore_id()] != fc))
+		__atomic_store_n(&flow_cache_lcore[rte_lcore_id()], fc, __ATOMIC_RELEASE);
+
+	next_index = ctx->last_next;
+	to_next = rte_node_next_stream_get(graph, node, next_index, nb_objs);
+
+	for (i = 0; i < nb_objs; i += n) {
+		n = RTE_MIN(nb_objs - i, FLOW_CACHE_BURST);
+
+		/* Signatures for the whole chunk first, so both candidate
+		 * slots are in flight before the first compare.
+		 */
+		for (j = 0; j < n; j++) {
+			if (likely(j + 4 < n))
+				rte_prefetch0(rte_pktmbuf_mtod(pkts[i + j + 4], void *));
+
+			flow_cache_key_get(pkts[i + j], &keys[j]);
+			sigs[j] = rte_hash_crc(&keys[j], sizeof(keys[j]), FLOW_CACHE_SEED);
+			rte_prefetch0(&fc->sigs[flow_cache_idx0(fc, sigs[j])]);
+			rte_prefetch0(&fc->sigs[flow_cache_idx1(fc, sigs[j])]);
+		}
+
+		for (j = 0; j < n; j++) {
+			e = flow_cache_lookup(fc, &keys[j], sigs[j], fc->generation);
+			if (likely(e != NULL)) {
+				if (unlikely(!*e->hit))
+					*e->hit = 1;
+				next = e->next;
+			} else {
+				next = ctx->miss_next;
+			}
+
+			flow_cache_node_enqueue(graph, node, next, next_index,
+						to_next, &held, pkts[i + j]);
+			ctx->last_next = next;
+		}
+	}
+
+	rte_node_next_stream_put(graph, node, next_index, held);
+	return nb_objs;
+}
+
+static struct flow_cache_node_item*
+flow_cache_node_data_get(rte_node_t node_id)
+{
+	struct flow_cache_node_item *item = node_list.head;
+
+	for (; item; item = item->next) {
+		if (item->node_id == node_id)
+			return item;
+	}
+
+	return NULL;
+}
+
+int
+flow_cache_node_data_add(rte_node_t node_id, unsigned int lcore_id,
+			 uint32_t entries, char const *miss_node)
+{
+	struct flow_cache_node_item *item;
+	struct flow_cache *fc;
+	int socket_id;
+
+	if (miss_node == NULL || lcore_id >= RTE_MAX_LCORE ||
+	    entries > FLOW_CACHE_ENTRIES_MAX)
+		return -EINVAL;
+
+	if (flow_cache_node_data_get(node_id))
+		return -EEXIST;
+
+	entries = rte_align32pow2(RTE_MAX(entries, (uint32_t)FLOW_CACHE_ENTRIES_MIN));
+	socket_id = rte_lcore_to_socket_id(lcore_id);
+
+	item = rte_zmalloc(NULL, sizeof(struct flow_cache_node_item), 0);
+	if (!item)
+		return -ENOMEM;
+
+	fc = rte_zmalloc_socket(NULL, sizeof(*fc), RTE_CACHE_LINE_SIZE, socket_id);
+	if (!fc)
+		goto err;
+
+	fc->sigs = rte_zmalloc_socket(NULL, entries * sizeof(*fc->sigs),
+				      RTE_CACHE_LINE_SIZE, socket_id);
+	fc->entries = rte_zmalloc_socket(NULL, entries * sizeof(*fc->entries),
+					 RTE_CACHE_LINE_SIZE, socket_id);
+	if (!fc->sigs || !fc->entries)
+		goto err;
+
+	fc->mask = entries - 1;
+
+	rte_node_edge_update(node_id, RTE_EDGE_ID_INVALID, &miss_node, 1);
+	item->ctx.fc = fc;
+	item->ctx.miss_next = rte_node_edge_count(node_id) - 1;
+	item->ctx.last_next = item->ctx.miss_next;
+	item->node_id = node_id;
+	item->prev = NULL;
+	item->next = node_list.head;
+	if (node_list.head)
+		node_list.head->prev = item;
+	node_list.head = item;
+
+	return 0;
+
+err:
+	if (fc) {
+		rte_free(fc->sigs);
+		rte_free(fc->entries);
+	}
+	rte_free(fc);
+	rte_free(item);
+	return -ENOMEM;
+}
+
+int
+flow_cache_node_data_add_egress(rte_node_t node_id, uint16_t link_id,
+				char const *next_node)
+{
+	struct flow_cache_node_item *item = flow_cache_node_data_get(node_id);
+	struct flow_cache *fc;
+
+	if (!item)
+		return -ENOENT;
+
+	if (next_node == NULL || link_id >= RTE_MAX_ETHPORTS)
+		return -EINVAL;
+
+	fc = item->ctx.fc;
+	rte_node_edge_update(node_id, RTE_EDGE_ID_INVALID, &next_node, 1);
+	fc->next_nodes[link_id].id = rte_node_edge_count(node_id) - 1;
+	fc->next_nodes[link_id].enabled = 1;
+
+	return 0;
+}
+
+static int
+flow_cache_node_init(__rte_unused const struct rte_graph *graph, struct rte_node *node)
+{
+	struct flow_cache_node_ctx *ctx = (struct flow_cache_node_ctx *)node->ctx;
+	struct flow_cache_node_item *item = flow_cache_node_data_get(node->id);
+
+	RTE_VERIFY(sizeof(*ctx) <= sizeof(node->ctx));
+	RTE_VERIFY(item != NULL);
+
+	memcpy(ctx, &item->ctx, sizeof(*ctx));
+
+	return 0;
+}
+
+static void
+flow_cache_node_fini(__rte_unused const struct rte_graph *graph, struct rte_node *node)
+{
+	struct flow_cache_node_item *item = flow_cache_node_data_get(node->id);
+	struct flow_cache *fc, *expected;
+	unsigned int i;
+
+	if (!item)
+		return;
+
+	/* Unless the worker already runs the cache of its new graph */
+	fc = item->ctx.fc;
+	for (i = 0; i < RTE_MAX_LCORE; i++) {
+		expected = fc;
+		__atomic_compare_exchange_n(&flow_cache_lcore[i], &expected, NULL, false,
+					    __ATOMIC_RELEASE, __ATOMIC_RELAXED);
+	}
+
+	if (item->next)
+		item->next->prev = item->prev;
+	if (item->prev)
+		item->prev->next = item->next;
+	if (item == node_list.head)
+		node_list.head = item->next;
+
+	rte_free(fc->sigs);
+	rte_free(fc->entries);
+	rte_free(fc);
+	rte_free(item);
+}
+
+static struct rte_node_register flow_cache_node = {
+	.process = flow_cache_node_process,
+	.name = "vs_flow_cache",
+
+	.init = flow_cache_node_init,
+	.fini = flow_cache_node_fini,
+
+	.nb_edges = FLOW_CACHE_NEXT_MAX,
+	.next_nodes = {
+		[FLOW_CACHE_NEXT_PKT_DROP] = "pkt_drop",
+	},
+};
+
+rte_node_t
+flow_cache_node_clone(char const *name)
+{
+	return rte_node_clone(flow_cache_node.id, name);
+}
+
+RTE_NODE_REGISTER(flow_cache_node);
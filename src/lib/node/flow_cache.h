@@ -0,0 +1,38 @@
+/*
+  SPDX-License-Identifier: MIT
+  Copyright(c) 2023 Sriram Yagnaraman.
+*/
+
+#ifndef __SRC_LIB_NODE_FLOW_CACHE_H__
+#define __SRC_LIB_NODE_FLOW_CACHE_H__
+
+#include <rte_graph.h>
+#include <rte_lcore.h>
+#include <rte_mbuf.h>
+
+#define FLOW_CACHE_ENTRIES_MIN	(64)
+#define FLOW_CACHE_ENTRIES_MAX	(1 << 20)
+
+/* Cached decisions carry the generation they were made in, bumping it
+ * drops every cached entry at the start of the next burst.
+ */
+extern uint32_t flow_cache_generation;
+
+static __rte_always_inline void
+flow_cache_invalidate(void)
+{
+	__atomic_fetch_add(&flow_cache_generation, 1, __ATOMIC_RELEASE);
+}
+
+rte_node_t flow_cache_node_clone(char const *name);
+int flow_cache_node_data_add(rte_node_t node_id, unsigned int lcore_id,
+			     uint32_t entries, char const *miss_node);
+int flow_cache_node_data_add_egress(rte_node_t node_id, uint16_t link_id,
+				    char const *next_node);
+
+/* Called on a cache miss by the node that resolved it, on the same lcore.
+ * hit is flagged on every later cache hit so the resolver can age.
+ */
+void flow_cache_learn(struct rte_mbuf *mbuf, uint16_t link_id, uint8_t *hit);
+
+#endif /* __SRC_LIB_NODE_FLOW_CACHE_H__ */
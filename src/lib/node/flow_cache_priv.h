@@ -0,0 +1,78 @@
+/*
+  SPDX-License-Identifier: MIT
+  Copyright(c) 2023 Sriram Yagnaraman.
+*/
+
+#ifndef __SRC_LIB_NODE_FLOW_CACHE_PRIV_H__
+#define __SRC_LIB_NODE_FLOW_CACHE_PRIV_H__
+
+#include <rte_common.h>
+#include <rte_ether.h>
+#include <rte_graph.h>
+
+#include "flow_cache.h"
+
+#define FLOW_CACHE_SEED		(0x9e3779b9)
+#define FLOW_CACHE_BURST	(64)
+
+enum flow_cache_next_nodes {
+	FLOW_CACHE_NEXT_PKT_DROP = 0,
+	FLOW_CACHE_NEXT_MAX,
+};
+
+/* 5-tuple plus what an L2 decision depends on, IPv4 addresses use the
+ * first 4 bytes of each address. Three 16 byte lanes for the compare.
+ */
+struct flow_cache_key {
+	struct rte_ether_addr dst_mac;
+	uint16_t vlan_id;
+	uint16_t in_port;
+	uint8_t proto;
+	uint8_t ip_version;
+	uint16_t src_port;
+	uint16_t dst_port;
+	uint8_t src_addr[16];
+	uint8_t dst_addr[16];
+} __rte_packed;
+
+struct flow_cache_entry {
+	struct flow_cache_key key;
+	uint32_t generation;
+	rte_edge_t next;
+	uint16_t link_id;
+	uint8_t *hit;
+} __rte_cache_aligned;
+
+/* Each key has two candidate slots, like the OVS EMC. Signatures are
+ * kept apart so a miss does not touch the entries.
+ */
+struct flow_cache {
+	uint32_t mask;
+	uint32_t generation;
+	uint32_t *sigs;
+	struct flow_cache_entry *entries;
+	struct {
+		rte_edge_t id;
+		uint8_t enabled;
+	} next_nodes[RTE_MAX_ETHPORTS];
+};
+
+struct flow_cache_node_ctx {
+	struct flow_cache *fc;
+	rte_edge_t miss_next;
+	rte_edge_t last_next;
+};
+
+struct flow_cache_node_item {
+	struct flow_cache_node_item *next;
+	struct flow_cache_node_item *prev;
+	struct flow_cache_node_ctx ctx;
+
+	rte_node_t node_id;
+};
+
+struct flow_cache_node_list {
+	struct flow_cache_node_item *head;
+};
+
+#endif /* __SRC_LIB_NODE_FLOW_CACHE_PRIV_H__ */
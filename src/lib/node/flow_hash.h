@@ -0,0 +1,148 @@
+/*
+  SPDX-License-Identifier: MIT
+  Copyright(c) 2023 Sriram Yagnaraman.
+*/
+
+#ifndef __SRC_LIB_NODE_FLOW_HASH_H__
+#define __SRC_LIB_NODE_FLOW_HASH_H__
+
+#include <rte_common.h>
+#include <rte_ether.h>
+#include <rte_hash_crc.h>
+#include <rte_ip.h>
+#include <rte_mbuf.h>
+
+#define FLOW_HASH_SEED	(0xdeadbeef)
+
+enum flow_hash_type {
+	FLOW_HASH_L3L4 = 0,
+	FLOW_HASH_L3,
+	FLOW_HASH_L2,
+	FLOW_HASH_NONE,
+	FLOW_HASH_MAX,
+};
+
+/* All hashes are symmetric, both directions of a flow get the same
+ * value so that atomic scheduling keeps them on the same lcore.
+ */
+static __rte_always_inline uint32_t
+flow_hash_l2(const struct rte_ether_hdr *eth)
+{
+	const struct rte_ether_addr *lo = &eth->src_addr, *hi = &eth->dst_addr;
+	uint32_t hash;
+
+	if (memcmp(lo, hi, RTE_ETHER_ADDR_LEN) > 0)
+		RTE_SWAP(lo, hi);
+
+	hash = rte_hash_crc(lo, RTE_ETHER_ADDR_LEN, FLOW_HASH_SEED);
+	return rte_hash_crc(hi, RTE_ETHER_ADDR_LEN, hash);
+}
+
+static __rte_always_inline uint32_t
+flow_hash_l4(const uint16_t *ports, uint8_t proto, uint32_t hash)
+{
+	uint16_t sp = ports[0], dp = ports[1];
+
+	hash = rte_hash_crc_4byte(((uint32_t)RTE_MIN(sp, dp) << 16) | RTE_MAX(sp, dp), hash);
+	return rte_hash_crc_4byte(proto, hash);
+}
+
+static __rte_always_inline int
+flow_hash_has_ports(uint8_t proto)
+{
+	return proto == IPPROTO_TCP || proto == IPPROTO_UDP || proto == IPPROTO_SCTP;
+}
+
+static __rte_always_inline uint32_t
+flow_hash_ipv4(const struct rte_ipv4_hdr *ip, uint16_t len, uint8_t type)
+{
+	uint32_t lo = RTE_MIN(ip->src_addr, ip->dst_addr);
+	uint32_t hi = RTE_MAX(ip->src_addr, ip->dst_addr);
+	uint16_t ihl = rte_ipv4_hdr_len(ip);
+	uint32_t hash;
+
+	hash = rte_hash_crc_4byte(lo, FLOW_HASH_SEED);
+	hash = rte_hash_crc_4byte(hi, hash);
+
+	/* Fragments carry no ports, keep them on the L3 hash */
+	if (type != FLOW_HASH_L3L4 ||
+	    !flow_hash_has_ports(ip->next_proto_id) ||
+	    (ip->fragment_offset & RTE_BE16(RTE_IPV4_HDR_MF_FLAG | RTE_IPV4_HDR_OFFSET_MASK)) ||
+	    len < ihl + 2 * sizeof(uint16_t))
+		return hash;
+
+	return flow_hash_l4((const uint16_t *)((const uint8_t *)ip + ihl),
+			    ip->next_proto_id, hash);
+}
+
+static __rte_always_inline uint32_t
+flow_hash_ipv6(const struct rte_ipv6_hdr *ip, uint16_t len, uint8_t type)
+{
+	const void *lo = &ip->src_addr, *hi = &ip->dst_addr;
+	uint32_t hash;
+
+	if (memcmp(lo, hi, 16) > 0)
+		RTE_SWAP(lo, hi);
+
+	hash = rte_hash_crc(lo, 16, FLOW_HASH_SEED);
+	hash = rte_hash_crc(hi, 16, hash);
+
+	/* Only the base header is parsed, extension headers stay on L3 */
+	if (type != FLOW_HASH_L3L4 ||
+	    !flow_hash_has_ports(ip->proto) ||
+	    len < sizeof(*ip) + 2 * sizeof(uint16_t))
+		return hash;
+
+	return flow_hash_l4((const uint16_t *)(ip + 1), ip->proto, hash);
+}
+
+static __rte_always_inline uint32_t
+flow_hash_get(struct rte_mbuf *mbuf, uint8_t type)
+{
+	struct rte_ether_hdr *eth = rte_pktmbuf_mtod(mbuf, struct rte_ether_hdr *);
+	uint16_t len = rte_pktmbuf_data_len(mbuf);
+	uint16_t off = sizeof(*eth);
+	struct rte_vlan_hdr *vlan;
+	uint16_t ether_type;
+
+	if (unlikely(len < off))
+		return 0;
+
+	if (type == FLOW_HASH_L2)
+		return flow_hash_l2(eth);
+
+	ether_type = eth->ether_type;
+	while (ether_type == RTE_BE16(RTE_ETHER_TYPE_VLAN) ||
+	       ether_type == RTE_BE16(RTE_ETHER_TYPE_QINQ)) {
+		if (len < off + sizeof(*vlan))
+			return flow_hash_l2(eth);
+		vlan = rte_pktmbuf_mtod_offset(mbuf, struct rte_vlan_hdr *, off);
+		ether_type = vlan->eth_proto;
+		off += sizeof(*vlan);
+	}
+
+	if (ether_type == RTE_BE16(RTE_ETHER_TYPE_IPV4) &&
+	    len >= off + sizeof(struct rte_ipv4_hdr))
+		return flow_hash_ipv4(rte_pktmbuf_mtod_offset(mbuf, struct rte_ipv4_hdr *, off),
+				      len - off, type);
+
+	if (ether_type == RTE_BE16(RTE_ETHER_TYPE_IPV6) &&
+	    len >= off + sizeof(struct rte_ipv6_hdr))
+		return flow_hash_ipv6(rte_pktmbuf_mtod_offset(mbuf, struct rte_ipv6_hdr *, off),
+				      len - off, type);
+
+	return flow_hash_l2(eth);
+}
+
+/* Fill in mbuf->hash.rss when the NIC did not provide one */
+static __rte_always_inline void
+flow_hash_set(struct rte_mbuf *mbuf, uint8_t type)
+{
+	if ((mbuf->ol_flags & RTE_MBUF_F_RX_RSS_HASH) || type == FLOW_HASH_NONE)
+		return;
+
+	mbuf->hash.rss = flow_hash_get(mbuf, type);
+	mbuf->ol_flags |= RTE_MBUF_F_RX_RSS_HASH;
+}
+
+#endif /* __SRC_LIB_NODE_FLOW_HASH_H__ */
@@ -15,8 +15,6 @@
 #include "forward_priv.h"
 #include "forward.h"
 
-static struct forward_node_data node_main;
-
 static struct forward_node_list node_list = {
 	.head = NULL,
 };
@@ -36,11 +34,21 @@ forward_node_data_add(rte_node_t node_id, uint16_t link_id, const char *next_nod
 		if (!item)
 			return -ENOMEM;
 
-		memset(&item->ctx, 0, sizeof(item->ctx));
-		item->ctx.data = &node_main;
+		/* Per clone, a rebuilt graph must not touch the edges of the
+		 * one still running.
+		 */
+		item->ctx.data = rte_zmalloc(NULL, sizeof(struct forward_node_data),
+					     RTE_CACHE_LINE_SIZE);
+		if (!item->ctx.data) {
+			rte_free(item);
+			return -ENOMEM;
+		}
+
 		item->node_id = node_id;
 		item->prev = NULL;
 		item->next = node_list.head;
+		if (node_list.head)
+			node_list.head->prev = item;
 		node_list.head = item;
 	}
 
@@ -68,6 +76,7 @@ forward_node_data_rem(rte_node_t node_id)
 	if (item == node_list.head)
 		node_list.head = item->next;
 
+	rte_free(item->ctx.data);
 	rte_free(item);
 	return 0;
 }
@@ -85,30 +94,191 @@ forward_node_data_get(rte_node_t node_id)
 	return NULL;
 }
 
+static __rte_always_inline rte_edge_t
+forward_node_next(struct forward_node_data *data, uint16_t port)
+{
+	if (likely(data->next_nodes[port].enabled))
+		return data->next_nodes[port].id;
+
+	return FORWARD_NEXT_PKT_DROP;
+}
+
 static __rte_always_inline uint16_t
 forward_node_process(struct rte_graph *graph,
 			 struct rte_node *node,
-			 void **mbufs,
-			 uint16_t count)
+			 void **objs,
+			 uint16_t nb_objs)
 {
 	struct forward_node_ctx *ctx = (struct forward_node_ctx *)node->ctx;
-	uint8_t next_index = FORWARD_NEXT_PKT_DROP;
-	struct rte_mbuf *mbuf;
-	int i;
-
-	for (i = 0; i < count; i++) {
-		mbuf = (struct rte_mbuf*)mbufs[i];
-		if (ctx->data->next_nodes[mbuf->port].enabled)
-			next_index = ctx->data->next_nodes[mbuf->port].id;
-
-		rte_node_enqueue(graph,
-				 node,
-				 next_index,
-				 (void**) &mbuf,
-				 1);
+	struct rte_mbuf *mbuf0, *mbuf1, *mbuf2, *mbuf3, **pkts;
+	uint16_t p0, p1, p2, p3, last_port;
+	uint16_t held = 0, last_spec = 0;
+	uint16_t n_left_from;
+	rte_edge_t next_index;
+	void **to_next, **from;
+	uint32_t i;
+
+	pkts = (struct rte_mbuf **)objs;
+	from = objs;
+	n_left_from = nb_objs;
+
+	for (i = OBJS_PER_CLINE; i < RTE_GRAPH_BURST_SIZE; i += OBJS_PER_CLINE)
+		rte_prefetch0(&objs[i]);
+
+	for (i = 0; i < 4 && i < n_left_from; i++)
+		rte_prefetch0(&pkts[i]->port);
+
+	last_port = ctx->last_port;
+	next_index = forward_node_next(ctx->data, last_port);
+
+	/* Get stream for the speculated next node */
+	to_next = rte_node_next_stream_get(graph, node,
+					   next_index, nb_objs);
+	while (n_left_from >= 4) {
+		if (likely(n_left_from > 7)) {
+			rte_prefetch0(&pkts[4]->port);
+			rte_prefetch0(&pkts[5]->port);
+			rte_prefetch0(&pkts[6]->port);
+			rte_prefetch0(&pkts[7]->port);
+		}
+
+		mbuf0 = pkts[0];
+		mbuf1 = pkts[1];
+		mbuf2 = pkts[2];
+		mbuf3 = pkts[3];
+		pkts += 4;
+		n_left_from -= 4;
+
+		p0 = mbuf0->port;
+		p1 = mbuf1->port;
+		p2 = mbuf2->port;
+		p3 = mbuf3->port;
+
+		/* Check if they are destined to same
+		 * next node based on input port.
+		 */
+		uint16_t fix_spec = (last_port ^ p0) | (last_port ^ p1) |
+			(last_port ^ p2) | (last_port ^ p3);
+
+		if (unlikely(fix_spec)) {
+			/* Copy things successfully speculated till now */
+			rte_memcpy(to_next, from,
+				   last_spec * sizeof(from[0]));
+			from += last_spec;
+			to_next += last_spec;
+			held += last_spec;
+			last_spec = 0;
+
+			/* p0 */
+			if (forward_node_next(ctx->data, p0) == next_index) {
+				to_next[0] = from[0];
+				to_next++;
+				held++;
+			} else {
+				rte_node_enqueue_x1(graph, node,
+						    forward_node_next(ctx->data, p0),
+						    from[0]);
+			}
+
+			/* p1 */
+			if (forward_node_next(ctx->data, p1) == next_index) {
+				to_next[0] = from[1];
+				to_next++;
+				held++;
+			} else {
+				rte_node_enqueue_x1(graph, node,
+						    forward_node_next(ctx->data, p1),
+						    from[1]);
+			}
+
+			/* p2 */
+			if (forward_node_next(ctx->data, p2) == next_index) {
+				to_next[0] = from[2];
+				to_next++;
+				held++;
+			} else {
+				rte_node_enqueue_x1(graph, node,
+						    forward_node_next(ctx->data, p2),
+						    from[2]);
+			}
+
+			/* p3 */
+			if (forward_node_next(ctx->data, p3) == next_index) {
+				to_next[0] = from[3];
+				to_next++;
+				held++;
+			} else {
+				rte_node_enqueue_x1(graph, node,
+						    forward_node_next(ctx->data, p3),
+						    from[3]);
+			}
+
+			/* Update speculated port */
+			if ((last_port != p3) && (p2 == p3) &&
+			    (next_index != forward_node_next(ctx->data, p3))) {
+				/* Put the current stream for
+				 * speculated port.
+				 */
+				rte_node_next_stream_put(graph, node,
+							 next_index, held);
+
+				held = 0;
+
+				/* Get next stream for new port */
+				next_index = forward_node_next(ctx->data, p3);
+				last_port = p3;
+				to_next = rte_node_next_stream_get(graph, node,
+								   next_index,
+								   nb_objs);
+			} else if (next_index == forward_node_next(ctx->data, p3)) {
+				last_port = p3;
+			}
+
+			from += 4;
+		} else {
+			last_spec += 4;
+		}
 	}
 
-	return count;
+	while (n_left_from > 0) {
+		mbuf0 = pkts[0];
+
+		pkts += 1;
+		n_left_from -= 1;
+
+		p0 = mbuf0->port;
+		if (unlikely((p0 != last_port) &&
+			     (forward_node_next(ctx->data, p0) != next_index))) {
+			/* Copy things successfully speculated till now */
+			rte_memcpy(to_next, from,
+				   last_spec * sizeof(from[0]));
+			from += last_spec;
+			to_next += last_spec;
+			held += last_spec;
+			last_spec = 0;
+
+			rte_node_enqueue_x1(graph, node,
+					    forward_node_next(ctx->data, p0),
+					    from[0]);
+			from += 1;
+		} else {
+			last_spec += 1;
+		}
+	}
+
+	/* !!! Home run !!! */
+	if (likely(last_spec == nb_objs)) {
+		rte_node_next_stream_move(graph, node, next_index);
+		return nb_objs;
+	}
+
+	held += last_spec;
+	/* Copy things successfully speculated till now */
+	rte_memcpy(to_next, from, last_spec * sizeof(from[0]));
+	rte_node_next_stream_put(graph, node, next_index, held);
+
+	ctx->last_port = last_port;
+	return nb_objs;
 }
 
 static int
@@ -127,11 +297,18 @@ forward_node_init(__rte_unused const struct rte_graph *graph, struct rte_node *n
 	return 0;
 }
 
+static void
+forward_node_fini(__rte_unused const struct rte_graph *graph, struct rte_node *node)
+{
+	forward_node_data_rem(node->id);
+}
+
 static struct rte_node_register forward_node = {
 	.process = forward_node_process,
 	.name = "vs_forward",
 
 	.init = forward_node_init,
+	.fini = forward_node_fini,
 
 	.nb_edges = FORWARD_NEXT_MAX,
 	.next_nodes = {
@@ -9,6 +9,8 @@
 #include <rte_common.h>
 #include <rte_graph.h>
 
+#define OBJS_PER_CLINE (RTE_CACHE_LINE_SIZE / sizeof(void *))
+
 enum forward_next_nodes {
 	FORWARD_NEXT_PKT_DROP = 0,
 	FORWARD_NEXT_MAX,
@@ -23,6 +25,7 @@ struct forward_node_data {
 
 struct forward_node_ctx {
         struct forward_node_data *data;
+        uint16_t last_port;
 };
 
 struct forward_node_item {
@@ -0,0 +1,437 @@
+/*
+  SPDX-License-Identifier: MIT
+  Copyright(c) 2023 Sriram Yagnaraman.
+*/
+
+#include <errno.h>
+#include <stddef.h>
+#include <string.h>
+
+#include <rte_acl.h>
+#include <rte_errno.h>
+#include <rte_ether.h>
+#include <rte_graph.h>
+#include <rte_graph_worker.h>
+#include <rte_ip.h>
+#include <rte_malloc.h>
+#include <rte_mbuf.h>
+
+#include "ip4_acl_priv.h"
+#include "ip4_acl.h"
+#include "policer.h"
+
+#define IP4_ACL_FIELD_OFFSET(f)	\
+	(offsetof(struct rte_ipv4_hdr, f) - offsetof(struct rte_ipv4_hdr, next_proto_id))
+#define IP4_ACL_L4_OFFSET	\
+	(sizeof(struct rte_ipv4_hdr) - offsetof(struct rte_ipv4_hdr, next_proto_id))
+
+/* The input must cover the ports of an option-less header */
+#define IP4_ACL_MIN_LEN		\
+	(RTE_ETHER_HDR_LEN + sizeof(struct rte_ipv4_hdr) + 2 * sizeof(uint16_t))
+
+static struct rte_acl_field_def ip4_acl_field_defs[IP4_ACL_FIELD_NUM] = {
+	[IP4_ACL_FIELD_PROTO] = {
+		.type = RTE_ACL_FIELD_TYPE_BITMASK,
+		.size = sizeof(uint8_t),
+		.field_index = IP4_ACL_FIELD_PROTO,
+		.input_index = 0,
+		.offset = 0,
+	},
+	[IP4_ACL_FIELD_SRC] = {
+		.type = RTE_ACL_FIELD_TYPE_MASK,
+		.size = sizeof(uint32_t),
+		.field_index = IP4_ACL_FIELD_SRC,
+		.input_index = 1,
+		.offset = IP4_ACL_FIELD_OFFSET(src_addr),
+	},
+	[IP4_ACL_FIELD_DST] = {
+		.type = RTE_ACL_FIELD_TYPE_MASK,
+		.size = sizeof(uint32_t),
+		.field_index = IP4_ACL_FIELD_DST,
+		.input_index = 2,
+		.offset = IP4_ACL_FIELD_OFFSET(dst_addr),
+	},
+	[IP4_ACL_FIELD_SPORT] = {
+		.type = RTE_ACL_FIELD_TYPE_RANGE,
+		.size = sizeof(uint16_t),
+		.field_index = IP4_ACL_FIELD_SPORT,
+		.input_index = 3,
+		.offset = IP4_ACL_L4_OFFSET,
+	},
+	[IP4_ACL_FIELD_DPORT] = {
+		.type = RTE_ACL_FIELD_TYPE_RANGE,
+		.size = sizeof(uint16_t),
+		.field_index = IP4_ACL_FIELD_DPORT,
+		.input_index = 3,
+		.offset = IP4_ACL_L4_OFFSET + sizeof(uint16_t),
+	},
+};
+
+/* Widest first, rte_acl refuses what the cpu or --force-max-simd-bitwidth
+ * does not allow.
+ */
+static const enum rte_acl_classify_alg ip4_acl_algs[] = {
+	RTE_ACL_CLASSIFY_AVX512X32,
+	RTE_ACL_CLASSIFY_AVX512X16,
+	RTE_ACL_CLASSIFY_AVX2,
+	RTE_ACL_CLASSIFY_SSE,
+	RTE_ACL_CLASSIFY_NEON,
+	RTE_ACL_CLASSIFY_ALTIVEC,
+};
+
+static struct ip4_acl_main *acl_main;
+
+static struct ip4_acl_node_list node_list = {
+	.head = NULL,
+};
+
+static void
+ip4_acl_table_free(struct ip4_acl_table *table)
+{
+	if (!table)
+		return;
+
+	rte_acl_free(table->acl);
+	rte_free(table);
+}
+
+int
+ip4_acl_init(struct rte_rcu_qsbr *qsv, int socket_id)
+{
+	struct ip4_acl_main *am;
+
+	if (acl_main)
+		return -EEXIST;
+
+	if (!qsv)
+		return -EINVAL;
+
+	am = rte_zmalloc_socket(NULL, sizeof(*am), RTE_CACHE_LINE_SIZE, socket_id);
+	if (!am)
+		return -ENOMEM;
+
+	/* Permit everything until the first rule set is in */
+	am->table = rte_zmalloc_socket(NULL, sizeof(*am->table), RTE_CACHE_LINE_SIZE, socket_id);
+	if (!am->table) {
+		rte_free(am);
+		return -ENOMEM;
+	}
+
+	am->qsv = qsv;
+	am->socket_id = socket_id;
+	acl_main = am;
+	return 0;
+}
+
+void
+ip4_acl_fini(void)
+{
+	struct ip4_acl_main *am = acl_main;
+
+	if (!am)
+		return;
+
+	acl_main = NULL;
+	ip4_acl_table_free(am->table);
+	rte_free(am);
+}
+
+bool
+ip4_acl_enabled(void)
+{
+	return acl_main != NULL;
+}
+
+static void
+ip4_acl_rule_convert(struct ip4_acl_rule const *rule, struct ip4_acl_acl_rule *r)
+{
+	memset(r, 0, sizeof(*r));
+	r->data.category_mask = 1;
+	r->data.priority = rule->priority;
+	/* userdata 0 is reserved for no match, the policer rides above */
+	r->data.userdata = ((uint32_t)rule->policer << 8) | (rule->action + 1);
+
+	r->field[IP4_ACL_FIELD_PROTO].value.u8 = rule->proto;
+	r->field[IP4_ACL_FIELD_PROTO].mask_range.u8 = rule->proto ? UINT8_MAX : 0;
+	r->field[IP4_ACL_FIELD_SRC].value.u32 = rule->src_ip;
+	r->field[IP4_ACL_FIELD_SRC].mask_range.u32 = rule->src_depth;
+	r->field[IP4_ACL_FIELD_DST].value.u32 = rule->dst_ip;
+	r->field[IP4_ACL_FIELD_DST].mask_range.u32 = rule->dst_depth;
+	r->field[IP4_ACL_FIELD_SPORT].value.u16 = rule->sport_lo;
+	r->field[IP4_ACL_FIELD_SPORT].mask_range.u16 = rule->sport_hi;
+	r->field[IP4_ACL_FIELD_DPORT].value.u16 = rule->dport_lo;
+	r->field[IP4_ACL_FIELD_DPORT].mask_range.u16 = rule->dport_hi;
+}
+
+static struct rte_acl_ctx *
+ip4_acl_build(struct ip4_acl_main *am, struct ip4_acl_rule const *rules, uint32_t nb_rules)
+{
+	struct ip4_acl_acl_rule *acl_rules = NULL;
+	struct rte_acl_ctx *acl = NULL;
+	struct rte_acl_config build;
+	struct rte_acl_param param;
+	char name[RTE_ACL_NAMESIZE];
+	uint32_t i;
+	int rc;
+
+	acl_rules = rte_malloc(NULL, nb_rules * sizeof(*acl_rules), 0);
+	if (!acl_rules) {
+		rc = -ENOMEM;
+		goto err;
+	}
+
+	for (i = 0; i < nb_rules; i++)
+		ip4_acl_rule_convert(&rules[i], &acl_rules[i]);
+
+	/* rte_acl_create hands back an existing context by name */
+	snprintf(name, sizeof(name), IP4_ACL_NAME_FMT, am->nb_builds++);
+	memset(&param, 0, sizeof(param));
+	param.name = name;
+	param.socket_id = am->socket_id;
+	param.rule_size = RTE_ACL_RULE_SZ(IP4_ACL_FIELD_NUM);
+	param.max_rule_num = nb_rules;
+	acl = rte_acl_create(&param);
+	if (!acl) {
+		rc = -rte_errno;
+		goto err;
+	}
+
+	for (i = 0; i < RTE_DIM(ip4_acl_algs); i++) {
+		if (rte_acl_set_ctx_classify(acl, ip4_acl_algs[i]) == 0)
+			break;
+	}
+
+	rc = rte_acl_add_rules(acl, (struct rte_acl_rule *)acl_rules, nb_rules);
+	if (rc < 0)
+		goto err;
+
+	memset(&build, 0, sizeof(build));
+	build.num_categories = 1;
+	build.num_fields = RTE_DIM(ip4_acl_field_defs);
+	memcpy(build.defs, ip4_acl_field_defs, sizeof(ip4_acl_field_defs));
+	rc = rte_acl_build(acl, &build);
+	if (rc < 0)
+		goto err;
+
+	rte_free(acl_rules);
+	return acl;
+
+err:
+	rte_acl_free(acl);
+	rte_free(acl_rules);
+	rte_errno = -rc;
+	return NULL;
+}
+
+int
+ip4_acl_rules_set(struct ip4_acl_rule const *rules, uint32_t nb_rules,
+		  uint8_t default_action)
+{
+	struct ip4_acl_main *am = acl_main;
+	struct ip4_acl_table *table, *old;
+
+	if (!am)
+		return -ENOENT;
+
+	if (nb_rules > IP4_ACL_RULES_MAX || default_action >= IP4_ACL_ACTION_MAX)
+		return -EINVAL;
+
+	table = rte_zmalloc_socket(NULL, sizeof(*table), RTE_CACHE_LINE_SIZE, am->socket_id);
+	if (!table)
+		return -ENOMEM;
+
+	table->default_action = default_action;
+	if (nb_rules) {
+		table->acl = ip4_acl_build(am, rules, nb_rules);
+		if (!table->acl) {
+			rte_free(table);
+			return -rte_errno;
+		}
+	}
+
+	old = am->table;
+	__atomic_store_n(&am->table, table, __ATOMIC_RELEASE);
+
+	/* Workers drop their reference before reporting quiescent */
+	rte_rcu_qsbr_synchronize(am->qsv, RTE_QSBR_THRID_INVALID);
+	ip4_acl_table_free(old);
+
+	return 0;
+}
+
+static __rte_always_inline uint8_t
+ip4_acl_result(struct ip4_acl_table *table, uint32_t result)
+{
+	return result ? (result & 0xff) - 1 : table->default_action;
+}
+
+static uint16_t
+ip4_acl_node_process(struct rte_graph *graph,
+		     struct rte_node *node,
+		     void **objs,
+		     uint16_t nb_objs)
+{
+	struct ip4_acl_node_ctx *ctx = (struct ip4_acl_node_ctx *)node->ctx;
+	struct rte_mbuf **pkts = (struct rte_mbuf **)objs;
+	const uint8_t *data[IP4_ACL_BURST];
+	uint32_t results[IP4_ACL_BURST];
+	uint8_t actions[IP4_ACL_BURST];
+	uint8_t policers[IP4_ACL_BURST];
+	uint16_t idx[IP4_ACL_BURST];
+	struct ip4_acl_table *table;
+	struct rte_ipv4_hdr *ip;
+	struct rte_ether_hdr *eth;
+	uint16_t i, j, n, nb_data, held = 0;
+	int policer_offset = policer_mbuf_offset;
+	struct rte_mbuf *mbuf;
+	void **to_next;
+
+	table = __atomic_load_n(&acl_main->table, __ATOMIC_ACQUIRE);
+	to_next = rte_node_next_stream_get(graph, node, ctx->next_node, nb_objs);
+
+	for (i = 0; i < nb_objs; i += n) {
+		n = RTE_MIN(nb_objs - i, IP4_ACL_BURST);
+
+		/* Rules only match untagged IPv4. Anything else, including
+		 * IPv6 and tagged frames, and packets whose ports are not
+		 * where the rules expect them, take the default.
+		 */
+		nb_data = 0;
+		for (j = 0; j < n; j++) {
+			mbuf = pkts[i + j];
+			policers[j] = POLICER_ID_NONE;
+			actions[j] = table->default_action;
+			eth = rte_pktmbuf_mtod(mbuf, struct rte_ether_hdr *);
+			if (eth->ether_type != RTE_BE16(RTE_ETHER_TYPE_IPV4))
+				continue;
+
+			ip = (struct rte_ipv4_hdr *)(eth + 1);
+			if (unlikely(table->acl == NULL ||
+				     rte_pktmbuf_data_len(mbuf) < IP4_ACL_MIN_LEN ||
+				     rte_ipv4_hdr_len(ip) != sizeof(*ip) ||
+				     (ip->fragment_offset & RTE_BE16(RTE_IPV4_HDR_OFFSET_MASK))))
+				continue;
+
+			data[nb_data] = &ip->next_proto_id;
+			idx[nb_data++] = j;
+		}
+
+		if (nb_data) {
+			rte_acl_classify(table->acl, data, results, nb_data, 1);
+			for (j = 0; j < nb_data; j++) {
+				actions[idx[j]] = ip4_acl_result(table, results[j]);
+				policers[idx[j]] = results[j] >> 8;
+			}
+		}
+
+		/* Written on every packet, the field is not reset on rx */
+		if (policer_offset >= 0) {
+			for (j = 0; j < n; j++)
+				policer_mbuf_get(pkts[i + j])->policer = policers[j];
+		}
+
+		for (j = 0; j < n; j++) {
+			if (likely(actions[j] == IP4_ACL_PERMIT))
+				to_next[held++] = pkts[i + j];
+			else
+				rte_node_enqueue_x1(graph, node, IP4_ACL_NEXT_PKT_DROP, pkts[i + j]);
+		}
+	}
+
+	rte_node_next_stream_put(graph, node, ctx->next_node, held);
+	return nb_objs;
+}
+
+static struct ip4_acl_node_item*
+ip4_acl_node_data_get(rte_node_t node_id)
+{
+	struct ip4_acl_node_item *item = node_list.head;
+
+	for (; item; item = item->next) {
+		if (item->node_id == node_id)
+			return item;
+	}
+
+	return NULL;
+}
+
+int
+ip4_acl_node_data_add(rte_node_t node_id, char const *next_node)
+{
+	struct ip4_acl_node_item *item;
+
+	if (next_node == NULL)
+		return -EINVAL;
+
+	if (ip4_acl_node_data_get(node_id))
+		return -EEXIST;
+
+	item = rte_zmalloc(NULL, sizeof(struct ip4_acl_node_item), 0);
+	if (!item)
+		return -ENOMEM;
+
+	rte_node_edge_update(node_id, RTE_EDGE_ID_INVALID, &next_node, 1);
+	item->ctx.next_node = rte_node_edge_count(node_id) - 1;
+	item->node_id = node_id;
+	item->prev = NULL;
+	item->next = node_list.head;
+	if (node_list.head)
+		node_list.head->prev = item;
+	node_list.head = item;
+
+	return 0;
+}
+
+static int
+ip4_acl_node_init(__rte_unused const struct rte_graph *graph, struct rte_node *node)
+{
+	struct ip4_acl_node_ctx *ctx = (struct ip4_acl_node_ctx *)node->ctx;
+	struct ip4_acl_node_item *item = ip4_acl_node_data_get(node->id);
+
+	RTE_VERIFY(sizeof(*ctx) <= sizeof(node->ctx));
+	RTE_VERIFY(item != NULL);
+	RTE_VERIFY(acl_main != NULL);
+
+	memcpy(ctx, &item->ctx, sizeof(*ctx));
+
+	return 0;
+}
+
+static void
+ip4_acl_node_fini(__rte_unused const struct rte_graph *graph, struct rte_node *node)
+{
+	struct ip4_acl_node_item *item = ip4_acl_node_data_get(node->id);
+
+	if (!item)
+		return;
+
+	if (item->next)
+		item->next->prev = item->prev;
+	if (item->prev)
+		item->prev->next = item->next;
+	if (item == node_list.head)
+		node_list.head = item->next;
+
+	rte_free(item);
+}
+
+static struct rte_node_register ip4_acl_node = {
+	.process = ip4_acl_node_process,
+	.name = "vs_acl",
+
+	.init = ip4_acl_node_init,
+	.fini = ip4_acl_node_fini,
+
+	.nb_edges = IP4_ACL_NEXT_MAX,
+	.next_nodes = {
+		[IP4_ACL_NEXT_PKT_DROP] = "pkt_drop",
+	},
+};
+
+rte_node_t
+ip4_acl_node_clone(char const *name)
+{
+	return rte_node_clone(ip4_acl_node.id, name);
+}
+
+RTE_NODE_REGISTER(ip4_acl_node);
@@ -0,0 +1,52 @@
+/*
+  SPDX-License-Identifier: MIT
+  Copyright(c) 2023 Sriram Yagnaraman.
+*/
+
+#ifndef __SRC_LIB_NODE_IP4_ACL_H__
+#define __SRC_LIB_NODE_IP4_ACL_H__
+
+#include <rte_graph.h>
+#include <rte_rcu_qsbr.h>
+
+#define IP4_ACL_RULES_MAX	(1 << 16)
+
+enum ip4_acl_action {
+	IP4_ACL_PERMIT = 0,
+	IP4_ACL_DENY,
+	IP4_ACL_ACTION_MAX,
+};
+
+/* Addresses and ports in host byte order, proto 0 and depth 0 match
+ * anything. The highest priority match wins and hands its policer, 0
+ * for none, to vs_policer.
+ */
+struct ip4_acl_rule {
+	uint32_t priority;
+	uint8_t action;
+	uint8_t policer;
+	uint8_t proto;
+	uint8_t src_depth;
+	uint8_t dst_depth;
+	uint32_t src_ip;
+	uint32_t dst_ip;
+	uint16_t sport_lo;
+	uint16_t sport_hi;
+	uint16_t dport_lo;
+	uint16_t dport_hi;
+};
+
+int ip4_acl_init(struct rte_rcu_qsbr *qsv, int socket_id);
+void ip4_acl_fini(void);
+bool ip4_acl_enabled(void);
+
+/* Compiles the rules on the calling thread and swaps them in, returns
+ * once no worker can see the previous set.
+ */
+int ip4_acl_rules_set(struct ip4_acl_rule const *rules, uint32_t nb_rules,
+		      uint8_t default_action);
+
+rte_node_t ip4_acl_node_clone(char const *name);
+int ip4_acl_node_data_add(rte_node_t node_id, char const *next_node);
+
+#endif /* __SRC_LIB_NODE_IP4_ACL_H__ */
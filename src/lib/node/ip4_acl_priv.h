@@ -0,0 +1,69 @@
+/*
+  SPDX-License-Identifier: MIT
+  Copyright(c) 2023 Sriram Yagnaraman.
+*/
+
+#ifndef __SRC_LIB_NODE_IP4_ACL_PRIV_H__
+#define __SRC_LIB_NODE_IP4_ACL_PRIV_H__
+
+#include <rte_acl.h>
+#include <rte_common.h>
+#include <rte_graph.h>
+#include <rte_rcu_qsbr.h>
+
+#include "ip4_acl.h"
+
+#define IP4_ACL_BURST		(64)
+#define IP4_ACL_NAME_FMT	"vs-acl-%u"
+
+/* rte_acl wants the first field to be one byte wide, the input starts
+ * at the protocol byte of the IPv4 header.
+ */
+enum ip4_acl_field {
+	IP4_ACL_FIELD_PROTO = 0,
+	IP4_ACL_FIELD_SRC,
+	IP4_ACL_FIELD_DST,
+	IP4_ACL_FIELD_SPORT,
+	IP4_ACL_FIELD_DPORT,
+	IP4_ACL_FIELD_NUM,
+};
+
+RTE_ACL_RULE_DEF(ip4_acl_acl_rule, IP4_ACL_FIELD_NUM);
+
+/* What the workers see, replaced as a whole. acl is NULL for an empty
+ * rule set.
+ */
+struct ip4_acl_table {
+	struct rte_acl_ctx *acl;
+	uint8_t default_action;
+};
+
+struct ip4_acl_main {
+	struct ip4_acl_table *table;
+	struct rte_rcu_qsbr *qsv;
+	int socket_id;
+	uint32_t nb_builds;
+};
+
+struct ip4_acl_node_ctx {
+	rte_edge_t next_node;
+};
+
+struct ip4_acl_node_item {
+	struct ip4_acl_node_item *next;
+	struct ip4_acl_node_item *prev;
+	struct ip4_acl_node_ctx ctx;
+
+	rte_node_t node_id;
+};
+
+struct ip4_acl_node_list {
+	struct ip4_acl_node_item *head;
+};
+
+enum ip4_acl_next_nodes {
+	IP4_ACL_NEXT_PKT_DROP = 0,
+	IP4_ACL_NEXT_MAX,
+};
+
+#endif /* __SRC_LIB_NODE_IP4_ACL_PRIV_H__ */
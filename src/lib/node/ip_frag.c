@@ -0,0 +1,553 @@
+/*
+  SPDX-License-Identifier: MIT
+  Copyright(c) 2023 Sriram Yagnaraman.
+*/
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <rte_cycles.h>
+#include <rte_ether.h>
+#include <rte_graph.h>
+#include <rte_graph_worker.h>
+#include <rte_ip.h>
+#include <rte_ip_frag.h>
+#include <rte_lcore.h>
+#include <rte_malloc.h>
+#include <rte_mbuf.h>
+#include <rte_tcp.h>
+#include <rte_udp.h>
+
+#include "ip_frag_priv.h"
+#include "ip_frag.h"
+
+static struct ip_frag_pools ip_frag_pools[RTE_MAX_NUMA_NODES];
+static struct ip_reassembly_table *ip_reassembly_tables[RTE_MAX_LCORE];
+
+static struct ip_frag_node_list node_list = {
+	.head = NULL,
+};
+
+static struct ip_frag_pools *
+ip_frag_pools_get(unsigned int socket)
+{
+	struct ip_frag_pools *pools = &ip_frag_pools[socket];
+	char name[RTE_MEMPOOL_NAMESIZE];
+
+	if (pools->direct)
+		return pools;
+
+	snprintf(name, sizeof(name), "vs_frag_direct_%u", socket);
+	pools->direct = rte_pktmbuf_pool_create(name, IP_FRAG_POOL_SIZE, IP_FRAG_POOL_CACHE,
+						0, IP_FRAG_DIRECT_ROOM, socket);
+	if (!pools->direct)
+		return NULL;
+
+	/* Indirect mbufs only point into the original payload */
+	snprintf(name, sizeof(name), "vs_frag_indirect_%u", socket);
+	pools->indirect = rte_pktmbuf_pool_create(name, IP_FRAG_POOL_SIZE, IP_FRAG_POOL_CACHE,
+						  0, 0, socket);
+	if (!pools->indirect) {
+		rte_mempool_free(pools->direct);
+		pools->direct = NULL;
+		return NULL;
+	}
+
+	return pools;
+}
+
+void
+ip_frag_fini(void)
+{
+	struct ip_reassembly_table *t;
+	uint32_t i;
+
+	for (i = 0; i < RTE_MAX_LCORE; i++) {
+		t = ip_reassembly_tables[i];
+		if (!t)
+			continue;
+
+		rte_ip_frag_free_death_row(&t->dr, 0);
+		rte_ip_frag_table_destroy(t->tbl);
+		rte_free(t);
+		ip_reassembly_tables[i] = NULL;
+	}
+
+	for (i = 0; i < RTE_MAX_NUMA_NODES; i++) {
+		rte_mempool_free(ip_frag_pools[i].indirect);
+		rte_mempool_free(ip_frag_pools[i].direct);
+		ip_frag_pools[i].indirect = NULL;
+		ip_frag_pools[i].direct = NULL;
+	}
+}
+
+static __rte_always_inline void
+ip_frag_l4_cksum(struct rte_mbuf *mbuf, void *l3, uint16_t l4_off, bool ipv4)
+{
+	uint8_t *l4 = (uint8_t *)l3 + l4_off;
+	uint16_t *cksum;
+	uint8_t proto;
+
+	proto = ipv4 ? ((struct rte_ipv4_hdr *)l3)->next_proto_id :
+		       ((struct rte_ipv6_hdr *)l3)->proto;
+	if (proto == IPPROTO_TCP)
+		cksum = &((struct rte_tcp_hdr *)l4)->cksum;
+	else if (proto == IPPROTO_UDP)
+		cksum = &((struct rte_udp_hdr *)l4)->dgram_cksum;
+	else
+		return;
+
+	*cksum = 0;
+	*cksum = ipv4 ? rte_ipv4_udptcp_cksum_mbuf(mbuf, l3, l4_off) :
+			rte_ipv6_udptcp_cksum_mbuf(mbuf, l3, l4_off);
+}
+
+/* The hardware cannot checksum a packet it only sees in pieces, finish
+ * what was left to it. mbuf starts at the IP header.
+ */
+static int
+ip_frag_cksum_finish(struct rte_mbuf *mbuf, bool ipv4)
+{
+	void *l3 = rte_pktmbuf_mtod(mbuf, void *);
+	uint64_t ol_flags = mbuf->ol_flags;
+
+	if (ol_flags & RTE_MBUF_F_TX_TUNNEL_MASK) {
+		/* Inner offsets are gone once the outer header is split */
+		if (ol_flags & RTE_MBUF_F_TX_L4_MASK)
+			return -ENOTSUP;
+		if (ol_flags & RTE_MBUF_F_TX_OUTER_UDP_CKSUM)
+			ip_frag_l4_cksum(mbuf, l3, mbuf->outer_l3_len, ipv4);
+	} else if (ol_flags & RTE_MBUF_F_TX_L4_MASK) {
+		ip_frag_l4_cksum(mbuf, l3, mbuf->l3_len, ipv4);
+	}
+
+	mbuf->ol_flags &= ~RTE_MBUF_F_TX_OFFLOAD_MASK;
+	return 0;
+}
+
+/* Frames on untouched links and QinQ customer frames still carry their
+ * tags in band, skip up to two to get at the IP header.
+ */
+static __rte_always_inline uint16_t
+ip_frag_l2_len(struct rte_mbuf *mbuf, rte_be16_t *proto)
+{
+	struct rte_ether_hdr *eth = rte_pktmbuf_mtod(mbuf, struct rte_ether_hdr *);
+	uint16_t len = sizeof(*eth);
+	struct rte_vlan_hdr *vh;
+	int i;
+
+	*proto = eth->ether_type;
+	for (i = 0; i < IP_FRAG_TAGS_MAX; i++) {
+		if (*proto != RTE_BE16(RTE_ETHER_TYPE_VLAN) &&
+		    *proto != RTE_BE16(RTE_ETHER_TYPE_QINQ))
+			break;
+
+		if (unlikely(rte_pktmbuf_data_len(mbuf) < len + sizeof(*vh)))
+			return 0;
+
+		vh = (struct rte_vlan_hdr *)((uint8_t *)eth + len);
+		*proto = vh->eth_proto;
+		len += sizeof(*vh);
+	}
+
+	return len;
+}
+
+static int
+ip_frag_one(struct ip_frag_node_ctx *ctx, struct rte_mbuf *mbuf, struct rte_mbuf **frags)
+{
+	uint8_t l2[IP_FRAG_L2_MAX];
+	struct rte_ipv4_hdr *ip4;
+	struct rte_mbuf *frag;
+	uint64_t vlan_flags;
+	rte_be16_t proto;
+	uint16_t l2_len;
+	int32_t n, i;
+	uint8_t *hdr;
+	bool ipv4;
+	int rc;
+
+	l2_len = ip_frag_l2_len(mbuf, &proto);
+	if (proto == RTE_BE16(RTE_ETHER_TYPE_IPV4))
+		ipv4 = true;
+	else if (proto == RTE_BE16(RTE_ETHER_TYPE_IPV6))
+		ipv4 = false;
+	else
+		return -EINVAL;
+
+	if (unlikely(l2_len == 0))
+		return -EINVAL;
+
+	/* Cleared with the checksum offloads below */
+	vlan_flags = mbuf->ol_flags & (RTE_MBUF_F_TX_VLAN | RTE_MBUF_F_TX_QINQ);
+
+	/* The library wants the IP header first */
+	memcpy(l2, rte_pktmbuf_mtod(mbuf, void *), l2_len);
+	rte_pktmbuf_adj(mbuf, l2_len);
+	rc = ip_frag_cksum_finish(mbuf, ipv4);
+	if (rc < 0)
+		return rc;
+
+	if (ipv4)
+		n = rte_ipv4_fragment_packet(mbuf, frags, IP_FRAG_MAX, ctx->mtu,
+					     ctx->pools->direct, ctx->pools->indirect);
+	else
+		n = rte_ipv6_fragment_packet(mbuf, frags, IP_FRAG_MAX, ctx->mtu,
+					     ctx->pools->direct, ctx->pools->indirect);
+	/* DF set or too many fragments, nothing was allocated. The frame is
+	 * put back together for the kernel.
+	 */
+	if (n < 0) {
+		rte_pktmbuf_prepend(mbuf, l2_len);
+		mbuf->ol_flags |= vlan_flags;
+		return n == -ENOMEM ? n : -EMSGSIZE;
+	}
+
+	for (i = 0; i < n; i++) {
+		frag = frags[i];
+		hdr = (uint8_t *)rte_pktmbuf_prepend(frag, l2_len);
+		if (unlikely(!hdr))
+			goto err;
+
+		memcpy(hdr, l2, l2_len);
+		if (ipv4) {
+			ip4 = (struct rte_ipv4_hdr *)(hdr + l2_len);
+			ip4->hdr_checksum = 0;
+			ip4->hdr_checksum = rte_ipv4_cksum(ip4);
+		}
+
+		/* What the tx side nodes still look at */
+		frag->port = mbuf->port;
+		frag->vlan_tci = mbuf->vlan_tci;
+		frag->vlan_tci_outer = mbuf->vlan_tci_outer;
+		frag->hash = mbuf->hash;
+		frag->ol_flags |= vlan_flags;
+		frag->ol_flags |= mbuf->ol_flags & (RTE_MBUF_F_RX_VLAN | RTE_MBUF_F_RX_VLAN_STRIPPED |
+						    RTE_MBUF_F_RX_RSS_HASH);
+	}
+
+	/* The fragments hold their own references to the payload */
+	rte_pktmbuf_free(mbuf);
+	return n;
+
+err:
+	for (i = 0; i < n; i++)
+		rte_pktmbuf_free(frags[i]);
+	return -ENOSPC;
+}
+
+static uint16_t
+ip_frag_node_process(struct rte_graph *graph,
+		     struct rte_node *node,
+		     void **objs,
+		     uint16_t nb_objs)
+{
+	struct ip_frag_node_ctx *ctx = (struct ip_frag_node_ctx *)node->ctx;
+	struct rte_mbuf **pkts = (struct rte_mbuf **)objs;
+	struct rte_mbuf *frags[IP_FRAG_MAX];
+	uint32_t max_len = ctx->mtu + RTE_ETHER_HDR_LEN;
+	struct rte_mbuf *mbuf;
+	uint16_t i;
+	int32_t n;
+
+	for (i = 0; i < nb_objs; i++) {
+		if (unlikely(rte_pktmbuf_pkt_len(pkts[i]) > max_len))
+			break;
+	}
+
+	/* Nothing to split, hand the whole burst over */
+	if (likely(i == nb_objs)) {
+		rte_node_next_stream_move(graph, node, ctx->next_node);
+		return nb_objs;
+	}
+
+	if (i)
+		rte_node_enqueue(graph, node, ctx->next_node, objs, i);
+
+	for (; i < nb_objs; i++) {
+		mbuf = pkts[i];
+		if (rte_pktmbuf_pkt_len(mbuf) <= max_len) {
+			rte_node_enqueue_x1(graph, node, ctx->next_node, mbuf);
+			continue;
+		}
+
+		n = ip_frag_one(ctx, mbuf, frags);
+		if (unlikely(n == -EMSGSIZE)) {
+			rte_node_enqueue_x1(graph, node, IP_FRAG_NEXT_EXCEPTION, mbuf);
+			continue;
+		} else if (unlikely(n < 0)) {
+			rte_node_enqueue_x1(graph, node, IP_FRAG_NEXT_PKT_DROP, mbuf);
+			continue;
+		}
+
+		rte_node_enqueue(graph, node, ctx->next_node, (void **)frags, n);
+	}
+
+	return nb_objs;
+}
+
+static __rte_always_inline struct rte_mbuf *
+ip_reassembly_one(struct ip_reassembly_table *t, struct rte_mbuf *mbuf, uint64_t tms)
+{
+	struct rte_ipv6_fragment_ext *frag;
+	struct rte_ipv4_hdr *ip4;
+	struct rte_ipv6_hdr *ip6;
+	rte_be16_t proto;
+	uint16_t l2_len;
+
+	/* The reassembled packet keeps the first fragment's L2 header */
+	l2_len = ip_frag_l2_len(mbuf, &proto);
+	mbuf->l2_len = l2_len;
+	if (unlikely(l2_len == 0))
+		return mbuf;
+
+	if (proto == RTE_BE16(RTE_ETHER_TYPE_IPV4)) {
+		ip4 = rte_pktmbuf_mtod_offset(mbuf, struct rte_ipv4_hdr *, l2_len);
+		if (!rte_ipv4_frag_pkt_is_fragmented(ip4))
+			return mbuf;
+
+		mbuf->l3_len = rte_ipv4_hdr_len(ip4);
+		mbuf = rte_ipv4_frag_reassemble_packet(t->tbl, &t->dr, mbuf, tms, ip4);
+		if (!mbuf)
+			return NULL;
+
+		ip4 = rte_pktmbuf_mtod_offset(mbuf, struct rte_ipv4_hdr *, mbuf->l2_len);
+		ip4->hdr_checksum = 0;
+		ip4->hdr_checksum = rte_ipv4_cksum(ip4);
+	} else if (proto == RTE_BE16(RTE_ETHER_TYPE_IPV6)) {
+		ip6 = rte_pktmbuf_mtod_offset(mbuf, struct rte_ipv6_hdr *, l2_len);
+		frag = rte_ipv6_frag_get_ipv6_fragment_header(ip6);
+		if (!frag)
+			return mbuf;
+
+		mbuf->l3_len = sizeof(*ip6) + sizeof(*frag);
+		mbuf = rte_ipv6_frag_reassemble_packet(t->tbl, &t->dr, mbuf, tms, ip6, frag);
+		if (!mbuf)
+			return NULL;
+	} else {
+		return mbuf;
+	}
+
+	/* The rx checksum verdict was for the first fragment only */
+	mbuf->ol_flags &= ~RTE_MBUF_F_RX_L4_CKSUM_MASK;
+	return mbuf;
+}
+
+static uint16_t
+ip_reassembly_node_process(struct rte_graph *graph,
+			   struct rte_node *node,
+			   void **objs,
+			   uint16_t nb_objs)
+{
+	struct ip_reassembly_node_ctx *ctx = (struct ip_reassembly_node_ctx *)node->ctx;
+	struct rte_mbuf **pkts = (struct rte_mbuf **)objs;
+	struct ip_reassembly_table *t = ctx->table;
+	struct rte_mbuf *mbuf;
+	uint16_t i, held = 0;
+	void **to_next;
+	uint64_t tms;
+
+	tms = rte_rdtsc();
+	to_next = rte_node_next_stream_get(graph, node, ctx->next_node, nb_objs);
+
+	for (i = 0; i < nb_objs; i++) {
+		mbuf = pkts[i];
+		if (likely(!t->links[mbuf->port])) {
+			to_next[held++] = mbuf;
+			continue;
+		}
+
+		/* Fragments are kept by the table until the last one shows up */
+		mbuf = ip_reassembly_one(t, mbuf, tms);
+		if (mbuf)
+			to_next[held++] = mbuf;
+	}
+
+	rte_node_next_stream_put(graph, node, ctx->next_node, held);
+
+	rte_ip_frag_table_del_expired_entries(t->tbl, &t->dr, tms);
+	rte_ip_frag_free_death_row(&t->dr, 3);
+	return nb_objs;
+}
+
+static struct ip_frag_node_item*
+ip_frag_node_data_get(rte_node_t node_id)
+{
+	struct ip_frag_node_item *item = node_list.head;
+
+	for (; item; item = item->next) {
+		if (item->node_id == node_id)
+			return item;
+	}
+
+	return NULL;
+}
+
+static void
+ip_frag_node_item_link(struct ip_frag_node_item *item, rte_node_t node_id)
+{
+	item->node_id = node_id;
+	item->prev = NULL;
+	item->next = node_list.head;
+	if (node_list.head)
+		node_list.head->prev = item;
+	node_list.head = item;
+}
+
+int
+ip_frag_node_data_add(rte_node_t node_id, unsigned int lcore_id, uint16_t mtu,
+		      char const *next_node)
+{
+	struct ip_frag_node_item *item;
+	struct ip_frag_pools *pools;
+
+	if (next_node == NULL || lcore_id >= RTE_MAX_LCORE ||
+	    mtu < RTE_IPV6_MIN_MTU)
+		return -EINVAL;
+
+	if (ip_frag_node_data_get(node_id))
+		return -EEXIST;
+
+	pools = ip_frag_pools_get(rte_lcore_to_socket_id(lcore_id));
+	if (!pools)
+		return -ENOMEM;
+
+	item = rte_zmalloc(NULL, sizeof(struct ip_frag_node_item), 0);
+	if (!item)
+		return -ENOMEM;
+
+	rte_node_edge_update(node_id, RTE_EDGE_ID_INVALID, &next_node, 1);
+	item->ctx.frag.pools = pools;
+	item->ctx.frag.mtu = mtu;
+	item->ctx.frag.next_node = rte_node_edge_count(node_id) - 1;
+	ip_frag_node_item_link(item, node_id);
+
+	return 0;
+}
+
+int
+ip_reassembly_node_data_add(rte_node_t node_id, unsigned int lcore_id,
+			    uint8_t const *links, char const *next_node)
+{
+	struct ip_reassembly_table *t;
+	struct ip_frag_node_item *item;
+	uint64_t max_cycles;
+	unsigned int socket;
+
+	if (next_node == NULL || links == NULL || lcore_id >= RTE_MAX_LCORE)
+		return -EINVAL;
+
+	if (ip_frag_node_data_get(node_id))
+		return -EEXIST;
+
+	item = rte_zmalloc(NULL, sizeof(struct ip_frag_node_item), 0);
+	if (!item)
+		return -ENOMEM;
+
+	/* A rebuilt graph takes over the pending fragments of the lcore */
+	t = ip_reassembly_tables[lcore_id];
+	if (t)
+		goto link;
+
+	socket = rte_lcore_to_socket_id(lcore_id);
+	t = rte_zmalloc_socket(NULL, sizeof(*t), RTE_CACHE_LINE_SIZE, socket);
+	if (!t) {
+		rte_free(item);
+		return -ENOMEM;
+	}
+
+	max_cycles = (rte_get_tsc_hz() + MS_PER_S - 1) / MS_PER_S * IP_REASSEMBLY_TTL_MS;
+	t->tbl = rte_ip_frag_table_create(IP_REASSEMBLY_FLOWS / IP_REASSEMBLY_ENTRIES,
+					  IP_REASSEMBLY_ENTRIES, IP_REASSEMBLY_FLOWS,
+					  max_cycles, socket);
+	if (!t->tbl) {
+		rte_free(t);
+		rte_free(item);
+		return -ENOMEM;
+	}
+
+	ip_reassembly_tables[lcore_id] = t;
+
+link:
+	memcpy(t->links, links, sizeof(t->links));
+	rte_node_edge_update(node_id, RTE_EDGE_ID_INVALID, &next_node, 1);
+	item->ctx.reassembly.table = t;
+	item->ctx.reassembly.next_node = rte_node_edge_count(node_id) - 1;
+	ip_frag_node_item_link(item, node_id);
+
+	return 0;
+}
+
+static int
+ip_frag_node_init(__rte_unused const struct rte_graph *graph, struct rte_node *node)
+{
+	struct ip_frag_node_item *item = ip_frag_node_data_get(node->id);
+
+	RTE_VERIFY(sizeof(item->ctx) <= sizeof(node->ctx));
+	RTE_VERIFY(item != NULL);
+
+	memcpy(node->ctx, &item->ctx, sizeof(item->ctx));
+
+	return 0;
+}
+
+static void
+ip_frag_node_fini(__rte_unused const struct rte_graph *graph, struct rte_node *node)
+{
+	struct ip_frag_node_item *item = ip_frag_node_data_get(node->id);
+
+	if (!item)
+		return;
+
+	if (item->next)
+		item->next->prev = item->prev;
+	if (item->prev)
+		item->prev->next = item->next;
+	if (item == node_list.head)
+		node_list.head = item->next;
+
+	rte_free(item);
+}
+
+static struct rte_node_register ip_frag_node = {
+	.process = ip_frag_node_process,
+	.name = "vs_ip_frag",
+
+	.init = ip_frag_node_init,
+	.fini = ip_frag_node_fini,
+
+	.nb_edges = IP_FRAG_NEXT_MAX,
+	.next_nodes = {
+		[IP_FRAG_NEXT_PKT_DROP] = "pkt_drop",
+		[IP_FRAG_NEXT_EXCEPTION] = "vs_exception_tx",
+	},
+};
+
+static struct rte_node_register ip_reassembly_node = {
+	.process = ip_reassembly_node_process,
+	.name = "vs_ip_reassembly",
+
+	.init = ip_frag_node_init,
+	.fini = ip_frag_node_fini,
+
+	.nb_edges = IP_REASSEMBLY_NEXT_MAX,
+	.next_nodes = {
+		[IP_REASSEMBLY_NEXT_PKT_DROP] = "pkt_drop",
+	},
+};
+
+rte_node_t
+ip_frag_node_clone(char const *name)
+{
+	return rte_node_clone(ip_frag_node.id, name);
+}
+
+rte_node_t
+ip_reassembly_node_clone(char const *name)
+{
+	return rte_node_clone(ip_reassembly_node.id, name);
+}
+
+RTE_NODE_REGISTER(ip_frag_node);
+RTE_NODE_REGISTER(ip_reassembly_node);
@@ -0,0 +1,31 @@
+/*
+  SPDX-License-Identifier: MIT
+  Copyright(c) 2023 Sriram Yagnaraman.
+*/
+
+#ifndef __SRC_LIB_NODE_IP_FRAG_H__
+#define __SRC_LIB_NODE_IP_FRAG_H__
+
+#include <rte_ethdev.h>
+#include <rte_graph.h>
+
+rte_node_t ip_frag_node_clone(char const *name);
+
+/* Packets over mtu, counted from the IP header, leave next_node as
+ * fragments. Payloads are attached, not copied. Packets that may not
+ * be fragmented are punted to vs_exception_tx.
+ */
+int ip_frag_node_data_add(rte_node_t node_id, unsigned int lcore_id, uint16_t mtu,
+			  char const *next_node);
+
+rte_node_t ip_reassembly_node_clone(char const *name);
+
+/* One table per lcore, only packets received on links set in links
+ * are reassembled.
+ */
+int ip_reassembly_node_data_add(rte_node_t node_id, unsigned int lcore_id,
+				uint8_t const *links, char const *next_node);
+
+void ip_frag_fini(void);
+
+#endif /* __SRC_LIB_NODE_IP_FRAG_H__ */
@@ -0,0 +1,82 @@
+/*
+  SPDX-License-Identifier: MIT
+  Copyright(c) 2023 Sriram Yagnaraman.
+*/
+
+#ifndef __SRC_LIB_NODE_IP_FRAG_PRIV_H__
+#define __SRC_LIB_NODE_IP_FRAG_PRIV_H__
+
+#include <rte_common.h>
+#include <rte_ether.h>
+#include <rte_graph.h>
+#include <rte_ip_frag.h>
+#include <rte_mempool.h>
+
+#include "ip_frag.h"
+
+#define IP_FRAG_POOL_SIZE	(16384)
+#define IP_FRAG_POOL_CACHE	(256)
+/* Copy of the IP header plus the prepended ethernet header */
+#define IP_FRAG_DIRECT_ROOM	(RTE_PKTMBUF_HEADROOM + 128)
+#define IP_FRAG_MAX		(RTE_LIBRTE_IP_FRAG_MAX_FRAG)
+
+/* In-band tags kept in front of the IP header of each fragment */
+#define IP_FRAG_TAGS_MAX	(2)
+#define IP_FRAG_L2_MAX		(RTE_ETHER_HDR_LEN + IP_FRAG_TAGS_MAX * sizeof(struct rte_vlan_hdr))
+
+#define IP_REASSEMBLY_FLOWS	(4096)
+#define IP_REASSEMBLY_ENTRIES	(16)
+#define IP_REASSEMBLY_TTL_MS	(2000)
+
+struct ip_frag_pools {
+	struct rte_mempool *direct;
+	struct rte_mempool *indirect;
+};
+
+struct ip_reassembly_table {
+	struct rte_ip_frag_tbl *tbl;
+	struct rte_ip_frag_death_row dr;
+	uint8_t links[RTE_MAX_ETHPORTS];
+};
+
+struct ip_frag_node_ctx {
+	struct ip_frag_pools *pools;
+	uint16_t mtu;
+	rte_edge_t next_node;
+};
+
+struct ip_reassembly_node_ctx {
+	struct ip_reassembly_table *table;
+	rte_edge_t next_node;
+};
+
+struct ip_frag_node_item {
+	struct ip_frag_node_item *next;
+	struct ip_frag_node_item *prev;
+	union {
+		struct ip_frag_node_ctx frag;
+		struct ip_reassembly_node_ctx reassembly;
+	} ctx;
+
+	rte_node_t node_id;
+};
+
+struct ip_frag_node_list {
+	struct ip_frag_node_item *head;
+};
+
+enum ip_frag_next_nodes {
+	IP_FRAG_NEXT_PKT_DROP = 0,
+	/* DF set or not splittable, the kernel answers with Fragmentation
+	 * Needed or Packet Too Big.
+	 */
+	IP_FRAG_NEXT_EXCEPTION,
+	IP_FRAG_NEXT_MAX,
+};
+
+enum ip_reassembly_next_nodes {
+	IP_REASSEMBLY_NEXT_PKT_DROP = 0,
+	IP_REASSEMBLY_NEXT_MAX,
+};
+
+#endif /* __SRC_LIB_NODE_IP_FRAG_PRIV_H__ */
@@ -0,0 +1,670 @@
+/*
+  SPDX-License-Identifier: MIT
+  Copyright(c) 2023 Sriram Yagnaraman.
+*/
+
+#include <errno.h>
+#include <string.h>
+
+#include <rte_ether.h>
+#include <rte_graph.h>
+#include <rte_graph_worker.h>
+#include <rte_hash.h>
+#include <rte_hash_crc.h>
+#include <rte_malloc.h>
+#include <rte_mbuf.h>
+#include <rte_ring_elem.h>
+
+#include "eventdev_rx.h"
+#include "flow_cache.h"
+#include "l2_bridge_priv.h"
+#include "l2_bridge.h"
+#include "vlan.h"
+
+static struct l2_bridge_main *bridge_main;
+
+static struct l2_bridge_node_list node_list = {
+	.head = NULL,
+};
+
+static struct l2_bridge_node_item* l2_bridge_node_data_get(rte_node_t node_id);
+
+int
+l2_bridge_init(uint32_t fdb_size, struct rte_rcu_qsbr *qsv, int socket_id)
+{
+	struct rte_hash_rcu_config rcu_config;
+	struct rte_hash_parameters params;
+	struct l2_bridge_main *bm;
+	uint32_t i;
+	int rc;
+
+	if (bridge_main)
+		return -EEXIST;
+
+	bm = rte_zmalloc_socket(NULL, sizeof(*bm), RTE_CACHE_LINE_SIZE, socket_id);
+	if (!bm)
+		return -ENOMEM;
+
+	rte_spinlock_init(&bm->lock);
+	bm->fdb_size = fdb_size;
+	for (i = 0; i < RTE_MAX_ETHPORTS; i++)
+		bm->link_bd[i] = L2_BRIDGE_ID_INVALID;
+
+	bm->entries = rte_zmalloc_socket(NULL, fdb_size * sizeof(*bm->entries),
+					 RTE_CACHE_LINE_SIZE, socket_id);
+	if (!bm->entries) {
+		rc = -ENOMEM;
+		goto err;
+	}
+
+	for (i = 0; i < fdb_size; i++)
+		bm->entries[i].link_id = L2_BRIDGE_LINK_INVALID;
+
+	/* Workers look up, only the control thread adds and deletes */
+	memset(&params, 0, sizeof(params));
+	params.name = "l2_bridge_fdb";
+	params.entries = fdb_size;
+	params.key_len = sizeof(struct l2_bridge_key);
+	params.hash_func = rte_hash_crc;
+	params.hash_func_init_val = 0;
+	params.socket_id = socket_id;
+	params.extra_flag = RTE_HASH_EXTRA_FLAGS_RW_CONCURRENCY_LF;
+	bm->fdb = rte_hash_create(&params);
+	if (!bm->fdb) {
+		rc = -rte_errno;
+		goto err;
+	}
+
+	memset(&rcu_config, 0, sizeof(rcu_config));
+	rcu_config.v = qsv;
+	rcu_config.mode = RTE_HASH_QSBR_MODE_DQ;
+	rc = rte_hash_rcu_qsbr_add(bm->fdb, &rcu_config);
+	if (rc) {
+		rc = -rte_errno;
+		goto err;
+	}
+
+	bm->learn = rte_ring_create_elem("l2_bridge_learn",
+					 sizeof(struct l2_bridge_learn),
+					 L2_BRIDGE_LEARN_RING_SZ,
+					 socket_id,
+					 RING_F_SC_DEQ);
+	if (!bm->learn) {
+		rc = -rte_errno;
+		goto err;
+	}
+
+	bridge_main = bm;
+	return 0;
+
+err:
+	rte_ring_free(bm->learn);
+	rte_hash_free(bm->fdb);
+	rte_free(bm->entries);
+	rte_free(bm);
+	return rc;
+}
+
+void
+l2_bridge_fini(void)
+{
+	struct l2_bridge_main *bm = bridge_main;
+
+	if (!bm)
+		return;
+
+	bridge_main = NULL;
+	rte_ring_free(bm->learn);
+	rte_hash_free(bm->fdb);
+	rte_free(bm->entries);
+	rte_free(bm);
+}
+
+bool
+l2_bridge_enabled(void)
+{
+	return bridge_main != NULL;
+}
+
+int
+l2_bridge_domain_set(uint16_t bd_id, uint16_t ageing_s)
+{
+	struct l2_bridge_main *bm = bridge_main;
+
+	if (!bm)
+		return -ENODEV;
+
+	if (bd_id >= L2_BRIDGE_MAX_DOMAINS)
+		return -EINVAL;
+
+	bm->domains[bd_id].ageing_s = ageing_s;
+	return 0;
+}
+
+int
+l2_bridge_domain_add_link(uint16_t bd_id, uint16_t link_id)
+{
+	struct l2_bridge_main *bm = bridge_main;
+	struct l2_bridge_domain *domain;
+
+	if (!bm)
+		return -ENODEV;
+
+	if (bd_id >= L2_BRIDGE_MAX_DOMAINS || link_id >= RTE_MAX_ETHPORTS)
+		return -EINVAL;
+
+	if (bm->link_bd[link_id] != L2_BRIDGE_ID_INVALID)
+		return -EEXIST;
+
+	domain = &bm->domains[bd_id];
+	if (domain->nb_links == L2_BRIDGE_MAX_MEMBERS)
+		return -ENOSPC;
+
+	domain->links[domain->nb_links++] = link_id;
+	bm->link_bd[link_id] = bd_id;
+	return 0;
+}
+
+uint16_t
+l2_bridge_domain_get(uint16_t link_id)
+{
+	struct l2_bridge_main *bm = bridge_main;
+
+	if (!bm || link_id >= RTE_MAX_ETHPORTS)
+		return L2_BRIDGE_ID_INVALID;
+
+	return bm->link_bd[link_id];
+}
+
+/* Readers treat an invalid link as a miss, so the entry is invalidated
+ * before the key goes away and only reused after a grace period.
+ */
+static void
+l2_bridge_fdb_del(struct l2_bridge_main *bm, struct l2_bridge_key *key)
+{
+	int32_t pos;
+
+	pos = rte_hash_lookup(bm->fdb, key);
+	if (pos < 0)
+		return;
+
+	__atomic_store_n(&bm->entries[pos].link_id, L2_BRIDGE_LINK_INVALID, __ATOMIC_RELEASE);
+	rte_hash_del_key(bm->fdb, key);
+	flow_cache_invalidate();
+}
+
+unsigned int
+l2_bridge_fdb_learn(void)
+{
+	struct l2_bridge_learn learn[L2_BRIDGE_LEARN_BURST];
+	struct l2_bridge_main *bm = bridge_main;
+	struct l2_bridge_fdb_entry *e;
+	unsigned int i, n, nb_learnt = 0, nb_moved = 0;
+	int32_t pos;
+
+	if (!bm)
+		return 0;
+
+	n = rte_ring_sc_dequeue_burst_elem(bm->learn, learn, sizeof(learn[0]),
+					   L2_BRIDGE_LEARN_BURST, NULL);
+	if (n == 0)
+		return 0;
+
+	rte_spinlock_lock(&bm->lock);
+	for (i = 0; i < n; i++) {
+		pos = rte_hash_lookup(bm->fdb, &learn[i].key);
+		if (pos < 0)
+			pos = rte_hash_add_key(bm->fdb, &learn[i].key);
+		if (pos < 0 || (uint32_t)pos >= bm->fdb_size)
+			continue;
+
+		e = &bm->entries[pos];
+		if (e->link_id != L2_BRIDGE_LINK_INVALID && e->link_id != learn[i].link_id)
+			nb_moved++;
+		e->bd_id = learn[i].key.bd_id;
+		e->age = 0;
+		__atomic_store_n(&e->link_id, learn[i].link_id, __ATOMIC_RELEASE);
+		nb_learnt++;
+	}
+	rte_spinlock_unlock(&bm->lock);
+
+	/* A station that moved invalidates cached forwarding towards it */
+	if (nb_moved)
+		flow_cache_invalidate();
+
+	return nb_learnt;
+}
+
+/* Called once a second, entries not hit for ageing_s seconds are removed */
+unsigned int
+l2_bridge_fdb_age(void)
+{
+	struct l2_bridge_key keys[L2_BRIDGE_AGE_BURST];
+	struct l2_bridge_main *bm = bridge_main;
+	struct l2_bridge_fdb_entry *e;
+	unsigned int i, n = 0;
+	uint16_t ageing_s;
+	uint32_t iter = 0;
+	const void *key;
+	void *data;
+	int32_t pos;
+
+	if (!bm)
+		return 0;
+
+	rte_spinlock_lock(&bm->lock);
+	while ((pos = rte_hash_iterate(bm->fdb, &key, &data, &iter)) >= 0) {
+		e = &bm->entries[pos];
+		if (e->link_id == L2_BRIDGE_LINK_INVALID)
+			continue;
+
+		if (e->hit) {
+			e->hit = 0;
+			e->age = 0;
+			continue;
+		}
+
+		ageing_s = bm->domains[e->bd_id].ageing_s;
+		if (ageing_s == 0 || ++e->age < ageing_s)
+			continue;
+
+		/* Whatever does not fit is removed on the next tick */
+		if (n < L2_BRIDGE_AGE_BURST)
+			keys[n++] = *(const struct l2_bridge_key *)key;
+	}
+
+	for (i = 0; i < n; i++)
+		l2_bridge_fdb_del(bm, &keys[i]);
+	rte_spinlock_unlock(&bm->lock);
+
+	return n;
+}
+
+int
+l2_bridge_fdb_flush(uint16_t bd_id)
+{
+	struct l2_bridge_key keys[L2_BRIDGE_AGE_BURST];
+	struct l2_bridge_main *bm = bridge_main;
+	const struct l2_bridge_key *k;
+	unsigned int i, n;
+	uint32_t iter;
+	const void *key;
+	void *data;
+
+	if (!bm)
+		return -ENODEV;
+
+	rte_spinlock_lock(&bm->lock);
+	do {
+		n = 0;
+		iter = 0;
+		while (n < L2_BRIDGE_AGE_BURST &&
+		       rte_hash_iterate(bm->fdb, &key, &data, &iter) >= 0) {
+			k = key;
+			if (bd_id == L2_BRIDGE_ID_INVALID || k->bd_id == bd_id)
+				keys[n++] = *k;
+		}
+
+		for (i = 0; i < n; i++)
+			l2_bridge_fdb_del(bm, &keys[i]);
+	} while (n == L2_BRIDGE_AGE_BURST);
+	rte_spinlock_unlock(&bm->lock);
+
+	return 0;
+}
+
+int
+l2_bridge_fdb_walk(l2_bridge_fdb_walk_cb cb, void *data)
+{
+	struct l2_bridge_main *bm = bridge_main;
+	struct l2_bridge_fdb_info info;
+	const struct l2_bridge_key *k;
+	struct l2_bridge_fdb_entry *e;
+	uint32_t iter = 0;
+	const void *key;
+	void *hash_data;
+	int32_t pos;
+	int rc = 0;
+
+	if (!bm)
+		return -ENODEV;
+
+	rte_spinlock_lock(&bm->lock);
+	while ((pos = rte_hash_iterate(bm->fdb, &key, &hash_data, &iter)) >= 0) {
+		e = &bm->entries[pos];
+		if (e->link_id == L2_BRIDGE_LINK_INVALID)
+			continue;
+
+		k = key;
+		rte_ether_addr_copy(&k->mac, &info.mac);
+		info.bd_id = k->bd_id;
+		info.vlan_id = k->vlan_id;
+		info.link_id = e->link_id;
+		info.age = e->age;
+		rc = cb(&info, data);
+		if (rc < 0)
+			break;
+	}
+	rte_spinlock_unlock(&bm->lock);
+
+	return rc;
+}
+
+int
+l2_bridge_node_data_add(rte_node_t node_id, uint16_t link_id, const char *next_node)
+{
+	struct l2_bridge_node_item* item;
+
+	if (link_id >= RTE_MAX_ETHPORTS)
+		return -EINVAL;
+
+	item = l2_bridge_node_data_get(node_id);
+	if (!item) {
+		item = rte_zmalloc(NULL, sizeof(struct l2_bridge_node_item), 0);
+		if (!item)
+			return -ENOMEM;
+
+		item->ctx.data = rte_zmalloc(NULL, sizeof(struct l2_bridge_node_data),
+					     RTE_CACHE_LINE_SIZE);
+		if (!item->ctx.data) {
+			rte_free(item);
+			return -ENOMEM;
+		}
+
+		item->ctx.last_next = L2_BRIDGE_NEXT_PKT_DROP;
+		item->node_id = node_id;
+		item->prev = NULL;
+		item->next = node_list.head;
+		if (node_list.head)
+			node_list.head->prev = item;
+		node_list.head = item;
+	}
+
+	rte_node_edge_update(node_id, RTE_EDGE_ID_INVALID, &next_node, 1);
+	item->ctx.data->next_nodes[link_id].enabled = 1;
+	item->ctx.data->next_nodes[link_id].id = rte_node_edge_count(node_id) - 1;
+
+	return 0;
+}
+
+int
+l2_bridge_node_data_set_port(rte_node_t node_id)
+{
+	struct l2_bridge_node_item *item;
+
+	item = l2_bridge_node_data_get(node_id);
+	if (!item)
+		return -ENOENT;
+
+	item->ctx.data->set_port = 1;
+	return 0;
+}
+
+int
+l2_bridge_node_data_rem(rte_node_t node_id)
+{
+	struct l2_bridge_node_item* item;
+
+	item = l2_bridge_node_data_get(node_id);
+	if (!item)
+		return -ENOENT;
+
+	if (item->next)
+		item->next->prev = item->prev;
+
+	if (item->prev)
+		item->prev->next = item->next;
+
+	if (item == node_list.head)
+		node_list.head = item->next;
+
+	rte_free(item->ctx.data);
+	rte_free(item);
+	return 0;
+}
+
+static struct l2_bridge_node_item*
+l2_bridge_node_data_get(rte_node_t node_id)
+{
+	struct l2_bridge_node_item *item = node_list.head;
+
+	for (; item; item = item->next) {
+		if (item->node_id == node_id)
+			return item;
+	}
+
+	return NULL;
+}
+
+static __rte_always_inline rte_edge_t
+l2_bridge_node_next(struct l2_bridge_node_data *data, uint16_t link_id)
+{
+	if (likely(data->next_nodes[link_id].enabled))
+		return data->next_nodes[link_id].id;
+
+	return L2_BRIDGE_NEXT_PKT_DROP;
+}
+
+/* Keep the speculated stream, anything else goes out one by one */
+static __rte_always_inline void
+l2_bridge_node_enqueue(struct rte_graph *graph, struct rte_node *node,
+		       rte_edge_t next, rte_edge_t next_index,
+		       void **to_next, uint16_t *held, void *obj)
+{
+	if (likely(next == next_index))
+		to_next[(*held)++] = obj;
+	else
+		rte_node_enqueue_x1(graph, node, next, obj);
+}
+
+/* Unknown unicast, broadcast and multicast go to every other member
+ * link of the vlan. The egress chains rewrite headers, offload flags and
+ * the sched hash in place, so every link but the last gets a copy of
+ * its own. Only the original forwards the dequeued event, copies are
+ * marked to go out as new events.
+ */
+static __rte_noinline void
+l2_bridge_node_flood(struct rte_graph *graph, struct rte_node *node,
+		     struct l2_bridge_node_data *data,
+		     struct l2_bridge_domain *domain, uint16_t vlan_id,
+		     rte_edge_t next_index, void **to_next, uint16_t *held,
+		     struct rte_mbuf *mbuf)
+{
+	uint16_t links[L2_BRIDGE_MAX_MEMBERS];
+	struct rte_mbuf *copy;
+	uint16_t i, link_id;
+	uint16_t n = 0;
+
+	for (i = 0; i < domain->nb_links; i++) {
+		link_id = domain->links[i];
+		if (link_id == mbuf->port || !data->next_nodes[link_id].enabled ||
+		    !vlan_link_member(link_id, vlan_id))
+			continue;
+		links[n++] = link_id;
+	}
+
+	if (unlikely(n == 0)) {
+		l2_bridge_node_enqueue(graph, node, L2_BRIDGE_NEXT_PKT_DROP,
+				       next_index, to_next, held, mbuf);
+		return;
+	}
+
+	for (i = 0; i < n - 1; i++) {
+		copy = rte_pktmbuf_copy(mbuf, mbuf->pool, 0, UINT32_MAX);
+		if (unlikely(copy == NULL))
+			continue;
+
+		copy->ol_flags |= eventdev_new_flag;
+
+		/* Only the original fits in the speculated stream */
+		if (data->set_port)
+			copy->port = links[i];
+		rte_node_enqueue_x1(graph, node, data->next_nodes[links[i]].id, copy);
+	}
+
+	if (data->set_port)
+		mbuf->port = links[n - 1];
+	l2_bridge_node_enqueue(graph, node, data->next_nodes[links[n - 1]].id,
+			       next_index, to_next, held, mbuf);
+}
+
+static uint16_t
+l2_bridge_node_process(struct rte_graph *graph,
+		       struct rte_node *node,
+		       void **objs,
+		       uint16_t nb_objs)
+{
+	struct l2_bridge_node_ctx *ctx = (struct l2_bridge_node_ctx *)node->ctx;
+	struct l2_bridge_key keys[2 * L2_BRIDGE_LOOKUP_BULK];
+	const void *key_ptrs[2 * L2_BRIDGE_LOOKUP_BULK];
+	int32_t positions[2 * L2_BRIDGE_LOOKUP_BULK];
+	struct l2_bridge_learn learn[L2_BRIDGE_LOOKUP_BULK];
+	struct l2_bridge_node_data *data = ctx->data;
+	struct l2_bridge_main *bm = bridge_main;
+	struct rte_mbuf *mbuf, **pkts;
+	struct l2_bridge_fdb_entry *e;
+	struct rte_ether_hdr *eth;
+	uint16_t in_link, out_link, bd_id, vlan_id;
+	uint8_t *src_hit;
+	rte_edge_t next_index, next;
+	uint16_t i, j, n, nb_learn;
+	uint16_t held = 0;
+	void **to_next;
+
+	if (unlikely(!bm)) {
+		rte_node_next_stream_move(graph, node, L2_BRIDGE_NEXT_PKT_DROP);
+		return nb_objs;
+	}
+
+	pkts = (struct rte_mbuf **)objs;
+	for (i = 0; i < 2 * L2_BRIDGE_LOOKUP_BULK; i++)
+		key_ptrs[i] = &keys[i];
+
+	next_index = ctx->last_next;
+	to_next = rte_node_next_stream_get(graph, node, next_index, nb_objs);
+
+	for (i = 0; i < nb_objs; i += n) {
+		n = RTE_MIN(nb_objs - i, L2_BRIDGE_LOOKUP_BULK);
+
+		/* Source and destination of the whole chunk in one lookup */
+		for (j = 0; j < n; j++) {
+			if (likely(j + 4 < n))
+				rte_prefetch0(rte_pktmbuf_mtod(pkts[i + j + 4], void *));
+
+			mbuf = pkts[i + j];
+			eth = rte_pktmbuf_mtod(mbuf, struct rte_ether_hdr *);
+			bd_id = bm->link_bd[mbuf->port];
+			vlan_id = vlan_mbuf_get(mbuf);
+			rte_ether_addr_copy(&eth->src_addr, &keys[2 * j].mac);
+			keys[2 * j].bd_id = bd_id;
+			keys[2 * j].vlan_id = vlan_id;
+			rte_ether_addr_copy(&eth->dst_addr, &keys[2 * j + 1].mac);
+			keys[2 * j + 1].bd_id = bd_id;
+			keys[2 * j + 1].vlan_id = vlan_id;
+		}
+
+		rte_hash_lookup_bulk(bm->fdb, key_ptrs, 2 * n, positions);
+
+		nb_learn = 0;
+		for (j = 0; j < n; j++) {
+			mbuf = pkts[i + j];
+			in_link = mbuf->port;
+			bd_id = keys[2 * j].bd_id;
+			if (unlikely(bd_id == L2_BRIDGE_ID_INVALID)) {
+				l2_bridge_node_enqueue(graph, node, L2_BRIDGE_NEXT_PKT_DROP,
+						       next_index, to_next, &held, mbuf);
+				continue;
+			}
+
+			/* Known on this link only needs the hit bit, anything
+			 * else is handed to the control thread.
+			 */
+			e = (positions[2 * j] >= 0) ? &bm->entries[positions[2 * j]] : NULL;
+			src_hit = NULL;
+			if (likely(e && e->link_id == in_link)) {
+				if (unlikely(!e->hit))
+					e->hit = 1;
+				src_hit = &e->hit;
+			} else if (!rte_is_multicast_ether_addr(&keys[2 * j].mac) &&
+				   (nb_learn == 0 ||
+				    memcmp(&learn[nb_learn - 1].key, &keys[2 * j],
+					   sizeof(keys[0])) != 0)) {
+				learn[nb_learn].key = keys[2 * j];
+				learn[nb_learn].link_id = in_link;
+				nb_learn++;
+			}
+
+			/* Multicast sources are never learnt, a hit is unicast */
+			out_link = L2_BRIDGE_LINK_INVALID;
+			if (positions[2 * j + 1] >= 0)
+				out_link = __atomic_load_n(&bm->entries[positions[2 * j + 1]].link_id,
+							   __ATOMIC_ACQUIRE);
+
+			if (likely(out_link != L2_BRIDGE_LINK_INVALID)) {
+				next = (out_link == in_link) ?
+					L2_BRIDGE_NEXT_PKT_DROP :
+					l2_bridge_node_next(data, out_link);
+				if (next != L2_BRIDGE_NEXT_PKT_DROP) {
+					flow_cache_learn(mbuf, out_link, src_hit);
+					if (data->set_port)
+						mbuf->port = out_link;
+				}
+				l2_bridge_node_enqueue(graph, node, next,
+						       next_index, to_next, &held, mbuf);
+				ctx->last_next = next;
+			} else {
+				l2_bridge_node_flood(graph, node, data, &bm->domains[bd_id],
+						     keys[2 * j].vlan_id,
+						     next_index, to_next, &held, mbuf);
+			}
+		}
+
+		if (nb_learn)
+			rte_ring_enqueue_burst_elem(bm->learn, learn, sizeof(learn[0]),
+						    nb_learn, NULL);
+	}
+
+	rte_node_next_stream_put(graph, node, next_index, held);
+	return nb_objs;
+}
+
+static int
+l2_bridge_node_init(__rte_unused const struct rte_graph *graph, struct rte_node *node)
+{
+	struct l2_bridge_node_ctx *ctx = (struct l2_bridge_node_ctx *)node->ctx;
+	struct l2_bridge_node_item *item = l2_bridge_node_data_get(node->id);
+
+	RTE_VERIFY(sizeof(*ctx) <= sizeof(node->ctx));
+	RTE_VERIFY(item != NULL);
+
+	memcpy(ctx, &item->ctx, sizeof(*ctx));
+
+	return 0;
+}
+
+static void
+l2_bridge_node_fini(__rte_unused const struct rte_graph *graph, struct rte_node *node)
+{
+	l2_bridge_node_data_rem(node->id);
+}
+
+static struct rte_node_register l2_bridge_node = {
+	.process = l2_bridge_node_process,
+	.name = "vs_l2_bridge",
+
+	.init = l2_bridge_node_init,
+	.fini = l2_bridge_node_fini,
+
+	.nb_edges = L2_BRIDGE_NEXT_MAX,
+	.next_nodes = {
+		[L2_BRIDGE_NEXT_PKT_DROP] = "pkt_drop",
+	},
+};
+
+rte_node_t
+l2_bridge_node_clone(char const *name)
+{
+	return rte_node_clone(l2_bridge_node.id, name);
+}
+
+RTE_NODE_REGISTER(l2_bridge_node);
@@ -0,0 +1,50 @@
+/*
+  SPDX-License-Identifier: MIT
+  Copyright(c) 2023 Sriram Yagnaraman.
+*/
+
+#ifndef __SRC_LIB_NODE_L2_BRIDGE_H__
+#define __SRC_LIB_NODE_L2_BRIDGE_H__
+
+#include <rte_ether.h>
+#include <rte_graph.h>
+#include <rte_rcu_qsbr.h>
+
+#define L2_BRIDGE_ID_INVALID	(0xFFFF)
+#define L2_BRIDGE_MAX_DOMAINS	(64)
+#define L2_BRIDGE_MAX_MEMBERS	(16)
+
+struct l2_bridge_fdb_info {
+	struct rte_ether_addr mac;
+	uint16_t bd_id;
+	uint16_t vlan_id;
+	uint16_t link_id;
+	uint16_t age;
+};
+
+typedef int (*l2_bridge_fdb_walk_cb) (struct l2_bridge_fdb_info *info, void *data);
+
+/* FDB shared by all bridge domains, workers must report quiescent
+ * state on qsv so deleted entries are only reused once unreferenced.
+ */
+int l2_bridge_init(uint32_t fdb_size, struct rte_rcu_qsbr *qsv, int socket_id);
+void l2_bridge_fini(void);
+bool l2_bridge_enabled(void);
+
+int l2_bridge_domain_set(uint16_t bd_id, uint16_t ageing_s);
+int l2_bridge_domain_add_link(uint16_t bd_id, uint16_t link_id);
+uint16_t l2_bridge_domain_get(uint16_t link_id);
+
+/* Control path, not thread safe against l2_bridge_fini() */
+unsigned int l2_bridge_fdb_learn(void);
+unsigned int l2_bridge_fdb_age(void);
+int l2_bridge_fdb_flush(uint16_t bd_id);
+int l2_bridge_fdb_walk(l2_bridge_fdb_walk_cb cb, void *data);
+
+rte_node_t l2_bridge_node_clone(char const *name);
+int l2_bridge_node_data_add(rte_node_t node_id, uint16_t link_id, const char *next_node);
+int l2_bridge_node_data_rem(rte_node_t node_id);
+/* Packets leave with mbuf->port set to their output link */
+int l2_bridge_node_data_set_port(rte_node_t node_id);
+
+#endif /* __SRC_LIB_NODE_L2_BRIDGE_H__ */
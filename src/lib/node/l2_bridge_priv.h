@@ -0,0 +1,96 @@
+/*
+  SPDX-License-Identifier: MIT
+  Copyright(c) 2023 Sriram Yagnaraman.
+*/
+
+#ifndef __SRC_LIB_NODE_L2_BRIDGE_PRIV_H__
+#define __SRC_LIB_NODE_L2_BRIDGE_PRIV_H__
+
+#include <rte_common.h>
+#include <rte_ether.h>
+#include <rte_graph.h>
+#include <rte_hash.h>
+#include <rte_ring.h>
+#include <rte_spinlock.h>
+
+#include "l2_bridge.h"
+
+/* rte_hash bulk lookups take at most 64 keys, source and destination
+ * of 32 packets.
+ */
+#define L2_BRIDGE_LOOKUP_BULK	(RTE_HASH_LOOKUP_BULK_MAX / 2)
+#define L2_BRIDGE_LEARN_RING_SZ	(4096)
+#define L2_BRIDGE_LEARN_BURST	(256)
+#define L2_BRIDGE_AGE_BURST	(256)
+#define L2_BRIDGE_LINK_INVALID	(0xFFFF)
+
+enum l2_bridge_next_nodes {
+	L2_BRIDGE_NEXT_PKT_DROP = 0,
+	L2_BRIDGE_NEXT_MAX,
+};
+
+struct l2_bridge_key {
+	struct rte_ether_addr mac;
+	uint16_t bd_id;
+	uint16_t vlan_id;
+} __rte_packed;
+
+/* Indexed by hash key position. Workers only ever write hit, and only
+ * when it is clear, so a known station costs one store per ageing tick.
+ */
+struct l2_bridge_fdb_entry {
+	uint16_t link_id;
+	uint16_t bd_id;
+	uint16_t age;
+	uint8_t hit;
+	uint8_t pad;
+};
+
+struct l2_bridge_learn {
+	struct l2_bridge_key key;
+	uint16_t link_id;
+};
+
+struct l2_bridge_domain {
+	uint16_t ageing_s;
+	uint16_t nb_links;
+	uint16_t links[L2_BRIDGE_MAX_MEMBERS];
+};
+
+struct l2_bridge_main {
+	struct rte_hash *fdb;
+	struct l2_bridge_fdb_entry *entries;
+	uint32_t fdb_size;
+	struct rte_ring *learn;
+	rte_spinlock_t lock;
+	uint16_t link_bd[RTE_MAX_ETHPORTS];
+	struct l2_bridge_domain domains[L2_BRIDGE_MAX_DOMAINS];
+};
+
+struct l2_bridge_node_data {
+	struct {
+		rte_edge_t id;
+		uint8_t enabled;
+	} next_nodes[RTE_MAX_ETHPORTS];
+	/* mbuf->port is set to the output link, for the Tx adapter */
+	uint8_t set_port;
+};
+
+struct l2_bridge_node_ctx {
+	struct l2_bridge_node_data *data;
+	rte_edge_t last_next;
+};
+
+struct l2_bridge_node_item {
+	struct l2_bridge_node_item *next;
+	struct l2_bridge_node_item *prev;
+	struct l2_bridge_node_ctx ctx;
+
+	rte_node_t node_id;
+};
+
+struct l2_bridge_node_list {
+	struct l2_bridge_node_item *head;
+};
+
+#endif /* __SRC_LIB_NODE_L2_BRIDGE_PRIV_H__ */
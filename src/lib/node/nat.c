@@ -0,0 +1,642 @@
+/*
+  SPDX-License-Identifier: MIT
+  Copyright(c) 2023 Sriram Yagnaraman.
+*/
+
+#include <errno.h>
+#include <string.h>
+
+#include <rte_byteorder.h>
+#include <rte_ether.h>
+#include <rte_graph.h>
+#include <rte_graph_worker.h>
+#include <rte_hash_crc.h>
+#include <rte_icmp.h>
+#include <rte_ip.h>
+#include <rte_lcore.h>
+#include <rte_malloc.h>
+#include <rte_mbuf.h>
+#include <rte_tcp.h>
+#include <rte_udp.h>
+
+#include "conntrack.h"
+#include "flow_hash.h"
+#include "nat_priv.h"
+#include "nat.h"
+
+bool nat_steering;
+
+static struct nat_main *nat_main;
+
+static struct nat_node_list node_list = {
+	.head = NULL,
+};
+
+/* RFC 1624, sums over the raw 16-bit words so byte order does not matter */
+static __rte_always_inline uint16_t
+nat_cksum_fold(uint32_t sum)
+{
+	sum = (sum & 0xffff) + (sum >> 16);
+	sum = (sum & 0xffff) + (sum >> 16);
+	return (uint16_t)sum;
+}
+
+static uint16_t
+nat_cksum_delta32(uint32_t from, uint32_t to)
+{
+	uint32_t sum;
+
+	sum = (uint16_t)~from + (uint16_t)~(from >> 16);
+	sum += (uint16_t)to + (uint16_t)(to >> 16);
+	return nat_cksum_fold(sum);
+}
+
+static uint16_t
+nat_cksum_delta16(uint16_t from, uint16_t to)
+{
+	return nat_cksum_fold((uint16_t)~from + (uint32_t)to);
+}
+
+static __rte_always_inline uint16_t
+nat_cksum_adjust(uint16_t cksum, uint16_t delta)
+{
+	return ~nat_cksum_fold((uint16_t)~cksum + (uint32_t)delta);
+}
+
+static __rte_always_inline uint32_t
+nat_prefix_mask(uint8_t depth)
+{
+	return depth ? UINT32_MAX << (32 - depth) : 0;
+}
+
+static __rte_always_inline int
+nat_has_ports(uint8_t proto)
+{
+	return proto == IPPROTO_TCP || proto == IPPROTO_UDP;
+}
+
+static struct nat_table *
+nat_table_get(unsigned int lcore_id)
+{
+	if (!nat_main || lcore_id >= RTE_MAX_LCORE)
+		return NULL;
+
+	return nat_main->tables[lcore_id];
+}
+
+/* Registered with conntrack, runs on the worker that owns idx */
+static void
+nat_release(uint32_t idx)
+{
+	struct nat_table *t = nat_table_get(rte_lcore_id());
+	struct nat_port_pool *pool;
+	struct nat_binding *b;
+
+	if (!t || idx >= t->nb_bindings)
+		return;
+
+	b = &t->bindings[idx];
+	if (b->state == NAT_BINDING_SNAT) {
+		pool = &t->pools[b->rule];
+		pool->ports[pool->nb_free++] = rte_be_to_cpu_16(b->new_port);
+	}
+	b->state = NAT_BINDING_UNSET;
+}
+
+static void
+nat_table_free(struct nat_table *t)
+{
+	uint32_t i;
+
+	if (!t)
+		return;
+
+	for (i = 0; i < NAT_RULES_MAX; i++)
+		rte_free(t->pools[i].ports);
+	rte_free(t->bindings);
+	rte_free(t);
+}
+
+int
+nat_init(struct nat_rule const *rules, uint32_t nb_rules, uint32_t nb_workers,
+	 bool hw_cksum)
+{
+	struct nat_main *nm;
+	uint32_t i;
+
+	if (nat_main)
+		return -EEXIST;
+
+	if (nb_rules > NAT_RULES_MAX || (nb_rules && !rules))
+		return -EINVAL;
+
+	for (i = 0; i < nb_rules; i++) {
+		if (rules[i].type >= NAT_TYPE_MAX || rules[i].depth > 32 ||
+		    rules[i].to_port_lo > rules[i].to_port_hi)
+			return -EINVAL;
+	}
+
+	nm = rte_zmalloc(NULL, sizeof(*nm), RTE_CACHE_LINE_SIZE);
+	if (!nm)
+		return -ENOMEM;
+
+	if (nb_rules)
+		memcpy(nm->rules, rules, nb_rules * sizeof(*rules));
+	nm->nb_rules = nb_rules;
+	nm->nb_workers = nb_workers;
+	nm->hw_cksum = hw_cksum;
+	nat_main = nm;
+
+	conntrack_release_register(nat_release);
+	nat_steering = nb_rules > 0;
+	return 0;
+}
+
+void
+nat_fini(void)
+{
+	struct nat_main *nm = nat_main;
+	uint32_t i;
+
+	if (!nm)
+		return;
+
+	nat_steering = false;
+	conntrack_release_register(NULL);
+	nat_main = NULL;
+	for (i = 0; i < RTE_MAX_LCORE; i++)
+		nat_table_free(nm->tables[i]);
+	rte_free(nm);
+}
+
+bool
+nat_enabled(void)
+{
+	return nat_main != NULL && nat_main->nb_rules > 0;
+}
+
+/* DNAT backend replies come from to_ip and the translated port */
+static __rte_always_inline int
+nat_dnat_backend(struct nat_rule const *r, uint32_t src, uint16_t sport, bool has_ports)
+{
+	if (src != r->to_ip)
+		return 0;
+	if (!has_ports)
+		return 1;
+	if (r->to_port_lo)
+		return sport == r->to_port_lo;
+	return r->match_port == 0 || sport == r->match_port;
+}
+
+void
+nat_flow_hash_set(struct rte_mbuf *mbuf)
+{
+	struct rte_ether_hdr *eth = rte_pktmbuf_mtod(mbuf, struct rte_ether_hdr *);
+	uint16_t len = rte_pktmbuf_data_len(mbuf);
+	uint16_t sport = 0, dport = 0, *ports;
+	struct nat_main *nm = nat_main;
+	struct nat_rule const *r;
+	struct rte_ipv4_hdr *ip;
+	uint32_t src, dst, addr;
+	uint16_t port, ihl;
+	bool has_ports = false;
+	uint32_t i, hash;
+	int side = -1;
+
+	if (eth->ether_type != RTE_BE16(RTE_ETHER_TYPE_IPV4) ||
+	    len < sizeof(*eth) + sizeof(*ip))
+		return;
+
+	ip = (struct rte_ipv4_hdr *)(eth + 1);
+	ihl = rte_ipv4_hdr_len(ip);
+	if (nat_has_ports(ip->next_proto_id) &&
+	    !(ip->fragment_offset & RTE_BE16(RTE_IPV4_HDR_OFFSET_MASK)) &&
+	    len >= sizeof(*eth) + ihl + 2 * sizeof(uint16_t)) {
+		ports = (uint16_t *)((uint8_t *)ip + ihl);
+		sport = rte_be_to_cpu_16(ports[0]);
+		dport = rte_be_to_cpu_16(ports[1]);
+		has_ports = true;
+	}
+
+	src = rte_be_to_cpu_32(ip->src_addr);
+	dst = rte_be_to_cpu_32(ip->dst_addr);
+
+	/* side 0 hashes on the source, 1 on the destination */
+	for (i = 0; i < nm->nb_rules && side < 0; i++) {
+		r = &nm->rules[i];
+		if (r->proto && r->proto != ip->next_proto_id)
+			continue;
+
+		if (r->type == NAT_TYPE_DNAT) {
+			if (dst == r->match_ip &&
+			    (!has_ports || r->match_port == 0 || dport == r->match_port))
+				side = 0;
+			else if (nat_dnat_backend(r, src, sport, has_ports))
+				side = 1;
+		} else {
+			if (dst == r->to_ip &&
+			    (!has_ports || (dport >= r->to_port_lo && dport <= r->to_port_hi)))
+				side = 0;
+			else if (((src ^ r->match_ip) & nat_prefix_mask(r->depth)) == 0)
+				side = 1;
+		}
+	}
+
+	if (side < 0)
+		return;
+
+	addr = side ? dst : src;
+	port = side ? dport : sport;
+	hash = rte_hash_crc_4byte(addr, FLOW_HASH_SEED);
+	if (has_ports)
+		hash = rte_hash_crc_4byte(((uint32_t)port << 16) | ip->next_proto_id, hash);
+
+	mbuf->hash.rss = hash;
+	mbuf->ol_flags |= RTE_MBUF_F_RX_RSS_HASH;
+}
+
+static __rte_always_inline int
+nat_rule_match(struct nat_rule const *r, struct rte_ipv4_hdr *ip, uint16_t *ports)
+{
+	if (r->proto && r->proto != ip->next_proto_id)
+		return 0;
+
+	if (r->type == NAT_TYPE_DNAT)
+		return ip->dst_addr == rte_cpu_to_be_32(r->match_ip) &&
+		       (r->match_port == 0 || !nat_has_ports(ip->next_proto_id) ||
+			ports[1] == rte_cpu_to_be_16(r->match_port));
+
+	return ((rte_be_to_cpu_32(ip->src_addr) ^ r->match_ip) &
+		nat_prefix_mask(r->depth)) == 0;
+}
+
+/* First packet of a connection, DNAT rules before SNAT, each in rule
+ * order. ports points at the ICMP identifier for echo.
+ */
+static int
+nat_bind(struct nat_table *t, struct nat_binding *b, struct rte_ipv4_hdr *ip,
+	 uint16_t *ports)
+{
+	struct nat_main *nm = nat_main;
+	struct nat_port_pool *pool;
+	uint8_t l4 = nat_has_ports(ip->next_proto_id);
+	struct nat_rule const *r;
+	uint32_t i, type;
+	uint16_t port;
+
+	for (type = NAT_TYPE_DNAT + 1; type-- > 0;) {
+		for (i = 0; i < nm->nb_rules; i++) {
+			r = &nm->rules[i];
+			if (r->type == type && nat_rule_match(r, ip, ports))
+				goto found;
+		}
+	}
+
+	b->state = NAT_BINDING_SKIP;
+	return 0;
+
+found:
+	b->rule = i;
+	b->new_ip = rte_cpu_to_be_32(r->to_ip);
+	if (r->type == NAT_TYPE_DNAT) {
+		b->orig_ip = ip->dst_addr;
+		b->orig_port = ports[l4];
+		b->new_port = (r->to_port_lo && l4) ?
+			rte_cpu_to_be_16(r->to_port_lo) : ports[l4];
+		b->state = NAT_BINDING_DNAT;
+	} else {
+		pool = &t->pools[i];
+		if (unlikely(pool->nb_free == 0))
+			return -ENOSPC;
+		port = pool->ports[--pool->nb_free];
+
+		b->orig_ip = ip->src_addr;
+		b->orig_port = ports[0];
+		b->new_port = rte_cpu_to_be_16(port);
+		b->state = NAT_BINDING_SNAT;
+	}
+
+	b->ip_delta[0] = nat_cksum_delta32(b->orig_ip, b->new_ip);
+	b->ip_delta[1] = nat_cksum_delta32(b->new_ip, b->orig_ip);
+	b->l4_delta[0] = nat_cksum_delta16(b->orig_port, b->new_port);
+	b->l4_delta[1] = nat_cksum_delta16(b->new_port, b->orig_port);
+
+	/* TCP and UDP cover the addresses through the pseudo header */
+	if (l4) {
+		b->l4_delta[0] = nat_cksum_fold((uint32_t)b->l4_delta[0] + b->ip_delta[0]);
+		b->l4_delta[1] = nat_cksum_fold((uint32_t)b->l4_delta[1] + b->ip_delta[1]);
+	}
+
+	return 0;
+}
+
+static __rte_always_inline void
+nat_rewrite(struct nat_node_ctx *ctx, struct nat_binding *b, struct rte_mbuf *mbuf,
+	    struct rte_ipv4_hdr *ip, uint16_t *ports, uint8_t reply)
+{
+	uint8_t proto = ip->next_proto_id;
+	uint16_t *cksum = NULL;
+	uint32_t ip_new;
+	uint16_t port_new;
+	int src;
+
+	/* SNAT rewrites the source going out and the destination coming
+	 * back, DNAT the other way round.
+	 */
+	src = (b->state == NAT_BINDING_SNAT) ^ reply;
+	ip_new = reply ? b->orig_ip : b->new_ip;
+	port_new = reply ? b->orig_port : b->new_port;
+
+	if (src)
+		ip->src_addr = ip_new;
+	else
+		ip->dst_addr = ip_new;
+
+	switch (proto) {
+	case IPPROTO_TCP:
+		cksum = &((struct rte_tcp_hdr *)ports)->cksum;
+		ports[!src] = port_new;
+		break;
+	case IPPROTO_UDP:
+		cksum = &((struct rte_udp_hdr *)ports)->dgram_cksum;
+		ports[!src] = port_new;
+		break;
+	case IPPROTO_ICMP:
+		/* ports is the identifier, the header starts 4 bytes before */
+		cksum = &((struct rte_icmp_hdr *)(ports - 2))->icmp_cksum;
+		ports[0] = port_new;
+		break;
+	default:
+		break;
+	}
+
+	if (ctx->hw_cksum && nat_has_ports(proto)) {
+		ip->hdr_checksum = 0;
+		mbuf->l2_len = sizeof(struct rte_ether_hdr);
+		mbuf->l3_len = rte_ipv4_hdr_len(ip);
+		mbuf->ol_flags |= RTE_MBUF_F_TX_IPV4 | RTE_MBUF_F_TX_IP_CKSUM |
+			(proto == IPPROTO_TCP ? RTE_MBUF_F_TX_TCP_CKSUM : RTE_MBUF_F_TX_UDP_CKSUM);
+		*cksum = rte_ipv4_phdr_cksum(ip, mbuf->ol_flags);
+		return;
+	}
+
+	ip->hdr_checksum = nat_cksum_adjust(ip->hdr_checksum, b->ip_delta[reply]);
+	if (!cksum)
+		return;
+
+	/* A zero UDP checksum means none, and a computed zero goes out as ones */
+	if (proto == IPPROTO_UDP && *cksum == 0)
+		return;
+	*cksum = nat_cksum_adjust(*cksum, b->l4_delta[reply]);
+	if (proto == IPPROTO_UDP && *cksum == 0)
+		*cksum = 0xffff;
+}
+
+static uint16_t
+nat_node_process(struct rte_graph *graph,
+		 struct rte_node *node,
+		 void **objs,
+		 uint16_t nb_objs)
+{
+	struct nat_node_ctx *ctx = (struct nat_node_ctx *)node->ctx;
+	struct rte_mbuf **pkts = (struct rte_mbuf **)objs;
+	struct nat_table *t = ctx->table;
+	struct conntrack_mbuf *cm;
+	struct rte_ipv4_hdr *ip;
+	struct nat_binding *b;
+	struct rte_mbuf *mbuf;
+	uint16_t i, held = 0;
+	uint16_t *ports;
+	void **to_next;
+	bool bound;
+
+	to_next = rte_node_next_stream_get(graph, node, ctx->next_node, nb_objs);
+
+	for (i = 0; i < nb_objs; i++) {
+		mbuf = pkts[i];
+		cm = conntrack_mbuf_get(mbuf);
+		if (cm->idx == CONNTRACK_IDX_INVALID || cm->state == CONNTRACK_INVALID)
+			goto pass;
+
+		b = &t->bindings[cm->idx];
+		if (likely(b->state == NAT_BINDING_SKIP))
+			goto pass;
+
+		/* conntrack already checked the headers are there */
+		ip = rte_pktmbuf_mtod_offset(mbuf, struct rte_ipv4_hdr *,
+					     sizeof(struct rte_ether_hdr));
+		ports = (uint16_t *)((uint8_t *)ip + rte_ipv4_hdr_len(ip));
+		if (ip->next_proto_id == IPPROTO_ICMP)
+			ports += 2;
+
+		bound = false;
+		if (unlikely(b->state == NAT_BINDING_UNSET)) {
+			if (cm->reply || cm->state != CONNTRACK_NEW)
+				goto pass;
+			if (nat_bind(t, b, ip, ports) < 0)
+				goto drop;
+			if (b->state == NAT_BINDING_SKIP)
+				goto pass;
+			bound = true;
+		}
+
+		nat_rewrite(ctx, b, mbuf, ip, ports, cm->reply);
+
+		/* Replies carry the translated tuple, teach conntrack about it */
+		if (unlikely(bound) && conntrack_alias_add(mbuf) < 0) {
+			nat_release(cm->idx);
+			goto drop;
+		}
+
+pass:
+		to_next[held++] = mbuf;
+		continue;
+drop:
+		rte_node_enqueue_x1(graph, node, NAT_NEXT_PKT_DROP, mbuf);
+	}
+
+	rte_node_next_stream_put(graph, node, ctx->next_node, held);
+	return nb_objs;
+}
+
+static struct nat_node_item*
+nat_node_data_get(rte_node_t node_id)
+{
+	struct nat_node_item *item = node_list.head;
+
+	for (; item; item = item->next) {
+		if (item->node_id == node_id)
+			return item;
+	}
+
+	return NULL;
+}
+
+/* Each worker gets its own slice of every SNAT port range so port
+ * allocation never leaves the lcore.
+ */
+static int
+nat_table_pools_fill(struct nat_table *t, uint32_t slice, int socket_id)
+{
+	struct nat_main *nm = nat_main;
+	struct nat_rule const *r;
+	uint32_t i, range, lo, hi, port;
+
+	for (i = 0; i < nm->nb_rules; i++) {
+		r = &nm->rules[i];
+		if (r->type != NAT_TYPE_SNAT)
+			continue;
+
+		range = (uint32_t)r->to_port_hi - r->to_port_lo + 1;
+		lo = r->to_port_lo + (uint64_t)range * slice / nm->nb_workers;
+		hi = r->to_port_lo + (uint64_t)range * (slice + 1) / nm->nb_workers;
+		if (lo == hi)
+			continue;
+
+		t->pools[i].ports = rte_malloc_socket(NULL, (hi - lo) * sizeof(uint16_t),
+						      0, socket_id);
+		if (!t->pools[i].ports)
+			return -ENOMEM;
+
+		/* Lowest port first */
+		for (port = hi; port > lo; port--)
+			t->pools[i].ports[t->pools[i].nb_free++] = port - 1;
+	}
+
+	return 0;
+}
+
+int
+nat_node_data_add(rte_node_t node_id, unsigned int lcore_id, char const *next_node)
+{
+	int socket_id = rte_lcore_to_socket_id(lcore_id);
+	struct nat_main *nm = nat_main;
+	struct nat_node_item *item;
+	struct nat_table *t;
+	uint32_t size;
+	int rc;
+
+	if (!nm)
+		return -ENOENT;
+
+	if (next_node == NULL || lcore_id >= RTE_MAX_LCORE)
+		return -EINVAL;
+
+	if (nat_node_data_get(node_id))
+		return -EEXIST;
+
+	item = rte_zmalloc(NULL, sizeof(struct nat_node_item), 0);
+	if (!item)
+		return -ENOMEM;
+
+	/* Graph rebuilds keep the bindings of the lcore */
+	t = nm->tables[lcore_id];
+	if (t)
+		goto add;
+
+	size = conntrack_table_size(lcore_id);
+	if (size == 0) {
+		rc = -ENOENT;
+		goto err;
+	}
+
+	if (nm->next_slice >= nm->nb_workers) {
+		rc = -ENOSPC;
+		goto err;
+	}
+
+	t = rte_zmalloc_socket(NULL, sizeof(*t), RTE_CACHE_LINE_SIZE, socket_id);
+	if (!t) {
+		rc = -ENOMEM;
+		goto err;
+	}
+
+	t->bindings = rte_zmalloc_socket(NULL, size * sizeof(*t->bindings),
+					 RTE_CACHE_LINE_SIZE, socket_id);
+	if (!t->bindings) {
+		rc = -ENOMEM;
+		goto err;
+	}
+	t->nb_bindings = size;
+
+	rc = nat_table_pools_fill(t, nm->next_slice, socket_id);
+	if (rc < 0)
+		goto err;
+
+	nm->next_slice++;
+	nm->tables[lcore_id] = t;
+
+add:
+	rte_node_edge_update(node_id, RTE_EDGE_ID_INVALID, &next_node, 1);
+	item->ctx.table = t;
+	item->ctx.next_node = rte_node_edge_count(node_id) - 1;
+	item->ctx.hw_cksum = nm->hw_cksum;
+	item->node_id = node_id;
+	item->prev = NULL;
+	item->next = node_list.head;
+	if (node_list.head)
+		node_list.head->prev = item;
+	node_list.head = item;
+
+	return 0;
+
+err:
+	nat_table_free(t);
+	rte_free(item);
+	return rc;
+}
+
+static int
+nat_node_init(__rte_unused const struct rte_graph *graph, struct rte_node *node)
+{
+	struct nat_node_ctx *ctx = (struct nat_node_ctx *)node->ctx;
+	struct nat_node_item *item = nat_node_data_get(node->id);
+
+	RTE_VERIFY(sizeof(*ctx) <= sizeof(node->ctx));
+	RTE_VERIFY(item != NULL);
+	RTE_VERIFY(nat_main != NULL);
+
+	memcpy(ctx, &item->ctx, sizeof(*ctx));
+
+	return 0;
+}
+
+/* The table stays with nat_main until nat_fini */
+static void
+nat_node_fini(__rte_unused const struct rte_graph *graph, struct rte_node *node)
+{
+	struct nat_node_item *item = nat_node_data_get(node->id);
+
+	if (!item)
+		return;
+
+	if (item->next)
+		item->next->prev = item->prev;
+	if (item->prev)
+		item->prev->next = item->next;
+	if (item == node_list.head)
+		node_list.head = item->next;
+
+	rte_free(item);
+}
+
+static struct rte_node_register nat_node = {
+	.process = nat_node_process,
+	.name = "vs_nat",
+
+	.init = nat_node_init,
+	.fini = nat_node_fini,
+
+	.nb_edges = NAT_NEXT_MAX,
+	.next_nodes = {
+		[NAT_NEXT_PKT_DROP] = "pkt_drop",
+	},
+};
+
+rte_node_t
+nat_node_clone(char const *name)
+{
+	return rte_node_clone(nat_node.id, name);
+}
+
+RTE_NODE_REGISTER(nat_node);
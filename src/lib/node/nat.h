@@ -0,0 +1,61 @@
+/*
+  SPDX-License-Identifier: MIT
+  Copyright(c) 2023 Sriram Yagnaraman.
+*/
+
+#ifndef __SRC_LIB_NODE_NAT_H__
+#define __SRC_LIB_NODE_NAT_H__
+
+#include <rte_graph.h>
+#include <rte_mbuf.h>
+
+#define NAT_RULES_MAX	(64)
+
+enum nat_type {
+	NAT_TYPE_SNAT = 0,
+	NAT_TYPE_DNAT,
+	NAT_TYPE_MAX,
+};
+
+/* Addresses and ports in host byte order, proto 0 matches anything.
+ * SNAT matches match_ip/depth on the source and picks the source port
+ * from to_port_lo..to_port_hi. DNAT matches match_ip:match_port (port 0
+ * any) on the destination and sends to to_ip:to_port_lo (port 0 keeps
+ * it).
+ */
+struct nat_rule {
+	uint8_t type;
+	uint8_t proto;
+	uint8_t depth;
+	uint32_t match_ip;
+	uint16_t match_port;
+	uint32_t to_ip;
+	uint16_t to_port_lo;
+	uint16_t to_port_hi;
+};
+
+/* Set while rules are installed, the stages feeding conntrack then
+ * steer translated flows on the endpoint that NAT leaves alone.
+ */
+extern bool nat_steering;
+
+/* Rules are fixed for the lifetime of the graphs. SNAT ports are split
+ * evenly over nb_workers, steering brings replies back to the worker
+ * that picked the port. hw_cksum hands TCP/UDP checksums to the NIC.
+ */
+int nat_init(struct nat_rule const *rules, uint32_t nb_rules, uint32_t nb_workers,
+	     bool hw_cksum);
+void nat_fini(void);
+bool nat_enabled(void);
+
+/* Overrides mbuf->hash.rss for packets of a translated flow so that both
+ * directions are steered to the queue of the same worker.
+ */
+void nat_flow_hash_set(struct rte_mbuf *mbuf);
+
+rte_node_t nat_node_clone(char const *name);
+
+/* Follows the conntrack node of lcore_id, which must be added first */
+int nat_node_data_add(rte_node_t node_id, unsigned int lcore_id, char const *next_node);
+
+#endif /* __SRC_LIB_NODE_NAT_H__ */
@@ -0,0 +1,81 @@
+/*
+  SPDX-License-Identifier: MIT
+  Copyright(c) 2023 Sriram Yagnaraman.
+*/
+
+#ifndef __SRC_LIB_NODE_NAT_PRIV_H__
+#define __SRC_LIB_NODE_NAT_PRIV_H__
+
+#include <rte_common.h>
+#include <rte_graph.h>
+
+#include "nat.h"
+
+enum nat_binding_state {
+	NAT_BINDING_UNSET = 0,
+	NAT_BINDING_SKIP,
+	NAT_BINDING_SNAT,
+	NAT_BINDING_DNAT,
+};
+
+/* One per conntrack entry, indexed alike. Addresses and ports in network
+ * byte order, orig is what the first packet carried. Checksum deltas
+ * are indexed by the reply flag.
+ */
+struct nat_binding {
+	uint32_t orig_ip;
+	uint32_t new_ip;
+	uint16_t orig_port;
+	uint16_t new_port;
+	uint16_t ip_delta[2];
+	uint16_t l4_delta[2];
+	uint8_t state;
+	uint8_t rule;
+};
+
+/* Free ports of one SNAT rule on one worker, in host byte order */
+struct nat_port_pool {
+	uint16_t *ports;
+	uint32_t nb_free;
+};
+
+struct nat_table {
+	struct nat_binding *bindings;
+	uint32_t nb_bindings;
+	struct nat_port_pool pools[NAT_RULES_MAX];
+};
+
+struct nat_main {
+	struct nat_rule rules[NAT_RULES_MAX];
+	uint32_t nb_rules;
+	uint32_t nb_workers;
+	/* Port slice handed to the next worker */
+	uint32_t next_slice;
+	uint8_t hw_cksum;
+	struct nat_table *tables[RTE_MAX_LCORE];
+};
+
+struct nat_node_ctx {
+	struct nat_table *table;
+	rte_edge_t next_node;
+	uint8_t hw_cksum;
+};
+
+struct nat_node_item {
+	struct nat_node_item *next;
+	struct nat_node_item *prev;
+	struct nat_node_ctx ctx;
+
+	rte_node_t node_id;
+};
+
+struct nat_node_list {
+	struct nat_node_item *head;
+};
+
+enum nat_next_nodes {
+	NAT_NEXT_PKT_DROP = 0,
+	NAT_NEXT_MAX,
+};
+
+#endif /* __SRC_LIB_NODE_NAT_PRIV_H__ */
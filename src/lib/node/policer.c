@@ -0,0 +1,367 @@
+/*
+  SPDX-License-Identifier: MIT
+  Copyright(c) 2023 Sriram Yagnaraman.
+*/
+
+#include <errno.h>
+#include <string.h>
+
+#include <rte_cycles.h>
+#include <rte_errno.h>
+#include <rte_ether.h>
+#include <rte_graph.h>
+#include <rte_graph_worker.h>
+#include <rte_ip.h>
+#include <rte_lcore.h>
+#include <rte_malloc.h>
+#include <rte_mbuf.h>
+#include <rte_mbuf_dyn.h>
+#include <rte_meter.h>
+
+#include "policer_priv.h"
+#include "policer.h"
+
+int policer_mbuf_offset = -1;
+uint64_t policer_demote_flag;
+
+static const struct rte_mbuf_dynfield policer_mbuf_desc = {
+	.name = POLICER_MBUF_NAME,
+	.size = sizeof(struct policer_mbuf),
+	.align = __alignof__(struct policer_mbuf),
+};
+
+static const struct rte_mbuf_dynflag policer_demote_desc = {
+	.name = POLICER_DEMOTE_NAME,
+};
+
+static struct policer_main *policer_main;
+
+static struct policer_node_list node_list = {
+	.head = NULL,
+};
+
+static int
+policer_profile_config(struct policer_profile *p, struct policer_params const *params,
+		       uint32_t nb_lcores)
+{
+	struct rte_meter_srtcm_params srtcm;
+	struct rte_meter_trtcm_params trtcm;
+	uint32_t i;
+
+	for (i = 0; i < RTE_COLORS; i++) {
+		if (params->action[i] >= POLICER_ACTION_MAX || params->dscp[i] > 63)
+			return -EINVAL;
+	}
+
+	p->type = params->type;
+	memcpy(p->action, params->action, sizeof(p->action));
+	memcpy(p->dscp, params->dscp, sizeof(p->dscp));
+
+	switch (params->type) {
+	case POLICER_TYPE_SRTCM:
+		srtcm.cir = RTE_MAX(params->cir / nb_lcores, 1);
+		srtcm.cbs = params->cbs;
+		srtcm.ebs = params->pbs;
+		return rte_meter_srtcm_profile_config(&p->srtcm, &srtcm);
+	case POLICER_TYPE_TRTCM:
+		trtcm.cir = RTE_MAX(params->cir / nb_lcores, 1);
+		trtcm.pir = RTE_MAX(params->pir / nb_lcores, 1);
+		trtcm.cbs = params->cbs;
+		trtcm.pbs = params->pbs;
+		return rte_meter_trtcm_profile_config(&p->trtcm, &trtcm);
+	default:
+		return -EINVAL;
+	}
+}
+
+int
+policer_init(struct policer_params const *params, uint8_t const *link_policer,
+	     uint32_t nb_lcores)
+{
+	struct policer_main *pm;
+	uint32_t i;
+	int rc;
+
+	if (policer_main)
+		return -EEXIST;
+
+	if (!params || !link_policer || nb_lcores == 0)
+		return -EINVAL;
+
+	if (policer_mbuf_offset < 0) {
+		policer_mbuf_offset = rte_mbuf_dynfield_register(&policer_mbuf_desc);
+		if (policer_mbuf_offset < 0)
+			return -rte_errno;
+	}
+
+	rc = rte_mbuf_dynflag_register(&policer_demote_desc);
+	if (rc < 0)
+		return -rte_errno;
+	policer_demote_flag = RTE_BIT64(rc);
+
+	pm = rte_zmalloc(NULL, sizeof(*pm), RTE_CACHE_LINE_SIZE);
+	if (!pm)
+		return -ENOMEM;
+
+	/* Id 0 is no policer */
+	for (i = 1; i < POLICER_MAX; i++) {
+		if (params[i].type == POLICER_TYPE_NONE)
+			continue;
+
+		rc = policer_profile_config(&pm->profiles[i], &params[i], nb_lcores);
+		if (rc < 0)
+			goto err;
+	}
+
+	for (i = 0; i < RTE_MAX_ETHPORTS; i++) {
+		if (link_policer[i] >= POLICER_MAX ||
+		    pm->profiles[link_policer[i]].type == POLICER_TYPE_NONE)
+			continue;
+		pm->link_policer[i] = link_policer[i];
+	}
+
+	policer_main = pm;
+	return 0;
+
+err:
+	rte_free(pm);
+	return rc;
+}
+
+void
+policer_fini(void)
+{
+	struct policer_main *pm = policer_main;
+	uint32_t i;
+
+	if (!pm)
+		return;
+
+	policer_main = NULL;
+	policer_demote_flag = 0;
+	for (i = 0; i < RTE_MAX_LCORE; i++)
+		rte_free(pm->tables[i]);
+	rte_free(pm);
+}
+
+bool
+policer_enabled(void)
+{
+	return policer_main != NULL;
+}
+
+static __rte_always_inline enum rte_color
+policer_color(struct policer_table *t, uint8_t id, uint64_t time, uint32_t len)
+{
+	struct policer_profile *p = &t->profiles[id];
+	struct policer_meter *m = &t->meters[id];
+
+	if (p->type == POLICER_TYPE_SRTCM)
+		return rte_meter_srtcm_color_blind_check(&m->srtcm, &p->srtcm, time, len);
+
+	return rte_meter_trtcm_color_blind_check(&m->trtcm, &p->trtcm, time, len);
+}
+
+static __rte_always_inline void
+policer_remark(struct rte_mbuf *mbuf, uint8_t dscp)
+{
+	struct rte_ether_hdr *eth = rte_pktmbuf_mtod(mbuf, struct rte_ether_hdr *);
+	struct rte_ipv4_hdr *ip;
+
+	if (eth->ether_type != RTE_BE16(RTE_ETHER_TYPE_IPV4) ||
+	    rte_pktmbuf_data_len(mbuf) < sizeof(*eth) + sizeof(*ip))
+		return;
+
+	ip = (struct rte_ipv4_hdr *)(eth + 1);
+	ip->type_of_service = (dscp << 2) | (ip->type_of_service & 0x3);
+	ip->hdr_checksum = 0;
+	ip->hdr_checksum = rte_ipv4_cksum(ip);
+}
+
+static uint16_t
+policer_node_process(struct rte_graph *graph,
+		     struct rte_node *node,
+		     void **objs,
+		     uint16_t nb_objs)
+{
+	struct policer_node_ctx *ctx = (struct policer_node_ctx *)node->ctx;
+	struct rte_mbuf **pkts = (struct rte_mbuf **)objs;
+	struct policer_table *t = ctx->table;
+	struct policer_profile *p;
+	struct rte_mbuf *mbuf;
+	uint16_t i, held = 0;
+	enum rte_color color;
+	uint64_t time;
+	void **to_next;
+	uint8_t id;
+
+	/* One timestamp per burst, the meters only need it to refill */
+	time = rte_rdtsc();
+	to_next = rte_node_next_stream_get(graph, node, ctx->next_node, nb_objs);
+
+	for (i = 0; i < nb_objs; i++) {
+		mbuf = pkts[i];
+
+		/* An ACL match wins over the ingress link */
+		id = ctx->acl ? policer_mbuf_get(mbuf)->policer : POLICER_ID_NONE;
+		if (id == POLICER_ID_NONE)
+			id = t->link_policer[mbuf->port];
+		p = &t->profiles[id];
+		if (likely(id == POLICER_ID_NONE) || unlikely(p->type == POLICER_TYPE_NONE)) {
+			to_next[held++] = mbuf;
+			continue;
+		}
+
+		color = policer_color(t, id, time, rte_pktmbuf_pkt_len(mbuf));
+		switch (p->action[color]) {
+		case POLICER_ACTION_DROP:
+			rte_node_enqueue_x1(graph, node, POLICER_NEXT_PKT_DROP, mbuf);
+			continue;
+		case POLICER_ACTION_REMARK:
+			policer_remark(mbuf, p->dscp[color]);
+			break;
+		case POLICER_ACTION_DEMOTE:
+			mbuf->ol_flags |= policer_demote_flag;
+			break;
+		default:
+			break;
+		}
+
+		to_next[held++] = mbuf;
+	}
+
+	rte_node_next_stream_put(graph, node, ctx->next_node, held);
+	return nb_objs;
+}
+
+static struct policer_node_item*
+policer_node_data_get(rte_node_t node_id)
+{
+	struct policer_node_item *item = node_list.head;
+
+	for (; item; item = item->next) {
+		if (item->node_id == node_id)
+			return item;
+	}
+
+	return NULL;
+}
+
+int
+policer_node_data_add(rte_node_t node_id, unsigned int lcore_id, bool acl,
+		      char const *next_node)
+{
+	struct policer_main *pm = policer_main;
+	struct policer_node_item *item;
+	struct policer_table *t;
+	uint32_t i;
+
+	if (!pm)
+		return -ENOENT;
+
+	if (next_node == NULL || lcore_id >= RTE_MAX_LCORE)
+		return -EINVAL;
+
+	if (policer_node_data_get(node_id))
+		return -EEXIST;
+
+	item = rte_zmalloc(NULL, sizeof(struct policer_node_item), 0);
+	if (!item)
+		return -ENOMEM;
+
+	/* A rebuilt graph keeps the meters of the lcore */
+	t = pm->tables[lcore_id];
+	if (t)
+		goto link;
+
+	t = rte_zmalloc_socket(NULL, sizeof(*t), RTE_CACHE_LINE_SIZE,
+			       rte_lcore_to_socket_id(lcore_id));
+	if (!t) {
+		rte_free(item);
+		return -ENOMEM;
+	}
+
+	t->profiles = pm->profiles;
+	memcpy(t->link_policer, pm->link_policer, sizeof(t->link_policer));
+	for (i = 1; i < POLICER_MAX; i++) {
+		switch (pm->profiles[i].type) {
+		case POLICER_TYPE_SRTCM:
+			rte_meter_srtcm_config(&t->meters[i].srtcm, &pm->profiles[i].srtcm);
+			break;
+		case POLICER_TYPE_TRTCM:
+			rte_meter_trtcm_config(&t->meters[i].trtcm, &pm->profiles[i].trtcm);
+			break;
+		default:
+			break;
+		}
+	}
+	pm->tables[lcore_id] = t;
+
+link:
+	rte_node_edge_update(node_id, RTE_EDGE_ID_INVALID, &next_node, 1);
+	item->ctx.table = t;
+	item->ctx.next_node = rte_node_edge_count(node_id) - 1;
+	item->ctx.acl = acl;
+	item->node_id = node_id;
+	item->prev = NULL;
+	item->next = node_list.head;
+	if (node_list.head)
+		node_list.head->prev = item;
+	node_list.head = item;
+
+	return 0;
+}
+
+static int
+policer_node_init(__rte_unused const struct rte_graph *graph, struct rte_node *node)
+{
+	struct policer_node_ctx *ctx = (struct policer_node_ctx *)node->ctx;
+	struct policer_node_item *item = policer_node_data_get(node->id);
+
+	RTE_VERIFY(sizeof(*ctx) <= sizeof(node->ctx));
+	RTE_VERIFY(item != NULL);
+	RTE_VERIFY(policer_main != NULL);
+
+	memcpy(ctx, &item->ctx, sizeof(*ctx));
+
+	return 0;
+}
+
+static void
+policer_node_fini(__rte_unused const struct rte_graph *graph, struct rte_node *node)
+{
+	struct policer_node_item *item = policer_node_data_get(node->id);
+
+	if (!item)
+		return;
+
+	if (item->next)
+		item->next->prev = item->prev;
+	if (item->prev)
+		item->prev->next = item->next;
+	if (item == node_list.head)
+		node_list.head = item->next;
+
+	rte_free(item);
+}
+
+static struct rte_node_register policer_node = {
+	.process = policer_node_process,
+	.name = "vs_policer",
+
+	.init = policer_node_init,
+	.fini = policer_node_fini,
+
+	.nb_edges = POLICER_NEXT_MAX,
+	.next_nodes = {
+		[POLICER_NEXT_PKT_DROP] = "pkt_drop",
+	},
+};
+
+rte_node_t
+policer_node_clone(char const *name)
+{
+	return rte_node_clone(policer_node.id, name);
+}
+
+RTE_NODE_REGISTER(policer_node);
@@ -0,0 +1,81 @@
+/*
+  SPDX-License-Identifier: MIT
+  Copyright(c) 2023 Sriram Yagnaraman.
+*/
+
+#ifndef __SRC_LIB_NODE_POLICER_H__
+#define __SRC_LIB_NODE_POLICER_H__
+
+#include <rte_ethdev.h>
+#include <rte_graph.h>
+#include <rte_mbuf.h>
+#include <rte_mbuf_dyn.h>
+#include <rte_meter.h>
+
+#define POLICER_MAX		(64)
+#define POLICER_ID_NONE		(0)
+
+enum policer_type {
+	POLICER_TYPE_NONE = 0,
+	POLICER_TYPE_SRTCM,
+	POLICER_TYPE_TRTCM,
+	POLICER_TYPE_MAX,
+};
+
+enum policer_action {
+	POLICER_ACTION_PASS = 0,
+	POLICER_ACTION_DROP,
+	/* Rewrite the IPv4 DSCP */
+	POLICER_ACTION_REMARK,
+	/* Lowest event priority from here on */
+	POLICER_ACTION_DEMOTE,
+	POLICER_ACTION_MAX,
+};
+
+/* Rates in bytes per second, bursts in bytes. srTCM takes the excess
+ * burst from pbs and ignores pir. Actions and DSCP are per color.
+ */
+struct policer_params {
+	uint8_t type;
+	uint64_t cir;
+	uint64_t cbs;
+	uint64_t pir;
+	uint64_t pbs;
+	uint8_t action[RTE_COLORS];
+	uint8_t dscp[RTE_COLORS];
+};
+
+/* Policer picked by an ACL match, written by vs_acl on every packet once
+ * policing is enabled.
+ */
+struct policer_mbuf {
+	uint8_t policer;
+};
+
+extern int policer_mbuf_offset;
+
+/* Set on demoted packets, 0 while policing is disabled */
+extern uint64_t policer_demote_flag;
+
+static __rte_always_inline struct policer_mbuf *
+policer_mbuf_get(struct rte_mbuf *mbuf)
+{
+	return RTE_MBUF_DYNFIELD(mbuf, policer_mbuf_offset, struct policer_mbuf *);
+}
+
+/* params is indexed by policer id, link_policer by port id. Each of the
+ * nb_lcores receiving lcores meters on its own at an even share of the
+ * rates, bursts are not split.
+ */
+int policer_init(struct policer_params const *params, uint8_t const *link_policer,
+		 uint32_t nb_lcores);
+void policer_fini(void);
+bool policer_enabled(void);
+
+rte_node_t policer_node_clone(char const *name);
+
+/* acl tells the node to look at the policer picked by vs_acl first */
+int policer_node_data_add(rte_node_t node_id, unsigned int lcore_id, bool acl,
+			  char const *next_node);
+
+#endif /* __SRC_LIB_NODE_POLICER_H__ */
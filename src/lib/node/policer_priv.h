@@ -0,0 +1,72 @@
+/*
+  SPDX-License-Identifier: MIT
+  Copyright(c) 2023 Sriram Yagnaraman.
+*/
+
+#ifndef __SRC_LIB_NODE_POLICER_PRIV_H__
+#define __SRC_LIB_NODE_POLICER_PRIV_H__
+
+#include <rte_common.h>
+#include <rte_graph.h>
+#include <rte_meter.h>
+
+#include "policer.h"
+
+#define POLICER_MBUF_NAME	"vs_policer_mbuf"
+#define POLICER_DEMOTE_NAME	"vs_policer_demote"
+
+/* Read only once the graphs run */
+struct policer_profile {
+	uint8_t type;
+	uint8_t action[RTE_COLORS];
+	uint8_t dscp[RTE_COLORS];
+	union {
+		struct rte_meter_srtcm_profile srtcm;
+		struct rte_meter_trtcm_profile trtcm;
+	};
+};
+
+struct policer_meter {
+	union {
+		struct rte_meter_srtcm srtcm;
+		struct rte_meter_trtcm trtcm;
+	};
+};
+
+/* Per lcore, the meters are only touched by their owner */
+struct policer_table {
+	struct policer_profile *profiles;
+	uint8_t link_policer[RTE_MAX_ETHPORTS];
+	struct policer_meter meters[POLICER_MAX];
+};
+
+struct policer_main {
+	struct policer_profile profiles[POLICER_MAX];
+	uint8_t link_policer[RTE_MAX_ETHPORTS];
+	struct policer_table *tables[RTE_MAX_LCORE];
+};
+
+struct policer_node_ctx {
+	struct policer_table *table;
+	rte_edge_t next_node;
+	uint8_t acl;
+};
+
+struct policer_node_item {
+	struct policer_node_item *next;
+	struct policer_node_item *prev;
+	struct policer_node_ctx ctx;
+
+	rte_node_t node_id;
+};
+
+struct policer_node_list {
+	struct policer_node_item *head;
+};
+
+enum policer_next_nodes {
+	POLICER_NEXT_PKT_DROP = 0,
+	POLICER_NEXT_MAX,
+};
+
+#endif /* __SRC_LIB_NODE_POLICER_PRIV_H__ */
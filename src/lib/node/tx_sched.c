@@ -0,0 +1,401 @@
+/*
+  SPDX-License-Identifier: MIT
+  Copyright(c) 2023 Sriram Yagnaraman.
+*/
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <rte_ether.h>
+#include <rte_graph.h>
+#include <rte_graph_worker.h>
+#include <rte_ip.h>
+#include <rte_lcore.h>
+#include <rte_malloc.h>
+#include <rte_mbuf.h>
+#include <rte_sched.h>
+
+#include "tx_sched_priv.h"
+#include "tx_sched.h"
+
+static struct tx_sched_link *tx_sched_links[RTE_MAX_LCORE][RTE_MAX_ETHPORTS];
+
+static struct tx_sched_node_list node_list = {
+	.head = NULL,
+};
+
+/* Class selector to traffic class, CS7 is served first and CS0 is
+ * best effort.
+ */
+static void
+tx_sched_dscp_tc_init(uint8_t *dscp_tc)
+{
+	uint32_t dscp, cs;
+
+	for (dscp = 0; dscp < 64; dscp++) {
+		cs = dscp >> 3;
+		dscp_tc[dscp] = cs ? TX_SCHED_TC_BE - cs : TX_SCHED_TC_BE;
+	}
+}
+
+static void
+tx_sched_pipe_params(struct rte_sched_pipe_params *pp, struct tx_sched_profile const *profile,
+		     uint64_t rate, uint32_t share)
+{
+	uint32_t i;
+
+	memset(pp, 0, sizeof(*pp));
+	pp->tb_rate = RTE_MAX(RTE_MIN(profile->rate, rate) / share, 1);
+	pp->tb_size = profile->size ? profile->size : TX_SCHED_TB_SIZE;
+	for (i = 0; i < RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE; i++)
+		pp->tc_rate[i] = pp->tb_rate;
+	pp->tc_period = TX_SCHED_TC_PERIOD;
+	pp->tc_ov_weight = 1;
+	for (i = 0; i < RTE_SCHED_BE_QUEUES_PER_PIPE; i++)
+		pp->wrr_weights[i] = 1;
+}
+
+static struct rte_sched_port *
+tx_sched_port_create(unsigned int lcore_id, uint16_t link_id,
+		     struct tx_sched_link_config const *config, uint32_t share)
+{
+	struct rte_sched_pipe_params pipes[TX_SCHED_PROFILES_MAX];
+	struct rte_sched_subport_profile_params sp;
+	struct rte_sched_subport_params subport;
+	struct rte_sched_port_params params;
+	struct rte_sched_port *port;
+	char name[32];
+	uint64_t rate;
+	uint32_t i;
+	int rc;
+
+	rate = RTE_MAX(config->rate / share, 1);
+
+	memset(&sp, 0, sizeof(sp));
+	sp.tb_rate = rate;
+	sp.tb_size = TX_SCHED_TB_SIZE;
+	for (i = 0; i < RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE; i++)
+		sp.tc_rate[i] = rate;
+	sp.tc_period = TX_SCHED_TC_PERIOD;
+
+	snprintf(name, sizeof(name), "tx_sched_%u_%u", lcore_id, link_id);
+	memset(&params, 0, sizeof(params));
+	params.name = name;
+	params.socket = rte_lcore_to_socket_id(lcore_id);
+	params.rate = rate;
+	params.mtu = TX_SCHED_MTU;
+	params.frame_overhead = RTE_SCHED_FRAME_OVERHEAD_DEFAULT;
+	params.n_subports_per_port = 1;
+	params.n_subport_profiles = 1;
+	params.subport_profiles = &sp;
+	params.n_max_subport_profiles = 1;
+	params.n_pipes_per_subport = config->nb_pipes;
+
+	port = rte_sched_port_config(&params);
+	if (!port)
+		return NULL;
+
+	for (i = 0; i < config->nb_profiles; i++)
+		tx_sched_pipe_params(&pipes[i], &config->profiles[i], config->rate, share);
+
+	memset(&subport, 0, sizeof(subport));
+	subport.n_pipes_per_subport_enabled = config->nb_pipes;
+	for (i = 0; i < RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE; i++)
+		subport.qsize[i] = TX_SCHED_QUEUE_SIZE;
+	subport.pipe_profiles = pipes;
+	subport.n_pipe_profiles = config->nb_profiles;
+	subport.n_max_pipe_profiles = config->nb_profiles;
+
+	rc = rte_sched_subport_config(port, 0, &subport, 0);
+	if (rc < 0)
+		goto err;
+
+	for (i = 0; i < config->nb_pipes; i++) {
+		rc = rte_sched_pipe_config(port, 0, i, config->pipe_profile[i]);
+		if (rc < 0)
+			goto err;
+	}
+
+	return port;
+
+err:
+	rte_sched_port_free(port);
+	return NULL;
+}
+
+void
+tx_sched_fini(void)
+{
+	uint32_t i, j;
+
+	for (i = 0; i < RTE_MAX_LCORE; i++) {
+		for (j = 0; j < RTE_MAX_ETHPORTS; j++) {
+			if (!tx_sched_links[i][j])
+				continue;
+			rte_sched_port_free(tx_sched_links[i][j]->port);
+			rte_free(tx_sched_links[i][j]);
+			tx_sched_links[i][j] = NULL;
+		}
+	}
+}
+
+static __rte_always_inline void
+tx_sched_classify(struct tx_sched_link *link, struct rte_mbuf *mbuf)
+{
+	struct rte_ether_hdr *eth = rte_pktmbuf_mtod(mbuf, struct rte_ether_hdr *);
+	uint32_t pipe, tc, queue;
+	struct rte_ipv4_hdr *ip;
+
+	pipe = link->vlan_pipe[vlan_mbuf_get(mbuf)];
+	tc = TX_SCHED_TC_BE;
+	/* The sched field shares the rss hash, read it first */
+	queue = mbuf->hash.rss & (RTE_SCHED_BE_QUEUES_PER_PIPE - 1);
+
+	if (eth->ether_type == RTE_BE16(RTE_ETHER_TYPE_IPV4) &&
+	    rte_pktmbuf_data_len(mbuf) >= sizeof(*eth) + sizeof(*ip)) {
+		ip = (struct rte_ipv4_hdr *)(eth + 1);
+		tc = link->dscp_tc[ip->type_of_service >> 2];
+		if (tc != TX_SCHED_TC_BE)
+			queue = 0;
+	}
+
+	rte_sched_port_pkt_write(link->port, mbuf, 0, pipe, tc, queue, RTE_COLOR_GREEN);
+}
+
+static uint16_t
+tx_sched_classify_node_process(struct rte_graph *graph,
+			       struct rte_node *node,
+			       void **objs,
+			       uint16_t nb_objs)
+{
+	struct tx_sched_node_ctx *ctx = (struct tx_sched_node_ctx *)node->ctx;
+	uint16_t i;
+
+	for (i = 0; i < nb_objs; i++)
+		tx_sched_classify(ctx->link, (struct rte_mbuf *)objs[i]);
+
+	rte_node_next_stream_move(graph, node, ctx->next_node);
+	return nb_objs;
+}
+
+static uint16_t
+tx_sched_node_process(__rte_unused struct rte_graph *graph,
+		      struct rte_node *node,
+		      void **objs,
+		      uint16_t nb_objs)
+{
+	struct tx_sched_node_ctx *ctx = (struct tx_sched_node_ctx *)node->ctx;
+
+	/* Packets that do not fit are freed by rte_sched */
+	rte_sched_port_enqueue(ctx->link->port, (struct rte_mbuf **)objs, nb_objs);
+	return nb_objs;
+}
+
+static uint16_t
+tx_sched_deq_node_process(struct rte_graph *graph,
+			  struct rte_node *node,
+			  __rte_unused void **objs,
+			  __rte_unused uint16_t nb_objs)
+{
+	struct tx_sched_node_ctx *ctx = (struct tx_sched_node_ctx *)node->ctx;
+	int count;
+
+	count = rte_sched_port_dequeue(ctx->link->port, (struct rte_mbuf **)node->objs,
+				       RTE_GRAPH_BURST_SIZE);
+	if (!count)
+		return 0;
+
+	node->idx = count;
+	rte_node_next_stream_move(graph, node, ctx->next_node);
+	return count;
+}
+
+static struct tx_sched_node_item*
+tx_sched_node_data_get(rte_node_t node_id)
+{
+	struct tx_sched_node_item *item = node_list.head;
+
+	for (; item; item = item->next) {
+		if (item->node_id == node_id)
+			return item;
+	}
+
+	return NULL;
+}
+
+static int
+tx_sched_node_item_add(rte_node_t node_id, struct tx_sched_link *link, char const *next_node)
+{
+	struct tx_sched_node_item *item;
+
+	item = rte_zmalloc(NULL, sizeof(struct tx_sched_node_item), 0);
+	if (!item)
+		return -ENOMEM;
+
+	if (next_node) {
+		rte_node_edge_update(node_id, RTE_EDGE_ID_INVALID, &next_node, 1);
+		item->ctx.next_node = rte_node_edge_count(node_id) - 1;
+	}
+	item->ctx.link = link;
+	item->node_id = node_id;
+	item->prev = NULL;
+	item->next = node_list.head;
+	if (node_list.head)
+		node_list.head->prev = item;
+	node_list.head = item;
+
+	return 0;
+}
+
+int
+tx_sched_node_data_add(rte_node_t classify_id, rte_node_t enq_id, rte_node_t deq_id,
+		       unsigned int lcore_id, uint16_t link_id,
+		       struct tx_sched_link_config const *config, uint32_t share,
+		       char const *next_node)
+{
+	struct tx_sched_link *link;
+	char const *enq_name;
+	uint32_t i;
+	int rc;
+
+	if (next_node == NULL || config == NULL || share == 0 ||
+	    lcore_id >= RTE_MAX_LCORE || link_id >= RTE_MAX_ETHPORTS)
+		return -EINVAL;
+
+	if (config->nb_profiles == 0 || !rte_is_power_of_2(config->nb_pipes) ||
+	    config->nb_pipes > TX_SCHED_PIPES_MAX)
+		return -EINVAL;
+
+	if (tx_sched_node_data_get(classify_id) ||
+	    tx_sched_node_data_get(enq_id) || tx_sched_node_data_get(deq_id))
+		return -EEXIST;
+
+	/* A rebuilt graph dequeues what the previous one left queued */
+	link = tx_sched_links[lcore_id][link_id];
+	if (link)
+		goto nodes;
+
+	link = rte_zmalloc_socket(NULL, sizeof(*link), RTE_CACHE_LINE_SIZE,
+				  rte_lcore_to_socket_id(lcore_id));
+	if (!link)
+		return -ENOMEM;
+
+	for (i = 0; i < VLAN_VID_MAX; i++)
+		link->vlan_pipe[i] = config->vlan_pipe[i] < config->nb_pipes ?
+				     config->vlan_pipe[i] : 0;
+	tx_sched_dscp_tc_init(link->dscp_tc);
+
+	link->port = tx_sched_port_create(lcore_id, link_id, config, share);
+	if (!link->port) {
+		rte_free(link);
+		return -EINVAL;
+	}
+	tx_sched_links[lcore_id][link_id] = link;
+
+nodes:
+	enq_name = rte_node_id_to_name(enq_id);
+	rc = tx_sched_node_item_add(classify_id, link, enq_name);
+	if (rc < 0)
+		return rc;
+
+	rc = tx_sched_node_item_add(enq_id, link, NULL);
+	if (rc < 0)
+		return rc;
+
+	return tx_sched_node_item_add(deq_id, link, next_node);
+}
+
+static int
+tx_sched_node_init(__rte_unused const struct rte_graph *graph, struct rte_node *node)
+{
+	struct tx_sched_node_ctx *ctx = (struct tx_sched_node_ctx *)node->ctx;
+	struct tx_sched_node_item *item = tx_sched_node_data_get(node->id);
+
+	RTE_VERIFY(sizeof(*ctx) <= sizeof(node->ctx));
+	RTE_VERIFY(item != NULL);
+
+	memcpy(ctx, &item->ctx, sizeof(*ctx));
+
+	return 0;
+}
+
+static void
+tx_sched_node_fini(__rte_unused const struct rte_graph *graph, struct rte_node *node)
+{
+	struct tx_sched_node_item *item = tx_sched_node_data_get(node->id);
+
+	if (!item)
+		return;
+
+	if (item->next)
+		item->next->prev = item->prev;
+	if (item->prev)
+		item->prev->next = item->next;
+	if (item == node_list.head)
+		node_list.head = item->next;
+
+	rte_free(item);
+}
+
+static struct rte_node_register tx_sched_classify_node = {
+	.process = tx_sched_classify_node_process,
+	.name = "vs_tx_sched_classify",
+
+	.init = tx_sched_node_init,
+	.fini = tx_sched_node_fini,
+
+	.nb_edges = TX_SCHED_NEXT_MAX,
+	.next_nodes = {
+		[TX_SCHED_NEXT_PKT_DROP] = "pkt_drop",
+	},
+};
+
+static struct rte_node_register tx_sched_node = {
+	.process = tx_sched_node_process,
+	.name = "vs_tx_sched",
+
+	.init = tx_sched_node_init,
+	.fini = tx_sched_node_fini,
+
+	.nb_edges = TX_SCHED_NEXT_MAX,
+	.next_nodes = {
+		[TX_SCHED_NEXT_PKT_DROP] = "pkt_drop",
+	},
+};
+
+static struct rte_node_register tx_sched_deq_node = {
+	.process = tx_sched_deq_node_process,
+	.flags = RTE_NODE_SOURCE_F,
+	.name = "vs_tx_sched_deq",
+
+	.init = tx_sched_node_init,
+	.fini = tx_sched_node_fini,
+
+	.nb_edges = TX_SCHED_NEXT_MAX,
+	.next_nodes = {
+		[TX_SCHED_NEXT_PKT_DROP] = "pkt_drop",
+	},
+};
+
+rte_node_t
+tx_sched_classify_node_clone(char const *name)
+{
+	return rte_node_clone(tx_sched_classify_node.id, name);
+}
+
+rte_node_t
+tx_sched_node_clone(char const *name)
+{
+	return rte_node_clone(tx_sched_node.id, name);
+}
+
+rte_node_t
+tx_sched_deq_node_clone(char const *name)
+{
+	return rte_node_clone(tx_sched_deq_node.id, name);
+}
+
+RTE_NODE_REGISTER(tx_sched_classify_node);
+RTE_NODE_REGISTER(tx_sched_node);
+RTE_NODE_REGISTER(tx_sched_deq_node);
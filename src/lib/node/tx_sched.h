@@ -0,0 +1,51 @@
+/*
+  SPDX-License-Identifier: MIT
+  Copyright(c) 2023 Sriram Yagnaraman.
+*/
+
+#ifndef __SRC_LIB_NODE_TX_SCHED_H__
+#define __SRC_LIB_NODE_TX_SCHED_H__
+
+#include <rte_graph.h>
+#include <rte_sched.h>
+
+#include "vlan.h"
+
+#define TX_SCHED_PIPES_MAX	(4096)
+#define TX_SCHED_PROFILES_MAX	(16)
+#define TX_SCHED_QUEUE_SIZE	(64)
+#define TX_SCHED_TC_BE		(RTE_SCHED_TRAFFIC_CLASS_BE)
+
+/* Token bucket of a pipe, rate in bytes per second */
+struct tx_sched_profile {
+	uint64_t rate;
+	uint64_t size;
+};
+
+/* One subport covering the link. Tenants are vlans mapped to pipes,
+ * unmapped vlans share pipe 0. Rates in bytes per second.
+ */
+struct tx_sched_link_config {
+	uint64_t rate;
+	uint32_t nb_pipes;
+	uint32_t nb_profiles;
+	struct tx_sched_profile profiles[TX_SCHED_PROFILES_MAX];
+	uint8_t pipe_profile[TX_SCHED_PIPES_MAX];
+	uint16_t vlan_pipe[VLAN_VID_MAX];
+};
+
+rte_node_t tx_sched_classify_node_clone(char const *name);
+rte_node_t tx_sched_node_clone(char const *name);
+rte_node_t tx_sched_deq_node_clone(char const *name);
+
+/* Builds the scheduler of link_id for lcore_id at 1/share of the
+ * configured rates. classify feeds the enqueue node, dequeue is a
+ * source node sending to next_node.
+ */
+int tx_sched_node_data_add(rte_node_t classify_id, rte_node_t enq_id, rte_node_t deq_id,
+			   unsigned int lcore_id, uint16_t link_id,
+			   struct tx_sched_link_config const *config, uint32_t share,
+			   char const *next_node);
+void tx_sched_fini(void);
+
+#endif /* __SRC_LIB_NODE_TX_SCHED_H__ */
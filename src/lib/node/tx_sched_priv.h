@@ -0,0 +1,48 @@
+/*
+  SPDX-License-Identifier: MIT
+  Copyright(c) 2023 Sriram Yagnaraman.
+*/
+
+#ifndef __SRC_LIB_NODE_TX_SCHED_PRIV_H__
+#define __SRC_LIB_NODE_TX_SCHED_PRIV_H__
+
+#include <rte_common.h>
+#include <rte_graph.h>
+#include <rte_sched.h>
+
+#include "tx_sched.h"
+
+#define TX_SCHED_MTU		(RTE_ETHER_MAX_VLAN_FRAME_LEN)
+#define TX_SCHED_TC_PERIOD	(10)
+#define TX_SCHED_TB_SIZE	(1000000)
+
+/* Owned by one lcore, rte_sched is not thread safe */
+struct tx_sched_link {
+	struct rte_sched_port *port;
+	uint16_t vlan_pipe[VLAN_VID_MAX];
+	uint8_t dscp_tc[64];
+};
+
+struct tx_sched_node_ctx {
+	struct tx_sched_link *link;
+	rte_edge_t next_node;
+};
+
+struct tx_sched_node_item {
+	struct tx_sched_node_item *next;
+	struct tx_sched_node_item *prev;
+	struct tx_sched_node_ctx ctx;
+
+	rte_node_t node_id;
+};
+
+struct tx_sched_node_list {
+	struct tx_sched_node_item *head;
+};
+
+enum tx_sched_next_nodes {
+	TX_SCHED_NEXT_PKT_DROP = 0,
+	TX_SCHED_NEXT_MAX,
+};
+
+#endif /* __SRC_LIB_NODE_TX_SCHED_PRIV_H__ */
@@ -0,0 +1,454 @@
+/*
+  SPDX-License-Identifier: MIT
+  Copyright(c) 2023 Sriram Yagnaraman.
+*/
+
+#include <errno.h>
+#include <string.h>
+
+#include <rte_byteorder.h>
+#include <rte_ether.h>
+#include <rte_graph.h>
+#include <rte_graph_worker.h>
+#include <rte_malloc.h>
+#include <rte_mbuf.h>
+#include <rte_vect.h>
+
+#include "vlan_priv.h"
+#include "vlan.h"
+
+struct vlan_link_config vlan_links[RTE_MAX_ETHPORTS];
+
+static struct vlan_rx_node_list rx_node_list = {
+	.head = NULL,
+};
+
+static struct vlan_tx_node_list tx_node_list = {
+	.head = NULL,
+};
+
+int
+vlan_link_set(uint16_t link_id, struct vlan_link_config *config)
+{
+	if (link_id >= RTE_MAX_ETHPORTS || config->mode >= VLAN_MODE_MAX)
+		return -EINVAL;
+
+	memcpy(&vlan_links[link_id], config, sizeof(*config));
+	return 0;
+}
+
+bool
+vlan_enabled(void)
+{
+	uint16_t link_id;
+
+	for (link_id = 0; link_id < RTE_MAX_ETHPORTS; link_id++) {
+		if (vlan_links[link_id].mode != VLAN_MODE_NONE)
+			return true;
+	}
+
+	return false;
+}
+
+/* Shift both MAC addresses over the outer tag, one 16 byte load and
+ * store instead of a byte wise memmove.
+ */
+static __rte_always_inline void
+vlan_hdr_pop(struct rte_mbuf *mbuf)
+{
+	uint8_t *data = rte_pktmbuf_mtod(mbuf, uint8_t *);
+#if defined(RTE_ARCH_X86)
+	__m128i hdr = _mm_loadu_si128((__m128i *)data);
+
+	_mm_storeu_si128((__m128i *)data, _mm_slli_si128(hdr, VLAN_HDR_LEN));
+#else
+	memmove(data + VLAN_HDR_LEN, data, 2 * RTE_ETHER_ADDR_LEN);
+#endif
+	rte_pktmbuf_adj(mbuf, VLAN_HDR_LEN);
+}
+
+static __rte_always_inline int
+vlan_hdr_push(struct rte_mbuf *mbuf, uint16_t tpid, uint16_t tci)
+{
+	uint8_t *data;
+
+	data = (uint8_t *)rte_pktmbuf_prepend(mbuf, VLAN_HDR_LEN);
+	if (unlikely(data == NULL))
+		return -ENOSPC;
+
+#if defined(RTE_ARCH_X86)
+	__m128i hdr = _mm_loadu_si128((__m128i *)(data + VLAN_HDR_LEN));
+
+	/* MAC addresses stay in lanes 0-2, the tag replaces lane 3 */
+	hdr = _mm_insert_epi32(hdr, (uint32_t)tpid | ((uint32_t)rte_cpu_to_be_16(tci) << 16), 3);
+	_mm_storeu_si128((__m128i *)data, hdr);
+#else
+	struct rte_ether_hdr *eth = (struct rte_ether_hdr *)data;
+	struct rte_vlan_hdr *vh = (struct rte_vlan_hdr *)(eth + 1);
+
+	memmove(data, data + VLAN_HDR_LEN, 2 * RTE_ETHER_ADDR_LEN);
+	eth->ether_type = tpid;
+	vh->vlan_tci = rte_cpu_to_be_16(tci);
+#endif
+	return 0;
+}
+
+static __rte_always_inline bool
+vlan_allowed(struct vlan_link_config *config, uint16_t vid)
+{
+	return (config->allowed[vid / 64] >> (vid % 64)) & 1;
+}
+
+/* Assigns the ingress vlan, trunk tags are popped here so everything
+ * after this node sees untagged frames.
+ */
+static __rte_always_inline bool
+vlan_rx_classify(struct rte_mbuf *mbuf)
+{
+	struct vlan_link_config *config = &vlan_links[mbuf->port];
+	struct rte_ether_hdr *eth;
+	struct rte_vlan_hdr *vh;
+	uint16_t tci, tpid;
+
+	switch (config->mode) {
+	case VLAN_MODE_NONE:
+		mbuf->ol_flags &= ~RTE_MBUF_F_RX_VLAN;
+		return true;
+	case VLAN_MODE_ACCESS:
+		tci = config->pvid;
+		break;
+	default:
+		tpid = (config->mode == VLAN_MODE_QINQ) ?
+			RTE_BE16(RTE_ETHER_TYPE_QINQ) : RTE_BE16(RTE_ETHER_TYPE_VLAN);
+		eth = rte_pktmbuf_mtod(mbuf, struct rte_ether_hdr *);
+		if (mbuf->ol_flags & RTE_MBUF_F_RX_VLAN_STRIPPED) {
+			tci = mbuf->vlan_tci;
+		} else if (eth->ether_type == tpid &&
+			   mbuf->data_len >= VLAN_TAGGED_MIN_LEN) {
+			vh = (struct rte_vlan_hdr *)(eth + 1);
+			tci = rte_be_to_cpu_16(vh->vlan_tci);
+			vlan_hdr_pop(mbuf);
+			mbuf->packet_type &= ~RTE_PTYPE_L2_MASK;
+			mbuf->packet_type |= (config->mode == VLAN_MODE_QINQ) ?
+				RTE_PTYPE_L2_ETHER_VLAN : RTE_PTYPE_L2_ETHER;
+		} else {
+			tci = config->pvid;
+		}
+
+		/* Priority tagged frames belong to the native vlan */
+		if ((tci & VLAN_VID_MASK) == 0)
+			tci = (tci & ~VLAN_VID_MASK) | config->pvid;
+
+		if (!vlan_allowed(config, tci & VLAN_VID_MASK))
+			return false;
+		break;
+	}
+
+	mbuf->vlan_tci = tci;
+	mbuf->ol_flags |= RTE_MBUF_F_RX_VLAN;
+	return true;
+}
+
+bool
+vlan_classify(struct rte_mbuf *mbuf)
+{
+	return vlan_rx_classify(mbuf);
+}
+
+static uint16_t
+vlan_rx_node_process(struct rte_graph *graph,
+		     struct rte_node *node,
+		     void **objs,
+		     uint16_t nb_objs)
+{
+	struct vlan_rx_node_ctx *ctx = (struct vlan_rx_node_ctx *)node->ctx;
+	struct rte_mbuf **pkts = (struct rte_mbuf **)objs;
+	uint16_t held = 0;
+	void **to_next;
+	uint16_t i;
+
+	to_next = rte_node_next_stream_get(graph, node, ctx->next_node, nb_objs);
+	for (i = 0; i < nb_objs; i++) {
+		if (likely(i + 4 < nb_objs))
+			rte_prefetch0(rte_pktmbuf_mtod(pkts[i + 4], void *));
+
+		if (likely(vlan_rx_classify(pkts[i])))
+			to_next[held++] = pkts[i];
+		else
+			rte_node_enqueue_x1(graph, node, VLAN_RX_NEXT_PKT_DROP, pkts[i]);
+	}
+
+	rte_node_next_stream_put(graph, node, ctx->next_node, held);
+	return nb_objs;
+}
+
+static struct vlan_rx_node_item*
+vlan_rx_node_data_get(rte_node_t node_id)
+{
+	struct vlan_rx_node_item *item = rx_node_list.head;
+
+	for (; item; item = item->next) {
+		if (item->node_id == node_id)
+			return item;
+	}
+
+	return NULL;
+}
+
+int
+vlan_rx_node_data_set_next(rte_node_t node_id, char const *next_node)
+{
+	struct vlan_rx_node_item *item;
+
+	if (next_node == NULL)
+		return -EINVAL;
+
+	item = vlan_rx_node_data_get(node_id);
+	if (!item) {
+		item = rte_zmalloc(NULL, sizeof(struct vlan_rx_node_item), 0);
+		if (!item)
+			return -ENOMEM;
+
+		item->node_id = node_id;
+		item->prev = NULL;
+		item->next = rx_node_list.head;
+		if (rx_node_list.head)
+			rx_node_list.head->prev = item;
+		rx_node_list.head = item;
+	}
+
+	rte_node_edge_update(node_id, RTE_EDGE_ID_INVALID, &next_node, 1);
+	item->ctx.next_node = rte_node_edge_count(node_id) - 1;
+
+	return 0;
+}
+
+static int
+vlan_rx_node_init(__rte_unused const struct rte_graph *graph, struct rte_node *node)
+{
+	struct vlan_rx_node_ctx *ctx = (struct vlan_rx_node_ctx *)node->ctx;
+	struct vlan_rx_node_item *item = vlan_rx_node_data_get(node->id);
+
+	RTE_VERIFY(sizeof(*ctx) <= sizeof(node->ctx));
+	RTE_VERIFY(item != NULL);
+
+	memcpy(ctx, &item->ctx, sizeof(*ctx));
+
+	return 0;
+}
+
+static void
+vlan_rx_node_fini(__rte_unused const struct rte_graph *graph, struct rte_node *node)
+{
+	struct vlan_rx_node_item *item = vlan_rx_node_data_get(node->id);
+
+	if (!item)
+		return;
+
+	if (item->next)
+		item->next->prev = item->prev;
+	if (item->prev)
+		item->prev->next = item->next;
+	if (item == rx_node_list.head)
+		rx_node_list.head = item->next;
+
+	rte_free(item);
+}
+
+static struct rte_node_register vlan_rx_node = {
+	.process = vlan_rx_node_process,
+	.name = "vs_vlan_rx",
+
+	.init = vlan_rx_node_init,
+	.fini = vlan_rx_node_fini,
+
+	.nb_edges = VLAN_RX_NEXT_MAX,
+	.next_nodes = {
+		[VLAN_RX_NEXT_PKT_DROP] = "pkt_drop",
+	},
+};
+
+rte_node_t
+vlan_rx_node_clone(char const *name)
+{
+	return rte_node_clone(vlan_rx_node.id, name);
+}
+
+RTE_NODE_REGISTER(vlan_rx_node);
+
+/* Flooded frames share one mbuf between links, tagging must not leak
+ * into the copies sent elsewhere.
+ */
+static __rte_always_inline struct rte_mbuf *
+vlan_tx_unshare(struct rte_mbuf *mbuf)
+{
+	struct rte_mbuf *copy;
+
+	if (likely(rte_mbuf_refcnt_read(mbuf) == 1))
+		return mbuf;
+
+	copy = rte_pktmbuf_copy(mbuf, mbuf->pool, 0, UINT32_MAX);
+	if (copy) {
+		copy->ol_flags |= mbuf->ol_flags & RTE_MBUF_F_RX_VLAN;
+		copy->vlan_tci = mbuf->vlan_tci;
+		rte_pktmbuf_free(mbuf);
+	}
+	return copy;
+}
+
+/* Returns -1 when *pmbuf is to be dropped */
+static __rte_always_inline int
+vlan_tx_tag(struct vlan_tx_node_ctx *ctx, struct rte_mbuf **pmbuf)
+{
+	struct vlan_link_config *config = ctx->config;
+	struct rte_mbuf *mbuf = *pmbuf;
+	uint16_t vid = vlan_mbuf_get(mbuf);
+
+	if (config->mode == VLAN_MODE_ACCESS)
+		return likely(vid == config->pvid) ? 0 : -1;
+
+	if (unlikely(vid == 0 || !vlan_allowed(config, vid)))
+		return -1;
+
+	/* The native vlan leaves untagged */
+	if (vid == config->pvid)
+		return 0;
+
+	mbuf = vlan_tx_unshare(mbuf);
+	if (unlikely(mbuf == NULL))
+		return -1;
+	*pmbuf = mbuf;
+
+	if (config->hw_insert) {
+		mbuf->ol_flags |= RTE_MBUF_F_TX_VLAN;
+		return 0;
+	}
+
+	return vlan_hdr_push(mbuf, ctx->tpid, mbuf->vlan_tci) < 0 ? -1 : 0;
+}
+
+static uint16_t
+vlan_tx_node_process(struct rte_graph *graph,
+		     struct rte_node *node,
+		     void **objs,
+		     uint16_t nb_objs)
+{
+	struct vlan_tx_node_ctx *ctx = (struct vlan_tx_node_ctx *)node->ctx;
+	struct rte_mbuf **pkts = (struct rte_mbuf **)objs;
+	struct rte_mbuf *mbuf;
+	uint16_t held = 0;
+	void **to_next;
+	uint16_t i;
+
+	to_next = rte_node_next_stream_get(graph, node, ctx->next_node, nb_objs);
+	for (i = 0; i < nb_objs; i++) {
+		if (likely(i + 4 < nb_objs))
+			rte_prefetch0(rte_pktmbuf_mtod(pkts[i + 4], void *));
+
+		mbuf = pkts[i];
+		if (likely(vlan_tx_tag(ctx, &mbuf) == 0))
+			to_next[held++] = mbuf;
+		else
+			rte_node_enqueue_x1(graph, node, VLAN_TX_NEXT_PKT_DROP, mbuf);
+	}
+
+	rte_node_next_stream_put(graph, node, ctx->next_node, held);
+	return nb_objs;
+}
+
+static struct vlan_tx_node_item*
+vlan_tx_node_data_get(rte_node_t node_id)
+{
+	struct vlan_tx_node_item *item = tx_node_list.head;
+
+	for (; item; item = item->next) {
+		if (item->node_id == node_id)
+			return item;
+	}
+
+	return NULL;
+}
+
+int
+vlan_tx_node_data_add(rte_node_t node_id, uint16_t link_id, char const *next_node)
+{
+	struct vlan_tx_node_item *item;
+
+	if (next_node == NULL || link_id >= RTE_MAX_ETHPORTS)
+		return -EINVAL;
+
+	item = vlan_tx_node_data_get(node_id);
+	if (item)
+		return -EEXIST;
+
+	item = rte_zmalloc(NULL, sizeof(struct vlan_tx_node_item), 0);
+	if (!item)
+		return -ENOMEM;
+
+	rte_node_edge_update(node_id, RTE_EDGE_ID_INVALID, &next_node, 1);
+	item->ctx.next_node = rte_node_edge_count(node_id) - 1;
+	item->ctx.config = &vlan_links[link_id];
+	item->ctx.tpid = (vlan_links[link_id].mode == VLAN_MODE_QINQ) ?
+		RTE_BE16(RTE_ETHER_TYPE_QINQ) : RTE_BE16(RTE_ETHER_TYPE_VLAN);
+	item->node_id = node_id;
+	item->prev = NULL;
+	item->next = tx_node_list.head;
+	if (tx_node_list.head)
+		tx_node_list.head->prev = item;
+	tx_node_list.head = item;
+
+	return 0;
+}
+
+static int
+vlan_tx_node_init(__rte_unused const struct rte_graph *graph, struct rte_node *node)
+{
+	struct vlan_tx_node_ctx *ctx = (struct vlan_tx_node_ctx *)node->ctx;
+	struct vlan_tx_node_item *item = vlan_tx_node_data_get(node->id);
+
+	RTE_VERIFY(sizeof(*ctx) <= sizeof(node->ctx));
+	RTE_VERIFY(item != NULL);
+
+	memcpy(ctx, &item->ctx, sizeof(*ctx));
+
+	return 0;
+}
+
+static void
+vlan_tx_node_fini(__rte_unused const struct rte_graph *graph, struct rte_node *node)
+{
+	struct vlan_tx_node_item *item = vlan_tx_node_data_get(node->id);
+
+	if (!item)
+		return;
+
+	if (item->next)
+		item->next->prev = item->prev;
+	if (item->prev)
+		item->prev->next = item->next;
+	if (item == tx_node_list.head)
+		tx_node_list.head = item->next;
+
+	rte_free(item);
+}
+
+static struct rte_node_register vlan_tx_node = {
+	.process = vlan_tx_node_process,
+	.name = "vs_vlan_tx",
+
+	.init = vlan_tx_node_init,
+	.fini = vlan_tx_node_fini,
+
+	.nb_edges = VLAN_TX_NEXT_MAX,
+	.next_nodes = {
+		[VLAN_TX_NEXT_PKT_DROP] = "pkt_drop",
+	},
+};
+
+rte_node_t
+vlan_tx_node_clone(char const *name)
+{
+	return rte_node_clone(vlan_tx_node.id, name);
+}
+
+RTE_NODE_REGISTER(vlan_tx_node);
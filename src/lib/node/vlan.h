@@ -0,0 +1,75 @@
+/*
+  SPDX-License-Identifier: MIT
+  Copyright(c) 2023 Sriram Yagnaraman.
+*/
+
+#ifndef __SRC_LIB_NODE_VLAN_H__
+#define __SRC_LIB_NODE_VLAN_H__
+
+#include <rte_ethdev.h>
+#include <rte_graph.h>
+#include <rte_mbuf.h>
+
+#define VLAN_VID_MAX		(4096)
+#define VLAN_VID_MASK		(0x0FFF)
+
+enum vlan_mode {
+	VLAN_MODE_NONE = 0,
+	/* Untagged, frames are carried as is in pvid (dot1q tunnel) */
+	VLAN_MODE_ACCESS,
+	/* 802.1Q tagged, pvid is the untagged native vlan */
+	VLAN_MODE_TRUNK,
+	/* 802.1ad S-tagged, customer tags are left in the payload */
+	VLAN_MODE_QINQ,
+	VLAN_MODE_MAX,
+};
+
+struct vlan_link_config {
+	uint8_t mode;
+	uint8_t hw_strip;
+	uint8_t hw_insert;
+	uint16_t pvid;
+	uint64_t allowed[VLAN_VID_MAX / 64];
+};
+
+/* Indexed by link id, written before the graphs are created */
+extern struct vlan_link_config vlan_links[RTE_MAX_ETHPORTS];
+
+/* Between the rx and tx nodes the vlan lives in the mbuf, untagged
+ * frames are in vlan 0.
+ */
+static __rte_always_inline uint16_t
+vlan_mbuf_get(struct rte_mbuf *mbuf)
+{
+	if (mbuf->ol_flags & RTE_MBUF_F_RX_VLAN)
+		return mbuf->vlan_tci & VLAN_VID_MASK;
+
+	return 0;
+}
+
+static __rte_always_inline bool
+vlan_link_member(uint16_t link_id, uint16_t vid)
+{
+	struct vlan_link_config *config = &vlan_links[link_id];
+
+	if (config->mode == VLAN_MODE_NONE)
+		return vid == 0;
+
+	return (config->allowed[vid / 64] >> (vid % 64)) & 1;
+}
+
+int vlan_link_set(uint16_t link_id, struct vlan_link_config *config);
+bool vlan_enabled(void);
+
+/* What vs_vlan_rx does, for frames entering the graph elsewhere.
+ * mbuf->port must be the link, false when the vlan is not allowed.
+ */
+bool vlan_classify(struct rte_mbuf *mbuf);
+
+rte_node_t vlan_rx_node_clone(char const *name);
+int vlan_rx_node_data_set_next(rte_node_t node_id, char const *next_node);
+
+rte_node_t vlan_tx_node_clone(char const *name);
+int vlan_tx_node_data_add(rte_node_t node_id, uint16_t link_id, char const *next_node);
+
+#endif /* __SRC_LIB_NODE_VLAN_H__ */
@@ -0,0 +1,63 @@
+/*
+  SPDX-License-Identifier: MIT
+  Copyright(c) 2023 Sriram Yagnaraman.
+*/
+
+#ifndef __SRC_LIB_NODE_VLAN_PRIV_H__
+#define __SRC_LIB_NODE_VLAN_PRIV_H__
+
+#include <rte_common.h>
+#include <rte_ether.h>
+#include <rte_graph.h>
+
+#include "vlan.h"
+
+#define VLAN_HDR_LEN		(sizeof(struct rte_vlan_hdr))
+#define VLAN_TAGGED_MIN_LEN	(RTE_ETHER_HDR_LEN + VLAN_HDR_LEN)
+
+enum vlan_rx_next_nodes {
+	VLAN_RX_NEXT_PKT_DROP = 0,
+	VLAN_RX_NEXT_MAX,
+};
+
+enum vlan_tx_next_nodes {
+	VLAN_TX_NEXT_PKT_DROP = 0,
+	VLAN_TX_NEXT_MAX,
+};
+
+struct vlan_rx_node_ctx {
+	rte_edge_t next_node;
+};
+
+struct vlan_rx_node_item {
+	struct vlan_rx_node_item *next;
+	struct vlan_rx_node_item *prev;
+	struct vlan_rx_node_ctx ctx;
+
+	rte_node_t node_id;
+};
+
+struct vlan_rx_node_list {
+	struct vlan_rx_node_item *head;
+};
+
+/* One clone per output link, in front of its ethdev tx node */
+struct vlan_tx_node_ctx {
+	struct vlan_link_config *config;
+	rte_edge_t next_node;
+	uint16_t tpid;
+};
+
+struct vlan_tx_node_item {
+	struct vlan_tx_node_item *next;
+	struct vlan_tx_node_item *prev;
+	struct vlan_tx_node_ctx ctx;
+
+	rte_node_t node_id;
+};
+
+struct vlan_tx_node_list {
+	struct vlan_tx_node_item *head;
+};
+
+#endif /* __SRC_LIB_NODE_VLAN_PRIV_H__ */
@@ -0,0 +1,739 @@
+/*
+  SPDX-License-Identifier: MIT
+  Copyright(c) 2023 Sriram Yagnaraman.
+*/
+
+#include <errno.h>
+#include <string.h>
+
+#include <rte_byteorder.h>
+#include <rte_errno.h>
+#include <rte_ether.h>
+#include <rte_graph.h>
+#include <rte_graph_worker.h>
+#include <rte_hash.h>
+#include <rte_hash_crc.h>
+#include <rte_ip.h>
+#include <rte_malloc.h>
+#include <rte_mbuf.h>
+#include <rte_net.h>
+#include <rte_random.h>
+#include <rte_udp.h>
+
+#include "flow_hash.h"
+#include "vtep_priv.h"
+#include "vtep.h"
+
+#define VTEP_TTL	(64)
+
+#define VTEP_PTYPE_INNER_MASK	(RTE_PTYPE_INNER_L2_MASK | RTE_PTYPE_INNER_L3_MASK | \
+				 RTE_PTYPE_INNER_L4_MASK)
+#define VTEP_PTYPE_INNER_L2(p)	(((p) & RTE_PTYPE_INNER_L2_MASK) >> 16)
+#define VTEP_PTYPE_INNER_L3(p)	(((p) & RTE_PTYPE_INNER_L3_MASK) >> 20)
+#define VTEP_PTYPE_INNER_L4(p)	(((p) & RTE_PTYPE_INNER_L4_MASK) >> 24)
+
+/* The inner codes do not line up with the outer ones, map each */
+static const uint32_t vtep_ptype_inner_l2[16] = {
+	[VTEP_PTYPE_INNER_L2(RTE_PTYPE_INNER_L2_ETHER)] = RTE_PTYPE_L2_ETHER,
+	[VTEP_PTYPE_INNER_L2(RTE_PTYPE_INNER_L2_ETHER_VLAN)] = RTE_PTYPE_L2_ETHER_VLAN,
+	[VTEP_PTYPE_INNER_L2(RTE_PTYPE_INNER_L2_ETHER_QINQ)] = RTE_PTYPE_L2_ETHER_QINQ,
+};
+
+static const uint32_t vtep_ptype_inner_l3[16] = {
+	[VTEP_PTYPE_INNER_L3(RTE_PTYPE_INNER_L3_IPV4)] = RTE_PTYPE_L3_IPV4,
+	[VTEP_PTYPE_INNER_L3(RTE_PTYPE_INNER_L3_IPV4_EXT)] = RTE_PTYPE_L3_IPV4_EXT,
+	[VTEP_PTYPE_INNER_L3(RTE_PTYPE_INNER_L3_IPV6)] = RTE_PTYPE_L3_IPV6,
+	[VTEP_PTYPE_INNER_L3(RTE_PTYPE_INNER_L3_IPV4_EXT_UNKNOWN)] =
+		RTE_PTYPE_L3_IPV4_EXT_UNKNOWN,
+	[VTEP_PTYPE_INNER_L3(RTE_PTYPE_INNER_L3_IPV6_EXT)] = RTE_PTYPE_L3_IPV6_EXT,
+	[VTEP_PTYPE_INNER_L3(RTE_PTYPE_INNER_L3_IPV6_EXT_UNKNOWN)] =
+		RTE_PTYPE_L3_IPV6_EXT_UNKNOWN,
+};
+
+static const uint32_t vtep_ptype_inner_l4[16] = {
+	[VTEP_PTYPE_INNER_L4(RTE_PTYPE_INNER_L4_TCP)] = RTE_PTYPE_L4_TCP,
+	[VTEP_PTYPE_INNER_L4(RTE_PTYPE_INNER_L4_UDP)] = RTE_PTYPE_L4_UDP,
+	[VTEP_PTYPE_INNER_L4(RTE_PTYPE_INNER_L4_FRAG)] = RTE_PTYPE_L4_FRAG,
+	[VTEP_PTYPE_INNER_L4(RTE_PTYPE_INNER_L4_SCTP)] = RTE_PTYPE_L4_SCTP,
+	[VTEP_PTYPE_INNER_L4(RTE_PTYPE_INNER_L4_ICMP)] = RTE_PTYPE_L4_ICMP,
+	[VTEP_PTYPE_INNER_L4(RTE_PTYPE_INNER_L4_NONFRAG)] = RTE_PTYPE_L4_NONFRAG,
+};
+
+bool vtep_decap_enabled;
+
+static struct vtep_main *vtep_main;
+
+static struct vtep_decap_node_list decap_node_list = {
+	.head = NULL,
+};
+
+static struct vtep_encap_node_list encap_node_list = {
+	.head = NULL,
+};
+
+int
+vtep_init(uint16_t nb_vteps, int socket_id)
+{
+	struct rte_hash_parameters params;
+	struct vtep_main *vm;
+	int rc;
+
+	if (vtep_main)
+		return -EEXIST;
+
+	if (nb_vteps == 0 || nb_vteps > VTEP_MAX)
+		return -EINVAL;
+
+	vm = rte_zmalloc_socket(NULL, sizeof(*vm), RTE_CACHE_LINE_SIZE, socket_id);
+	if (!vm)
+		return -ENOMEM;
+
+	/* Filled in before the graphs run, workers only look up */
+	memset(&params, 0, sizeof(params));
+	params.name = "vtep_decap";
+	params.entries = VTEP_MAX;
+	params.key_len = sizeof(struct vtep_key);
+	params.hash_func = rte_hash_crc;
+	params.hash_func_init_val = 0;
+	params.socket_id = socket_id;
+	vm->decap = rte_hash_create(&params);
+	if (!vm->decap) {
+		rc = -rte_errno;
+		goto err;
+	}
+
+	vm->nb_vteps = nb_vteps;
+	vtep_main = vm;
+	vtep_decap_enabled = true;
+	return 0;
+
+err:
+	rte_free(vm);
+	return rc;
+}
+
+void
+vtep_fini(void)
+{
+	if (!vtep_main)
+		return;
+
+	vtep_decap_enabled = false;
+	rte_hash_free(vtep_main->decap);
+	rte_free(vtep_main);
+	vtep_main = NULL;
+}
+
+static void
+vtep_build(struct vtep *v, struct vtep_config *config)
+{
+	struct rte_ether_hdr *eth = (struct rte_ether_hdr *)v->hdr;
+	struct rte_ipv4_hdr *ip4;
+	struct rte_ipv6_hdr *ip6;
+	struct rte_udp_hdr *udp;
+	uint64_t tunnel;
+	uint8_t *tun;
+
+	memset(v->hdr, 0, sizeof(v->hdr));
+	rte_ether_addr_copy(&config->dst_mac, &eth->dst_addr);
+	rte_ether_addr_copy(&config->src_mac, &eth->src_addr);
+
+	if (config->ipv6) {
+		ip6 = (struct rte_ipv6_hdr *)(eth + 1);
+		eth->ether_type = RTE_BE16(RTE_ETHER_TYPE_IPV6);
+		ip6->vtc_flow = RTE_BE32(6 << 28);
+		ip6->proto = IPPROTO_UDP;
+		ip6->hop_limits = VTEP_TTL;
+		memcpy(&ip6->src_addr, config->local.ip6, sizeof(config->local.ip6));
+		memcpy(&ip6->dst_addr, config->remote.ip6, sizeof(config->remote.ip6));
+		v->l3_len = sizeof(*ip6);
+	} else {
+		ip4 = (struct rte_ipv4_hdr *)(eth + 1);
+		eth->ether_type = RTE_BE16(RTE_ETHER_TYPE_IPV4);
+		ip4->version_ihl = RTE_IPV4_VHL_DEF;
+		/* No DF, a smaller underlay MTU fragments the outer packet */
+		ip4->fragment_offset = 0;
+		ip4->time_to_live = VTEP_TTL;
+		ip4->next_proto_id = IPPROTO_UDP;
+		ip4->src_addr = config->local.ip4;
+		ip4->dst_addr = config->remote.ip4;
+		v->l3_len = sizeof(*ip4);
+		/* Length and id are patched per packet, keep the rest summed */
+		v->ip4_sum = rte_raw_cksum(ip4, sizeof(*ip4));
+	}
+
+	/* VXLAN and GENEVE both carry the VNI in bytes 4-6 */
+	udp = (struct rte_udp_hdr *)(v->hdr + RTE_ETHER_HDR_LEN + v->l3_len);
+	tun = (uint8_t *)(udp + 1);
+	if (config->type == VTEP_TYPE_VXLAN) {
+		udp->dst_port = RTE_BE16(VTEP_VXLAN_PORT);
+		tun[0] = VTEP_VXLAN_FLAG_VNI;
+		tunnel = RTE_MBUF_F_TX_TUNNEL_VXLAN;
+	} else {
+		udp->dst_port = RTE_BE16(VTEP_GENEVE_PORT);
+		*(rte_be16_t *)&tun[2] = RTE_BE16(VTEP_GENEVE_PROTO);
+		tunnel = RTE_MBUF_F_TX_TUNNEL_GENEVE;
+	}
+	tun[4] = config->vni >> 16;
+	tun[5] = config->vni >> 8;
+	tun[6] = config->vni;
+
+	v->hdr_len = RTE_ETHER_HDR_LEN + v->l3_len + sizeof(*udp) + VTEP_VXLAN_HDR_LEN;
+	v->ipv6 = config->ipv6;
+
+	/* IPv4 leaves the UDP checksum zero, IPv6 must fill it in */
+	v->ol_flags = 0;
+	if (!config->ipv6 && (config->tx_offloads & RTE_ETH_TX_OFFLOAD_OUTER_IPV4_CKSUM))
+		v->ol_flags = tunnel | RTE_MBUF_F_TX_OUTER_IPV4 | RTE_MBUF_F_TX_OUTER_IP_CKSUM;
+	else if (config->ipv6 && (config->tx_offloads & RTE_ETH_TX_OFFLOAD_OUTER_UDP_CKSUM))
+		v->ol_flags = tunnel | RTE_MBUF_F_TX_OUTER_IPV6 | RTE_MBUF_F_TX_OUTER_UDP_CKSUM;
+}
+
+int
+vtep_set(uint16_t vtep_id, struct vtep_config *config)
+{
+	struct vtep_main *vm = vtep_main;
+	struct vtep_key key;
+	struct vtep *v;
+	int rc;
+
+	if (!vm)
+		return -ENOENT;
+
+	if (vtep_id >= vm->nb_vteps || config->type >= VTEP_TYPE_MAX ||
+	    config->vni > VTEP_VNI_MAX)
+		return -EINVAL;
+
+	v = &vm->vteps[vtep_id];
+	if (v->valid)
+		return -EEXIST;
+
+	memset(&key, 0, sizeof(key));
+	key.vni = config->vni;
+	key.type = config->type;
+	if (rte_hash_lookup(vm->decap, &key) >= 0)
+		return -EEXIST;
+
+	rc = rte_hash_add_key_data(vm->decap, &key, (void *)(uintptr_t)vtep_id);
+	if (rc < 0)
+		return rc;
+
+	memcpy(&v->config, config, sizeof(*config));
+	vtep_build(v, config);
+	v->valid = 1;
+	return 0;
+}
+
+/* Outer header length up to the inner Ethernet header, 0 if the frame
+ * is not something this node can terminate.
+ */
+static __rte_always_inline uint16_t
+vtep_decap_parse(struct rte_mbuf *mbuf, struct vtep_key *key)
+{
+	uint8_t *pkt = rte_pktmbuf_mtod(mbuf, uint8_t *);
+	uint16_t len = rte_pktmbuf_data_len(mbuf);
+	uint16_t off = RTE_ETHER_HDR_LEN;
+	struct rte_ipv4_hdr *ip4;
+	struct rte_udp_hdr *udp;
+	uint8_t *tun;
+
+	memset(key, 0, sizeof(*key));
+	key->type = VTEP_TYPE_MAX;
+
+	/* Inline clones see everything the underlay receives */
+	if (!vtep_mbuf_is_tunnel(mbuf))
+		return 0;
+
+	ip4 = (struct rte_ipv4_hdr *)(pkt + off);
+	if ((ip4->version_ihl >> 4) == 4)
+		off += rte_ipv4_hdr_len(ip4);
+	else
+		off += sizeof(struct rte_ipv6_hdr);
+
+	udp = (struct rte_udp_hdr *)(pkt + off);
+	off += sizeof(*udp);
+	if (unlikely(len < off + VTEP_VXLAN_HDR_LEN))
+		return 0;
+
+	tun = pkt + off;
+	if (udp->dst_port == RTE_BE16(VTEP_VXLAN_PORT)) {
+		if (unlikely(!(tun[0] & VTEP_VXLAN_FLAG_VNI)))
+			return 0;
+		key->type = VTEP_TYPE_VXLAN;
+		off += VTEP_VXLAN_HDR_LEN;
+	} else if (udp->dst_port == RTE_BE16(VTEP_GENEVE_PORT)) {
+		/* Version 0 carrying Ethernet, critical options are not
+		 * understood so those frames must not be decapsulated.
+		 */
+		if (unlikely((tun[0] >> 6) != 0 || (tun[1] & 0x40) ||
+			     *(rte_be16_t *)&tun[2] != RTE_BE16(VTEP_GENEVE_PROTO)))
+			return 0;
+		key->type = VTEP_TYPE_GENEVE;
+		off += VTEP_GENEVE_HDR_LEN + (tun[0] & 0x3F) * 4;
+	} else {
+		return 0;
+	}
+
+	if (unlikely(len < off + RTE_ETHER_HDR_LEN))
+		return 0;
+
+	key->vni = (tun[4] << 16) | (tun[5] << 8) | tun[6];
+	return off;
+}
+
+static __rte_always_inline bool
+vtep_decap_match(struct vtep *v, struct rte_mbuf *mbuf)
+{
+	struct rte_ipv4_hdr *ip4;
+	struct rte_ipv6_hdr *ip6;
+
+	ip4 = rte_pktmbuf_mtod_offset(mbuf, struct rte_ipv4_hdr *, RTE_ETHER_HDR_LEN);
+	if (!v->ipv6)
+		return (ip4->version_ihl >> 4) == 4 &&
+		       ip4->dst_addr == v->config.local.ip4 &&
+		       ip4->src_addr == v->config.remote.ip4;
+
+	ip6 = (struct rte_ipv6_hdr *)ip4;
+	return (ip4->version_ihl >> 4) == 6 &&
+	       memcmp(&ip6->dst_addr, v->config.local.ip6, sizeof(v->config.local.ip6)) == 0 &&
+	       memcmp(&ip6->src_addr, v->config.remote.ip6, sizeof(v->config.remote.ip6)) == 0;
+}
+
+/* With a NIC recognised tunnel the plain Rx flags describe the inner
+ * headers and the OUTER_ flags the outer ones, otherwise the plain flags
+ * are about the outer headers. Unknown outer IPv4 status is checked in
+ * software, a non-zero outer UDP checksum is not verified (RFC 7348).
+ */
+static __rte_always_inline bool
+vtep_decap_cksum_bad(struct rte_mbuf *mbuf, bool tunnel)
+{
+	uint64_t ol_flags = mbuf->ol_flags;
+	struct rte_ipv4_hdr *ip4;
+
+	if (tunnel)
+		return (ol_flags & RTE_MBUF_F_RX_OUTER_IP_CKSUM_BAD) ||
+		       (ol_flags & RTE_MBUF_F_RX_OUTER_L4_CKSUM_MASK) ==
+				RTE_MBUF_F_RX_OUTER_L4_CKSUM_BAD;
+
+	if ((ol_flags & RTE_MBUF_F_RX_IP_CKSUM_MASK) == RTE_MBUF_F_RX_IP_CKSUM_BAD ||
+	    (ol_flags & RTE_MBUF_F_RX_L4_CKSUM_MASK) == RTE_MBUF_F_RX_L4_CKSUM_BAD)
+		return true;
+
+	ip4 = rte_pktmbuf_mtod_offset(mbuf, struct rte_ipv4_hdr *, RTE_ETHER_HDR_LEN);
+	if ((ol_flags & RTE_MBUF_F_RX_IP_CKSUM_MASK) == RTE_MBUF_F_RX_IP_CKSUM_UNKNOWN &&
+	    (ip4->version_ihl >> 4) == 4)
+		return rte_raw_cksum(ip4, rte_ipv4_hdr_len(ip4)) != 0xFFFF;
+
+	return false;
+}
+
+static __rte_always_inline uint32_t
+vtep_ptype_inner(uint32_t ptype)
+{
+	return vtep_ptype_inner_l2[VTEP_PTYPE_INNER_L2(ptype)] |
+	       vtep_ptype_inner_l3[VTEP_PTYPE_INNER_L3(ptype)] |
+	       vtep_ptype_inner_l4[VTEP_PTYPE_INNER_L4(ptype)];
+}
+
+static __rte_always_inline rte_edge_t
+vtep_decap_one(struct vtep_main *vm, struct vtep_decap_node_ctx *ctx,
+	       struct rte_mbuf *mbuf, void *data, uint16_t off)
+{
+	uint32_t ptype = mbuf->packet_type;
+	bool tunnel = (ptype & RTE_PTYPE_TUNNEL_MASK) != 0;
+	struct vtep *v;
+
+	/* Not terminated here, route the outer packet as is */
+	if (off == 0 || data == NULL)
+		goto outer;
+
+	v = &vm->vteps[(uintptr_t)data];
+	if (unlikely(!vtep_decap_match(v, mbuf)))
+		goto outer;
+
+	if (unlikely(vtep_decap_cksum_bad(mbuf, tunnel)))
+		return CLASSIFIER_NEXT_PKT_DROP;
+
+	rte_pktmbuf_adj(mbuf, off);
+	mbuf->ol_flags &= ~(RTE_MBUF_F_RX_VLAN | RTE_MBUF_F_RX_VLAN_STRIPPED |
+			    RTE_MBUF_F_RX_OUTER_IP_CKSUM_BAD |
+			    RTE_MBUF_F_RX_OUTER_L4_CKSUM_MASK);
+
+	/* Reuse the NIC inner ptype when there is one, parse otherwise */
+	if (tunnel && (ptype & VTEP_PTYPE_INNER_MASK)) {
+		mbuf->packet_type = vtep_ptype_inner(ptype);
+	} else {
+		mbuf->ol_flags &= ~(RTE_MBUF_F_RX_IP_CKSUM_MASK | RTE_MBUF_F_RX_L4_CKSUM_MASK);
+		mbuf->packet_type = rte_net_get_ptype(mbuf, NULL,
+						      RTE_PTYPE_L2_MASK | RTE_PTYPE_L3_MASK);
+	}
+
+	return classifier_next[mbuf->packet_type & (RTE_PTYPE_L2_MASK | RTE_PTYPE_L3_MASK)];
+
+outer:
+	if (ctx->inline_outer)
+		return ctx->outer_next;
+	return classifier_next[ptype & (RTE_PTYPE_L2_MASK | RTE_PTYPE_L3_MASK)];
+}
+
+static __rte_always_inline void
+vtep_decap_enqueue(struct rte_graph *graph, struct rte_node *node,
+		   rte_edge_t next, rte_edge_t next_index,
+		   void **to_next, uint16_t *held, void *obj)
+{
+	if (likely(next == next_index))
+		to_next[(*held)++] = obj;
+	else
+		rte_node_enqueue_x1(graph, node, next, obj);
+}
+
+static uint16_t
+vtep_decap_node_process(struct rte_graph *graph,
+			struct rte_node *node,
+			void **objs,
+			uint16_t nb_objs)
+{
+	struct vtep_decap_node_ctx *ctx = (struct vtep_decap_node_ctx *)node->ctx;
+	const void *key_ptrs[RTE_HASH_LOOKUP_BULK_MAX];
+	struct vtep_key keys[RTE_HASH_LOOKUP_BULK_MAX];
+	struct rte_mbuf **pkts = (struct rte_mbuf **)objs;
+	uint16_t off[RTE_HASH_LOOKUP_BULK_MAX];
+	void *data[RTE_HASH_LOOKUP_BULK_MAX];
+	struct vtep_main *vm = vtep_main;
+	rte_edge_t next, next_index;
+	uint16_t i, j, n, held = 0;
+	uint64_t hits;
+	void **to_next;
+
+	for (i = 0; i < RTE_HASH_LOOKUP_BULK_MAX; i++)
+		key_ptrs[i] = &keys[i];
+
+	next_index = ctx->last_next;
+	to_next = rte_node_next_stream_get(graph, node, next_index, nb_objs);
+
+	for (i = 0; i < nb_objs; i += n) {
+		n = RTE_MIN(nb_objs - i, RTE_HASH_LOOKUP_BULK_MAX);
+
+		/* Parse the whole chunk first so the VNI lookup is one bulk
+		 * operation.
+		 */
+		for (j = 0; j < n; j++)
+			off[j] = vtep_decap_parse(pkts[i + j], &keys[j]);
+
+		hits = 0;
+		if (likely(vm != NULL))
+			rte_hash_lookup_bulk_data(vm->decap, key_ptrs, n, &hits, data);
+
+		for (j = 0; j < n; j++) {
+			next = vtep_decap_one(vm, ctx, pkts[i + j],
+					      ((hits >> j) & 1) ? data[j] : NULL,
+					      off[j]);
+			vtep_decap_enqueue(graph, node, next, next_index,
+					   to_next, &held, pkts[i + j]);
+			ctx->last_next = next;
+		}
+	}
+
+	rte_node_next_stream_put(graph, node, next_index, held);
+	return nb_objs;
+}
+
+static struct vtep_decap_node_item*
+vtep_decap_node_data_get(rte_node_t node_id)
+{
+	struct vtep_decap_node_item *item = decap_node_list.head;
+
+	for (; item; item = item->next) {
+		if (item->node_id == node_id)
+			return item;
+	}
+
+	return NULL;
+}
+
+int
+vtep_decap_node_data_add(rte_node_t node_id, char const *next_node)
+{
+	struct vtep_decap_node_item *item;
+
+	if (next_node == NULL)
+		return -EINVAL;
+
+	item = vtep_decap_node_data_get(node_id);
+	if (item)
+		return -EEXIST;
+
+	item = rte_zmalloc(NULL, sizeof(struct vtep_decap_node_item), 0);
+	if (!item)
+		return -ENOMEM;
+
+	rte_node_edge_update(node_id, RTE_EDGE_ID_INVALID, &next_node, 1);
+	item->ctx.outer_next = rte_node_edge_count(node_id) - 1;
+	item->ctx.last_next = item->ctx.outer_next;
+	item->ctx.inline_outer = 1;
+	item->node_id = node_id;
+	item->prev = NULL;
+	item->next = decap_node_list.head;
+	if (decap_node_list.head)
+		decap_node_list.head->prev = item;
+	decap_node_list.head = item;
+
+	return 0;
+}
+
+/* Reached from vs_classifier when there is no item */
+static int
+vtep_decap_node_init(__rte_unused const struct rte_graph *graph, struct rte_node *node)
+{
+	struct vtep_decap_node_ctx *ctx = (struct vtep_decap_node_ctx *)node->ctx;
+	struct vtep_decap_node_item *item = vtep_decap_node_data_get(node->id);
+
+	RTE_VERIFY(sizeof(*ctx) <= sizeof(node->ctx));
+
+	if (item) {
+		memcpy(ctx, &item->ctx, sizeof(*ctx));
+		return 0;
+	}
+
+	ctx->last_next = CLASSIFIER_NEXT_IP4_LOOKUP;
+	ctx->inline_outer = 0;
+
+	return 0;
+}
+
+static void
+vtep_decap_node_fini(__rte_unused const struct rte_graph *graph, struct rte_node *node)
+{
+	struct vtep_decap_node_item *item = vtep_decap_node_data_get(node->id);
+
+	if (!item)
+		return;
+
+	if (item->next)
+		item->next->prev = item->prev;
+	if (item->prev)
+		item->prev->next = item->next;
+	if (item == decap_node_list.head)
+		decap_node_list.head = item->next;
+
+	rte_free(item);
+}
+
+/* Edges mirror the classifier so inner ptypes use the same table */
+static struct rte_node_register vtep_decap_node = {
+	.process = vtep_decap_node_process,
+	.name = "vs_tunnel_decap",
+
+	.init = vtep_decap_node_init,
+	.fini = vtep_decap_node_fini,
+
+	.nb_edges = VTEP_DECAP_NEXT_MAX,
+	.next_nodes = {
+		[CLASSIFIER_NEXT_EXCEPTION] = "vs_exception_tx",
+		[CLASSIFIER_NEXT_IP4_LOOKUP] = "ip4_lookup",
+		[CLASSIFIER_NEXT_IP6_LOOKUP] = "ip6_lookup",
+		[CLASSIFIER_NEXT_PKT_DROP] = "pkt_drop",
+	},
+};
+
+rte_node_t
+vtep_decap_node_clone(char const *name)
+{
+	return rte_node_clone(vtep_decap_node.id, name);
+}
+
+RTE_NODE_REGISTER(vtep_decap_node);
+
+static __rte_always_inline uint16_t
+vtep_ip4_cksum(uint16_t sum, rte_be16_t total_length, rte_be16_t packet_id)
+{
+	uint32_t cksum = (uint32_t)sum + total_length + packet_id;
+
+	cksum = (cksum & 0xFFFF) + (cksum >> 16);
+	cksum = (cksum & 0xFFFF) + (cksum >> 16);
+	return (uint16_t)~cksum;
+}
+
+/* Copy the template in front of the frame and patch lengths, IPv4 id,
+ * source port and whatever checksum the underlay cannot compute.
+ */
+static __rte_always_inline int
+vtep_encap_one(struct vtep *v, struct rte_mbuf *mbuf, uint16_t packet_id)
+{
+	struct rte_ipv4_hdr *ip4;
+	struct rte_ipv6_hdr *ip6;
+	struct rte_udp_hdr *udp;
+	uint32_t len;
+	uint8_t *hdr;
+
+	flow_hash_set(mbuf, FLOW_HASH_L3L4);
+
+	len = rte_pktmbuf_pkt_len(mbuf) + v->hdr_len - RTE_ETHER_HDR_LEN - v->l3_len;
+	hdr = (uint8_t *)rte_pktmbuf_prepend(mbuf, v->hdr_len);
+	if (unlikely(hdr == NULL || len > UINT16_MAX))
+		return -ENOSPC;
+
+	rte_memcpy(hdr, v->hdr, v->hdr_len);
+
+	udp = (struct rte_udp_hdr *)(hdr + RTE_ETHER_HDR_LEN + v->l3_len);
+	udp->src_port = rte_cpu_to_be_16(VTEP_SPORT_BASE | (mbuf->hash.rss & VTEP_SPORT_MASK));
+	udp->dgram_len = rte_cpu_to_be_16(len);
+
+	if (!v->ipv6) {
+		ip4 = (struct rte_ipv4_hdr *)(hdr + RTE_ETHER_HDR_LEN);
+		ip4->total_length = rte_cpu_to_be_16(len + v->l3_len);
+		ip4->packet_id = rte_cpu_to_be_16(packet_id);
+		if (!(v->ol_flags & RTE_MBUF_F_TX_OUTER_IP_CKSUM))
+			ip4->hdr_checksum = vtep_ip4_cksum(v->ip4_sum, ip4->total_length,
+							   ip4->packet_id);
+	} else {
+		ip6 = (struct rte_ipv6_hdr *)(hdr + RTE_ETHER_HDR_LEN);
+		ip6->payload_len = rte_cpu_to_be_16(len);
+		if (v->ol_flags & RTE_MBUF_F_TX_OUTER_UDP_CKSUM)
+			udp->dgram_cksum = rte_ipv6_phdr_cksum(ip6, 0);
+		else
+			udp->dgram_cksum = rte_ipv6_udptcp_cksum_mbuf(mbuf, ip6,
+								      RTE_ETHER_HDR_LEN + v->l3_len);
+	}
+
+	if (v->ol_flags) {
+		mbuf->ol_flags |= v->ol_flags;
+		mbuf->outer_l2_len = RTE_ETHER_HDR_LEN;
+		mbuf->outer_l3_len = v->l3_len;
+		mbuf->l2_len = v->hdr_len - v->l3_len;
+	}
+
+	return 0;
+}
+
+static uint16_t
+vtep_encap_node_process(struct rte_graph *graph,
+			struct rte_node *node,
+			void **objs,
+			uint16_t nb_objs)
+{
+	struct vtep_encap_node_ctx *ctx = (struct vtep_encap_node_ctx *)node->ctx;
+	struct rte_mbuf **pkts = (struct rte_mbuf **)objs;
+	struct vtep *v = ctx->vtep;
+	uint16_t packet_id = ctx->packet_id;
+	uint16_t held = 0;
+	void **to_next;
+	uint16_t i;
+
+	/* Frames that do not fit the headroom are dropped */
+	to_next = rte_node_next_stream_get(graph, node, ctx->next_node, nb_objs);
+	for (i = 0; i < nb_objs; i++) {
+		if (likely(i + 4 < nb_objs))
+			rte_prefetch0(rte_pktmbuf_mtod(pkts[i + 4], void *));
+
+		if (likely(vtep_encap_one(v, pkts[i], packet_id++) == 0))
+			to_next[held++] = pkts[i];
+		else
+			rte_node_enqueue_x1(graph, node, VTEP_ENCAP_NEXT_PKT_DROP, pkts[i]);
+	}
+
+	rte_node_next_stream_put(graph, node, ctx->next_node, held);
+	ctx->packet_id = packet_id;
+	return nb_objs;
+}
+
+static struct vtep_encap_node_item*
+vtep_encap_node_data_get(rte_node_t node_id)
+{
+	struct vtep_encap_node_item *item = encap_node_list.head;
+
+	for (; item; item = item->next) {
+		if (item->node_id == node_id)
+			return item;
+	}
+
+	return NULL;
+}
+
+int
+vtep_encap_node_data_add(rte_node_t node_id, uint16_t vtep_id, char const *next_node)
+{
+	struct vtep_encap_node_item *item;
+
+	if (!vtep_main)
+		return -ENOENT;
+
+	if (next_node == NULL || vtep_id >= vtep_main->nb_vteps ||
+	    !vtep_main->vteps[vtep_id].valid)
+		return -EINVAL;
+
+	item = vtep_encap_node_data_get(node_id);
+	if (item)
+		return -EEXIST;
+
+	item = rte_zmalloc(NULL, sizeof(struct vtep_encap_node_item), 0);
+	if (!item)
+		return -ENOMEM;
+
+	rte_node_edge_update(node_id, RTE_EDGE_ID_INVALID, &next_node, 1);
+	item->ctx.next_node = rte_node_edge_count(node_id) - 1;
+	item->ctx.vtep = &vtep_main->vteps[vtep_id];
+	item->node_id = node_id;
+	item->prev = NULL;
+	item->next = encap_node_list.head;
+	if (encap_node_list.head)
+		encap_node_list.head->prev = item;
+	encap_node_list.head = item;
+
+	return 0;
+}
+
+static int
+vtep_encap_node_init(__rte_unused const struct rte_graph *graph, struct rte_node *node)
+{
+	struct vtep_encap_node_ctx *ctx = (struct vtep_encap_node_ctx *)node->ctx;
+	struct vtep_encap_node_item *item = vtep_encap_node_data_get(node->id);
+
+	RTE_VERIFY(sizeof(*ctx) <= sizeof(node->ctx));
+	RTE_VERIFY(item != NULL);
+
+	memcpy(ctx, &item->ctx, sizeof(*ctx));
+	/* Workers share the endpoint addresses, start them apart */
+	ctx->packet_id = (uint16_t)rte_rand();
+
+	return 0;
+}
+
+static void
+vtep_encap_node_fini(__rte_unused const struct rte_graph *graph, struct rte_node *node)
+{
+	struct vtep_encap_node_item *item = vtep_encap_node_data_get(node->id);
+
+	if (!item)
+		return;
+
+	if (item->next)
+		item->next->prev = item->prev;
+	if (item->prev)
+		item->prev->next = item->next;
+	if (item == encap_node_list.head)
+		encap_node_list.head = item->next;
+
+	rte_free(item);
+}
+
+static struct rte_node_register vtep_encap_node = {
+	.process = vtep_encap_node_process,
+	.name = "vs_tunnel_encap",
+
+	.init = vtep_encap_node_init,
+	.fini = vtep_encap_node_fini,
+
+	.nb_edges = VTEP_ENCAP_NEXT_MAX,
+	.next_nodes = {
+		[VTEP_ENCAP_NEXT_PKT_DROP] = "pkt_drop",
+	},
+};
+
+rte_node_t
+vtep_encap_node_clone(char const *name)
+{
+	return rte_node_clone(vtep_encap_node.id, name);
+}
+
+RTE_NODE_REGISTER(vtep_encap_node);
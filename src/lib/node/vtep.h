@@ -0,0 +1,109 @@
+/*
+  SPDX-License-Identifier: MIT
+  Copyright(c) 2023 Sriram Yagnaraman.
+*/
+
+#ifndef __SRC_LIB_NODE_VTEP_H__
+#define __SRC_LIB_NODE_VTEP_H__
+
+#include <rte_byteorder.h>
+#include <rte_ether.h>
+#include <rte_graph.h>
+#include <rte_ip.h>
+#include <rte_mbuf.h>
+#include <rte_udp.h>
+
+#define VTEP_ID_INVALID		(0xFFFF)
+#define VTEP_MAX		(64)
+#define VTEP_VNI_MAX		(0xFFFFFF)
+#define VTEP_VXLAN_PORT		(4789)
+#define VTEP_GENEVE_PORT	(6081)
+
+enum vtep_type {
+	VTEP_TYPE_VXLAN = 0,
+	VTEP_TYPE_GENEVE,
+	VTEP_TYPE_MAX,
+};
+
+union vtep_addr {
+	rte_be32_t ip4;
+	uint8_t ip6[16];
+};
+
+struct vtep_config {
+	uint8_t type;
+	uint8_t ipv6;
+	uint32_t vni;
+	union vtep_addr local;
+	union vtep_addr remote;
+	struct rte_ether_addr src_mac;
+	struct rte_ether_addr dst_mac;
+	/* Tx offloads granted on the underlay link */
+	uint64_t tx_offloads;
+};
+
+/* Set once the endpoint table exists, the classifier only looks at UDP
+ * ports when it is.
+ */
+extern bool vtep_decap_enabled;
+
+static __rte_always_inline bool
+vtep_udp_port(rte_be16_t port)
+{
+	return port == RTE_BE16(VTEP_VXLAN_PORT) ||
+	       port == RTE_BE16(VTEP_GENEVE_PORT);
+}
+
+/* Outer UDP destination port of an untagged Ethernet/IP/UDP frame, 0 if
+ * the IP header does not carry UDP.
+ */
+static __rte_always_inline rte_be16_t
+vtep_mbuf_udp_port(struct rte_mbuf *mbuf)
+{
+	struct rte_ipv4_hdr *ip4;
+	struct rte_ipv6_hdr *ip6;
+	struct rte_udp_hdr *udp;
+
+	ip4 = rte_pktmbuf_mtod_offset(mbuf, struct rte_ipv4_hdr *, RTE_ETHER_HDR_LEN);
+	if ((ip4->version_ihl >> 4) == 4) {
+		if (ip4->next_proto_id != IPPROTO_UDP)
+			return 0;
+		udp = (struct rte_udp_hdr *)((uint8_t *)ip4 + rte_ipv4_hdr_len(ip4));
+	} else {
+		ip6 = (struct rte_ipv6_hdr *)ip4;
+		if (ip6->proto != IPPROTO_UDP)
+			return 0;
+		udp = (struct rte_udp_hdr *)(ip6 + 1);
+	}
+
+	return udp->dst_port;
+}
+
+/* NIC typed tunnel, or untagged UDP to one of the overlay ports */
+static __rte_always_inline bool
+vtep_mbuf_is_tunnel(struct rte_mbuf *mbuf)
+{
+	uint32_t ptype = mbuf->packet_type;
+
+	if ((ptype & RTE_PTYPE_TUNNEL_MASK) == RTE_PTYPE_TUNNEL_VXLAN ||
+	    (ptype & RTE_PTYPE_TUNNEL_MASK) == RTE_PTYPE_TUNNEL_GENEVE)
+		return true;
+
+	if ((ptype & (RTE_PTYPE_L2_MASK | RTE_PTYPE_L4_MASK)) !=
+	    (RTE_PTYPE_L2_ETHER | RTE_PTYPE_L4_UDP))
+		return false;
+
+	return vtep_udp_port(vtep_mbuf_udp_port(mbuf));
+}
+
+int vtep_init(uint16_t nb_vteps, int socket_id);
+void vtep_fini(void);
+int vtep_set(uint16_t vtep_id, struct vtep_config *config);
+
+rte_node_t vtep_decap_node_clone(char const *name);
+int vtep_decap_node_data_add(rte_node_t node_id, char const *next_node);
+
+rte_node_t vtep_encap_node_clone(char const *name);
+int vtep_encap_node_data_add(rte_node_t node_id, uint16_t vtep_id, char const *next_node);
+
+#endif /* __SRC_LIB_NODE_VTEP_H__ */
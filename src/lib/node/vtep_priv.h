@@ -0,0 +1,105 @@
+/*
+  SPDX-License-Identifier: MIT
+  Copyright(c) 2023 Sriram Yagnaraman.
+*/
+
+#ifndef __SRC_LIB_NODE_VTEP_PRIV_H__
+#define __SRC_LIB_NODE_VTEP_PRIV_H__
+
+#include <rte_common.h>
+#include <rte_graph.h>
+#include <rte_hash.h>
+#include <rte_ip.h>
+#include <rte_udp.h>
+
+#include "classifier_priv.h"
+#include "vtep.h"
+
+#define VTEP_VXLAN_HDR_LEN	(8)
+#define VTEP_GENEVE_HDR_LEN	(8)
+#define VTEP_VXLAN_FLAG_VNI	(0x08)
+#define VTEP_GENEVE_PROTO	(RTE_ETHER_TYPE_TEB)
+
+/* Outer Ethernet, IPv6, UDP and an option-less GENEVE header */
+#define VTEP_HDR_MAX		(RTE_ETHER_HDR_LEN + sizeof(struct rte_ipv6_hdr) + \
+				 sizeof(struct rte_udp_hdr) + VTEP_GENEVE_HDR_LEN)
+
+/* UDP source port entropy, RFC 7348 recommends the dynamic range */
+#define VTEP_SPORT_BASE		(49152)
+#define VTEP_SPORT_MASK		(0x3FFF)
+
+/* Decap shares the classifier edges up to the tunnel edge itself */
+#define VTEP_DECAP_NEXT_MAX	CLASSIFIER_NEXT_TUNNEL_DECAP
+
+struct vtep_key {
+	uint32_t vni;
+	uint8_t type;
+	uint8_t pad[3];
+};
+
+/* Prebuilt outer headers, encap copies hdr and patches the lengths */
+struct vtep {
+	uint8_t hdr[VTEP_HDR_MAX] __rte_cache_aligned;
+	uint16_t hdr_len;
+	uint16_t l3_len;
+	uint16_t ip4_sum;
+	uint8_t ipv6;
+	uint8_t valid;
+	uint64_t ol_flags;
+	struct vtep_config config;
+};
+
+struct vtep_main {
+	struct rte_hash *decap;
+	uint16_t nb_vteps;
+	struct vtep vteps[VTEP_MAX];
+};
+
+/* Clones sit in the ingress chain of underlay links, frames that are not
+ * terminated leave on outer_next instead of the classifier edges.
+ */
+struct vtep_decap_node_ctx {
+	rte_edge_t last_next;
+	rte_edge_t outer_next;
+	uint8_t inline_outer;
+};
+
+struct vtep_decap_node_item {
+	struct vtep_decap_node_item *next;
+	struct vtep_decap_node_item *prev;
+	struct vtep_decap_node_ctx ctx;
+
+	rte_node_t node_id;
+};
+
+struct vtep_decap_node_list {
+	struct vtep_decap_node_item *head;
+};
+
+/* One clone per endpoint and worker, in front of the underlay tx node.
+ * Outer IPv4 may be fragmented, every packet takes the next id.
+ */
+struct vtep_encap_node_ctx {
+	struct vtep *vtep;
+	rte_edge_t next_node;
+	uint16_t packet_id;
+};
+
+struct vtep_encap_node_item {
+	struct vtep_encap_node_item *next;
+	struct vtep_encap_node_item *prev;
+	struct vtep_encap_node_ctx ctx;
+
+	rte_node_t node_id;
+};
+
+struct vtep_encap_node_list {
+	struct vtep_encap_node_item *head;
+};
+
+enum vtep_encap_next_nodes {
+	VTEP_ENCAP_NEXT_PKT_DROP = 0,
+	VTEP_ENCAP_NEXT_MAX,
+};
+
+#endif /* __SRC_LIB_NODE_VTEP_PRIV_H__ */
@@ -8,13 +8,24 @@
 #include <sys/queue.h>
 
 #include <rte_common.h>
+#include <rte_dev.h>
 #include <rte_malloc.h>
 
 #include "link.h"
 #include "mempool.h"
 
+#define LINK_VDEV_ARGS_LEN	(256)
+#define LINK_VDEV_MP_CACHE	(256)
+
 static struct link_head link_node = TAILQ_HEAD_INITIALIZER(link_node);
 
+static char const * const link_type_names[] = {
+	[LINK_TYPE_ETHDEV] = "ethdev",
+	[LINK_TYPE_VHOST] = "vhost",
+	[LINK_TYPE_MEMIF] = "memif",
+	[LINK_TYPE_AFXDP] = "afxdp",
+};
+
 static struct rte_eth_conf link_conf_default = {
 	.link_speeds = 0,
 	.rxmode = {
@@ -34,12 +45,214 @@ static struct rte_eth_conf link_conf_default = {
 	.lpbk_mode = 0,
 };
 
+/* Repeating 0x6d5a makes Toeplitz symmetric, both directions of a flow
+ * land on the same queue.
+ */
+static uint8_t link_rss_key_symmetric[ETHDEV_RSS_KEY_LEN_MAX] = {
+	0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a,
+	0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a,
+	0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a,
+	0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a,
+	0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a,
+	0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a,
+	0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a,
+	0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a,
+};
+
 struct rte_eth_conf *
 link_config_default_get()
 {
         return &link_conf_default;
 }
 
+/* Only plain 802.1Q trunks can use the PMD, access ports keep customer
+ * tags in the frame and 802.1ad tags are pushed and popped in software.
+ */
+static int
+link_vlan_offload_get(struct link *l, struct rte_eth_conf *link_conf)
+{
+	struct vlan_link_config *vlan = &l->config.vlan;
+	struct rte_eth_dev_info info;
+	int rc;
+
+	vlan->hw_strip = 0;
+	vlan->hw_insert = 0;
+	if (vlan->mode != VLAN_MODE_TRUNK)
+		return 0;
+
+	rc = rte_eth_dev_info_get(l->config.link_id, &info);
+	if (rc < 0)
+		return rc;
+
+	if (info.rx_offload_capa & RTE_ETH_RX_OFFLOAD_VLAN_STRIP) {
+		link_conf->rxmode.offloads |= RTE_ETH_RX_OFFLOAD_VLAN_STRIP;
+		vlan->hw_strip = 1;
+	}
+
+	if (info.rx_offload_capa & RTE_ETH_RX_OFFLOAD_VLAN_FILTER)
+		link_conf->rxmode.offloads |= RTE_ETH_RX_OFFLOAD_VLAN_FILTER;
+
+	if (info.tx_offload_capa & RTE_ETH_TX_OFFLOAD_VLAN_INSERT) {
+		link_conf->txmode.offloads |= RTE_ETH_TX_OFFLOAD_VLAN_INSERT;
+		vlan->hw_insert = 1;
+	}
+
+	return 0;
+}
+
+static int
+link_vlan_filter_set(struct link *l, struct rte_eth_conf *link_conf)
+{
+	struct vlan_link_config *vlan = &l->config.vlan;
+	uint16_t vid;
+	int rc;
+
+	if (!(link_conf->rxmode.offloads & RTE_ETH_RX_OFFLOAD_VLAN_FILTER))
+		return 0;
+
+	for (vid = 1; vid < VLAN_VID_MAX; vid++) {
+		if (!((vlan->allowed[vid / 64] >> (vid % 64)) & 1))
+			continue;
+
+		rc = rte_eth_dev_vlan_filter(l->config.link_id, vid, 1);
+		if (rc < 0)
+			return rc;
+	}
+
+	return 0;
+}
+
+/* The filter table outlives rte_eth_dev_configure, vids the old config
+ * allowed and the new one does not are taken out by hand.
+ */
+static void
+link_vlan_filter_clear(struct link *l, struct vlan_link_config const *old)
+{
+	struct vlan_link_config *vlan = &l->config.vlan;
+	uint16_t vid;
+
+	for (vid = 1; vid < VLAN_VID_MAX; vid++) {
+		if (!((old->allowed[vid / 64] >> (vid % 64)) & 1) ||
+		    ((vlan->allowed[vid / 64] >> (vid % 64)) & 1))
+			continue;
+
+		rte_eth_dev_vlan_filter(l->config.link_id, vid, 0);
+	}
+}
+
+static int
+link_configure(struct link *l)
+{
+	struct link_rss_config *rss = &l->config.rx.rss;
+	struct rte_eth_dev_info info;
+	struct rte_eth_conf link_conf;
+	int rc = -EINVAL;
+	uint32_t i;
+
+	memcpy(&link_conf, link_config_default_get(), sizeof(struct rte_eth_conf));
+	link_conf.rxmode.mtu = l->config.mtu;
+
+	rc = rte_eth_dev_info_get(l->config.link_id, &info);
+	if (rc < 0)
+		return rc;
+
+	/* Fragments and reassembled packets are mbuf chains */
+	link_conf.txmode.offloads |= info.tx_offload_capa & RTE_ETH_TX_OFFLOAD_MULTI_SEGS;
+
+	if (rss->n_queues) {
+		if (info.hash_key_size > ETHDEV_RSS_KEY_LEN_MAX)
+			return -ENOTSUP;
+
+		link_conf.rxmode.mq_mode = RTE_ETH_MQ_RX_RSS;
+		link_conf.rx_adv_conf.rss_conf.rss_key = link_rss_key_symmetric;
+		link_conf.rx_adv_conf.rss_conf.rss_key_len = info.hash_key_size;
+		link_conf.rx_adv_conf.rss_conf.rss_hf = rss->rss_hf;
+	}
+
+	rc = link_vlan_offload_get(l, &link_conf);
+	if (rc < 0)
+		return rc;
+
+	link_conf.txmode.offloads |= l->config.tx.offloads;
+
+	rc = rte_eth_dev_configure(
+		l->config.link_id,
+		l->config.rx.nb_queues,
+		l->config.tx.nb_queues,
+		&link_conf);
+	if (rc < 0)
+		return rc;
+
+	rc = link_vlan_filter_set(l, &link_conf);
+	if (rc < 0)
+		return rc;
+
+	/* Port RX */
+	for (i = 0; i < l->config.rx.nb_queues; i++) {
+		rc = rte_eth_rx_queue_setup(
+			l->config.link_id,
+			i,
+			l->config.rx.queue_sz,
+			l->config.numa_node,
+			NULL,
+			l->config.rx.mp);
+		if (rc < 0)
+			return rc;
+	}
+
+	/* Port TX */
+	for (i = 0; i < l->config.tx.nb_queues; i++) {
+		rc = rte_eth_tx_queue_setup(
+			l->config.link_id,
+			i,
+			l->config.tx.queue_sz,
+			l->config.numa_node,
+			NULL);
+		if (rc < 0)
+			return rc;
+	}
+
+	return 0;
+}
+
+static int
+link_rss_reta_update(struct link *l)
+{
+	struct rte_eth_rss_reta_entry64 reta_conf[RTE_ETH_RSS_RETA_SIZE_512 / RTE_ETH_RETA_GROUP_SIZE];
+	struct link_rss_config *rss = &l->config.rx.rss;
+	struct rte_eth_dev_info info;
+	uint32_t i;
+	int rc;
+
+	if (!rss->n_queues)
+		return 0;
+
+	rc = rte_eth_dev_info_get(l->config.link_id, &info);
+	if (rc < 0)
+		return rc;
+
+	if (info.reta_size == 0 || info.reta_size > RTE_ETH_RSS_RETA_SIZE_512)
+		return -ENOTSUP;
+
+	/* Spread the listed queues round robin over the whole table */
+	memset(reta_conf, 0, sizeof(reta_conf));
+	for (i = 0; i < info.reta_size; i++) {
+		reta_conf[i / RTE_ETH_RETA_GROUP_SIZE].mask |= 1ULL << (i % RTE_ETH_RETA_GROUP_SIZE);
+		reta_conf[i / RTE_ETH_RETA_GROUP_SIZE].reta[i % RTE_ETH_RETA_GROUP_SIZE] =
+			rss->queue_id[i % rss->n_queues];
+	}
+
+	return rte_eth_dev_rss_reta_update(l->config.link_id, reta_conf, info.reta_size);
+}
+
+char const *
+link_type_name(uint8_t type)
+{
+	if (type >= LINK_TYPE_MAX)
+		return "unknown";
+	return link_type_names[type];
+}
+
 struct link*
 link_config_get(char const *name)
 {
@@ -55,11 +268,10 @@ link_config_get(char const *name)
 int
 link_config_add(struct link_config *config)
 {
-	struct rte_eth_conf link_conf;
+	struct rte_eth_dev_info info;
+	struct link *l = NULL;
 	struct mempool *m;
 	int rc = -EINVAL;
-	struct link* l;
-	uint32_t i;
 
 	rc = rte_eth_dev_get_port_by_name(config->link_name, &config->link_id);
 	if (rc < 0) {
@@ -87,63 +299,245 @@ link_config_add(struct link_config *config)
 		goto err;
 	}
 
-	memcpy(&link_conf, link_config_default_get(), sizeof(struct rte_eth_conf));
 	config->peer.link_name[0] = '\0';
 	config->peer.link_id = LINK_ID_MAX;
-	config->mtu = link_conf.rxmode.mtu;
+	/* Not every port takes jumbo frames */
+	rc = rte_eth_dev_info_get(config->link_id, &info);
+	if (rc < 0)
+		goto err;
+	config->mtu = RTE_MIN(link_config_default_get()->rxmode.mtu, info.max_mtu);
 	config->rx.mp = m->mp;
+	config->rx.rss.n_queues = 0;
 
-	config->numa_node = rte_eth_dev_socket_id(config->link_id);
-	if (config->numa_node == SOCKET_ID_ANY)
-		config->numa_node = 0;
+	/* Created ports follow their pool */
+	if (config->type == LINK_TYPE_ETHDEV) {
+		config->numa_node = rte_eth_dev_socket_id(config->link_id);
+		if (config->numa_node == SOCKET_ID_ANY)
+			config->numa_node = 0;
+	}
 
 	memcpy(&l->config, config, sizeof(*config));
-	rc = rte_eth_dev_configure(
-		l->config.link_id,
-		l->config.rx.nb_queues,
-		l->config.tx.nb_queues,
-		&link_conf);
-	if (rc < 0) {
-                rc = -rte_errno;
+	l->started = 0;
+	rc = link_configure(l);
+	if (rc < 0)
 		goto err;
-	}
 
-	/* Port RX */
-	for (i = 0; i < l->config.rx.nb_queues; i++) {
-		rc = rte_eth_rx_queue_setup(
-			l->config.link_id,
-			i,
-			l->config.rx.queue_sz,
-			l->config.numa_node,
-			NULL,
-			l->config.rx.mp);
-		if (rc < 0) {
-                        rc = -rte_errno;
-			goto err;
-		}
-	}
+	TAILQ_INSERT_TAIL(&link_node, l, next);
+        return 0;
 
-	/* Port TX */
-	for (i = 0; i < l->config.tx.nb_queues; i++) {
-		rc = rte_eth_tx_queue_setup(
-			l->config.link_id,
-			i,
-			l->config.tx.queue_sz,
-			l->config.numa_node,
-			NULL);
+err:
+	if (l)
+		rte_free(l);
+        return rc;
+}
+
+static void
+link_vdev_destroy(char const *name, char const *mp_name)
+{
+	uint16_t port_id;
+
+	if (rte_eth_dev_get_port_by_name(name, &port_id) == 0)
+		rte_eth_dev_close(port_id);
+	rte_eal_hotplug_remove("vdev", name);
+	if (mp_name)
+		mempool_config_rem(mp_name);
+}
+
+/* Hotplugs the vdev named after the link, gives it a pool of its own
+ * and adds it as any other link. mp carries the pool size, the numa
+ * node defaults to the one of the port. Without mp the link keeps the
+ * pool and node already in its config.
+ */
+static int
+link_vdev_add(struct link_config *config, char const *prefix, char const *args,
+	      uint16_t nb_queues, struct mempool_config *mp)
+{
+	uint16_t port_id;
+	int rc;
+
+	/* The vdev bus finds the driver from the device name */
+	if (strncmp(config->link_name, prefix, strlen(prefix)) != 0 ||
+	    nb_queues == 0 || nb_queues > LINK_VDEV_QUEUES_MAX)
+		return -EINVAL;
+
+	if (rte_eth_dev_get_port_by_name(config->link_name, &port_id) == 0)
+		return -EEXIST;
+
+	rc = rte_eal_hotplug_add("vdev", config->link_name, args);
+	if (rc < 0)
+		return rc;
+
+	rc = rte_eth_dev_get_port_by_name(config->link_name, &port_id);
+	if (rc < 0)
+		goto err;
+
+	if (mp) {
+		snprintf(mp->name, sizeof(mp->name), "%s%u", link_type_name(config->type), port_id);
+		mp->type = MEMPOOL_TYPE_PKTMBUF;
+		mp->cache_sz = LINK_VDEV_MP_CACHE;
+		if (mp->numa_node == SOCKET_ID_ANY)
+			mp->numa_node = rte_eth_dev_socket_id(port_id);
+		if (mp->numa_node == SOCKET_ID_ANY)
+			mp->numa_node = rte_socket_id();
+
+		rc = mempool_config_add(mp);
 		if (rc < 0) {
-                        rc = -rte_errno;
+			/* Not ours to free */
+			mp->name[0] = '\0';
 			goto err;
 		}
+
+		config->numa_node = mp->numa_node;
+		rte_strscpy(config->rx.mp_name, mp->name, RTE_MEMPOOL_NAMESIZE);
 	}
 
-	TAILQ_INSERT_TAIL(&link_node, l, next);
-        return 0;
+	config->rx.nb_queues = nb_queues;
+	if (config->rx.queue_sz == 0)
+		config->rx.queue_sz = ETHDEV_RX_DESC_DEFAULT;
+	config->tx.nb_queues = nb_queues;
+	if (config->tx.queue_sz == 0)
+		config->tx.queue_sz = ETHDEV_TX_DESC_DEFAULT;
+
+	rc = link_config_add(config);
+	if (rc < 0)
+		goto err;
+
+	return 0;
 
 err:
-	if (l)
-		rte_free(l);
-        return rc;
+	link_vdev_destroy(config->link_name, mp ? mp->name : NULL);
+	return rc;
+}
+
+int
+link_config_add_vhost(struct link_config *config, struct link_vhost_config const *vhost)
+{
+	char args[LINK_VDEV_ARGS_LEN];
+	struct mempool_config mp;
+	int rc;
+
+	if (vhost->path[0] == '\0')
+		return -EINVAL;
+
+	rc = snprintf(args, sizeof(args), "iface=%s,queues=%u,client=%u",
+		      vhost->path, vhost->nb_queues, vhost->client ? 1 : 0);
+	if (rc < 0 || rc >= (int)sizeof(args))
+		return -ENAMETOOLONG;
+
+	/* One pool per guest so that a busy guest can not starve the
+	 * others. The vhost PMD allocates from it on dequeue, the mbufs
+	 * then sit on the tx rings of other links.
+	 */
+	memset(&mp, 0, sizeof(mp));
+	mp.nb_items = vhost->nb_mbufs ? vhost->nb_mbufs :
+		vhost->nb_queues * (ETHDEV_RX_DESC_DEFAULT + ETHDEV_TX_DESC_DEFAULT);
+	mp.item_sz = RTE_MBUF_DEFAULT_BUF_SIZE;
+	mp.numa_node = SOCKET_ID_ANY;
+
+	config->type = LINK_TYPE_VHOST;
+	rc = link_vdev_add(config, LINK_VHOST_PREFIX, args, vhost->nb_queues, &mp);
+	if (rc < 0)
+		return rc;
+
+	RTE_LOG(INFO, USER1, "Link %s: vhost-user %s queues %u mbufs %d\n",
+		config->link_name, vhost->path, vhost->nb_queues, mp.nb_items);
+	return 0;
+}
+
+int
+link_config_add_memif(struct link_config *config, struct link_memif_config const *memif)
+{
+	char args[LINK_VDEV_ARGS_LEN];
+	struct mempool_config mp;
+	uint32_t ring_sz;
+	int rc;
+
+	if (memif->path[0] == '\0' || memif->ring_sz == 0 ||
+	    memif->ring_sz > LINK_MEMIF_RING_SZ_MAX || memif->buf_sz < RTE_ETHER_MIN_LEN ||
+	    (memif->zero_copy && !memif->client))
+		return -EINVAL;
+
+	/* A path in the file system, so two processes only need to agree
+	 * on it and on the id.
+	 */
+	rc = snprintf(args, sizeof(args),
+		      "id=%u,role=%s,socket=%s,socket-abstract=no,rsize=%u,bsize=%u,zero-copy=%s",
+		      memif->id, memif->client ? "client" : "server", memif->path,
+		      memif->ring_sz, memif->buf_sz, memif->zero_copy ? "yes" : "no");
+	if (rc < 0 || rc >= (int)sizeof(args))
+		return -ENAMETOOLONG;
+
+	/* Zero-copy clients hand the pool itself to the peer as the shared
+	 * regions, so it lives on the requested node. Each queue pair needs
+	 * a full ring on top of what the other links hold.
+	 */
+	ring_sz = 1U << memif->ring_sz;
+	memset(&mp, 0, sizeof(mp));
+	mp.nb_items = memif->nb_queues *
+		(2 * ring_sz + ETHDEV_RX_DESC_DEFAULT + ETHDEV_TX_DESC_DEFAULT);
+	mp.item_sz = RTE_PKTMBUF_HEADROOM + memif->buf_sz;
+	mp.numa_node = memif->numa_node;
+
+	config->type = LINK_TYPE_MEMIF;
+	config->rx.queue_sz = ring_sz;
+	config->tx.queue_sz = ring_sz;
+	rc = link_vdev_add(config, LINK_MEMIF_PREFIX, args, memif->nb_queues, &mp);
+	if (rc < 0)
+		return rc;
+
+	RTE_LOG(INFO, USER1, "Link %s: memif %s %s id %u queues %u ring %u numa %d\n",
+		config->link_name, memif->client ? "client" : "server", memif->path,
+		memif->id, memif->nb_queues, ring_sz, mp.numa_node);
+	return 0;
+}
+
+int
+link_config_add_afxdp(struct link_config *config, struct link_afxdp_config const *afxdp)
+{
+	char args[LINK_VDEV_ARGS_LEN];
+	uint32_t queue_sz;
+	struct mempool *m;
+	int rc;
+
+	if (afxdp->ifname[0] == '\0' || afxdp->nb_queues == 0)
+		return -EINVAL;
+
+	m = mempool_config_get(config->rx.mp_name);
+	if (!m)
+		return -ENOENT;
+	if (m->config.type != MEMPOOL_TYPE_PKTMBUF)
+		return -EINVAL;
+
+	/* The PMD registers the pool as the UMEM, so the rings are sized to
+	 * what it holds: each queue keeps its fill and tx rings full and
+	 * leaves as much again to the graph and the other links.
+	 */
+	queue_sz = m->config.nb_items / (4 * afxdp->nb_queues);
+	queue_sz = RTE_MIN(rte_align32prevpow2(queue_sz), ETHDEV_RX_DESC_DEFAULT);
+	if (queue_sz < LINK_AFXDP_QUEUE_SZ_MIN)
+		return -ENOSPC;
+
+	/* Preferred busy polling, the PMD turns on need_wakeup by itself */
+	rc = snprintf(args, sizeof(args), "iface=%s,start_queue=%u,queue_count=%u,busy_budget=%u",
+		      afxdp->ifname, afxdp->start_queue, afxdp->nb_queues,
+		      LINK_AFXDP_BUSY_BUDGET);
+	if (rc < 0 || rc >= (int)sizeof(args))
+		return -ENAMETOOLONG;
+
+	config->type = LINK_TYPE_AFXDP;
+	config->numa_node = m->config.numa_node;
+	if (config->numa_node == SOCKET_ID_ANY)
+		config->numa_node = 0;
+	config->rx.queue_sz = queue_sz;
+	config->tx.queue_sz = queue_sz;
+	rc = link_vdev_add(config, LINK_AFXDP_PREFIX, args, afxdp->nb_queues, NULL);
+	if (rc < 0)
+		return rc;
+
+	RTE_LOG(INFO, USER1, "Link %s: af_xdp %s queues %u-%u ring %u mempool %s\n",
+		config->link_name, afxdp->ifname, afxdp->start_queue,
+		afxdp->start_queue + afxdp->nb_queues - 1, queue_sz, config->rx.mp_name);
+	return 0;
 }
 
 int
@@ -151,7 +545,13 @@ link_config_rem(char const *name)
 {
         struct link *l = link_config_get(name);
         if (l) {
+		if (l->config.type != LINK_TYPE_ETHDEV && l->started)
+			return -EBUSY;
+
                 TAILQ_REMOVE(&link_node, l, next);
+		if (l->config.type != LINK_TYPE_ETHDEV)
+			link_vdev_destroy(l->config.link_name,
+					  l->config.type == LINK_TYPE_AFXDP ? NULL : l->config.rx.mp_name);
 		rte_free(l);
                 return 0;
         }
@@ -225,13 +625,231 @@ link_config_set_peer(char const *name, char const *peer_name)
 	return rc;
 }
 
+int
+link_config_set_rss(char const *name, struct link_rss_config *rss)
+{
+	struct link *l = link_config_get(name);
+	struct link_rss_config old;
+	struct rte_eth_dev_info info;
+	int rc = -ENOENT;
+	uint32_t i;
+
+        if (l) {
+		if (rss->n_queues == 0 || rss->n_queues > ETHDEV_RXQ_RSS_MAX)
+			return -EINVAL;
+
+		for (i = 0; i < rss->n_queues; i++) {
+			if (rss->queue_id[i] >= l->config.rx.nb_queues)
+				return -EINVAL;
+		}
+
+		rc = rte_eth_dev_info_get(l->config.link_id, &info);
+		if (rc < 0)
+			return rc;
+
+		/* Only ask for the hash types this PMD can do */
+		rss->rss_hf = (RTE_ETH_RSS_IP | RTE_ETH_RSS_TCP | RTE_ETH_RSS_UDP) &
+				info.flow_type_rss_offloads;
+		if (rss->rss_hf == 0)
+			return -ENOTSUP;
+
+		memcpy(&old, &l->config.rx.rss, sizeof(old));
+		memcpy(&l->config.rx.rss, rss, sizeof(*rss));
+		rc = link_configure(l);
+		if (rc < 0) {
+			memcpy(&l->config.rx.rss, &old, sizeof(old));
+			link_configure(l);
+		}
+	}
+
+	return rc;
+}
+
+int
+link_config_set_vlan(char const *name, struct vlan_link_config *vlan)
+{
+	struct link *l = link_config_get(name);
+	struct vlan_link_config old;
+	int rc = -ENOENT;
+
+	if (l) {
+		/* Reconfiguring a started port would need a stop first */
+		if (l->started)
+			return -EBUSY;
+
+		if (vlan->mode >= VLAN_MODE_MAX)
+			return -EINVAL;
+
+		/* An access port lives in exactly one vlan */
+		if (vlan->mode == VLAN_MODE_ACCESS &&
+		    (vlan->pvid == 0 || vlan->pvid >= VLAN_VID_MAX))
+			return -EINVAL;
+
+		memcpy(&old, &l->config.vlan, sizeof(old));
+		memcpy(&l->config.vlan, vlan, sizeof(*vlan));
+		link_vlan_filter_clear(l, &old);
+		rc = link_configure(l);
+		if (rc < 0) {
+			memcpy(&l->config.vlan, &old, sizeof(old));
+			link_configure(l);
+		}
+	}
+
+	return rc;
+}
+
+int
+link_config_set_vlan_native(char const *name, uint16_t vid)
+{
+	struct link *l = link_config_get(name);
+	struct vlan_link_config vlan;
+
+	if (!l)
+		return -ENOENT;
+
+	if (l->config.vlan.mode != VLAN_MODE_TRUNK &&
+	    l->config.vlan.mode != VLAN_MODE_QINQ)
+		return -EINVAL;
+
+	if (vid == 0 || vid >= VLAN_VID_MAX)
+		return -EINVAL;
+
+	memcpy(&vlan, &l->config.vlan, sizeof(vlan));
+	vlan.pvid = vid;
+	vlan.allowed[vid / 64] |= 1ULL << (vid % 64);
+	return link_config_set_vlan(name, &vlan);
+}
+
+/* Only what the port supports is kept, callers check tx.offloads */
+int
+link_config_add_tx_offloads(char const *name, uint64_t offloads)
+{
+	struct link *l = link_config_get(name);
+	struct rte_eth_dev_info info;
+	uint64_t old;
+	int rc;
+
+	if (!l)
+		return -ENOENT;
+
+	rc = rte_eth_dev_info_get(l->config.link_id, &info);
+	if (rc < 0)
+		return rc;
+
+	offloads &= info.tx_offload_capa;
+	if ((l->config.tx.offloads | offloads) == l->config.tx.offloads)
+		return 0;
+
+	old = l->config.tx.offloads;
+	l->config.tx.offloads |= offloads;
+	rc = link_configure(l);
+	if (rc < 0) {
+		l->config.tx.offloads = old;
+		link_configure(l);
+	}
+
+	return rc;
+}
+
+/* What every link can do, so a node may rely on it whatever the egress */
+uint64_t
+link_tx_offloads_common(void)
+{
+	uint64_t offloads = UINT64_MAX;
+	struct link *l;
+
+	if (TAILQ_EMPTY(&link_node))
+		return 0;
+
+	TAILQ_FOREACH(l, &link_node, next) {
+		offloads &= l->config.tx.offloads;
+	}
+
+	return offloads;
+}
+
+/* Software pushed tags move the IP header after the graph nodes ran */
+bool
+link_vlan_sw_insert(void)
+{
+	struct link *l;
+
+	TAILQ_FOREACH(l, &link_node, next) {
+		if ((l->config.vlan.mode == VLAN_MODE_TRUNK ||
+		     l->config.vlan.mode == VLAN_MODE_QINQ) && !l->config.vlan.hw_insert)
+			return true;
+	}
+
+	return false;
+}
+
+int
+link_config_set_reassembly(char const *name, bool enable)
+{
+	struct link *l = link_config_get(name);
+
+	if (!l)
+		return -ENOENT;
+
+	l->config.reassembly = enable;
+	return 0;
+}
+
+bool
+link_reassembly_enabled(uint16_t link_id)
+{
+	struct link *l;
+
+	TAILQ_FOREACH(l, &link_node, next) {
+		if (l->config.link_id == link_id)
+			return l->config.reassembly;
+	}
+
+	return false;
+}
+
+uint32_t
+link_mtu_get(uint16_t link_id)
+{
+	struct link *l;
+
+	TAILQ_FOREACH(l, &link_node, next) {
+		if (l->config.link_id == link_id)
+			return l->config.mtu;
+	}
+
+	return 0;
+}
+
+/* Largest packet any link may hand to the graph */
+uint32_t
+link_mtu_max(void)
+{
+	uint32_t mtu = 0;
+	struct link *l;
+
+	TAILQ_FOREACH(l, &link_node, next) {
+		mtu = RTE_MAX(mtu, l->config.mtu);
+	}
+
+	return mtu;
+}
+
 int
 link_start()
 {
 	struct link *l;
 	int rc = 0;
 
+	/* Again on reconfigure, links added since are started then */
 	TAILQ_FOREACH(l, &link_node, next) {
+		if (l->started)
+			continue;
+
+		rc = vlan_link_set(l->config.link_id, &l->config.vlan);
+		if (rc < 0)
+			return rc;
+
 		rc = rte_eth_dev_start(l->config.link_id);
 		if (rc < 0) {
 			return rc;
@@ -242,6 +860,14 @@ link_start()
 			rte_eth_dev_stop(l->config.link_id);
 			return rc;
 		}
+
+		rc = link_rss_reta_update(l);
+		if (rc < 0) {
+			rte_eth_dev_stop(l->config.link_id);
+			return rc;
+		}
+
+		l->started = 1;
 	}
 
 	return rc;
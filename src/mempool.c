@@ -7,6 +7,7 @@
 #include <stdlib.h>
 #include <sys/queue.h>
 
+#include <rte_eventdev.h>
 #include <rte_malloc.h>
 
 #include "mempool.h"
@@ -54,16 +55,14 @@ mempool_config_add(struct mempool_config *config)
                         mp->config.numa_node);
                 rc = (mp->mp) ? rc : -rte_errno;
                 break;
-        case MEMPOOL_TYPE_EVENT:
-                mp->mp = rte_mempool_create(
+        case MEMPOOL_TYPE_VECTOR:
+                /* item_sz is the number of mbufs per rte_event_vector */
+                mp->mp = rte_event_vector_pool_create(
                         mp->config.name,
                         mp->config.nb_items,
-                        mp->config.item_sz,
                         mp->config.cache_sz,
-                        0,
-                        NULL, NULL, NULL, NULL,
-                        mp->config.numa_node,
-                        0);
+                        mp->config.item_sz,
+                        mp->config.numa_node);
                 rc = (mp->mp) ? rc : -rte_errno;
                 break;
         default:
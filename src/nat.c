@@ -0,0 +1,197 @@
+/*
+  SPDX-License-Identifier: MIT
+  Copyright(c) 2023 Sriram Yagnaraman.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/queue.h>
+
+#include <rte_ethdev.h>
+#include <rte_malloc.h>
+
+#include "link.h"
+#include "nat.h"
+#include "stage.h"
+#include "tunnel.h"
+
+#define NAT_TX_CKSUM_OFFLOADS	(RTE_ETH_TX_OFFLOAD_IPV4_CKSUM | \
+				 RTE_ETH_TX_OFFLOAD_TCP_CKSUM | \
+				 RTE_ETH_TX_OFFLOAD_UDP_CKSUM)
+
+static struct nat_rule_head nat_rule_node = TAILQ_HEAD_INITIALIZER(nat_rule_node);
+static struct nat_rule_entry *nat_rule_array[NAT_RULE_ID_MAX];
+
+static uint32_t nat_nb_rules;
+static uint8_t nat_started;
+
+static int
+nat_tunnel_found(__rte_unused struct tunnel_config *config, __rte_unused void *data)
+{
+	return -EEXIST;
+}
+
+struct nat_rule_entry*
+nat_rule_config_get(uint32_t rule_id)
+{
+	if (rule_id >= NAT_RULE_ID_MAX)
+		return NULL;
+
+	return nat_rule_array[rule_id];
+}
+
+int
+nat_rule_config_add(struct nat_rule_config *config)
+{
+	struct nat_rule *rule = &config->rule;
+	struct nat_rule_entry *r;
+
+	if (nat_started)
+		return -EBUSY;
+
+	if (config->rule_id >= NAT_RULE_ID_MAX)
+		return -EINVAL;
+
+	if (rule->type >= NAT_TYPE_MAX || rule->depth > 32 ||
+	    rule->to_port_lo > rule->to_port_hi ||
+	    (rule->type == NAT_TYPE_SNAT && rule->to_port_lo == 0))
+		return -EINVAL;
+
+	if (nat_rule_array[config->rule_id])
+		return -EEXIST;
+
+	r = rte_malloc(NULL, sizeof(struct nat_rule_entry), 0);
+	if (!r)
+		return -ENOMEM;
+
+	memcpy(&r->config, config, sizeof(*config));
+	TAILQ_INSERT_TAIL(&nat_rule_node, r, next);
+	nat_rule_array[config->rule_id] = r;
+	nat_nb_rules++;
+	return 0;
+}
+
+int
+nat_rule_config_rem(uint32_t rule_id)
+{
+	struct nat_rule_entry *r = nat_rule_config_get(rule_id);
+
+	if (nat_started)
+		return -EBUSY;
+
+	if (!r)
+		return -ENOENT;
+
+	TAILQ_REMOVE(&nat_rule_node, r, next);
+	nat_rule_array[rule_id] = NULL;
+	nat_nb_rules--;
+	rte_free(r);
+	return 0;
+}
+
+int
+nat_rule_config_walk(nat_rule_walk_cb cb, void *data)
+{
+	struct nat_rule_entry *r;
+	int rc = 0;
+
+	TAILQ_FOREACH(r, &nat_rule_node, next) {
+		rc = cb(&r->config, data);
+		if (rc < 0)
+			break;
+	}
+
+	return rc;
+}
+
+/* Bindings and port slices live on one worker, flows only reach the
+ * same worker again when the stage feeding it steers them.
+ */
+static int
+nat_check_input(struct stage_config *config, void *data)
+{
+	struct stage_config *tracked = data;
+
+	if (config->type != STAGE_TYPE_RX || !config->adapter ||
+	    config->ev_queue.out != tracked->ev_queue.in)
+		return 0;
+
+	if (config->ev_id != STAGE_EV_ID_ANY && tracked->ev_id != STAGE_EV_ID_ANY &&
+	    config->ev_id != tracked->ev_id)
+		return 0;
+
+	RTE_LOG(INFO, USER1, "NAT on stage %s: fed by the Rx adapter of %s, not steered\n",
+		tracked->name, config->name);
+	return -ENOTSUP;
+}
+
+static int
+nat_count_workers(struct stage_config *config, void *data)
+{
+	uint32_t *nb_workers = data;
+
+	if (config->type != STAGE_TYPE_WORKER || !config->conntrack)
+		return 0;
+
+	*nb_workers += __builtin_popcount(config->coremask);
+	return stage_config_walk(nat_check_input, config);
+}
+
+int
+nat_start(void)
+{
+	struct nat_rule *rules = NULL;
+	struct nat_rule_entry *r;
+	uint32_t nb_workers = 0;
+	uint32_t i = 0, id;
+	bool hw_cksum;
+	int rc;
+
+	/* The node is only in the graph if something was configured */
+	if (nat_started || TAILQ_EMPTY(&nat_rule_node))
+		return 0;
+
+	/* Translation keys off the connection table */
+	rc = stage_config_walk(nat_count_workers, &nb_workers);
+	if (rc < 0)
+		return rc;
+
+	if (nb_workers == 0) {
+		RTE_LOG(INFO, USER1, "NAT rules need a worker stage with conntrack\n");
+		return -EINVAL;
+	}
+
+	rules = rte_malloc(NULL, nat_nb_rules * sizeof(*rules), 0);
+	if (!rules)
+		return -ENOMEM;
+
+	/* Lower rule ids are tried first */
+	for (id = 0; id < NAT_RULE_ID_MAX; id++) {
+		r = nat_rule_array[id];
+		if (r)
+			rules[i++] = r->config.rule;
+	}
+
+	/* The offload flags describe the headers as NAT leaves them, a tag
+	 * pushed or a tunnel header added later would leave them stale.
+	 */
+	hw_cksum = (link_tx_offloads_common() & NAT_TX_CKSUM_OFFLOADS) == NAT_TX_CKSUM_OFFLOADS &&
+		   !link_vlan_sw_insert() && tunnel_config_walk(nat_tunnel_found, NULL) == 0;
+	rc = nat_init(rules, nat_nb_rules, nb_workers, hw_cksum);
+	rte_free(rules);
+	if (rc < 0)
+		return rc;
+
+	nat_started = 1;
+	return 0;
+}
+
+void
+nat_stop(void)
+{
+	if (!nat_started)
+		return;
+
+	nat_fini();
+	nat_started = 0;
+}
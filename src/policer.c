@@ -0,0 +1,216 @@
+/*
+  SPDX-License-Identifier: MIT
+  Copyright(c) 2023 Sriram Yagnaraman.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/queue.h>
+
+#include <rte_ethdev.h>
+#include <rte_malloc.h>
+
+#include "link.h"
+#include "policer.h"
+#include "stage.h"
+
+static struct policer_head policer_node = TAILQ_HEAD_INITIALIZER(policer_node);
+static struct policer *policer_array[POLICER_ID_MAX];
+
+static uint8_t policer_link[RTE_MAX_ETHPORTS];
+static uint8_t policer_started;
+
+struct policer*
+policer_config_get(uint32_t policer_id)
+{
+	if (policer_id >= POLICER_ID_MAX)
+		return NULL;
+
+	return policer_array[policer_id];
+}
+
+int
+policer_config_add(struct policer_config *config)
+{
+	struct policer_params *params = &config->params;
+	struct policer *p;
+
+	if (policer_started)
+		return -EBUSY;
+
+	if (config->policer_id == POLICER_ID_NONE || config->policer_id >= POLICER_ID_MAX)
+		return -EINVAL;
+
+	if (params->type == POLICER_TYPE_NONE || params->type >= POLICER_TYPE_MAX ||
+	    params->cir == 0 ||
+	    (params->type == POLICER_TYPE_TRTCM && params->pir < params->cir))
+		return -EINVAL;
+
+	if (policer_array[config->policer_id])
+		return -EEXIST;
+
+	p = rte_malloc(NULL, sizeof(struct policer), 0);
+	if (!p)
+		return -ENOMEM;
+
+	memcpy(&p->config, config, sizeof(*config));
+	TAILQ_INSERT_TAIL(&policer_node, p, next);
+	policer_array[config->policer_id] = p;
+	return 0;
+}
+
+int
+policer_config_rem(uint32_t policer_id)
+{
+	struct policer *p = policer_config_get(policer_id);
+	uint32_t i;
+
+	if (policer_started)
+		return -EBUSY;
+
+	if (!p)
+		return -ENOENT;
+
+	for (i = 0; i < RTE_MAX_ETHPORTS; i++) {
+		if (policer_link[i] == policer_id)
+			policer_link[i] = POLICER_ID_NONE;
+	}
+
+	TAILQ_REMOVE(&policer_node, p, next);
+	policer_array[policer_id] = NULL;
+	rte_free(p);
+	return 0;
+}
+
+int
+policer_config_set_action(uint32_t policer_id, uint8_t color, uint8_t action, uint8_t dscp)
+{
+	struct policer *p = policer_config_get(policer_id);
+
+	if (policer_started)
+		return -EBUSY;
+
+	if (!p)
+		return -ENOENT;
+
+	if (color >= RTE_COLORS || action >= POLICER_ACTION_MAX || dscp > 63)
+		return -EINVAL;
+
+	p->config.params.action[color] = action;
+	p->config.params.dscp[color] = dscp;
+	return 0;
+}
+
+int
+policer_config_walk(policer_walk_cb cb, void *data)
+{
+	struct policer *p;
+	int rc = 0;
+
+	TAILQ_FOREACH(p, &policer_node, next) {
+		rc = cb(&p->config, data);
+		if (rc < 0)
+			break;
+	}
+
+	return rc;
+}
+
+int
+policer_config_set_link(char const *link_name, uint32_t policer_id)
+{
+	struct link *l = link_config_get(link_name);
+
+	if (policer_started)
+		return -EBUSY;
+
+	if (!l)
+		return -ENOENT;
+
+	if (policer_id != POLICER_ID_NONE && !policer_config_get(policer_id))
+		return -ENOENT;
+
+	policer_link[l->config.link_id] = policer_id;
+	return 0;
+}
+
+uint8_t
+policer_config_get_link(uint16_t link_id)
+{
+	if (link_id >= RTE_MAX_ETHPORTS)
+		return POLICER_ID_NONE;
+
+	return policer_link[link_id];
+}
+
+/* Meters are per lcore, the rates are split over every lcore that
+ * polls a link.
+ */
+static int
+policer_count_lcores(struct stage_config *config, void *data)
+{
+	uint32_t *nb_lcores = data;
+	int i;
+
+	/* Adapter fed stages have no ethdev rx chain to police in */
+	if (config->type == STAGE_TYPE_RX && config->adapter) {
+		RTE_LOG(INFO, USER1, "Stage %s: policers need ethdev rx, not the adapter\n",
+			config->name);
+		return -ENOTSUP;
+	}
+
+	for (i = 0; i < STAGE_MAX_LINK_QUEUES; i++) {
+		if (config->link_in_queue[i].enabled) {
+			*nb_lcores += __builtin_popcount(config->coremask);
+			break;
+		}
+	}
+
+	return 0;
+}
+
+int
+policer_start(void)
+{
+	struct policer_params *params;
+	uint32_t nb_lcores = 0;
+	struct policer *p;
+	int rc;
+
+	/* The node is only in the graph if something was configured */
+	if (policer_started || TAILQ_EMPTY(&policer_node))
+		return 0;
+
+	rc = stage_config_walk(policer_count_lcores, &nb_lcores);
+	if (rc < 0)
+		return rc;
+
+	if (nb_lcores == 0)
+		return 0;
+
+	params = rte_zmalloc(NULL, POLICER_ID_MAX * sizeof(*params), 0);
+	if (!params)
+		return -ENOMEM;
+
+	TAILQ_FOREACH(p, &policer_node, next) {
+		params[p->config.policer_id] = p->config.params;
+	}
+
+	rc = policer_init(params, policer_link, nb_lcores);
+	rte_free(params);
+	if (rc < 0)
+		return rc;
+
+	policer_started = 1;
+	return 0;
+}
+
+void
+policer_stop(void)
+{
+	if (!policer_started)
+		return;
+
+	policer_fini();
+	policer_started = 0;
+}
@@ -5,6 +5,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <sys/queue.h>
 
 #include <rte_bitmap.h>
@@ -12,7 +13,12 @@
 #include <rte_malloc.h>
 
 #include "link.h"
+#include "mempool.h"
 #include "stage.h"
+#include "node/conntrack.h"
+#include "node/eventdev_rx.h"
+#include "node/flow_cache.h"
+#include "node/flow_hash.h"
 
 static void *enabled_cores_bitmap = NULL;
 static struct rte_bitmap *enabled_cores = NULL;
@@ -29,6 +35,7 @@ char const *stage_type_str[] =
     [STAGE_TYPE_RX] 	= "rx",
     [STAGE_TYPE_WORKER]	= "worker",
     [STAGE_TYPE_TX]	= "tx",
+    [STAGE_TYPE_RTC]	= "rtc",
     [STAGE_TYPE_MAX]	= "invalid",
 };
 
@@ -226,12 +233,19 @@ stage_config_set_type(char const *name, uint8_t type)
 		case STAGE_TYPE_WORKER:
 		case STAGE_TYPE_TX:
 		case STAGE_TYPE_RX:
+		case STAGE_TYPE_RTC:
 			s->config.type = type;
 			break;
 		default:
 			return -EINVAL;
 		}
 
+		/* Drop what the new type cannot use */
+		if (type != STAGE_TYPE_RX && type != STAGE_TYPE_TX)
+			s->config.adapter = 0;
+		if (type == STAGE_TYPE_RTC)
+			memset(&s->config.vector, 0, sizeof(s->config.vector));
+
                 return 0;
         }
 
@@ -239,7 +253,24 @@ stage_config_set_type(char const *name, uint8_t type)
 }
 
 int
-stage_config_set_ev_queue_in(char const *name, uint8_t qid, uint8_t schedule_type, char const *mp_name)
+stage_config_set_eventdev(char const *name, int16_t ev_id)
+{
+        struct stage *s = stage_config_get(name);
+
+        if (s) {
+		if (ev_id != STAGE_EV_ID_ANY &&
+		    (ev_id < 0 || ev_id >= rte_event_dev_count()))
+			return -ENODEV;
+
+		s->config.ev_id = ev_id;
+                return 0;
+        }
+
+        return -ENOENT;
+}
+
+int
+stage_config_set_ev_queue_in(char const *name, uint8_t qid, uint8_t schedule_type)
 {
 	struct rte_event_queue_conf *ev_queue_config;
         struct stage *s = stage_config_get(name);
@@ -247,7 +278,6 @@ stage_config_set_ev_queue_in(char const *name, uint8_t qid, uint8_t schedule_typ
         if (s) {
 		s->config.ev_queue.in = qid;
 		s->config.ev_queue.sched_type_in = schedule_type;
-		strncpy(s->config.ev_queue.mp_name, mp_name, RTE_MEMPOOL_NAMESIZE);
 		ev_queue_config = &s->config.ev_queue.config_in;
 
 		switch (s->config.type) {
@@ -293,8 +323,9 @@ stage_config_set_link_queue_in(char const *name, char const *link_name, uint8_t
 	int i;
 
         if (s && l) {
-		// Only valid for RX cores
-		if (s->config.type != STAGE_TYPE_RX)
+		// Only valid for RX and run-to-completion cores
+		if (s->config.type != STAGE_TYPE_RX &&
+		    s->config.type != STAGE_TYPE_RTC)
 			return -EINVAL;
 
 		// Check for duplicate configuration
@@ -334,8 +365,9 @@ stage_config_set_link_queue_out(char const *name, char const *link_name, uint8_t
 	int i;
 
         if (s && l) {
-		// Only valid for TX cores
-		if (s->config.type != STAGE_TYPE_TX)
+		// Only valid for TX and run-to-completion cores
+		if (s->config.type != STAGE_TYPE_TX &&
+		    s->config.type != STAGE_TYPE_RTC)
 			return -EINVAL;
 
 		// Check for duplicate configuration
@@ -379,6 +411,108 @@ stage_config_set_graph_nodes(char const *name, char const *graph_nodes)
         return -ENOENT;
 }
 
+int
+stage_config_set_flow_hash(char const *name, uint8_t flow_hash)
+{
+        struct stage *s = stage_config_get(name);
+
+        if (s) {
+		if (flow_hash >= FLOW_HASH_MAX)
+			return -EINVAL;
+
+		s->config.flow_hash = flow_hash;
+                return 0;
+        }
+
+        return -ENOENT;
+}
+
+int
+stage_config_set_adapter(char const *name, bool enable)
+{
+        struct stage *s = stage_config_get(name);
+
+        if (s) {
+		// Ethernet adapters replace RX and TX cores only
+		if (s->config.type != STAGE_TYPE_RX &&
+		    s->config.type != STAGE_TYPE_TX)
+			return -EINVAL;
+
+		s->config.adapter = enable;
+                return 0;
+        }
+
+        return -ENOENT;
+}
+
+int
+stage_config_set_vector(char const *name, uint16_t size, uint64_t timeout_ns,
+			char const *mp_name)
+{
+        struct stage *s = stage_config_get(name);
+	struct mempool *m;
+
+        if (s) {
+		if (size) {
+			m = mempool_config_get(mp_name);
+			if (!m)
+				return -ENOENT;
+
+			// The pool fixes the largest vector it can hold
+			if (m->config.type != MEMPOOL_TYPE_VECTOR ||
+			    size > m->config.item_sz || size > EVENTDEV_VECTOR_SIZE_MAX)
+				return -EINVAL;
+
+			strncpy(s->config.vector.mp_name, mp_name, RTE_MEMPOOL_NAMESIZE);
+		}
+
+		s->config.vector.size = size;
+		s->config.vector.timeout_ns = timeout_ns;
+                return 0;
+        }
+
+        return -ENOENT;
+}
+
+int
+stage_config_set_flow_cache(char const *name, uint32_t entries)
+{
+        struct stage *s = stage_config_get(name);
+
+        if (s) {
+		if (entries > FLOW_CACHE_ENTRIES_MAX)
+			return -EINVAL;
+
+		// Rounded up to a power of two when the cache is built
+		if (entries && entries < FLOW_CACHE_ENTRIES_MIN)
+			entries = FLOW_CACHE_ENTRIES_MIN;
+
+		s->config.flow_cache = entries;
+                return 0;
+        }
+
+        return -ENOENT;
+}
+
+int
+stage_config_set_conntrack(char const *name, uint32_t entries, bool strict)
+{
+        struct stage *s = stage_config_get(name);
+
+        if (s) {
+		// Inputs are checked at start, see stage_steer_queues()
+		if (s->config.type != STAGE_TYPE_WORKER ||
+		    entries > CONNTRACK_ENTRIES_MAX)
+			return -EINVAL;
+
+		s->config.conntrack = entries;
+		s->config.conntrack_strict = strict;
+                return 0;
+        }
+
+        return -ENOENT;
+}
+
 int
 stage_config_walk(stage_config_cb cb, void *data)
 {
@@ -0,0 +1,229 @@
+/*
+  SPDX-License-Identifier: MIT
+  Copyright(c) 2023 Sriram Yagnaraman.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/queue.h>
+
+#include <rte_ethdev.h>
+#include <rte_malloc.h>
+
+#include "link.h"
+#include "tunnel.h"
+
+static struct tunnel_head tunnel_node = TAILQ_HEAD_INITIALIZER(tunnel_node);
+
+static uint8_t tunnel_started;
+
+struct tunnel*
+tunnel_config_get(char const *name)
+{
+	struct tunnel *t;
+
+	TAILQ_FOREACH(t, &tunnel_node, next) {
+		if (strcmp(t->config.name, name) == 0)
+			return t;
+	}
+	return NULL;
+}
+
+static int
+tunnel_alloc_id()
+{
+	uint64_t used = 0;
+	struct tunnel *t;
+	uint16_t tunnel_id;
+
+	TAILQ_FOREACH(t, &tunnel_node, next) {
+		used |= 1ULL << t->config.tunnel_id;
+	}
+
+	for (tunnel_id = 0; tunnel_id < VTEP_MAX; tunnel_id++) {
+		if (!(used & (1ULL << tunnel_id)))
+			return tunnel_id;
+	}
+
+	return -ENOSPC;
+}
+
+int
+tunnel_config_add(struct tunnel_config *config)
+{
+	struct tunnel *t;
+	int rc;
+
+	if (tunnel_started)
+		return -EBUSY;
+
+	if (config->vtep.type >= VTEP_TYPE_MAX || config->vtep.vni > VTEP_VNI_MAX)
+		return -EINVAL;
+
+	t = tunnel_config_get(config->name);
+	if (t)
+		return -EEXIST;
+
+	/* One endpoint per VNI and encapsulation */
+	TAILQ_FOREACH(t, &tunnel_node, next) {
+		if (t->config.vtep.vni == config->vtep.vni &&
+		    t->config.vtep.type == config->vtep.type)
+			return -EEXIST;
+	}
+
+	rc = tunnel_alloc_id();
+	if (rc < 0)
+		return rc;
+
+	t = rte_malloc(NULL, sizeof(struct tunnel), 0);
+	if (!t)
+		return -ENOMEM;
+
+	config->tunnel_id = rc;
+	config->link_name[0] = '\0';
+	config->link_id = LINK_ID_MAX;
+	config->overlay_link_name[0] = '\0';
+	config->overlay_link_id = LINK_ID_MAX;
+
+	memcpy(&t->config, config, sizeof(*config));
+	TAILQ_INSERT_TAIL(&tunnel_node, t, next);
+	return 0;
+}
+
+int
+tunnel_config_rem(char const *name)
+{
+	struct tunnel *t = tunnel_config_get(name);
+
+	if (!t)
+		return -ENOENT;
+
+	if (tunnel_started)
+		return -EBUSY;
+
+	TAILQ_REMOVE(&tunnel_node, t, next);
+	rte_free(t);
+	return 0;
+}
+
+int
+tunnel_config_set_link(char const *name, char const *link_name,
+		       struct rte_ether_addr *nexthop)
+{
+	struct tunnel *t = tunnel_config_get(name);
+	struct link *l = link_config_get(link_name);
+	uint64_t offloads;
+	int rc;
+
+	if (!t || !l)
+		return -ENOENT;
+
+	if (tunnel_started)
+		return -EBUSY;
+
+	/* Whatever the underlay cannot do is done in software */
+	offloads = t->config.vtep.ipv6 ? RTE_ETH_TX_OFFLOAD_OUTER_UDP_CKSUM :
+		RTE_ETH_TX_OFFLOAD_OUTER_IPV4_CKSUM;
+	rc = link_config_add_tx_offloads(link_name, offloads);
+	if (rc < 0)
+		return rc;
+
+	rte_strscpy(t->config.link_name, link_name, RTE_ETH_NAME_MAX_LEN);
+	t->config.link_id = l->config.link_id;
+	rte_ether_addr_copy(nexthop, &t->config.vtep.dst_mac);
+	return 0;
+}
+
+int
+tunnel_config_set_overlay(char const *name, char const *link_name)
+{
+	struct tunnel *t = tunnel_config_get(name);
+	struct link *l = link_config_get(link_name);
+	struct tunnel *o;
+
+	if (!t || !l)
+		return -ENOENT;
+
+	if (tunnel_started)
+		return -EBUSY;
+
+	TAILQ_FOREACH(o, &tunnel_node, next) {
+		if (o != t && o->config.overlay_link_id == l->config.link_id)
+			return -EEXIST;
+	}
+
+	rte_strscpy(t->config.overlay_link_name, link_name, RTE_ETH_NAME_MAX_LEN);
+	t->config.overlay_link_id = l->config.link_id;
+	return 0;
+}
+
+int
+tunnel_config_walk(tunnel_walk_cb cb, void *data)
+{
+	struct tunnel *t;
+	int rc;
+
+	TAILQ_FOREACH(t, &tunnel_node, next) {
+		rc = cb(&t->config, data);
+		if (rc < 0)
+			return rc;
+	}
+
+	return 0;
+}
+
+int
+tunnel_start(void)
+{
+	uint16_t nb_vteps = 0;
+	struct tunnel *t;
+	struct link *l;
+	int rc;
+
+	if (tunnel_started || TAILQ_EMPTY(&tunnel_node))
+		return 0;
+
+	TAILQ_FOREACH(t, &tunnel_node, next) {
+		if (t->config.link_id == LINK_ID_MAX)
+			return -EINVAL;
+		nb_vteps = RTE_MAX(nb_vteps, t->config.tunnel_id + 1);
+	}
+
+	rc = vtep_init(nb_vteps, SOCKET_ID_ANY);
+	if (rc < 0)
+		return rc;
+
+	TAILQ_FOREACH(t, &tunnel_node, next) {
+		l = link_config_get(t->config.link_name);
+		if (!l) {
+			rc = -ENOENT;
+			goto err;
+		}
+
+		rc = rte_eth_macaddr_get(t->config.link_id, &t->config.vtep.src_mac);
+		if (rc < 0)
+			goto err;
+
+		t->config.vtep.tx_offloads = l->config.tx.offloads;
+		rc = vtep_set(t->config.tunnel_id, &t->config.vtep);
+		if (rc < 0)
+			goto err;
+	}
+
+	tunnel_started = 1;
+	return 0;
+
+err:
+	vtep_fini();
+	return rc;
+}
+
+void
+tunnel_stop(void)
+{
+	if (!tunnel_started)
+		return;
+
+	vtep_fini();
+	tunnel_started = 0;
+}
@@ -0,0 +1,222 @@
+/*
+  SPDX-License-Identifier: MIT
+  Copyright(c) 2023 Sriram Yagnaraman.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <rte_common.h>
+#include <rte_ethdev.h>
+#include <rte_malloc.h>
+
+#include "link.h"
+#include "stage.h"
+#include "tx_sched.h"
+
+static struct tx_sched_link_config *tx_sched_link[RTE_MAX_ETHPORTS];
+static uint32_t tx_sched_share[RTE_MAX_ETHPORTS];
+static uint8_t tx_sched_started;
+
+static struct tx_sched_link_config *
+tx_sched_config_lookup(char const *link_name)
+{
+	struct link *l = link_config_get(link_name);
+
+	if (!l)
+		return NULL;
+
+	return tx_sched_link[l->config.link_id];
+}
+
+int
+tx_sched_config_set_link(char const *link_name, uint64_t rate, uint32_t nb_pipes)
+{
+	struct link *l = link_config_get(link_name);
+	struct tx_sched_link_config *config;
+	uint32_t i;
+
+	if (tx_sched_started)
+		return -EBUSY;
+
+	if (!l)
+		return -ENOENT;
+
+	if (rate == 0 || !rte_is_power_of_2(nb_pipes) || nb_pipes > TX_SCHED_PIPES_MAX)
+		return -EINVAL;
+
+	config = tx_sched_link[l->config.link_id];
+	if (!config) {
+		config = rte_zmalloc(NULL, sizeof(*config), 0);
+		if (!config)
+			return -ENOMEM;
+		/* Profile 0 is uncapped, every pipe starts on it */
+		config->nb_profiles = 1;
+		tx_sched_link[l->config.link_id] = config;
+	}
+
+	config->rate = rate;
+	config->profiles[0].rate = rate;
+	config->nb_pipes = nb_pipes;
+	/* Tenants on pipes that no longer exist fall back to pipe 0 */
+	for (i = 0; i < VLAN_VID_MAX; i++) {
+		if (config->vlan_pipe[i] >= nb_pipes)
+			config->vlan_pipe[i] = 0;
+	}
+
+	return 0;
+}
+
+int
+tx_sched_config_rem_link(char const *link_name)
+{
+	struct link *l = link_config_get(link_name);
+
+	if (tx_sched_started)
+		return -EBUSY;
+
+	if (!l)
+		return -ENOENT;
+
+	if (!tx_sched_link[l->config.link_id])
+		return -ENOENT;
+
+	rte_free(tx_sched_link[l->config.link_id]);
+	tx_sched_link[l->config.link_id] = NULL;
+	return 0;
+}
+
+int
+tx_sched_config_set_profile(char const *link_name, uint32_t profile_id, uint64_t rate,
+			    uint64_t size)
+{
+	struct tx_sched_link_config *config = tx_sched_config_lookup(link_name);
+
+	if (tx_sched_started)
+		return -EBUSY;
+
+	if (!config)
+		return -ENOENT;
+
+	/* Profiles are dense, one past the last adds a new one */
+	if (profile_id > config->nb_profiles || profile_id >= TX_SCHED_PROFILES_MAX ||
+	    rate == 0)
+		return -EINVAL;
+
+	config->profiles[profile_id].rate = rate;
+	config->profiles[profile_id].size = size;
+	if (profile_id == config->nb_profiles)
+		config->nb_profiles++;
+
+	return 0;
+}
+
+int
+tx_sched_config_set_pipe(char const *link_name, uint32_t pipe_id, uint32_t profile_id)
+{
+	struct tx_sched_link_config *config = tx_sched_config_lookup(link_name);
+
+	if (tx_sched_started)
+		return -EBUSY;
+
+	if (!config)
+		return -ENOENT;
+
+	if (pipe_id >= config->nb_pipes || profile_id >= config->nb_profiles)
+		return -EINVAL;
+
+	config->pipe_profile[pipe_id] = profile_id;
+	return 0;
+}
+
+int
+tx_sched_config_set_vlan(char const *link_name, uint16_t vid, uint32_t pipe_id)
+{
+	struct tx_sched_link_config *config = tx_sched_config_lookup(link_name);
+
+	if (tx_sched_started)
+		return -EBUSY;
+
+	if (!config)
+		return -ENOENT;
+
+	if (vid >= VLAN_VID_MAX || pipe_id >= config->nb_pipes)
+		return -EINVAL;
+
+	config->vlan_pipe[vid] = pipe_id;
+	return 0;
+}
+
+int
+tx_sched_config_walk(tx_sched_walk_cb cb, void *data)
+{
+	uint16_t i;
+	int rc = 0;
+
+	for (i = 0; i < RTE_MAX_ETHPORTS; i++) {
+		if (!tx_sched_link[i])
+			continue;
+
+		rc = cb(i, tx_sched_link[i], data);
+		if (rc < 0)
+			break;
+	}
+
+	return rc;
+}
+
+struct tx_sched_link_config *
+tx_sched_config_get_link(uint16_t link_id)
+{
+	if (link_id >= RTE_MAX_ETHPORTS || !tx_sched_started)
+		return NULL;
+
+	return tx_sched_link[link_id];
+}
+
+uint32_t
+tx_sched_config_get_share(uint16_t link_id)
+{
+	if (link_id >= RTE_MAX_ETHPORTS)
+		return 0;
+
+	return tx_sched_share[link_id];
+}
+
+static int
+tx_sched_count_lcores(struct stage_config *config, void *data __rte_unused)
+{
+	struct stage_link_queue_config *qconf;
+	int i;
+
+	for (i = 0; i < STAGE_MAX_LINK_QUEUES; i++) {
+		qconf = &config->link_out_queue[i];
+		if (qconf->enabled)
+			tx_sched_share[qconf->link_id] += __builtin_popcount(config->coremask);
+	}
+
+	return 0;
+}
+
+int
+tx_sched_start(void)
+{
+	if (tx_sched_started)
+		return 0;
+
+	memset(tx_sched_share, 0, sizeof(tx_sched_share));
+	stage_config_walk(tx_sched_count_lcores, NULL);
+
+	tx_sched_started = 1;
+	return 0;
+}
+
+void
+tx_sched_stop(void)
+{
+	if (!tx_sched_started)
+		return;
+
+	tx_sched_fini();
+	tx_sched_started = 0;
+}
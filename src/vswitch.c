@@ -5,7 +5,9 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
+#include <rte_bus_vdev.h>
 #include <rte_ethdev.h>
 #include <rte_eventdev.h>
 #include <rte_graph.h>
@@ -15,26 +17,87 @@
 #include <rte_node_eth_api.h>
 #include <rte_service.h>
 
+#include "acl.h"
+#include "adapter.h"
+#include "bridge.h"
+#include "exception.h"
 #include "lcore.h"
 #include "link.h"
+#include "nat.h"
+#include "policer.h"
 #include "stage.h"
+#include "tunnel.h"
+#include "tx_sched.h"
 #include "vswitch.h"
 #include "node/eventdev_dispatcher.h"
 #include "node/eventdev_rx.h"
 #include "node/eventdev_tx.h"
 #include "node/forward.h"
+#include "node/flow_hash.h"
+#include "node/ip_frag.h"
 
 #define DEFAULT_PKT_BURST (32)
 #define DEFAULT_EVENT_BURST (32)
 
 static struct vswitch_config *config = NULL;
 
+static int
+vswitch_eventdev_probe(uint8_t ev_id)
+{
+	struct vswitch_eventdev *ev = &config->eventdevs[ev_id];
+	int rc;
+
+	ev->socket_id = rte_event_dev_socket_id(ev_id);
+	rc = rte_event_dev_info_get(ev_id, &ev->info);
+	if (rc < 0)
+		return -rte_errno;
+
+	adapter_init(ev_id);
+	return 0;
+}
+
+/* Software event device for a socket no device sits on, only created
+ * once a stage needs it.
+ */
+static int
+vswitch_eventdev_create(int socket_id)
+{
+	char name[RTE_DEV_NAME_MAX_LEN];
+	char args[RTE_DEV_NAME_MAX_LEN];
+	uint8_t ev_id;
+	int rc;
+
+	if (config->nb_eventdevs >= RTE_EVENT_MAX_DEVS)
+		return -ENOSPC;
+
+	snprintf(name, sizeof(name), "event_sw_numa%d", socket_id);
+	snprintf(args, sizeof(args), "numa_node=%d", socket_id);
+	rc = rte_vdev_init(name, args);
+	if (rc < 0) {
+		RTE_LOG(INFO, USER1, "Eventdev (%s) create failed: %s\n",
+			name, rte_strerror(-rc));
+		return rc;
+	}
+
+	rc = rte_event_dev_get_dev_id(name);
+	if (rc < 0)
+		return rc;
+
+	ev_id = rc;
+	rc = vswitch_eventdev_probe(ev_id);
+	if (rc < 0)
+		return rc;
+
+	config->nb_eventdevs = RTE_MAX(config->nb_eventdevs, ev_id + 1);
+	return ev_id;
+}
+
 int
 vswitch_init(struct params *p)
 {
-	int num_eventdev = 0;
 	uint16_t core_id;
 	int rc = -EINVAL;
+	uint8_t ev_id;
 
 	if (!config) {
 		config = rte_malloc(NULL, sizeof(struct vswitch_config), 0);
@@ -44,23 +107,34 @@ vswitch_init(struct params *p)
 		}
 	}
 
-	num_eventdev = rte_event_dev_count();
-	if (num_eventdev < 1) {
-		rc = -ENOENT;
+	memset(config, 0, sizeof(*config));
+	config->params = *p;
+
+	/* Workers report quiescent state after every graph walk */
+	config->qsv = rte_zmalloc(NULL, rte_rcu_qsbr_get_memsize(RTE_MAX_LCORE),
+				  RTE_CACHE_LINE_SIZE);
+	if (!config->qsv) {
+		rc = -ENOMEM;
 		goto err;
 	}
 
-	memset(config, 0, sizeof(*config));
-	config->params = *p;
-	config->ev_id = 0; // TODO: Pick event device based on configuration instead
-	rc = rte_event_dev_info_get(config->ev_id, &config->ev_info);
-	if (rc < 0) {
+	rc = rte_rcu_qsbr_init(config->qsv, RTE_MAX_LCORE);
+	if (rc) {
 		rc = -rte_errno;
 		goto err;
 	}
 
 	for (core_id = 0; core_id < RTE_MAX_LCORE; core_id++) {
-		lcore_init(core_id, config->ev_id, &config->lcores[core_id]);
+		lcore_init(core_id, &config->lcores[core_id]);
+		config->lcores[core_id].qsv = config->qsv;
+	}
+
+	/* Software devices are added at start for the sockets that need one */
+	config->nb_eventdevs = RTE_MIN(rte_event_dev_count(), RTE_EVENT_MAX_DEVS);
+	for (ev_id = 0; ev_id < config->nb_eventdevs; ev_id++) {
+		rc = vswitch_eventdev_probe(ev_id);
+		if (rc < 0)
+			goto err;
 	}
 
 	return 0;
@@ -72,6 +146,22 @@ err:
 int
 vswitch_quit()
 {
+	uint8_t ev_id;
+
+	if (config) {
+		for (ev_id = 0; ev_id < config->nb_eventdevs; ev_id++)
+			adapter_stop(ev_id);
+		bridge_stop();
+		tunnel_stop();
+		acl_stop();
+		nat_stop();
+		policer_stop();
+		tx_sched_stop();
+		exception_stop();
+		ip_frag_fini();
+		rte_free(config->qsv);
+	}
+
 	rte_free(config);
 	return 0;
 }
@@ -82,95 +172,659 @@ vswitch_config_get()
 	return config;
 }
 
+static int
+vswitch_eventdev_from_socket(int socket_id)
+{
+	uint8_t ev_id;
+	int rc;
+
+	if (socket_id == SOCKET_ID_ANY)
+		socket_id = rte_socket_id();
+
+	for (ev_id = 0; ev_id < config->nb_eventdevs; ev_id++) {
+		if (config->eventdevs[ev_id].socket_id == socket_id)
+			return ev_id;
+	}
+
+	rc = vswitch_eventdev_create(socket_id);
+	if (rc >= 0)
+		return rc;
+
+	return config->nb_eventdevs ? 0 : -ENODEV;
+}
+
+/* Stages without an explicit device use the one on their socket, taken
+ * from their cores or, for core-less adapter stages, the first link.
+ * A stage whose cores span sockets would schedule through a remote
+ * device and is refused.
+ */
+static int
+stage_resolve_eventdev(struct stage_config *stage_config, __rte_unused void *data)
+{
+	int socket_id = SOCKET_ID_ANY;
+	uint16_t core_id;
+	int ev_id, i;
+
+	if (stage_config->type == STAGE_TYPE_RTC)
+		return 0;
+
+	RTE_LCORE_FOREACH_WORKER(core_id) {
+		if (!(stage_config->coremask & (1UL << core_id)))
+			continue;
+
+		if (socket_id == SOCKET_ID_ANY) {
+			socket_id = rte_lcore_to_socket_id(core_id);
+		} else if (socket_id != (int)rte_lcore_to_socket_id(core_id)) {
+			RTE_LOG(INFO, USER1, "Stage %s: cores span sockets\n", stage_config->name);
+			return -EINVAL;
+		}
+	}
+
+	if (stage_config->ev_id != STAGE_EV_ID_ANY) {
+		if (stage_config->ev_id >= config->nb_eventdevs)
+			return -ENODEV;
+		return 0;
+	}
+
+	for (i = 0; i < STAGE_MAX_LINK_QUEUES && socket_id == SOCKET_ID_ANY; i++) {
+		if (stage_config->link_in_queue[i].enabled)
+			socket_id = rte_eth_dev_socket_id(stage_config->link_in_queue[i].link_id);
+		else if (stage_config->link_out_queue[i].enabled)
+			socket_id = rte_eth_dev_socket_id(stage_config->link_out_queue[i].link_id);
+	}
+
+	ev_id = vswitch_eventdev_from_socket(socket_id);
+	if (ev_id < 0)
+		return ev_id;
+
+	stage_config->ev_id = ev_id;
+	return 0;
+}
+
+struct vswitch_queue_map {
+	uint64_t produced[RTE_EVENT_MAX_DEVS][4];
+	uint64_t consumed[RTE_EVENT_MAX_DEVS][4];
+};
+
+static int
+stage_map_queues(struct stage_config *stage_config, void *data)
+{
+	struct vswitch_queue_map *map = data;
+	uint8_t ev_id = stage_config->ev_id;
+	uint8_t qid;
+
+	switch (stage_config->type) {
+	case STAGE_TYPE_RX:
+		qid = stage_config->ev_queue.out;
+		map->produced[ev_id][qid / 64] |= 1ULL << (qid % 64);
+		break;
+	case STAGE_TYPE_WORKER:
+		qid = stage_config->ev_queue.out;
+		map->produced[ev_id][qid / 64] |= 1ULL << (qid % 64);
+		qid = stage_config->ev_queue.in;
+		map->consumed[ev_id][qid / 64] |= 1ULL << (qid % 64);
+		break;
+	case STAGE_TYPE_TX:
+		qid = stage_config->ev_queue.in;
+		map->consumed[ev_id][qid / 64] |= 1ULL << (qid % 64);
+		break;
+	default:
+		break;
+	}
+
+	return 0;
+}
+
+/* Queue ids are local to a device, a queue fed on one device and drained
+ * on another would silently lose every event.
+ */
+static int
+vswitch_validate_queues()
+{
+	struct vswitch_queue_map map;
+	uint8_t ev_id;
+	int i;
+
+	memset(&map, 0, sizeof(map));
+	stage_config_walk(stage_map_queues, &map);
+
+	for (ev_id = 0; ev_id < config->nb_eventdevs; ev_id++) {
+		for (i = 0; i < 4; i++) {
+			if (map.produced[ev_id][i] != map.consumed[ev_id][i]) {
+				RTE_LOG(INFO, USER1, "Eventdev (%u) queues not both produced and consumed:"
+					" 0x%016" PRIx64 "\n", ev_id,
+					map.produced[ev_id][i] ^ map.consumed[ev_id][i]);
+				return -EINVAL;
+			}
+		}
+	}
+
+	return 0;
+}
+
+static void
+vswitch_eventdev_add_queue(struct vswitch_eventdev *ev, uint8_t qid)
+{
+	if (qid != EV_QUEUE_ID_INVALID && qid >= ev->nb_queues)
+		ev->nb_queues = qid + 1;
+}
+
 static int
 stage_get_lcore_config(struct stage_config *stage_config, __rte_unused void *data)
 {
+	struct vswitch_eventdev *ev = NULL;
 	uint16_t core_id;
+	int rc;
+
+	if (stage_config->type != STAGE_TYPE_RTC) {
+		ev = &config->eventdevs[stage_config->ev_id];
+		if (stage_config->type != STAGE_TYPE_RX)
+			vswitch_eventdev_add_queue(ev, stage_config->ev_queue.in);
+		if (stage_config->type != STAGE_TYPE_TX)
+			vswitch_eventdev_add_queue(ev, stage_config->ev_queue.out);
+	}
+
+	/* Adapter stages run as services, their cores get no graph */
+	if (stage_config->adapter)
+		return adapter_stage_reserve(stage_config, &ev->nb_ports);
 
 	RTE_LCORE_FOREACH_WORKER(core_id) {
 		if (stage_config->coremask & (1UL << core_id)) {
-			lcore_config_populate(stage_config, config->nb_ports++, &config->lcores[core_id]);
+			if (stage_config->type == STAGE_TYPE_RTC)
+				rc = lcore_config_populate(stage_config, 0, &config->lcores[core_id]);
+			else
+				rc = lcore_config_populate(stage_config, ev->nb_ports++, &config->lcores[core_id]);
+			if (rc < 0)
+				return rc;
 		}
 	}
 
-	if (stage_config->type == STAGE_TYPE_WORKER ||
-	    stage_config->type == STAGE_TYPE_TX)
-		config->nb_queues++;
+	return 0;
+}
+
+/* Connection tracking keeps a table per core. Each core of such a stage
+ * drains a queue of its own and the stages feeding it pick the queue by
+ * flow id, so both directions of a flow always meet the same table. The
+ * first core keeps the configured queue, the others get queues past the
+ * configured ones.
+ */
+struct vswitch_steer {
+	struct stage_config *stage;
+	uint8_t nb_queues;
+	uint8_t queues[LCORE_EV_OUT_QUEUES_MAX];
+};
+
+static int
+stage_check_steer_input(struct stage_config *stage_config, void *data)
+{
+	struct stage_config *steered = ((struct vswitch_steer *)data)->stage;
+
+	if ((stage_config->type != STAGE_TYPE_RX &&
+	     stage_config->type != STAGE_TYPE_WORKER) ||
+	    stage_config->ev_id != steered->ev_id ||
+	    stage_config->ev_queue.out != steered->ev_queue.in)
+		return 0;
+
+	/* The Rx adapter enqueues to the configured queue only */
+	if (stage_config->adapter) {
+		RTE_LOG(INFO, USER1, "Stage %s: conntrack cannot be fed by the Rx adapter of %s\n",
+			steered->name, stage_config->name);
+		return -ENOTSUP;
+	}
+
+	/* Replies must hash to the same core as the original direction */
+	if (stage_config->type == STAGE_TYPE_RX &&
+	    stage_config->flow_hash == FLOW_HASH_NONE) {
+		RTE_LOG(INFO, USER1, "Stage %s: conntrack needs a flow hash on %s\n",
+			steered->name, stage_config->name);
+		return -EINVAL;
+	}
 
 	return 0;
 }
 
 static int
-stage_configure_input_queues(__rte_unused struct stage_config *stage_config, __rte_unused void *data)
+stage_steer_queues(struct stage_config *stage_config, __rte_unused void *data)
 {
+	struct vswitch_eventdev *ev;
+	struct lcore_params *lcore;
+	struct vswitch_steer steer;
+	uint16_t core_id;
+	int rc;
+
+	if (stage_config->type != STAGE_TYPE_WORKER || !stage_config->conntrack)
+		return 0;
+
+	steer.stage = stage_config;
+	rc = stage_config_walk(stage_check_steer_input, &steer);
+	if (rc < 0)
+		return rc;
+
+	ev = &config->eventdevs[stage_config->ev_id];
+	steer.nb_queues = 0;
+	RTE_LCORE_FOREACH_WORKER(core_id) {
+		if (!(stage_config->coremask & (1UL << core_id)))
+			continue;
+
+		lcore = &config->lcores[core_id];
+		if (steer.nb_queues) {
+			if (ev->nb_queues >= ev->info.max_event_queues ||
+			    ev->nb_queues >= EV_QUEUE_ID_INVALID) {
+				RTE_LOG(INFO, USER1, "Stage %s: out of event queues for conntrack\n",
+					stage_config->name);
+				return -ENOSPC;
+			}
+			lcore->ev_in_queue = ev->nb_queues++;
+		}
+		steer.queues[steer.nb_queues++] = lcore->ev_in_queue;
+	}
+
+	for (core_id = 0; core_id < RTE_MAX_LCORE; core_id++) {
+		lcore = &config->lcores[core_id];
+		if (!lcore->enabled || !lcore->ev_out_queue_needed ||
+		    lcore->ev_id != stage_config->ev_id ||
+		    lcore->ev_out_queue != stage_config->ev_queue.in)
+			continue;
+
+		memcpy(lcore->ev_out_queues, steer.queues, steer.nb_queues);
+		lcore->nb_ev_out_queues = steer.nb_queues;
+	}
+
+	return 0;
+}
+
+static int
+stage_configure_input_queues(struct stage_config *stage_config, __rte_unused void *data)
+{
+	struct vswitch_eventdev *ev;
+	uint16_t core_id;
 	int rc = 0;
 
-	if (config->ev_info.event_dev_cap & RTE_EVENT_DEV_CAP_QUEUE_ALL_TYPES)
+	if (stage_config->type != STAGE_TYPE_WORKER &&
+	    stage_config->type != STAGE_TYPE_TX)
+		return 0;
+
+	ev = &config->eventdevs[stage_config->ev_id];
+	if (ev->info.event_dev_cap & RTE_EVENT_DEV_CAP_QUEUE_ALL_TYPES)
 		stage_config->ev_queue.config_in.event_queue_cfg |= RTE_EVENT_QUEUE_CFG_ALL_TYPES;
 
-	if (stage_config->type == STAGE_TYPE_WORKER ||
-	    stage_config->type == STAGE_TYPE_TX) {
-		rc = rte_event_queue_setup(config->ev_id,
-					   stage_config->ev_queue.in,
+	rc = rte_event_queue_setup(stage_config->ev_id,
+				   stage_config->ev_queue.in,
+				   &stage_config->ev_queue.config_in);
+	if (rc < 0 || !stage_config->conntrack)
+		return rc;
+
+	/* The per core queues of a conntrack stage, see stage_steer_queues() */
+	RTE_LCORE_FOREACH_WORKER(core_id) {
+		if (!(stage_config->coremask & (1UL << core_id)) ||
+		    config->lcores[core_id].ev_in_queue == stage_config->ev_queue.in)
+			continue;
+
+		rc = rte_event_queue_setup(stage_config->ev_id,
+					   config->lcores[core_id].ev_in_queue,
 					   &stage_config->ev_queue.config_in);
+		if (rc < 0)
+			return rc;
 	}
 
-	return rc;
+	return 0;
+}
+
+static int
+vswitch_eventdev_configure(uint8_t ev_id)
+{
+	struct vswitch_eventdev *ev = &config->eventdevs[ev_id];
+	struct rte_event_dev_config ev_config;
+	int rc;
+
+	memset(&ev_config, 0, sizeof(ev_config));
+	ev_config.nb_event_queues = ev->nb_queues;
+	ev_config.nb_event_ports = ev->nb_ports;
+	ev_config.nb_events_limit  = ev->info.max_num_events;
+	ev_config.nb_event_queue_flows = 1024;
+	ev_config.nb_event_port_dequeue_depth = ev->info.max_event_port_dequeue_depth;
+	ev_config.nb_event_port_enqueue_depth = ev->info.max_event_port_enqueue_depth;
+	rc = rte_event_dev_configure(ev_id, &ev_config);
+	if (rc < 0)
+		return rc;
+
+	return 0;
+}
+
+static int
+vswitch_eventdev_start(uint8_t ev_id)
+{
+	struct vswitch_eventdev *ev = &config->eventdevs[ev_id];
+	int rc;
+
+	rc = rte_event_dev_service_id_get(ev_id, &ev->service_id);
+	if (rc == 0) {
+		rte_service_runstate_set(ev->service_id, 1);
+		rte_service_set_runstate_mapped_check(ev->service_id, 0);
+	} else if (rc != -ESRCH) {
+		return rc;
+	}
+
+	rc = rte_event_dev_start(ev_id);
+	if (rc < 0)
+		return rc;
+
+	return adapter_start(ev_id);
+}
+
+static int
+stage_snapshot(struct stage_config *stage_config, __rte_unused void *data)
+{
+	memcpy(&config->stages[stage_config->stage_id], stage_config, sizeof(*stage_config));
+	return 0;
+}
+
+static void
+vswitch_stage_snapshot(void)
+{
+	memset(config->stages, 0, sizeof(config->stages));
+	stage_config_walk(stage_snapshot, NULL);
 }
 
 int
 vswitch_start()
 {
-	struct rte_event_dev_config ev_config;
 	uint16_t core_id;
 	int rc = -EINVAL;
+	uint8_t ev_id;
 
 	// Start all links
 	link_start();
 
-	stage_config_walk(stage_get_lcore_config, config);
+	rc = bridge_start(config->qsv);
+	if (rc < 0)
+		goto err;
 
-	memset(&ev_config, 0, sizeof(ev_config));
-	ev_config.nb_event_queues = config->nb_queues;
-	ev_config.nb_event_ports = config->nb_ports;
-	ev_config.nb_events_limit  = config->ev_info.max_num_events;
-	ev_config.nb_event_queue_flows = 1024;
-	ev_config.nb_event_port_dequeue_depth = config->ev_info.max_event_port_dequeue_depth;
-	ev_config.nb_event_port_enqueue_depth = config->ev_info.max_event_port_enqueue_depth;
-	rc = rte_event_dev_configure(config->ev_id, &ev_config);
-	if (rc < 0) {
-		rc = -rte_errno;
+	rc = tunnel_start();
+	if (rc < 0)
+		goto err;
+
+	rc = acl_start(config->qsv);
+	if (rc < 0)
+		goto err;
+
+	rc = nat_start();
+	if (rc < 0)
+		goto err;
+
+	rc = policer_start();
+	if (rc < 0)
+		goto err;
+
+	rc = tx_sched_start();
+	if (rc < 0)
+		goto err;
+
+	rc = exception_start();
+	if (rc < 0)
+		goto err;
+
+	rc = stage_config_walk(stage_resolve_eventdev, config);
+	if (rc < 0)
+		goto err;
+
+	rc = vswitch_validate_queues();
+	if (rc < 0)
+		goto err;
+
+	rc = stage_config_walk(stage_get_lcore_config, config);
+	if (rc < 0)
+		goto err;
+
+	rc = stage_config_walk(stage_steer_queues, config);
+	if (rc < 0)
 		goto err;
+
+	/* Run-to-completion stages need no event ports */
+	for (ev_id = 0; ev_id < config->nb_eventdevs; ev_id++) {
+		if (config->eventdevs[ev_id].nb_ports == 0)
+			continue;
+
+		rc = vswitch_eventdev_configure(ev_id);
+		if (rc < 0)
+			goto err;
 	}
 
-	stage_config_walk(stage_configure_input_queues, config);
+	rc = stage_config_walk(stage_configure_input_queues, config);
+	if (rc < 0)
+		goto err;
+
+	rc = stage_config_walk(adapter_stage_setup, config);
+	if (rc < 0)
+		goto err;
 
 	RTE_LCORE_FOREACH_WORKER(core_id) {
 		rc = lcore_graph_populate(&config->lcores[core_id], config->params.enable_graph_pcap);
 		if (rc < 0)
 			goto err;
+
+		rc = lcore_graph_create(&config->lcores[core_id]);
+		if (rc < 0)
+			goto err;
 	}
 
-	rc = rte_event_dev_service_id_get(config->ev_id, &config->ev_service_id);
-	if (rc != -ESRCH && rc != 0) {
-		goto err;
+	for (ev_id = 0; ev_id < config->nb_eventdevs; ev_id++) {
+		if (config->eventdevs[ev_id].nb_ports == 0)
+			continue;
+
+		rc = vswitch_eventdev_start(ev_id);
+		if (rc < 0)
+			goto err;
 	}
-	rte_service_runstate_set(config->ev_service_id, 1);
-	rte_service_set_runstate_mapped_check(config->ev_service_id, 0);
 
-	rc = rte_event_dev_start(config->ev_id);
-	if (rc < 0) {
-		rc = -rte_errno;
+	RTE_LCORE_FOREACH_WORKER(core_id) {
+		if (!config->lcores[core_id].enabled)
+			continue;
+		rte_eal_remote_launch(lcore_graph_worker, &config->lcores[core_id], core_id);
+	}
+
+	vswitch_stage_snapshot();
+	config->started = 1;
+	return 0;
+
+err:
+	return rc;
+}
+
+static int
+stage_get_rtc_lcore_config(struct stage_config *stage_config, void *data)
+{
+	struct lcore_params *next = data;
+	uint16_t core_id;
+	int rc;
+
+	if (stage_config->type != STAGE_TYPE_RTC || stage_config->adapter)
+		return 0;
+
+	RTE_LCORE_FOREACH_WORKER(core_id) {
+		if (!(stage_config->coremask & (1UL << core_id)))
+			continue;
+
+		/* Event ports are set up once, those lcores keep their graph */
+		if (config->lcores[core_id].enabled &&
+		    config->lcores[core_id].type != STAGE_TYPE_RTC)
+			return -EBUSY;
+
+		rc = lcore_config_populate(stage_config, 0, &next[core_id]);
+		if (rc < 0)
+			return rc;
+	}
+
+	return 0;
+}
+
+/* Event ports, queues and adapters are set up once at start, only the
+ * run-to-completion stages can change under a rebuild.
+ */
+static int
+stage_check_reconfigure(struct stage_config *stage_config, __rte_unused void *data)
+{
+	struct stage_config *old = &config->stages[stage_config->stage_id];
+	bool rtc = stage_config->type == STAGE_TYPE_RTC;
+
+	if (old->name[0] == '\0' || strcmp(old->name, stage_config->name) != 0) {
+		if (rtc)
+			return 0;
+
+		RTE_LOG(INFO, USER1, "Stage %s: eventdev stages cannot be added at runtime\n",
+			stage_config->name);
+		return -ENOTSUP;
+	}
+
+	if ((old->type == STAGE_TYPE_RTC) != rtc) {
+		RTE_LOG(INFO, USER1, "Stage %s: cannot move between eventdev and rtc at runtime\n",
+			stage_config->name);
+		return -EBUSY;
+	}
+
+	if (!rtc && memcmp(old, stage_config, sizeof(*old)) != 0) {
+		RTE_LOG(INFO, USER1, "Stage %s: eventdev stage changes need a restart\n",
+			stage_config->name);
+		return -ENOTSUP;
+	}
+
+	return 0;
+}
+
+static int
+vswitch_check_reconfigure(void)
+{
+	struct stage *s;
+	uint32_t i;
+	int rc;
+
+	rc = stage_config_walk(stage_check_reconfigure, NULL);
+	if (rc < 0)
+		return rc;
+
+	for (i = 0; i < STAGE_MAX; i++) {
+		if (config->stages[i].name[0] == '\0' ||
+		    config->stages[i].type == STAGE_TYPE_RTC)
+			continue;
+
+		s = stage_config_get(config->stages[i].name);
+		if (!s || s->config.stage_id != i) {
+			RTE_LOG(INFO, USER1, "Stage %s: eventdev stages cannot be removed at runtime\n",
+				config->stages[i].name);
+			return -ENOTSUP;
+		}
+	}
+
+	return 0;
+}
+
+static bool
+vswitch_lcore_rebuilt(struct lcore_params const *next, uint16_t core_id)
+{
+	struct lcore_params const *lcore = &config->lcores[core_id];
+
+	return next[core_id].enabled ||
+	       (lcore->enabled && lcore->type == STAGE_TYPE_RTC);
+}
+
+/* Builds new graphs for the run-to-completion lcores from the current
+ * stage and link config, next to the running ones. The lcores are then
+ * parked at a quiescent point, handed their new graph and the old graphs
+ * destroyed. Nothing changes when a graph fails to build.
+ */
+int
+vswitch_reconfigure()
+{
+	struct lcore_params *next;
+	rte_graph_t old_id;
+	uint16_t core_id;
+	int rc;
+
+	if (!config || !config->started)
+		return -EAGAIN;
+
+	if (config->generation == VSWITCH_GENERATION_MAX) {
+		RTE_LOG(INFO, USER1, "Graphs rebuilt %u times, restart to rebuild again\n",
+			VSWITCH_GENERATION_MAX);
+		return -ENOSPC;
+	}
+
+	rc = vswitch_check_reconfigure();
+	if (rc < 0)
+		return rc;
+
+	next = rte_zmalloc(NULL, RTE_MAX_LCORE * sizeof(*next), RTE_CACHE_LINE_SIZE);
+	if (!next)
+		return -ENOMEM;
+
+	config->generation++;
+	for (core_id = 0; core_id < RTE_MAX_LCORE; core_id++) {
+		lcore_init(core_id, &next[core_id]);
+		next[core_id].qsv = config->qsv;
+		next[core_id].generation = config->generation;
+	}
+
+	rc = link_start();
+	if (rc < 0)
+		goto err;
+
+	rc = stage_config_walk(stage_get_rtc_lcore_config, next);
+	if (rc < 0)
 		goto err;
+
+	RTE_LCORE_FOREACH_WORKER(core_id) {
+		if (!vswitch_lcore_rebuilt(next, core_id))
+			continue;
+
+		rc = lcore_graph_populate(&next[core_id], config->params.enable_graph_pcap);
+		if (rc < 0)
+			goto err_graph;
+
+		rc = lcore_graph_create(&next[core_id]);
+		if (rc < 0)
+			goto err_graph;
 	}
 
+	/* Park, the old graphs are done with once every worker has been
+	 * quiescent since.
+	 */
 	RTE_LCORE_FOREACH_WORKER(core_id) {
-		rte_eal_remote_launch(lcore_graph_worker, &config->lcores[core_id], core_id);
+		if (!vswitch_lcore_rebuilt(next, core_id))
+			continue;
+
+		__atomic_store_n(&config->lcores[core_id].graph, NULL, __ATOMIC_RELEASE);
 	}
+	rte_rcu_qsbr_synchronize(config->qsv, RTE_QSBR_THRID_INVALID);
 
+	RTE_LCORE_FOREACH_WORKER(core_id) {
+		if (!vswitch_lcore_rebuilt(next, core_id))
+			continue;
+
+		old_id = config->lcores[core_id].graph_id;
+		lcore_params_update(&config->lcores[core_id], &next[core_id]);
+		__atomic_store_n(&config->lcores[core_id].graph, next[core_id].graph,
+				 __ATOMIC_RELEASE);
+
+		if (next[core_id].enabled &&
+		    rte_eal_get_lcore_state(core_id) == WAIT)
+			rte_eal_remote_launch(lcore_graph_worker, &config->lcores[core_id], core_id);
+
+		if (old_id != RTE_GRAPH_ID_INVALID)
+			rte_graph_destroy(old_id);
+	}
+
+	vswitch_stage_snapshot();
+	RTE_LOG(INFO, USER1, "Graphs rebuilt, generation %u\n", config->generation);
+	rte_free(next);
 	return 0;
 
+err_graph:
+	RTE_LCORE_FOREACH_WORKER(core_id) {
+		if (next[core_id].graph_id != RTE_GRAPH_ID_INVALID)
+			rte_graph_destroy(next[core_id].graph_id);
+	}
 err:
+	rte_free(next);
 	return rc;
 }
 